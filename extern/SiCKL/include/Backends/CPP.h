@@ -0,0 +1,118 @@
+#pragma once
+
+#include "SiCKL.h"
+
+#include <math.h>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <map>
+
+namespace SiCKL
+{
+	/// interface between CPUProgram and generated kernels
+
+	// a uniform (Data points at its components) or buffer input
+	struct CPPKernelInput
+	{
+		const void* Data;
+		int32_t Width;
+		int32_t Height;
+		int32_t Components;
+	};
+
+	struct CPPKernelOutput
+	{
+		void* Data;
+		int32_t Width;
+		int32_t Height;
+		int32_t Components;
+	};
+
+	// inputs and outputs are in ConstData and OutData declaration order
+	struct CPPKernelArgs
+	{
+		// the Index() grid
+		int32_t Width;
+		int32_t Height;
+		// rows of the grid to run
+		int32_t RowBegin;
+		int32_t RowEnd;
+		const CPPKernelInput* Inputs;
+		const CPPKernelOutput* Outputs;
+	};
+
+	typedef void (*CPPKernel)(const CPPKernelArgs&);
+
+	// generated kernels register themselves (by the hash of their source) with a static one of these
+	struct CPPKernelRegistration
+	{
+		CPPKernelRegistration(uint64_t hash, CPPKernel kernel);
+	};
+
+	/// prints a Source as C++ which can be compiled into the binary; CPUCompiler
+	/// uses the compiled kernel in place of its interpreter when the hashes match
+	class CPPGenerator
+	{
+	public:
+		// a complete translation unit for the kernel
+		static std::string Generate(const Source&);
+		static uint64_t Hash(const Source&);
+		// the registered kernel for this Source, if any
+		static CPPKernel FindKernel(const Source&);
+		static bool HasKernels();
+	private:
+		CPPGenerator();
+
+		uint32_t _indent;
+		std::stringstream _ss;
+
+		// symbol id -> input index
+		std::map<symbol_id_t, int32_t> _inputs;
+		// symbol id -> type for every symbol used
+		std::map<symbol_id_t, ReturnType::Type> _symbols;
+		// symbol id -> variable name
+		std::map<symbol_id_t, uint32_t> _names;
+
+		// prints the body of the kernel function
+		std::string print_kernel(const ASTNode&);
+		void collect_symbols(const ASTNode*);
+
+		void print_type(ReturnType::Type);
+		void print_indent();
+		void print_var(symbol_id_t, uint32_t component);
+		void print_literal(const ASTNode*);
+		void print_block(const ASTNode*, uint32_t first_child);
+		void print_statement(const ASTNode*);
+		void print_assignment(const ASTNode*);
+		// print component of an expression, converted to the given base type
+		void print_operand(const ASTNode*, uint32_t component, ReturnType::Type to);
+		void print_expression(const ASTNode*, uint32_t component);
+		void print_function(const ASTNode*, uint32_t component);
+	};
+
+	/// helpers used by generated code; these match the CPUProgram interpreter
+
+	inline int32_t CPPDivide(int32_t a, int32_t b) {return (b == 0 || (b == -1 && a == (-2147483647 - 1))) ? 0 : a / b;}
+	inline uint32_t CPPDivide(uint32_t a, uint32_t b) {return b == 0 ? 0 : a / b;}
+	inline float CPPDivide(float a, float b) {return a / b;}
+	inline int32_t CPPModulo(int32_t a, int32_t b) {return (b == 0 || b == -1) ? 0 : a % b;}
+	inline uint32_t CPPModulo(uint32_t a, uint32_t b) {return b == 0 ? 0 : a % b;}
+	inline float CPPModulo(float a, float b) {return a - b * floorf(a / b);}
+	inline int32_t CPPSign(int32_t a) {return (a > 0) - (a < 0);}
+	inline float CPPSign(float a) {return a > 0.0f ? 1.0f : (a < 0.0f ? -1.0f : 0.0f);}
+	inline float CPPMin(float a, float b) {return b < a ? b : a;}
+	inline float CPPMax(float a, float b) {return a < b ? b : a;}
+	inline float CPPClamp(float a, float lo, float hi) {return CPPMin(CPPMax(a, lo), hi);}
+
+	// out of range reads return 0
+	template<typename T>
+	inline T CPPSample(const CPPKernelInput& buffer, int32_t x, int32_t y, int32_t component)
+	{
+		if(x < 0 || y < 0 || x >= buffer.Width || y >= buffer.Height)
+		{
+			return T(0);
+		}
+		return ((const T*)buffer.Data)[(y * buffer.Width + x) * buffer.Components + component];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "SiCKL.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace SiCKL
+{
+	class CPURuntime
+	{
+	public:
+		// start the worker threads programs are run on, 0 means one per hardware thread
+		static bool Initialize(uint32_t thread_count = 0);
+		// and tear them down
+		static bool Finalize();
+		static uint32_t GetThreadCount();
+		// buffers are only limited by memory; matches OpenGLRuntime so either can back a program
+		static int32_t GetMaxTextureSize();
+		// when set, CPUCompiler writes CPPGenerator output for every kernel it builds which has
+		// no compiled version here; add those files to the build to use them
+		static void SetGeneratedKernelPath(const char* in_path);
+		// programs built while this is off always run on the interpreter (on by default)
+		static void SetUseGeneratedKernels(bool in_use);
+		// the interpreter runs this many grid points at a time, one per SIMD lane: 4 (SSE2, the
+		// default), 8 (AVX2) or 16 (AVX-512); the caller checks the CPU supports the wider ones
+		static bool SetLaneCount(uint32_t in_lanes);
+		static uint32_t GetLaneCount();
+
+		friend class CPUProgram;
+	};
+
+	// buffers are plain 16 byte aligned host memory; elements are stored row major
+	// with one 32 bit value per component (Bool is not a valid buffer type)
+
+	struct CPUBuffer1D
+	{
+		CPUBuffer1D();
+		CPUBuffer1D(int32_t length, ReturnType::Type type, const void* data);
+		~CPUBuffer1D();
+		CPUBuffer1D(const CPUBuffer1D&);
+		CPUBuffer1D& operator=(const CPUBuffer1D&);
+
+		uint32_t GetBufferSize() const;
+
+		void SetData(const void* in_buffer);
+
+		const int32_t Length;
+		const ReturnType::Type Type;
+		void* const Data;
+	private:
+		int32_t* _counter;
+	};
+
+	struct CPUBuffer2D
+	{
+		CPUBuffer2D();
+		CPUBuffer2D(int32_t width, int32_t height, ReturnType::Type type, const void* data);
+		~CPUBuffer2D();
+		CPUBuffer2D(const CPUBuffer2D&);
+		CPUBuffer2D& operator=(const CPUBuffer2D&);
+
+		uint32_t GetBufferSize() const;
+
+		template<typename T>
+		inline void GetData(T*& in_out_buffer) const
+		{
+			get_data((void**)&in_out_buffer);
+		}
+
+		void SetData(const void* in_buffer);
+
+		const int32_t Width;
+		const int32_t Height;
+		const ReturnType::Type Type;
+		void* const Data;
+	private:
+		void get_data(void** in_out_buffer) const;
+
+		int32_t* _counter;
+	};
+
+	/// handles for setting inputs and outputs for CPU Programs
+	typedef int32_t input_t;
+	typedef int32_t output_t;
+	class CPUProgram : public Program
+	{
+	public:
+		virtual ~CPUProgram();
+		// sets the size of the Index() grid
+		void Initialize(int32_t width, int32_t height);
+
+		input_t GetInputHandle(const char*);
+		output_t GetOutputHandle(const char*);
+		// inputs to program
+		void SetInput(input_t, bool);
+		void SetInput(input_t, int32_t);
+		void SetInput(input_t, uint32_t);
+		void SetInput(input_t, float);
+		// vec2s
+		void SetInput(input_t, int32_t, int32_t);
+		void SetInput(input_t, uint32_t, uint32_t);
+		void SetInput(input_t, float, float);
+		// vec3s
+		void SetInput(input_t, int32_t, int32_t, int32_t);
+		void SetInput(input_t, uint32_t, uint32_t, uint32_t);
+		void SetInput(input_t, float, float, float);
+		// vec4s
+		void SetInput(input_t, int32_t, int32_t, int32_t, int32_t);
+		void SetInput(input_t, uint32_t, uint32_t, uint32_t, uint32_t);
+		void SetInput(input_t, float, float, float, float);
+
+		void SetInput(input_t, const CPUBuffer1D&);
+		void SetInput(input_t, const CPUBuffer2D&);
+
+		// outputs
+		void BindOutput(output_t, const CPUBuffer2D&);
+
+		// copy an output buffer out
+		template<typename T>
+		inline void GetOutput(output_t o, T*& in_out_buffer)
+		{
+			get_output(o, 0, 0, _size[0], _size[1], (void**)&in_out_buffer);
+		}
+
+		template<typename T>
+		inline void GetSubOutput(output_t o, int32_t offset_x, int32_t offset_y, int32_t width, int32_t height, T*& in_out_buffer)
+		{
+			get_output(o, offset_x, offset_y, width, height, (void**)&in_out_buffer);
+		}
+
+		virtual void Run();
+		// true when Run uses a compiled kernel rather than interpreting the program
+		bool HasGeneratedKernel() const;
+	private:
+		CPUProgram();
+		CPUProgram(const CPUProgram&);
+		CPUProgram& operator=(const CPUProgram&);
+		friend class CPUCompiler;
+
+		void get_output(output_t, int32_t, int32_t, int32_t, int32_t, void**);
+		void set_input(input_t, ReturnType::Type, const void*);
+
+		// every register holds up to 4 components; Bool is stored as 0 or 1
+		union Value
+		{
+			int32_t i[4];
+			uint32_t u[4];
+			float f[4];
+		};
+
+		// a single bytecode op; see OpCode in CPUInterpreter.h
+		struct Instruction
+		{
+			uint8_t OpCode;
+			// base type and component count of the result
+			uint8_t Type;
+			uint8_t Width;
+			// base type of the operands for comparisons and conversions
+			uint8_t SourceType;
+			uint16_t Dest;
+			uint16_t Source[3];
+			// member index, function id, input index or jump target
+			int32_t Immediate;
+		};
+
+		// grid points are run Lanes at a time along x, one per SIMD lane; a register for every
+		// lane, stored component major so each component is a SIMD vector
+		template<int32_t Lanes>
+		union LaneValue
+		{
+			int32_t i[4][Lanes];
+			uint32_t u[4][Lanes];
+			float f[4][Lanes];
+		};
+
+		// the lane masks for an If chain or loop
+		template<int32_t Lanes>
+		struct MaskEntry
+		{
+			// mask on entry
+			uint32_t Saved[Lanes];
+			// lanes which haven't taken a branch yet
+			uint32_t Remaining[Lanes];
+		};
+
+		// where a grid point reads a buffer input from
+		struct Sampler
+		{
+			const uint32_t* Data;
+			int32_t Width;
+			int32_t Height;
+			uint32_t Components;
+		};
+
+		// where a grid point writes an output to
+		struct Target
+		{
+			uint32_t* Data;
+			int32_t Width;
+			int32_t Height;
+			uint32_t Components;
+			uint16_t Register;
+		};
+
+		// what the interpreter reads, resolved once per Run
+		struct InterpreterArgs
+		{
+			const Instruction* Code;
+			int32_t CodeSize;
+			const Value* Registers;
+			uint32_t RegisterCount;
+			const Sampler* Samplers;
+			const Target* Targets;
+			uint32_t TargetCount;
+		};
+
+		void run_kernel();
+		// the interpreter; each lane count is built for its own instruction set, see CPUInterpreter.h
+		template<int32_t Lanes>
+		void run_rows(int32_t row_begin, int32_t row_end, const InterpreterArgs& args) const;
+		template<int32_t Lanes>
+		void execute(LaneValue<Lanes>* registers, MaskEntry<Lanes>* mask_stack, int32_t x, int32_t y, const InterpreterArgs& args) const;
+
+		// the Index() grid
+		int32_t _size[2];
+
+		// compiled version of this program, used instead of _code when present
+		CPPKernel _kernel;
+
+		std::vector<Instruction> _code;
+		// deepest nesting of If chains and loops
+		uint32_t _mask_depth;
+		// literals and uniform values; copied into each worker's register file
+		std::vector<Value> _registers;
+
+		struct Input
+		{
+			std::string _name;
+			ReturnType::Type _type;
+			// register for scalar and vector uniforms
+			uint16_t _register;
+			CPUBuffer1D _buffer1d;
+			CPUBuffer2D _buffer2d;
+		};
+		std::vector<Input> _inputs;
+
+		struct Output
+		{
+			std::string _name;
+			ReturnType::Type _type;
+			uint16_t _register;
+			CPUBuffer2D _buffer;
+		};
+		std::vector<Output> _outputs;
+	};
+
+	class CPUCompiler : public Compiler<CPUProgram>
+	{
+	public:
+		virtual CPUProgram* Build(const Source&);
+	private:
+		CPUProgram* _program;
+
+		// symbol id -> register for variables, uniforms and outputs
+		std::map<symbol_id_t, uint16_t> _variables;
+		// symbol id -> input index for buffers
+		std::map<symbol_id_t, int32_t> _buffers;
+		// literal bits -> register
+		std::map<std::pair<uint32_t, uint32_t>, uint16_t> _literals;
+		// temporaries live above the variables and literals and are reused between statements
+		uint16_t _next_temp;
+		uint16_t _register_count;
+		uint32_t _mask_depth;
+
+		void allocate_registers(const ASTNode*);
+		uint16_t allocate_variable(symbol_id_t);
+		uint16_t allocate_literal(const ASTNode*);
+		uint16_t allocate_temp();
+
+		void compile_block(const ASTNode*, uint32_t first_child);
+		void compile_statement(const ASTNode*);
+		uint16_t compile_expression(const ASTNode*);
+		uint16_t compile_function(const ASTNode*);
+		uint16_t convert(uint16_t, ReturnType::Type from, ReturnType::Type to);
+
+		uint32_t emit(uint8_t op_code, ReturnType::Type type, uint16_t dest, uint16_t source0 = 0, uint16_t source1 = 0, uint16_t source2 = 0, int32_t immediate = 0);
+		void push_mask();
+		void pop_mask();
+		void patch_jump(uint32_t instruction);
+	};
+}
\ No newline at end of file
@@ -15,4 +15,6 @@
 
 // Backends
 #include "Backends/OpenGL.h"
+#include "Backends/CPP.h"
+#include "Backends/CPU.h"
 
@@ -0,0 +1,847 @@
+#include "SiCKL.h"
+#include "TypeInfo.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Source.h's Else macro collides with NodeType::Else
+#undef Else
+
+namespace SiCKL
+{
+	/// Registry
+
+	static std::map<uint64_t, CPPKernel>& registered_kernels()
+	{
+		// function local so registrations from other translation units can run during static init
+		static std::map<uint64_t, CPPKernel> kernels;
+		return kernels;
+	}
+
+	CPPKernelRegistration::CPPKernelRegistration(uint64_t hash, CPPKernel kernel)
+	{
+		registered_kernels()[hash] = kernel;
+	}
+
+	static uint64_t fnv1a(const std::string& in_string)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for(size_t k = 0; k < in_string.size(); k++)
+		{
+			hash ^= (uint8_t)in_string[k];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	/// CPPGenerator
+
+	CPPGenerator::CPPGenerator()
+		: _indent(0)
+	{ }
+
+	std::string CPPGenerator::Generate(const Source& in_source)
+	{
+		CPPGenerator generator;
+		const std::string body = generator.print_kernel(in_source.GetRoot());
+
+		char name[32];
+		sprintf(name, "sickl_kernel_%016llx", (unsigned long long)fnv1a(body));
+
+		std::stringstream ss;
+		ss << "// generated by SiCKL::CPPGenerator, do not edit\n";
+		ss << "#include \"SiCKL.h\"\n";
+		ss << "\n";
+		ss << "namespace\n";
+		ss << "{\n";
+		ss << "\tusing namespace SiCKL;\n";
+		ss << "\n";
+		ss << "\tvoid " << name << "(const CPPKernelArgs& args)\n";
+		ss << body;
+		ss << "\n";
+		ss << "\tCPPKernelRegistration " << name << "_registration(0x" << (name + 13) << "ull, &" << name << ");\n";
+		ss << "}\n";
+		return ss.str();
+	}
+
+	uint64_t CPPGenerator::Hash(const Source& in_source)
+	{
+		CPPGenerator generator;
+		return fnv1a(generator.print_kernel(in_source.GetRoot()));
+	}
+
+	CPPKernel CPPGenerator::FindKernel(const Source& in_source)
+	{
+		if(HasKernels() == false)
+		{
+			return nullptr;
+		}
+
+		auto it = registered_kernels().find(Hash(in_source));
+		return it != registered_kernels().end() ? it->second : nullptr;
+	}
+
+	bool CPPGenerator::HasKernels()
+	{
+		return registered_kernels().empty() == false;
+	}
+
+	std::string CPPGenerator::print_kernel(const ASTNode& in_root)
+	{
+		const ASTNode* const_data = nullptr;
+		const ASTNode* out_data = nullptr;
+		const ASTNode* main = nullptr;
+		for(uint32_t k = 0; k < in_root._count; k++)
+		{
+			const ASTNode* node = in_root._children[k];
+			switch(node->_node_type)
+			{
+			case NodeType::ConstData:
+				const_data = node;
+				break;
+			case NodeType::OutData:
+				out_data = node;
+				break;
+			case NodeType::Main:
+				main = node;
+				break;
+			}
+		}
+		COMPUTE_ASSERT(main != nullptr);
+
+		for(uint32_t k = 0; const_data != nullptr && k < const_data->_count; k++)
+		{
+			_inputs[const_data->_children[k]->_u.sid] = int32_t(k);
+		}
+		collect_symbols(const_data);
+		collect_symbols(out_data);
+		collect_symbols(main);
+
+		_ss << "\t{\n";
+		_indent = 2;
+
+		// uniforms are loaded once per call
+		for(uint32_t k = 0; const_data != nullptr && k < const_data->_count; k++)
+		{
+			const ASTNode* node = const_data->_children[k];
+			if(is_buffer(node->_return_type))
+			{
+				continue;
+			}
+			for(uint32_t c = 0; c < component_count(node->_return_type); c++)
+			{
+				print_indent();
+				_ss << "const ";
+				print_type(node->_return_type);
+				_ss << " ";
+				print_var(node->_u.sid, c);
+				_ss << " = ((const ";
+				print_type(node->_return_type);
+				_ss << "*)args.Inputs[" << k << "].Data)[" << c << "];\n";
+			}
+		}
+
+		print_indent(); _ss << "for(int32_t y = args.RowBegin; y < args.RowEnd; y++)\n";
+		print_indent(); _ss << "{\n";
+		_indent++;
+		print_indent(); _ss << "for(int32_t x = 0; x < args.Width; x++)\n";
+		print_indent(); _ss << "{\n";
+		_indent++;
+
+		// every variable is declared up front, so scoping in the Source doesn't matter
+		for(auto it = _symbols.begin(); it != _symbols.end(); ++it)
+		{
+			if(_inputs.count(it->first) > 0)
+			{
+				continue;
+			}
+			for(uint32_t c = 0; c < component_count(it->second); c++)
+			{
+				print_indent();
+				print_type(it->second);
+				_ss << " ";
+				print_var(it->first, c);
+				_ss << " = 0;\n";
+			}
+		}
+
+		print_block(main, 0);
+
+		// write outputs
+		for(uint32_t k = 0; out_data != nullptr && k < out_data->_count; k++)
+		{
+			const ASTNode* node = out_data->_children[k];
+			print_indent(); _ss << "if(x < args.Outputs[" << k << "].Width && y < args.Outputs[" << k << "].Height)\n";
+			print_indent(); _ss << "{\n";
+			_indent++;
+			print_indent();
+			print_type(node->_return_type);
+			_ss << "* dest = (";
+			print_type(node->_return_type);
+			_ss << "*)args.Outputs[" << k << "].Data + (y * args.Outputs[" << k << "].Width + x) * " << uint32_t(component_count(node->_return_type)) << ";\n";
+			for(uint32_t c = 0; c < component_count(node->_return_type); c++)
+			{
+				print_indent();
+				_ss << "dest[" << c << "] = ";
+				print_var(node->_u.sid, c);
+				_ss << ";\n";
+			}
+			_indent--;
+			print_indent(); _ss << "}\n";
+		}
+
+		_indent--;
+		print_indent(); _ss << "}\n";
+		_indent--;
+		print_indent(); _ss << "}\n";
+		_ss << "\t}\n";
+
+		return _ss.str();
+	}
+
+	void CPPGenerator::collect_symbols(const ASTNode* in_node)
+	{
+		if(in_node == nullptr)
+		{
+			return;
+		}
+
+		switch(in_node->_node_type)
+		{
+		case NodeType::Var:
+		case NodeType::OutVar:
+		case NodeType::ConstVar:
+			if(is_buffer(in_node->_return_type) == false && _symbols.count(in_node->_u.sid) == 0)
+			{
+				_symbols[in_node->_u.sid] = in_node->_return_type;
+				// numbered in order of appearance so the output doesn't depend on symbol ids
+				const uint32_t name = uint32_t(_names.size());
+				_names[in_node->_u.sid] = name;
+			}
+			break;
+		case NodeType::Literal:
+			return;
+		}
+
+		for(uint32_t k = 0; k < in_node->_count; k++)
+		{
+			collect_symbols(in_node->_children[k]);
+		}
+	}
+
+	void CPPGenerator::print_type(ReturnType::Type in_type)
+	{
+		switch(base_type(in_type))
+		{
+		case BaseType::Bool:
+			_ss << "bool";
+			break;
+		case BaseType::Int:
+			_ss << "int32_t";
+			break;
+		case BaseType::UInt:
+			_ss << "uint32_t";
+			break;
+		case BaseType::Float:
+			_ss << "float";
+			break;
+		}
+	}
+
+	void CPPGenerator::print_indent()
+	{
+		for(uint32_t k = 0; k < _indent; k++)
+		{
+			_ss << '\t';
+		}
+	}
+
+	// vectors are split into one variable per component
+	void CPPGenerator::print_var(symbol_id_t in_sid, uint32_t in_component)
+	{
+		auto it = _symbols.find(in_sid);
+		COMPUTE_ASSERT(it != _symbols.end());
+
+		_ss << "v" << _names[in_sid];
+		if(component_count(it->second) > 1)
+		{
+			_ss << "_" << in_component;
+		}
+	}
+
+	void CPPGenerator::print_literal(const ASTNode* in_node)
+	{
+		const void* data = in_node->_u.literal.data;
+		switch(base_type(in_node->_return_type))
+		{
+		case BaseType::Bool:
+			_ss << (*(const bool*)data ? "true" : "false");
+			break;
+		case BaseType::Int:
+			{
+				const int32_t val = *(const int32_t*)data;
+				if(val == (-2147483647 - 1))
+				{
+					_ss << "(-2147483647 - 1)";
+				}
+				else
+				{
+					_ss << "(" << val << ")";
+				}
+			}
+			break;
+		case BaseType::UInt:
+			_ss << *(const uint32_t*)data << "u";
+			break;
+		case BaseType::Float:
+			{
+				const float val = *(const float*)data;
+				char buffer[64];
+				if(val != val)
+				{
+					strcpy(buffer, "std::numeric_limits<float>::quiet_NaN()");
+				}
+				else if(val == INFINITY || val == -INFINITY)
+				{
+					strcpy(buffer, val > 0.0f ? "std::numeric_limits<float>::infinity()" : "(-std::numeric_limits<float>::infinity())");
+				}
+				else
+				{
+					// 9 significant digits round trip a float
+					sprintf(buffer, "%.9g", val);
+					if(strpbrk(buffer, ".e") == nullptr)
+					{
+						strcat(buffer, ".0");
+					}
+					strcat(buffer, "f");
+					if(val < 0.0f)
+					{
+						memmove(buffer + 1, buffer, strlen(buffer) + 1);
+						buffer[0] = '(';
+						strcat(buffer, ")");
+					}
+				}
+				_ss << buffer;
+			}
+			break;
+		}
+	}
+
+	void CPPGenerator::print_block(const ASTNode* in_block, uint32_t first_child)
+	{
+		for(uint32_t k = first_child; k < in_block->_count; k++)
+		{
+			print_statement(in_block->_children[k]);
+		}
+	}
+
+	void CPPGenerator::print_statement(const ASTNode* in_node)
+	{
+		switch(in_node->_node_type)
+		{
+		case NodeType::Block:
+			print_indent(); _ss << "{\n";
+			_indent++;
+			print_block(in_node, 0);
+			_indent--;
+			print_indent(); _ss << "}\n";
+			break;
+		case NodeType::Assignment:
+			print_assignment(in_node);
+			break;
+		case NodeType::If:
+		case NodeType::ElseIf:
+		case NodeType::While:
+			print_indent();
+			_ss << (in_node->_node_type == NodeType::If ? "if(" : in_node->_node_type == NodeType::ElseIf ? "else if(" : "while(");
+			print_operand(in_node->_children[0], 0, ReturnType::Bool);
+			_ss << ")\n";
+			print_indent(); _ss << "{\n";
+			_indent++;
+			print_block(in_node, 1);
+			_indent--;
+			print_indent(); _ss << "}\n";
+			break;
+		case NodeType::Else:
+			print_indent(); _ss << "else\n";
+			print_indent(); _ss << "{\n";
+			_indent++;
+			print_block(in_node, 0);
+			_indent--;
+			print_indent(); _ss << "}\n";
+			break;
+		case NodeType::ForInRange:
+			print_indent();
+			_ss << "for(";
+			print_var(in_node->_children[0]->_u.sid, 0);
+			_ss << " = ";
+			print_operand(in_node->_children[1], 0, ReturnType::Int);
+			_ss << "; ";
+			print_var(in_node->_children[0]->_u.sid, 0);
+			_ss << " < ";
+			print_operand(in_node->_children[2], 0, ReturnType::Int);
+			_ss << "; ";
+			print_var(in_node->_children[0]->_u.sid, 0);
+			_ss << "++)\n";
+			print_indent(); _ss << "{\n";
+			_indent++;
+			print_block(in_node, 3);
+			_indent--;
+			print_indent(); _ss << "}\n";
+			break;
+		default:
+			// expression statements have no side effects
+			break;
+		}
+	}
+
+	void CPPGenerator::print_assignment(const ASTNode* in_node)
+	{
+		const ASTNode* left = in_node->_children[0];
+		const ASTNode* right = in_node->_children[1];
+
+		if(left->_node_type == NodeType::Member)
+		{
+			const ASTNode* parent = left->_children[0];
+			const int32_t member = *(const int32_t*)left->_children[1]->_u.literal.data;
+
+			print_indent();
+			print_var(parent->_u.sid, member);
+			_ss << " = ";
+			print_operand(right, 0, make_type(base_type(left->_return_type), 1));
+			_ss << ";\n";
+			return;
+		}
+
+		const uint32_t width = component_count(left->_return_type);
+		if(width == 1)
+		{
+			print_indent();
+			print_var(left->_u.sid, 0);
+			_ss << " = ";
+			print_operand(right, 0, left->_return_type);
+			_ss << ";\n";
+			return;
+		}
+
+		// the right side may read the components being written, so compute them all first
+		print_indent(); _ss << "{\n";
+		_indent++;
+		for(uint32_t c = 0; c < width; c++)
+		{
+			print_indent();
+			_ss << "const ";
+			print_type(left->_return_type);
+			_ss << " t" << c << " = ";
+			print_operand(right, c, left->_return_type);
+			_ss << ";\n";
+		}
+		for(uint32_t c = 0; c < width; c++)
+		{
+			print_indent();
+			print_var(left->_u.sid, c);
+			_ss << " = t" << c << ";\n";
+		}
+		_indent--;
+		print_indent(); _ss << "}\n";
+	}
+
+	void CPPGenerator::print_operand(const ASTNode* in_node, uint32_t in_component, ReturnType::Type to)
+	{
+		const uint8_t from_base = base_type(in_node->_return_type);
+		const uint8_t to_base = base_type(to);
+		// scalars are broadcast
+		const uint32_t component = component_count(in_node->_return_type) == 1 ? 0 : in_component;
+
+		if(from_base == to_base)
+		{
+			print_expression(in_node, component);
+			return;
+		}
+
+		// same conversions as the interpreter
+		_ss << "((";
+		print_type(to);
+		_ss << ")";
+		if(from_base == BaseType::Float && to_base == BaseType::UInt)
+		{
+			_ss << "(int64_t)";
+		}
+		else if(from_base != BaseType::Bool && to_base == BaseType::Bool)
+		{
+			_ss << "(0 != ";
+			print_expression(in_node, component);
+			_ss << "))";
+			return;
+		}
+		_ss << "(";
+		print_expression(in_node, component);
+		_ss << "))";
+	}
+
+	void CPPGenerator::print_expression(const ASTNode* in_node, uint32_t in_component)
+	{
+		const ReturnType::Type type = in_node->_return_type;
+		const uint8_t base = base_type(type);
+
+		switch(in_node->_node_type)
+		{
+		case NodeType::Var:
+		case NodeType::OutVar:
+		case NodeType::ConstVar:
+			print_var(in_node->_u.sid, in_component);
+			break;
+		case NodeType::Literal:
+			print_literal(in_node);
+			break;
+		case NodeType::UnaryMinus:
+		case NodeType::BitwiseNot:
+		case NodeType::LogicalNot:
+			{
+				const char* op =
+					in_node->_node_type == NodeType::UnaryMinus ? "-" :
+					in_node->_node_type == NodeType::BitwiseNot ? "~" : "!";
+				if(in_node->_node_type == NodeType::UnaryMinus && base == BaseType::Int)
+				{
+					// wrap around rather than overflow
+					_ss << "(int32_t)(0u - (uint32_t)";
+					print_operand(in_node->_children[0], in_component, type);
+					_ss << ")";
+				}
+				else
+				{
+					_ss << "(" << op;
+					print_operand(in_node->_children[0], in_component, type);
+					_ss << ")";
+				}
+			}
+			break;
+		case NodeType::Add:
+		case NodeType::Subtract:
+		case NodeType::Multiply:
+			{
+				const char* op =
+					in_node->_node_type == NodeType::Add ? " + " :
+					in_node->_node_type == NodeType::Subtract ? " - " : " * ";
+				if(base == BaseType::Int)
+				{
+					// signed overflow is undefined in C++, so do the math unsigned
+					_ss << "(int32_t)((uint32_t)";
+					print_operand(in_node->_children[0], in_component, type);
+					_ss << op << "(uint32_t)";
+					print_operand(in_node->_children[1], in_component, type);
+					_ss << ")";
+				}
+				else
+				{
+					_ss << "(";
+					print_operand(in_node->_children[0], in_component, type);
+					_ss << op;
+					print_operand(in_node->_children[1], in_component, type);
+					_ss << ")";
+				}
+			}
+			break;
+		case NodeType::Divide:
+		case NodeType::Modulo:
+			_ss << (in_node->_node_type == NodeType::Divide ? "CPPDivide(" : "CPPModulo(");
+			print_operand(in_node->_children[0], in_component, type);
+			_ss << ", ";
+			print_operand(in_node->_children[1], in_component, type);
+			_ss << ")";
+			break;
+		case NodeType::BitwiseAnd:
+		case NodeType::BitwiseOr:
+		case NodeType::BitwiseXor:
+		case NodeType::LogicalAnd:
+		case NodeType::LogicalOr:
+			{
+				const char* op = nullptr;
+				switch(in_node->_node_type)
+				{
+				case NodeType::BitwiseAnd: op = " & "; break;
+				case NodeType::BitwiseOr: op = " | "; break;
+				case NodeType::BitwiseXor: op = " ^ "; break;
+				case NodeType::LogicalAnd: op = " && "; break;
+				case NodeType::LogicalOr: op = " || "; break;
+				}
+				_ss << "(";
+				print_operand(in_node->_children[0], in_component, type);
+				_ss << op;
+				print_operand(in_node->_children[1], in_component, type);
+				_ss << ")";
+			}
+			break;
+		case NodeType::LeftShift:
+		case NodeType::RightShift:
+			if(in_node->_node_type == NodeType::LeftShift && base == BaseType::Int)
+			{
+				_ss << "(int32_t)((uint32_t)";
+				print_operand(in_node->_children[0], in_component, type);
+				_ss << " << (";
+			}
+			else
+			{
+				_ss << "(";
+				print_operand(in_node->_children[0], in_component, type);
+				_ss << (in_node->_node_type == NodeType::LeftShift ? " << (" : " >> (");
+			}
+			print_operand(in_node->_children[1], in_component, make_type(BaseType::UInt, 1));
+			_ss << " & 31u))";
+			break;
+		case NodeType::Equal:
+		case NodeType::NotEqual:
+		case NodeType::Greater:
+		case NodeType::GreaterEqual:
+		case NodeType::Less:
+		case NodeType::LessEqual:
+			{
+				const char* op = nullptr;
+				switch(in_node->_node_type)
+				{
+				case NodeType::Equal: op = " == "; break;
+				case NodeType::NotEqual: op = " != "; break;
+				case NodeType::Greater: op = " > "; break;
+				case NodeType::GreaterEqual: op = " >= "; break;
+				case NodeType::Less: op = " < "; break;
+				case NodeType::LessEqual: op = " <= "; break;
+				}
+
+				const ASTNode* left = in_node->_children[0];
+				const ASTNode* right = in_node->_children[1];
+				const uint8_t left_base = base_type(left->_return_type);
+				const uint8_t right_base = base_type(right->_return_type);
+				const ReturnType::Type common = make_type((left_base == BaseType::Float || right_base == BaseType::Float) ? BaseType::Float : left_base, 1);
+
+				_ss << "(";
+				print_operand(left, 0, common);
+				_ss << op;
+				print_operand(right, 0, common);
+				_ss << ")";
+			}
+			break;
+		case NodeType::Member:
+			{
+				const int32_t member = *(const int32_t*)in_node->_children[1]->_u.literal.data;
+				print_expression(in_node->_children[0], member);
+			}
+			break;
+		case NodeType::Constructor:
+			print_operand(in_node->_children[in_component], 0, make_type(base, 1));
+			break;
+		case NodeType::Cast:
+			print_operand(in_node->_children[0], in_component, type);
+			break;
+		case NodeType::Function:
+			print_function(in_node, in_component);
+			break;
+		case NodeType::GetIndex:
+			_ss << (in_component == 0 ? "x" : "y");
+			break;
+		case NodeType::GetNormalizedIndex:
+			_ss << (in_component == 0 ? "((float(x) + 0.5f) / float(args.Width))" : "((float(y) + 0.5f) / float(args.Height))");
+			break;
+		case NodeType::Sample1D:
+		case NodeType::Sample2D:
+			{
+				auto it = _inputs.find(in_node->_children[0]->_u.sid);
+				COMPUTE_ASSERT(it != _inputs.end());
+
+				_ss << "CPPSample<";
+				print_type(type);
+				_ss << ">(args.Inputs[" << it->second << "], ";
+				if(in_node->_count == 3)
+				{
+					print_operand(in_node->_children[1], 0, ReturnType::Int);
+					_ss << ", ";
+					print_operand(in_node->_children[2], 0, ReturnType::Int);
+				}
+				else if(in_node->_node_type == NodeType::Sample2D)
+				{
+					// sampled with an Int2
+					print_operand(in_node->_children[1], 0, ReturnType::Int);
+					_ss << ", ";
+					print_operand(in_node->_children[1], 1, ReturnType::Int);
+				}
+				else
+				{
+					print_operand(in_node->_children[1], 0, ReturnType::Int);
+					_ss << ", 0";
+				}
+				_ss << ", " << in_component << ")";
+			}
+			break;
+		default:
+			COMPUTE_ASSERT(false);
+			break;
+		}
+	}
+
+	void CPPGenerator::print_function(const ASTNode* in_node, uint32_t in_component)
+	{
+		const ReturnType::Type type = in_node->_return_type;
+		const int32_t function = *(const int32_t*)in_node->_children[0]->_u.literal.data;
+
+		switch(function)
+		{
+		case BuiltinFunction::Index:
+			_ss << (in_component == 0 ? "x" : "y");
+			return;
+		case BuiltinFunction::NormalizedIndex:
+			_ss << (in_component == 0 ? "((float(x) + 0.5f) / float(args.Width))" : "((float(y) + 0.5f) / float(args.Height))");
+			return;
+		}
+
+		// same argument conversions as the interpreter
+		const uint8_t argument_base = base_type(type) == BaseType::Int ? BaseType::Int : BaseType::Float;
+		const uint32_t argument_count = in_node->_count - 1;
+		const ASTNode* arguments[3] = {nullptr, nullptr, nullptr};
+		for(uint32_t k = 0; k < argument_count && k < 3; k++)
+		{
+			arguments[k] = in_node->_children[k + 1];
+		}
+		const uint32_t argument_width = arguments[0] != nullptr ? component_count(arguments[0]->_return_type) : 1;
+
+		#define ARGUMENT(K, C) print_operand(arguments[K], C, make_type(argument_base, component_count(arguments[K]->_return_type)))
+
+		const char* name = nullptr;
+		switch(function)
+		{
+		case BuiltinFunction::Sin: name = "sinf"; break;
+		case BuiltinFunction::Cos: name = "cosf"; break;
+		case BuiltinFunction::Tan: name = "tanf"; break;
+		case BuiltinFunction::ASin: name = "asinf"; break;
+		case BuiltinFunction::ACos: name = "acosf"; break;
+		case BuiltinFunction::ATan: name = "atanf"; break;
+		case BuiltinFunction::SinH: name = "sinhf"; break;
+		case BuiltinFunction::CosH: name = "coshf"; break;
+		case BuiltinFunction::TanH: name = "tanhf"; break;
+		case BuiltinFunction::ASinH: name = "asinhf"; break;
+		case BuiltinFunction::ACosH: name = "acoshf"; break;
+		case BuiltinFunction::ATanH: name = "atanhf"; break;
+		case BuiltinFunction::Pow: name = "powf"; break;
+		case BuiltinFunction::Exp: name = "expf"; break;
+		case BuiltinFunction::Log: name = "logf"; break;
+		case BuiltinFunction::Exp2: name = "exp2f"; break;
+		case BuiltinFunction::Log2: name = "log2f"; break;
+		case BuiltinFunction::Sqrt: name = "sqrtf"; break;
+		case BuiltinFunction::Abs: name = argument_base == BaseType::Int ? "abs" : "fabsf"; break;
+		case BuiltinFunction::Sign: name = "CPPSign"; break;
+		case BuiltinFunction::Floor: name = "floorf"; break;
+		case BuiltinFunction::Ceiling: name = "ceilf"; break;
+		case BuiltinFunction::Min: name = "CPPMin"; break;
+		case BuiltinFunction::Max: name = "CPPMax"; break;
+		case BuiltinFunction::Clamp: name = "CPPClamp"; break;
+		}
+
+		if(name != nullptr)
+		{
+			_ss << name << "(";
+			for(uint32_t k = 0; k < argument_count; k++)
+			{
+				if(k > 0)
+				{
+					_ss << ", ";
+				}
+				ARGUMENT(k, in_component);
+			}
+			_ss << ")";
+			return;
+		}
+
+		switch(function)
+		{
+		case BuiltinFunction::IsNan:
+		case BuiltinFunction::IsInf:
+			_ss << "(";
+			print_type(type);
+			_ss << ")(";
+			if(function == BuiltinFunction::IsNan)
+			{
+				_ss << "(";
+				ARGUMENT(0, in_component);
+				_ss << ") != (";
+				ARGUMENT(0, in_component);
+				_ss << ")";
+			}
+			else
+			{
+				_ss << "fabsf(";
+				ARGUMENT(0, in_component);
+				_ss << ") == INFINITY";
+			}
+			_ss << ")";
+			break;
+		case BuiltinFunction::Length:
+		case BuiltinFunction::Normalize:
+			if(function == BuiltinFunction::Normalize)
+			{
+				_ss << "(";
+				ARGUMENT(0, in_component);
+				_ss << " / ";
+			}
+			_ss << "sqrtf(0.0f";
+			for(uint32_t c = 0; c < argument_width; c++)
+			{
+				_ss << " + ";
+				ARGUMENT(0, c);
+				_ss << " * ";
+				ARGUMENT(0, c);
+			}
+			_ss << ")";
+			if(function == BuiltinFunction::Normalize)
+			{
+				_ss << ")";
+			}
+			break;
+		case BuiltinFunction::Distance:
+			_ss << "sqrtf(0.0f";
+			for(uint32_t c = 0; c < argument_width; c++)
+			{
+				_ss << " + (";
+				ARGUMENT(0, c);
+				_ss << " - ";
+				ARGUMENT(1, c);
+				_ss << ") * (";
+				ARGUMENT(0, c);
+				_ss << " - ";
+				ARGUMENT(1, c);
+				_ss << ")";
+			}
+			_ss << ")";
+			break;
+		case BuiltinFunction::Dot:
+			_ss << "(0.0f";
+			for(uint32_t c = 0; c < argument_width; c++)
+			{
+				_ss << " + ";
+				ARGUMENT(0, c);
+				_ss << " * ";
+				ARGUMENT(1, c);
+			}
+			_ss << ")";
+			break;
+		case BuiltinFunction::Cross:
+			{
+				const uint32_t a = (in_component + 1) % 3;
+				const uint32_t b = (in_component + 2) % 3;
+				_ss << "(";
+				ARGUMENT(0, a);
+				_ss << " * ";
+				ARGUMENT(1, b);
+				_ss << " - ";
+				ARGUMENT(0, b);
+				_ss << " * ";
+				ARGUMENT(1, a);
+				_ss << ")";
+			}
+			break;
+		default:
+			COMPUTE_ASSERT(false);
+			break;
+		}
+
+		#undef ARGUMENT
+	}
+}
\ No newline at end of file
@@ -0,0 +1,1339 @@
+#include "SiCKL.h"
+#include "TypeInfo.h"
+#include "CPUInterpreter.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace SiCKL
+{
+	/// Worker Threads
+
+	class WorkerPool
+	{
+	public:
+		WorkerPool(uint32_t in_thread_count)
+			: _generation(0)
+			, _busy_workers(0)
+			, _shutdown(false)
+			, _func(nullptr)
+			, _count(0)
+			, _grain(1)
+		{
+			_next = 0;
+			// the calling thread is one of the workers
+			for(uint32_t k = 1; k < in_thread_count; k++)
+			{
+				_workers.push_back(std::thread(&WorkerPool::worker_main, this));
+			}
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_shutdown = true;
+			}
+			_job_ready.notify_all();
+			for(auto it = _workers.begin(); it != _workers.end(); ++it)
+			{
+				it->join();
+			}
+		}
+
+		uint32_t ThreadCount() const
+		{
+			return uint32_t(_workers.size()) + 1;
+		}
+
+		// calls in_func(begin, end) on disjoint ranges covering [0, in_count)
+		void ParallelFor(int32_t in_count, const std::function<void(int32_t, int32_t)>& in_func)
+		{
+			if(in_count <= 0)
+			{
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_func = &in_func;
+				_count = in_count;
+				_grain = std::max(1, in_count / int32_t(ThreadCount() * 4));
+				_next = 0;
+				_busy_workers = uint32_t(_workers.size());
+				_generation++;
+			}
+			_job_ready.notify_all();
+
+			run_ranges();
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_job_done.wait(lock, [this]() {return _busy_workers == 0;});
+			_func = nullptr;
+		}
+	private:
+		void worker_main()
+		{
+			uint64_t generation = 0;
+			while(true)
+			{
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_job_ready.wait(lock, [&]() {return _shutdown || _generation != generation;});
+					if(_shutdown)
+					{
+						return;
+					}
+					generation = _generation;
+				}
+
+				run_ranges();
+
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_busy_workers--;
+				}
+				_job_done.notify_all();
+			}
+		}
+
+		void run_ranges()
+		{
+			while(true)
+			{
+				const int32_t begin = _next.fetch_add(_grain);
+				if(begin >= _count)
+				{
+					return;
+				}
+				(*_func)(begin, std::min(begin + _grain, _count));
+			}
+		}
+
+		std::vector<std::thread> _workers;
+
+		std::mutex _mutex;
+		std::condition_variable _job_ready;
+		std::condition_variable _job_done;
+		uint64_t _generation;
+		uint32_t _busy_workers;
+		bool _shutdown;
+
+		// the current job
+		const std::function<void(int32_t, int32_t)>* _func;
+		int32_t _count;
+		int32_t _grain;
+		std::atomic<int32_t> _next;
+	};
+
+	static WorkerPool* _worker_pool = nullptr;
+
+	/// CPURuntime
+
+	bool CPURuntime::Initialize(uint32_t thread_count)
+	{
+		if(_worker_pool != nullptr)
+		{
+			return false;
+		}
+
+		if(thread_count == 0)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		_worker_pool = new WorkerPool(thread_count);
+		return true;
+	}
+
+	bool CPURuntime::Finalize()
+	{
+		if(_worker_pool == nullptr)
+		{
+			return false;
+		}
+
+		delete _worker_pool;
+		_worker_pool = nullptr;
+		return true;
+	}
+
+	uint32_t CPURuntime::GetThreadCount()
+	{
+		return _worker_pool != nullptr ? _worker_pool->ThreadCount() : 1;
+	}
+
+	int32_t CPURuntime::GetMaxTextureSize()
+	{
+		return INT32_MAX;
+	}
+
+	static std::string _generated_kernel_path;
+	static bool _use_generated_kernels = true;
+
+	void CPURuntime::SetGeneratedKernelPath(const char* in_path)
+	{
+		_generated_kernel_path = in_path != nullptr ? in_path : "";
+	}
+
+	void CPURuntime::SetUseGeneratedKernels(bool in_use)
+	{
+		_use_generated_kernels = in_use;
+	}
+
+	static uint32_t _lane_count = 4;
+
+	bool CPURuntime::SetLaneCount(uint32_t in_lanes)
+	{
+		if(in_lanes != 4 && in_lanes != 8 && in_lanes != 16)
+		{
+			return false;
+		}
+		_lane_count = in_lanes;
+		return true;
+	}
+
+	uint32_t CPURuntime::GetLaneCount()
+	{
+		return _lane_count;
+	}
+
+	static void write_generated_kernel(const Source& in_source)
+	{
+		char filename[64];
+		sprintf(filename, "/sickl_kernel_%016llx.cpp", (unsigned long long)CPPGenerator::Hash(in_source));
+		const std::string path = _generated_kernel_path + filename;
+
+		// each kernel configuration only needs writing once
+		FILE* file = fopen(path.c_str(), "rb");
+		if(file != nullptr)
+		{
+			fclose(file);
+			return;
+		}
+
+		file = fopen(path.c_str(), "wb");
+		if(file != nullptr)
+		{
+			const std::string code = CPPGenerator::Generate(in_source);
+			fwrite(code.c_str(), 1, code.size(), file);
+			fclose(file);
+		}
+	}
+
+	/// Buffers
+
+	static void* allocate_buffer(uint32_t in_size, const void* in_data)
+	{
+		void* result = _aligned_malloc(std::max(in_size, 16u), 16);
+		if(in_data != nullptr)
+		{
+			memcpy(result, in_data, in_size);
+		}
+		else
+		{
+			memset(result, 0x00, in_size);
+		}
+		return result;
+	}
+
+	CPUBuffer1D::CPUBuffer1D()
+		: Length(0)
+		, Type(ReturnType::Invalid)
+		, Data(nullptr)
+		, _counter(nullptr)
+	{ }
+
+	CPUBuffer1D::CPUBuffer1D(int32_t length, ReturnType::Type type, const void* data)
+		: Length(length)
+		, Type(type)
+		, Data(allocate_buffer(length * component_count(type) * sizeof(uint32_t), data))
+		, _counter(new int32_t(1))
+	{
+		COMPUTE_ASSERT(length > 0);
+		COMPUTE_ASSERT(base_type(type) != BaseType::Bool);
+	}
+
+	CPUBuffer1D::~CPUBuffer1D()
+	{
+		if(_counter != nullptr && --(*_counter) == 0)
+		{
+			_aligned_free(Data);
+			delete _counter;
+		}
+	}
+
+	CPUBuffer1D::CPUBuffer1D(const CPUBuffer1D& that)
+		: Length(that.Length)
+		, Type(that.Type)
+		, Data(that.Data)
+		, _counter(that._counter)
+	{
+		if(_counter != nullptr)
+		{
+			++(*_counter);
+		}
+	}
+
+	CPUBuffer1D& CPUBuffer1D::operator=(const CPUBuffer1D& that)
+	{
+		if(this != &that)
+		{
+			this->~CPUBuffer1D();
+			new (this) CPUBuffer1D(that);
+		}
+		return *this;
+	}
+
+	uint32_t CPUBuffer1D::GetBufferSize() const
+	{
+		return Length * component_count(Type) * sizeof(uint32_t);
+	}
+
+	void CPUBuffer1D::SetData(const void* in_buffer)
+	{
+		COMPUTE_ASSERT(Data != nullptr);
+		memcpy(Data, in_buffer, GetBufferSize());
+	}
+
+	CPUBuffer2D::CPUBuffer2D()
+		: Width(0)
+		, Height(0)
+		, Type(ReturnType::Invalid)
+		, Data(nullptr)
+		, _counter(nullptr)
+	{ }
+
+	CPUBuffer2D::CPUBuffer2D(int32_t width, int32_t height, ReturnType::Type type, const void* data)
+		: Width(width)
+		, Height(height)
+		, Type(type)
+		, Data(allocate_buffer(width * height * component_count(type) * sizeof(uint32_t), data))
+		, _counter(new int32_t(1))
+	{
+		COMPUTE_ASSERT(width > 0 && height > 0);
+		COMPUTE_ASSERT(base_type(type) != BaseType::Bool);
+	}
+
+	CPUBuffer2D::~CPUBuffer2D()
+	{
+		if(_counter != nullptr && --(*_counter) == 0)
+		{
+			_aligned_free(Data);
+			delete _counter;
+		}
+	}
+
+	CPUBuffer2D::CPUBuffer2D(const CPUBuffer2D& that)
+		: Width(that.Width)
+		, Height(that.Height)
+		, Type(that.Type)
+		, Data(that.Data)
+		, _counter(that._counter)
+	{
+		if(_counter != nullptr)
+		{
+			++(*_counter);
+		}
+	}
+
+	CPUBuffer2D& CPUBuffer2D::operator=(const CPUBuffer2D& that)
+	{
+		if(this != &that)
+		{
+			this->~CPUBuffer2D();
+			new (this) CPUBuffer2D(that);
+		}
+		return *this;
+	}
+
+	uint32_t CPUBuffer2D::GetBufferSize() const
+	{
+		return Width * Height * component_count(Type) * sizeof(uint32_t);
+	}
+
+	void CPUBuffer2D::SetData(const void* in_buffer)
+	{
+		COMPUTE_ASSERT(Data != nullptr);
+		memcpy(Data, in_buffer, GetBufferSize());
+	}
+
+	void CPUBuffer2D::get_data(void** in_out_buffer) const
+	{
+		COMPUTE_ASSERT(Data != nullptr);
+		if(*in_out_buffer == nullptr)
+		{
+			*in_out_buffer = malloc(GetBufferSize());
+		}
+		memcpy(*in_out_buffer, Data, GetBufferSize());
+	}
+
+	/// CPUProgram
+
+	CPUProgram::CPUProgram()
+		: _kernel(nullptr)
+		, _mask_depth(0)
+	{
+		_size[0] = 0;
+		_size[1] = 0;
+	}
+
+	CPUProgram::~CPUProgram()
+	{ }
+
+	void CPUProgram::Initialize(int32_t width, int32_t height)
+	{
+		COMPUTE_ASSERT(width > 0 && height > 0);
+		_size[0] = width;
+		_size[1] = height;
+	}
+
+	input_t CPUProgram::GetInputHandle(const char* in_name)
+	{
+		for(size_t k = 0; k < _inputs.size(); k++)
+		{
+			if(_inputs[k]._name == in_name)
+			{
+				return input_t(k);
+			}
+		}
+		return -1;
+	}
+
+	output_t CPUProgram::GetOutputHandle(const char* in_name)
+	{
+		for(size_t k = 0; k < _outputs.size(); k++)
+		{
+			if(_outputs[k]._name == in_name)
+			{
+				return output_t(k);
+			}
+		}
+		return -1;
+	}
+
+	void CPUProgram::set_input(input_t i, ReturnType::Type in_type, const void* in_data)
+	{
+		COMPUTE_ASSERT(i >= 0 && i < (input_t)_inputs.size());
+		COMPUTE_ASSERT(_inputs[i]._type == in_type);
+
+		memcpy(&_registers[_inputs[i]._register], in_data, component_count(in_type) * sizeof(uint32_t));
+	}
+
+	void CPUProgram::SetInput(input_t i, bool b)
+	{
+		const uint32_t val = b ? 1 : 0;
+		set_input(i, ReturnType::Bool, &val);
+	}
+
+	void CPUProgram::SetInput(input_t i, int32_t x)
+	{
+		set_input(i, ReturnType::Int, &x);
+	}
+
+	void CPUProgram::SetInput(input_t i, uint32_t x)
+	{
+		set_input(i, ReturnType::UInt, &x);
+	}
+
+	void CPUProgram::SetInput(input_t i, float x)
+	{
+		set_input(i, ReturnType::Float, &x);
+	}
+
+	void CPUProgram::SetInput(input_t i, int32_t x, int32_t y)
+	{
+		const int32_t vals[] = {x, y};
+		set_input(i, ReturnType::Int2, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, uint32_t x, uint32_t y)
+	{
+		const uint32_t vals[] = {x, y};
+		set_input(i, ReturnType::UInt2, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, float x, float y)
+	{
+		const float vals[] = {x, y};
+		set_input(i, ReturnType::Float2, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, int32_t x, int32_t y, int32_t z)
+	{
+		const int32_t vals[] = {x, y, z};
+		set_input(i, ReturnType::Int3, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, uint32_t x, uint32_t y, uint32_t z)
+	{
+		const uint32_t vals[] = {x, y, z};
+		set_input(i, ReturnType::UInt3, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, float x, float y, float z)
+	{
+		const float vals[] = {x, y, z};
+		set_input(i, ReturnType::Float3, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, int32_t x, int32_t y, int32_t z, int32_t w)
+	{
+		const int32_t vals[] = {x, y, z, w};
+		set_input(i, ReturnType::Int4, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, uint32_t x, uint32_t y, uint32_t z, uint32_t w)
+	{
+		const uint32_t vals[] = {x, y, z, w};
+		set_input(i, ReturnType::UInt4, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, float x, float y, float z, float w)
+	{
+		const float vals[] = {x, y, z, w};
+		set_input(i, ReturnType::Float4, vals);
+	}
+
+	void CPUProgram::SetInput(input_t i, const CPUBuffer1D& buffer)
+	{
+		COMPUTE_ASSERT(i >= 0 && i < (input_t)_inputs.size());
+		COMPUTE_ASSERT(element_type(_inputs[i]._type) == buffer.Type);
+		COMPUTE_ASSERT(((uint32_t)_inputs[i]._type & ReturnType::Buffer1D) != 0);
+
+		_inputs[i]._buffer1d = buffer;
+	}
+
+	void CPUProgram::SetInput(input_t i, const CPUBuffer2D& buffer)
+	{
+		COMPUTE_ASSERT(i >= 0 && i < (input_t)_inputs.size());
+		COMPUTE_ASSERT(element_type(_inputs[i]._type) == buffer.Type);
+		COMPUTE_ASSERT(((uint32_t)_inputs[i]._type & (uint32_t)ReturnType::Buffer2D) != 0);
+
+		_inputs[i]._buffer2d = buffer;
+	}
+
+	void CPUProgram::BindOutput(output_t o, const CPUBuffer2D& buffer)
+	{
+		COMPUTE_ASSERT(o >= 0 && o < (output_t)_outputs.size());
+		COMPUTE_ASSERT(_outputs[o]._type == buffer.Type);
+
+		_outputs[o]._buffer = buffer;
+	}
+
+	void CPUProgram::get_output(output_t o, int32_t offset_x, int32_t offset_y, int32_t width, int32_t height, void** in_out_buffer)
+	{
+		COMPUTE_ASSERT(o >= 0 && o < (output_t)_outputs.size());
+		const CPUBuffer2D& buffer = _outputs[o]._buffer;
+		COMPUTE_ASSERT(buffer.Data != nullptr);
+		COMPUTE_ASSERT(offset_x >= 0 && offset_y >= 0 && offset_x + width <= buffer.Width && offset_y + height <= buffer.Height);
+
+		const uint32_t element_size = component_count(buffer.Type) * sizeof(uint32_t);
+		if(*in_out_buffer == nullptr)
+		{
+			*in_out_buffer = malloc(width * height * element_size);
+		}
+
+		for(int32_t y = 0; y < height; y++)
+		{
+			const uint8_t* src = (const uint8_t*)buffer.Data + ((offset_y + y) * buffer.Width + offset_x) * element_size;
+			uint8_t* dest = (uint8_t*)*in_out_buffer + y * width * element_size;
+			memcpy(dest, src, width * element_size);
+		}
+	}
+
+	/// Interpreter
+
+	// the SSE2 build of the interpreter; the wider ones are in CPUAVX2.cpp and CPUAVX512.cpp
+	template void CPUProgram::run_rows<4>(int32_t, int32_t, const InterpreterArgs&) const;
+	extern template void CPUProgram::run_rows<8>(int32_t, int32_t, const InterpreterArgs&) const;
+	extern template void CPUProgram::run_rows<16>(int32_t, int32_t, const InterpreterArgs&) const;
+
+	bool CPUProgram::HasGeneratedKernel() const
+	{
+		return _kernel != nullptr;
+	}
+
+	void CPUProgram::Run()
+	{
+		COMPUTE_ASSERT(_size[0] > 0 && _size[1] > 0);
+
+		if(_kernel != nullptr)
+		{
+			run_kernel();
+			return;
+		}
+
+		// resolve buffer inputs once rather than per grid point
+		std::vector<Sampler> samplers(_inputs.size());
+		for(size_t k = 0; k < _inputs.size(); k++)
+		{
+			Sampler& s = samplers[k];
+			memset(&s, 0x00, sizeof(Sampler));
+			if(((uint32_t)_inputs[k]._type & (uint32_t)ReturnType::Buffer2D) != 0)
+			{
+				const CPUBuffer2D& buffer = _inputs[k]._buffer2d;
+				s.Data = (const uint32_t*)buffer.Data;
+				s.Width = buffer.Width;
+				s.Height = buffer.Height;
+				s.Components = component_count(buffer.Type);
+			}
+			else if(((uint32_t)_inputs[k]._type & ReturnType::Buffer1D) != 0)
+			{
+				const CPUBuffer1D& buffer = _inputs[k]._buffer1d;
+				s.Data = (const uint32_t*)buffer.Data;
+				s.Width = buffer.Length;
+				s.Height = 1;
+				s.Components = component_count(buffer.Type);
+			}
+		}
+
+		// and outputs
+		std::vector<Target> targets(_outputs.size());
+		for(size_t k = 0; k < _outputs.size(); k++)
+		{
+			const CPUBuffer2D& buffer = _outputs[k]._buffer;
+			Target& t = targets[k];
+			t.Data = (uint32_t*)buffer.Data;
+			t.Width = buffer.Width;
+			t.Height = buffer.Height;
+			t.Components = component_count(buffer.Type);
+			t.Register = _outputs[k]._register;
+		}
+
+		InterpreterArgs args;
+		args.Code = &_code[0];
+		args.CodeSize = int32_t(_code.size());
+		args.Registers = _registers.empty() ? nullptr : &_registers[0];
+		args.RegisterCount = uint32_t(_registers.size());
+		args.Samplers = samplers.empty() ? nullptr : &samplers[0];
+		args.Targets = targets.empty() ? nullptr : &targets[0];
+		args.TargetCount = uint32_t(targets.size());
+
+		// the interpreter built for the lane count's instruction set
+		void (CPUProgram::*run_rows_lanes)(int32_t, int32_t, const InterpreterArgs&) const = &CPUProgram::run_rows<4>;
+		if(_lane_count == 16)
+		{
+			run_rows_lanes = &CPUProgram::run_rows<16>;
+		}
+		else if(_lane_count == 8)
+		{
+			run_rows_lanes = &CPUProgram::run_rows<8>;
+		}
+
+		if(_worker_pool != nullptr)
+		{
+			_worker_pool->ParallelFor(_size[1], [&](int32_t begin, int32_t end)
+			{
+				(this->*run_rows_lanes)(begin, end, args);
+			});
+		}
+		else
+		{
+			(this->*run_rows_lanes)(0, _size[1], args);
+		}
+	}
+
+	void CPUProgram::run_kernel()
+	{
+		std::vector<CPPKernelInput> inputs(_inputs.size());
+		for(size_t k = 0; k < _inputs.size(); k++)
+		{
+			CPPKernelInput& in = inputs[k];
+			memset(&in, 0x00, sizeof(CPPKernelInput));
+			if(((uint32_t)_inputs[k]._type & (uint32_t)ReturnType::Buffer2D) != 0)
+			{
+				const CPUBuffer2D& buffer = _inputs[k]._buffer2d;
+				in.Data = buffer.Data;
+				in.Width = buffer.Width;
+				in.Height = buffer.Height;
+				in.Components = component_count(buffer.Type);
+			}
+			else if(((uint32_t)_inputs[k]._type & ReturnType::Buffer1D) != 0)
+			{
+				const CPUBuffer1D& buffer = _inputs[k]._buffer1d;
+				in.Data = buffer.Data;
+				in.Width = buffer.Length;
+				in.Height = 1;
+				in.Components = component_count(buffer.Type);
+			}
+			else
+			{
+				in.Data = &_registers[_inputs[k]._register];
+				in.Width = 1;
+				in.Height = 1;
+				in.Components = component_count(_inputs[k]._type);
+			}
+		}
+
+		std::vector<CPPKernelOutput> outputs(_outputs.size());
+		for(size_t k = 0; k < _outputs.size(); k++)
+		{
+			const CPUBuffer2D& buffer = _outputs[k]._buffer;
+			outputs[k].Data = buffer.Data;
+			outputs[k].Width = buffer.Data != nullptr ? buffer.Width : 0;
+			outputs[k].Height = buffer.Data != nullptr ? buffer.Height : 0;
+			outputs[k].Components = component_count(buffer.Type);
+		}
+
+		CPPKernelArgs args;
+		args.Width = _size[0];
+		args.Height = _size[1];
+		args.RowBegin = 0;
+		args.RowEnd = _size[1];
+		args.Inputs = inputs.empty() ? nullptr : &inputs[0];
+		args.Outputs = outputs.empty() ? nullptr : &outputs[0];
+
+		if(_worker_pool != nullptr)
+		{
+			_worker_pool->ParallelFor(_size[1], [&](int32_t begin, int32_t end)
+			{
+				CPPKernelArgs range = args;
+				range.RowBegin = begin;
+				range.RowEnd = end;
+				_kernel(range);
+			});
+		}
+		else
+		{
+			_kernel(args);
+		}
+	}
+
+	/// CPUCompiler
+
+	CPUProgram* CPUCompiler::Build(const Source& in_source)
+	{
+		_program = new CPUProgram();
+		_variables.clear();
+		_buffers.clear();
+		_literals.clear();
+		_next_temp = 0;
+		_register_count = 0;
+		_mask_depth = 0;
+
+		const ASTNode& root = in_source.GetRoot();
+		const ASTNode* const_data = nullptr;
+		const ASTNode* out_data = nullptr;
+		const ASTNode* main = nullptr;
+		for(uint32_t k = 0; k < root._count; k++)
+		{
+			const ASTNode* node = root._children[k];
+			switch(node->_node_type)
+			{
+			case NodeType::ConstData:
+				const_data = node;
+				break;
+			case NodeType::OutData:
+				out_data = node;
+				break;
+			case NodeType::Main:
+				main = node;
+				break;
+			}
+		}
+		COMPUTE_ASSERT(main != nullptr);
+
+		// inputs are numbered in declaration order, same as OpenGLProgram
+		for(uint32_t k = 0; const_data != nullptr && k < const_data->_count; k++)
+		{
+			const ASTNode* node = const_data->_children[k];
+
+			CPUProgram::Input input;
+			input._name = node->_name != nullptr ? node->_name : "";
+			input._type = node->_return_type;
+			input._register = 0;
+			if(is_buffer(node->_return_type))
+			{
+				_buffers[node->_u.sid] = int32_t(k);
+			}
+			else
+			{
+				input._register = allocate_variable(node->_u.sid);
+			}
+			_program->_inputs.push_back(input);
+		}
+
+		for(uint32_t k = 0; out_data != nullptr && k < out_data->_count; k++)
+		{
+			const ASTNode* node = out_data->_children[k];
+
+			CPUProgram::Output output;
+			output._name = node->_name != nullptr ? node->_name : "";
+			output._type = node->_return_type;
+			output._register = allocate_variable(node->_u.sid);
+			_program->_outputs.push_back(output);
+		}
+
+		// every variable and literal gets a fixed register
+		allocate_registers(main);
+
+		// then compile
+		_next_temp = _register_count;
+		compile_block(main, 0);
+
+		_program->_registers.resize(_register_count);
+
+		// prefer a compiled version of the kernel (see CPPGenerator)
+		_program->_kernel = _use_generated_kernels ? CPPGenerator::FindKernel(in_source) : nullptr;
+		if(_program->_kernel == nullptr && _generated_kernel_path.empty() == false)
+		{
+			write_generated_kernel(in_source);
+		}
+
+		CPUProgram* result = _program;
+		_program = nullptr;
+		return result;
+	}
+
+	void CPUCompiler::allocate_registers(const ASTNode* in_node)
+	{
+		if(in_node == nullptr)
+		{
+			return;
+		}
+
+		uint32_t first_child = 0;
+		uint32_t skip_child = in_node->_count;
+		switch(in_node->_node_type)
+		{
+		case NodeType::Var:
+		case NodeType::OutVar:
+		case NodeType::ConstVar:
+			// buffers are read through their Sampler rather than a register
+			if(is_buffer(in_node->_return_type) == false)
+			{
+				allocate_variable(in_node->_u.sid);
+			}
+			break;
+		case NodeType::Literal:
+			allocate_literal(in_node);
+			break;
+		case NodeType::Function:
+			// first child is the function id
+			first_child = 1;
+			break;
+		case NodeType::Member:
+			// second child is the member id
+			skip_child = 1;
+			break;
+		case NodeType::ForInRange:
+			{
+				// loop increment
+				const int32_t one = 1;
+				ASTNode literal(NodeType::Literal, ReturnType::Int, &one);
+				allocate_literal(&literal);
+			}
+			break;
+		}
+
+		for(uint32_t k = first_child; k < in_node->_count; k++)
+		{
+			if(k != skip_child)
+			{
+				allocate_registers(in_node->_children[k]);
+			}
+		}
+	}
+
+	uint16_t CPUCompiler::allocate_variable(symbol_id_t in_sid)
+	{
+		auto it = _variables.find(in_sid);
+		if(it != _variables.end())
+		{
+			return it->second;
+		}
+
+		// fixed registers can only be handed out before any temporaries
+		COMPUTE_ASSERT(_register_count == _program->_registers.size());
+		const uint16_t result = _register_count++;
+		_variables[in_sid] = result;
+
+		CPUProgram::Value zero;
+		memset(&zero, 0x00, sizeof(zero));
+		_program->_registers.push_back(zero);
+
+		return result;
+	}
+
+	uint16_t CPUCompiler::allocate_literal(const ASTNode* in_node)
+	{
+		COMPUTE_ASSERT(in_node->_node_type == NodeType::Literal);
+
+		const uint8_t base = base_type(in_node->_return_type);
+		uint32_t bits = 0;
+		if(base == BaseType::Bool)
+		{
+			bits = *(const bool*)in_node->_u.literal.data ? 1 : 0;
+		}
+		else
+		{
+			COMPUTE_ASSERT(in_node->_u.literal.size == sizeof(uint32_t));
+			memcpy(&bits, in_node->_u.literal.data, sizeof(uint32_t));
+		}
+
+		const std::pair<uint32_t, uint32_t> key(base, bits);
+		auto it = _literals.find(key);
+		if(it != _literals.end())
+		{
+			return it->second;
+		}
+
+		COMPUTE_ASSERT(_register_count == _program->_registers.size());
+		const uint16_t result = _register_count++;
+		_literals[key] = result;
+
+		CPUProgram::Value literal;
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			literal.u[c] = bits;
+		}
+		_program->_registers.push_back(literal);
+
+		return result;
+	}
+
+	uint16_t CPUCompiler::allocate_temp()
+	{
+		const uint16_t result = _next_temp++;
+		COMPUTE_ASSERT(result < 0xFFFF);
+		_register_count = std::max<uint16_t>(_register_count, result + 1);
+		return result;
+	}
+
+	void CPUCompiler::compile_block(const ASTNode* in_block, uint32_t first_child)
+	{
+		// temporaries only need to live for a single statement
+		const uint16_t temp_base = _next_temp;
+
+		for(uint32_t k = first_child; k < in_block->_count; k++)
+		{
+			const ASTNode* node = in_block->_children[k];
+
+			if(node->_node_type == NodeType::If)
+			{
+				// an If is followed by its ElseIf and Else siblings; each branch runs for the lanes
+				// which haven't taken an earlier one
+				std::vector<uint32_t> end_jumps;
+				push_mask();
+				const ASTNode* branch = node;
+				while(true)
+				{
+					if(branch != node)
+					{
+						end_jumps.push_back(emit(OpCode::JumpIfDone, ReturnType::Void, 0));
+					}
+
+					if(branch->_node_type == NodeType::Else)
+					{
+						end_jumps.push_back(emit(OpCode::BranchElse, ReturnType::Void, 0));
+						compile_block(branch, 0);
+						break;
+					}
+
+					const uint16_t condition = compile_expression(branch->_children[0]);
+					const uint32_t skip = emit(OpCode::Branch, ReturnType::Void, 0, condition);
+					_next_temp = temp_base;
+
+					compile_block(branch, 1);
+					patch_jump(skip);
+
+					const bool has_next = k + 1 < in_block->_count &&
+						(in_block->_children[k + 1]->_node_type == NodeType::ElseIf || in_block->_children[k + 1]->_node_type == NodeType::Else);
+					if(has_next == false)
+					{
+						break;
+					}
+					branch = in_block->_children[++k];
+				}
+
+				for(auto it = end_jumps.begin(); it != end_jumps.end(); ++it)
+				{
+					patch_jump(*it);
+				}
+				pop_mask();
+			}
+			else
+			{
+				compile_statement(node);
+			}
+
+			_next_temp = temp_base;
+		}
+	}
+
+	void CPUCompiler::compile_statement(const ASTNode* in_node)
+	{
+		switch(in_node->_node_type)
+		{
+		case NodeType::Block:
+			compile_block(in_node, 0);
+			break;
+		case NodeType::Assignment:
+			{
+				const ASTNode* left = in_node->_children[0];
+				const ASTNode* right = in_node->_children[1];
+
+				if(left->_node_type == NodeType::Member)
+				{
+					// assign to a single component of a variable
+					const ASTNode* parent = left->_children[0];
+					COMPUTE_ASSERT(parent->_node_type == NodeType::Var || parent->_node_type == NodeType::OutVar);
+					const int32_t member = *(const int32_t*)left->_children[1]->_u.literal.data;
+
+					const uint16_t value = convert(compile_expression(right), right->_return_type, make_type(base_type(left->_return_type), 1));
+					emit(OpCode::Insert, left->_return_type, _variables[parent->_u.sid], value, 0, 0, member);
+				}
+				else
+				{
+					COMPUTE_ASSERT(left->_node_type == NodeType::Var || left->_node_type == NodeType::OutVar);
+					const uint16_t dest = _variables[left->_u.sid];
+					const uint16_t first_temp = _next_temp;
+					const uint16_t value = convert(compile_expression(right), right->_return_type, left->_return_type);
+
+					// when the value is a temporary computed by the last instruction, write it to the
+					// variable directly; constructors are built up over several Inserts so are excluded
+					std::vector<CPUProgram::Instruction>& code = _program->_code;
+					if(value >= first_temp && code.empty() == false && code.back().Dest == value &&
+					   code.back().OpCode != OpCode::Insert && code.back().OpCode < OpCode::Jump)
+					{
+						code.back().Dest = dest;
+					}
+					else
+					{
+						emit(OpCode::Move, left->_return_type, dest, value);
+					}
+				}
+			}
+			break;
+		case NodeType::While:
+			{
+				push_mask();
+				const uint32_t top = uint32_t(_program->_code.size());
+				const uint16_t condition = compile_expression(in_node->_children[0]);
+				const uint32_t exit = emit(OpCode::LoopBranch, ReturnType::Void, 0, condition);
+
+				compile_block(in_node, 1);
+
+				emit(OpCode::Jump, ReturnType::Void, 0, 0, 0, 0, top);
+				patch_jump(exit);
+				pop_mask();
+			}
+			break;
+		case NodeType::ForInRange:
+			{
+				const ASTNode* index = in_node->_children[0];
+				const uint16_t counter = _variables[index->_u.sid];
+				const uint16_t from = convert(compile_expression(in_node->_children[1]), in_node->_children[1]->_return_type, ReturnType::Int);
+				const uint16_t to = convert(compile_expression(in_node->_children[2]), in_node->_children[2]->_return_type, ReturnType::Int);
+				const int32_t one_value = 1;
+				const uint16_t one = _literals[std::make_pair(uint32_t(BaseType::Int), *(const uint32_t*)&one_value)];
+				const uint16_t condition = allocate_temp();
+
+				emit(OpCode::Move, ReturnType::Int, counter, from);
+				push_mask();
+				const uint32_t top = uint32_t(_program->_code.size());
+				emit(OpCode::Less, ReturnType::Bool, condition, counter, to);
+				_program->_code.back().SourceType = BaseType::Int;
+				const uint32_t exit = emit(OpCode::LoopBranch, ReturnType::Void, 0, condition);
+
+				compile_block(in_node, 3);
+
+				emit(OpCode::Add, ReturnType::Int, counter, counter, one);
+				emit(OpCode::Jump, ReturnType::Void, 0, 0, 0, 0, top);
+				patch_jump(exit);
+				pop_mask();
+			}
+			break;
+		case NodeType::ElseIf:
+		case NodeType::Else:
+			// these are handled along with their If in compile_block
+			COMPUTE_ASSERT(false);
+			break;
+		default:
+			// expression statements have no side effects
+			break;
+		}
+	}
+
+	uint16_t CPUCompiler::compile_expression(const ASTNode* in_node)
+	{
+		const ReturnType::Type type = in_node->_return_type;
+
+		switch(in_node->_node_type)
+		{
+		case NodeType::Var:
+		case NodeType::OutVar:
+		case NodeType::ConstVar:
+			{
+				auto it = _variables.find(in_node->_u.sid);
+				COMPUTE_ASSERT(it != _variables.end());
+				return it->second;
+			}
+		case NodeType::Literal:
+			return allocate_literal(in_node);
+		case NodeType::UnaryMinus:
+		case NodeType::BitwiseNot:
+		case NodeType::LogicalNot:
+			{
+				const ASTNode* child = in_node->_children[0];
+				const uint16_t a = convert(compile_expression(child), child->_return_type, type);
+				const uint8_t op_code =
+					in_node->_node_type == NodeType::UnaryMinus ? OpCode::Negate :
+					in_node->_node_type == NodeType::BitwiseNot ? OpCode::BitwiseNot : OpCode::LogicalNot;
+				const uint16_t dest = allocate_temp();
+				emit(op_code, type, dest, a);
+				return dest;
+			}
+		case NodeType::Add:
+		case NodeType::Subtract:
+		case NodeType::Multiply:
+		case NodeType::Divide:
+		case NodeType::Modulo:
+		case NodeType::BitwiseAnd:
+		case NodeType::BitwiseOr:
+		case NodeType::BitwiseXor:
+		case NodeType::LeftShift:
+		case NodeType::RightShift:
+		case NodeType::LogicalAnd:
+		case NodeType::LogicalOr:
+			{
+				uint8_t op_code = 0;
+				switch(in_node->_node_type)
+				{
+				case NodeType::Add: op_code = OpCode::Add; break;
+				case NodeType::Subtract: op_code = OpCode::Subtract; break;
+				case NodeType::Multiply: op_code = OpCode::Multiply; break;
+				case NodeType::Divide: op_code = OpCode::Divide; break;
+				case NodeType::Modulo: op_code = OpCode::Modulo; break;
+				case NodeType::BitwiseAnd: op_code = OpCode::BitwiseAnd; break;
+				case NodeType::BitwiseOr: op_code = OpCode::BitwiseOr; break;
+				case NodeType::BitwiseXor: op_code = OpCode::BitwiseXor; break;
+				case NodeType::LeftShift: op_code = OpCode::LeftShift; break;
+				case NodeType::RightShift: op_code = OpCode::RightShift; break;
+				case NodeType::LogicalAnd: op_code = OpCode::LogicalAnd; break;
+				case NodeType::LogicalOr: op_code = OpCode::LogicalOr; break;
+				}
+
+				// scalar operands are converted and broadcast to the result's type
+				const ASTNode* left = in_node->_children[0];
+				const ASTNode* right = in_node->_children[1];
+				const uint16_t a = convert(compile_expression(left), left->_return_type, type);
+				const uint16_t b = convert(compile_expression(right), right->_return_type, type);
+				const uint16_t dest = allocate_temp();
+				emit(op_code, type, dest, a, b);
+				return dest;
+			}
+		case NodeType::Equal:
+		case NodeType::NotEqual:
+		case NodeType::Greater:
+		case NodeType::GreaterEqual:
+		case NodeType::Less:
+		case NodeType::LessEqual:
+			{
+				uint8_t op_code = 0;
+				switch(in_node->_node_type)
+				{
+				case NodeType::Equal: op_code = OpCode::Equal; break;
+				case NodeType::NotEqual: op_code = OpCode::NotEqual; break;
+				case NodeType::Greater: op_code = OpCode::Greater; break;
+				case NodeType::GreaterEqual: op_code = OpCode::GreaterEqual; break;
+				case NodeType::Less: op_code = OpCode::Less; break;
+				case NodeType::LessEqual: op_code = OpCode::LessEqual; break;
+				}
+
+				const ASTNode* left = in_node->_children[0];
+				const ASTNode* right = in_node->_children[1];
+				const uint8_t left_base = base_type(left->_return_type);
+				const uint8_t right_base = base_type(right->_return_type);
+				const uint8_t common = (left_base == BaseType::Float || right_base == BaseType::Float) ? BaseType::Float : left_base;
+
+				const uint16_t a = convert(compile_expression(left), left->_return_type, make_type(common, 1));
+				const uint16_t b = convert(compile_expression(right), right->_return_type, make_type(common, 1));
+				const uint16_t dest = allocate_temp();
+				emit(op_code, ReturnType::Bool, dest, a, b);
+				_program->_code.back().SourceType = common;
+				return dest;
+			}
+		case NodeType::Member:
+			{
+				const uint16_t parent = compile_expression(in_node->_children[0]);
+				const int32_t member = *(const int32_t*)in_node->_children[1]->_u.literal.data;
+				const uint16_t dest = allocate_temp();
+				emit(OpCode::Extract, type, dest, parent, 0, 0, member);
+				return dest;
+			}
+		case NodeType::Constructor:
+			{
+				const uint16_t dest = allocate_temp();
+				const ReturnType::Type component = make_type(base_type(type), 1);
+				for(uint32_t k = 0; k < in_node->_count; k++)
+				{
+					const ASTNode* child = in_node->_children[k];
+					const uint16_t value = convert(compile_expression(child), child->_return_type, component);
+					emit(OpCode::Insert, component, dest, value, 0, 0, k);
+				}
+				return dest;
+			}
+		case NodeType::Cast:
+			{
+				const ASTNode* child = in_node->_children[0];
+				return convert(compile_expression(child), child->_return_type, type);
+			}
+		case NodeType::Function:
+			return compile_function(in_node);
+		case NodeType::GetIndex:
+			{
+				const uint16_t dest = allocate_temp();
+				emit(OpCode::Index, ReturnType::Int2, dest);
+				return dest;
+			}
+		case NodeType::GetNormalizedIndex:
+			{
+				const uint16_t dest = allocate_temp();
+				emit(OpCode::NormalizedIndex, ReturnType::Float2, dest);
+				return dest;
+			}
+		case NodeType::Sample1D:
+		case NodeType::Sample2D:
+			{
+				const ASTNode* buffer = in_node->_children[0];
+				auto it = _buffers.find(buffer->_u.sid);
+				COMPUTE_ASSERT(it != _buffers.end());
+
+				uint16_t x = 0;
+				uint16_t y = 0;
+				if(in_node->_count == 3)
+				{
+					x = convert(compile_expression(in_node->_children[1]), in_node->_children[1]->_return_type, ReturnType::Int);
+					y = convert(compile_expression(in_node->_children[2]), in_node->_children[2]->_return_type, ReturnType::Int);
+				}
+				else if(in_node->_node_type == NodeType::Sample2D)
+				{
+					// sampled with an Int2
+					const ASTNode* child = in_node->_children[1];
+					const uint16_t index = convert(compile_expression(child), child->_return_type, ReturnType::Int2);
+					x = allocate_temp();
+					emit(OpCode::Extract, ReturnType::Int, x, index, 0, 0, 0);
+					y = allocate_temp();
+					emit(OpCode::Extract, ReturnType::Int, y, index, 0, 0, 1);
+				}
+				else
+				{
+					x = convert(compile_expression(in_node->_children[1]), in_node->_children[1]->_return_type, ReturnType::Int);
+				}
+
+				const uint16_t dest = allocate_temp();
+				emit(in_node->_node_type == NodeType::Sample1D ? OpCode::Sample1D : OpCode::Sample2D, type, dest, x, y, 0, it->second);
+				return dest;
+			}
+		default:
+			COMPUTE_ASSERT(false);
+			return 0;
+		}
+	}
+
+	uint16_t CPUCompiler::compile_function(const ASTNode* in_node)
+	{
+		const ReturnType::Type type = in_node->_return_type;
+		const int32_t function = *(const int32_t*)in_node->_children[0]->_u.literal.data;
+
+		switch(function)
+		{
+		case BuiltinFunction::Index:
+			{
+				const uint16_t dest = allocate_temp();
+				emit(OpCode::Index, ReturnType::Int2, dest);
+				return dest;
+			}
+		case BuiltinFunction::NormalizedIndex:
+			{
+				const uint16_t dest = allocate_temp();
+				emit(OpCode::NormalizedIndex, ReturnType::Float2, dest);
+				return dest;
+			}
+		}
+
+		// arguments are Int for the Int overloads of Abs and Sign, and Float otherwise
+		const uint8_t argument_base = base_type(type) == BaseType::Int ? BaseType::Int : BaseType::Float;
+		uint16_t arguments[3] = {0, 0, 0};
+		uint8_t argument_width = 1;
+		for(uint32_t k = 1; k < in_node->_count && k <= 3; k++)
+		{
+			const ASTNode* child = in_node->_children[k];
+			argument_width = std::max(argument_width, component_count(child->_return_type));
+			arguments[k - 1] = convert(compile_expression(child), child->_return_type, make_type(argument_base, component_count(child->_return_type)));
+		}
+
+		const uint16_t dest = allocate_temp();
+		emit(OpCode::Function, type, dest, arguments[0], arguments[1], arguments[2], function | (argument_width << 8));
+		return dest;
+	}
+
+	uint16_t CPUCompiler::convert(uint16_t in_register, ReturnType::Type from, ReturnType::Type to)
+	{
+		const uint8_t from_base = base_type(from);
+		const uint8_t from_width = component_count(from);
+		const uint8_t to_base = base_type(to);
+		const uint8_t to_width = component_count(to);
+
+		uint16_t result = in_register;
+		if(from_base != to_base)
+		{
+			const uint16_t dest = allocate_temp();
+			emit(OpCode::Convert, make_type(to_base, from_width), dest, result);
+			_program->_code.back().SourceType = from_base;
+			result = dest;
+		}
+		if(from_width == 1 && to_width > 1)
+		{
+			const uint16_t dest = allocate_temp();
+			emit(OpCode::Splat, to, dest, result);
+			result = dest;
+		}
+		return result;
+	}
+
+	uint32_t CPUCompiler::emit(uint8_t op_code, ReturnType::Type type, uint16_t dest, uint16_t source0, uint16_t source1, uint16_t source2, int32_t immediate)
+	{
+		CPUProgram::Instruction in;
+		in.OpCode = op_code;
+		in.Type = type == ReturnType::Void ? BaseType::Bool : base_type(type);
+		in.Width = type == ReturnType::Void ? 0 : component_count(type);
+		in.SourceType = in.Type;
+		in.Dest = dest;
+		in.Source[0] = source0;
+		in.Source[1] = source1;
+		in.Source[2] = source2;
+		in.Immediate = immediate;
+
+		_program->_code.push_back(in);
+		return uint32_t(_program->_code.size() - 1);
+	}
+
+	void CPUCompiler::push_mask()
+	{
+		emit(OpCode::PushMask, ReturnType::Void, 0);
+		_mask_depth++;
+		_program->_mask_depth = std::max(_program->_mask_depth, _mask_depth);
+	}
+
+	void CPUCompiler::pop_mask()
+	{
+		emit(OpCode::PopMask, ReturnType::Void, 0);
+		_mask_depth--;
+	}
+
+	void CPUCompiler::patch_jump(uint32_t instruction)
+	{
+		_program->_code[instruction].Immediate = int32_t(_program->_code.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#include "CPUInterpreter.h"
+
+// the interpreter at 8 lanes, one AVX2 register per component; built with /arch:AVX2 and
+// only run after CPURuntime::SetLaneCount(8), which callers only make on AVX2 machines
+
+namespace SiCKL
+{
+	template void CPUProgram::run_rows<8>(int32_t, int32_t, const InterpreterArgs&) const;
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#include "CPUInterpreter.h"
+
+// the interpreter at 16 lanes, one AVX-512 register per component; built with /arch:AVX512
+// and only run after CPURuntime::SetLaneCount(16), which callers only make on AVX-512 machines
+
+namespace SiCKL
+{
+	template void CPUProgram::run_rows<16>(int32_t, int32_t, const InterpreterArgs&) const;
+}
\ No newline at end of file
@@ -0,0 +1,577 @@
+#pragma once
+
+#include "SiCKL.h"
+#include "TypeInfo.h"
+
+#include <math.h>
+#include <malloc.h>
+#include <string.h>
+
+// Source.h's Else macro collides with NodeType::Else
+#undef Else
+
+/*
+ * The CPUProgram interpreter, templated on the number of grid points it runs at
+ * a time.  Each lane count is instantiated in its own translation unit, built for
+ * the instruction set whose registers it fills, so the per-lane loops compile to
+ * full width vectors:
+ *
+ *   4   CPU.cpp (SSE2)
+ *   8   CPUAVX2.cpp (/arch:AVX2)
+ *   16  CPUAVX512.cpp (/arch:AVX512)
+ *
+ * CPUProgram::Run picks one by CPURuntime::SetLaneCount.  Only static helpers are
+ * called in here, no inline functions with external linkage (std::min, the
+ * TypeInfo.h queries, ...), so the linker can't hand the SSE2 build a copy of one
+ * compiled for a wider instruction set.
+ */
+
+namespace SiCKL
+{
+	struct OpCode
+	{
+		enum Code
+		{
+			// data movement
+			Move,
+			Convert,
+			Splat,
+			Extract,
+			Insert,
+			// arithmetic
+			Negate,
+			Add,
+			Subtract,
+			Multiply,
+			Divide,
+			Modulo,
+			// comparison
+			Equal,
+			NotEqual,
+			Greater,
+			GreaterEqual,
+			Less,
+			LessEqual,
+			// logical
+			LogicalAnd,
+			LogicalOr,
+			LogicalNot,
+			// bitwise
+			BitwiseAnd,
+			BitwiseOr,
+			BitwiseXor,
+			BitwiseNot,
+			LeftShift,
+			RightShift,
+			// builtins
+			Function,
+			Index,
+			NormalizedIndex,
+			Sample1D,
+			Sample2D,
+			// flow control; the ops from PopMask on change the lane mask, and all but PopMask
+			// skip to Immediate when that leaves no lanes running
+			Jump,
+			PushMask,
+			PopMask,
+			// re-enable the lanes which haven't taken a branch yet, before an ElseIf's condition
+			JumpIfDone,
+			Branch,
+			BranchElse,
+			LoopBranch,
+		};
+	};
+
+	template<int32_t Lanes>
+	void CPUProgram::run_rows(int32_t row_begin, int32_t row_end, const InterpreterArgs& args) const
+	{
+		// each worker gets its own copy of the register file, with every value broadcast to all lanes
+		LaneValue<Lanes>* r = (LaneValue<Lanes>*)_aligned_malloc(sizeof(LaneValue<Lanes>) * (args.RegisterCount > 0 ? args.RegisterCount : 1), 64);
+		for(uint32_t k = 0; k < args.RegisterCount; k++)
+		{
+			for(uint32_t c = 0; c < 4; c++)
+			{
+				for(int32_t l = 0; l < Lanes; l++)
+				{
+					r[k].u[c][l] = args.Registers[k].u[c];
+				}
+			}
+		}
+		const uint32_t mask_entries = _mask_depth > 0 ? _mask_depth : 1;
+		MaskEntry<Lanes>* mask_stack = (MaskEntry<Lanes>*)_aligned_malloc(sizeof(MaskEntry<Lanes>) * mask_entries, 64);
+
+		for(int32_t y = row_begin; y < row_end; y++)
+		{
+			for(int32_t x = 0; x < _size[0]; x += Lanes)
+			{
+				for(uint32_t k = 0; k < args.TargetCount; k++)
+				{
+					memset(r + args.Targets[k].Register, 0x00, sizeof(LaneValue<Lanes>));
+				}
+
+				execute<Lanes>(r, mask_stack, x, y, args);
+
+				for(uint32_t k = 0; k < args.TargetCount; k++)
+				{
+					const Target& target = args.Targets[k];
+					if(target.Data == nullptr || y >= target.Height)
+					{
+						continue;
+					}
+
+					const LaneValue<Lanes>& value = r[target.Register];
+					const uint32_t components = target.Components;
+					const int32_t lanes = target.Width - x < Lanes ? target.Width - x : Lanes;
+					uint32_t* dest = target.Data + (y * target.Width + x) * components;
+					for(int32_t l = 0; l < lanes; l++)
+					{
+						for(uint32_t c = 0; c < components; c++)
+						{
+							dest[l * components + c] = value.u[c][l];
+						}
+					}
+				}
+			}
+		}
+
+		_aligned_free(mask_stack);
+		_aligned_free(r);
+	}
+
+	static inline uint32_t convert_component(uint32_t in_bits, uint8_t in_from, uint8_t in_to)
+	{
+		union
+		{
+			uint32_t u;
+			int32_t i;
+			float f;
+		} src, dest;
+		src.u = in_bits;
+		dest.u = 0;
+
+		switch(in_to)
+		{
+		case BaseType::Bool:
+			dest.u = in_from == BaseType::Float ? (src.f != 0.0f) : (src.u != 0);
+			break;
+		case BaseType::Int:
+			dest.i = in_from == BaseType::Float ? int32_t(src.f) : src.i;
+			break;
+		case BaseType::UInt:
+			dest.u = in_from == BaseType::Float ? uint32_t(int64_t(src.f)) : src.u;
+			break;
+		case BaseType::Float:
+			switch(in_from)
+			{
+			case BaseType::Bool:
+				dest.f = src.u != 0 ? 1.0f : 0.0f;
+				break;
+			case BaseType::Int:
+				dest.f = float(src.i);
+				break;
+			case BaseType::UInt:
+				dest.f = float(src.u);
+				break;
+			default:
+				dest.f = src.f;
+				break;
+			}
+			break;
+		}
+		return dest.u;
+	}
+
+	static inline float sign(float x)
+	{
+		return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f);
+	}
+
+	// same results as the <algorithm> min and max, which can't be used here (see above)
+	static inline float min_float(float a, float b)
+	{
+		return b < a ? b : a;
+	}
+
+	static inline float max_float(float a, float b)
+	{
+		return a < b ? b : a;
+	}
+
+	// apply EXPR to every lane of every component of the instruction's result
+#	define LANEWISE(EXPR) for(uint32_t c = 0; c < in.Width; c++) for(int32_t l = 0; l < Lanes; l++) { EXPR; }
+
+	// arithmetic on Int and UInt is done with unsigned wraparound
+#	define ARITHMETIC(OP)\
+		if(in.Type == BaseType::Float)\
+			LANEWISE(r.f[c][l] = a.f[c][l] OP b.f[c][l])\
+		else\
+			LANEWISE(r.u[c][l] = a.u[c][l] OP b.u[c][l])\
+		break;
+
+#	define COMPARISON(OP)\
+		switch(in.SourceType)\
+		{\
+		case BaseType::Int: LANEWISE(r.u[0][l] = a.i[0][l] OP b.i[0][l]) break;\
+		case BaseType::Float: LANEWISE(r.u[0][l] = a.f[0][l] OP b.f[0][l]) break;\
+		default: LANEWISE(r.u[0][l] = a.u[0][l] OP b.u[0][l]) break;\
+		}\
+		break;
+
+	// runs Lanes grid points starting at (x, y) together; lanes which are past the end of
+	// the row or on the other side of a branch are masked off and keep their old values
+	template<int32_t Lanes>
+	void CPUProgram::execute(LaneValue<Lanes>* registers, MaskEntry<Lanes>* mask_stack, int32_t x, int32_t y, const InterpreterArgs& args) const
+	{
+		const Instruction* code = args.Code;
+		const int32_t code_size = args.CodeSize;
+
+		uint32_t mask[Lanes];
+		for(int32_t l = 0; l < Lanes; l++)
+		{
+			mask[l] = x + l < _size[0] ? 0xFFFFFFFFu : 0;
+		}
+		bool full_mask = x + Lanes <= _size[0];
+		uint32_t mask_depth = 0;
+
+		LaneValue<Lanes> r;
+		for(int32_t pc = 0; pc < code_size; pc++)
+		{
+			const Instruction& in = code[pc];
+			LaneValue<Lanes>& d = registers[in.Dest];
+			const LaneValue<Lanes>& a = registers[in.Source[0]];
+			const LaneValue<Lanes>& b = registers[in.Source[1]];
+
+			switch(in.OpCode)
+			{
+			/// data movement
+			case OpCode::Move:
+				LANEWISE(r.u[c][l] = a.u[c][l])
+				break;
+			case OpCode::Convert:
+				LANEWISE(r.u[c][l] = convert_component(a.u[c][l], in.SourceType, in.Type))
+				break;
+			case OpCode::Splat:
+				LANEWISE(r.u[c][l] = a.u[0][l])
+				break;
+			case OpCode::Extract:
+				LANEWISE(r.u[c][l] = a.u[in.Immediate][l])
+				break;
+			case OpCode::Insert:
+				// only writes a single component
+				for(int32_t l = 0; l < Lanes; l++)
+				{
+					d.u[in.Immediate][l] = (a.u[0][l] & mask[l]) | (d.u[in.Immediate][l] & ~mask[l]);
+				}
+				continue;
+			/// arithmetic
+			case OpCode::Negate:
+				if(in.Type == BaseType::Float)
+					LANEWISE(r.f[c][l] = -a.f[c][l])
+				else
+					LANEWISE(r.u[c][l] = 0u - a.u[c][l])
+				break;
+			case OpCode::Add:
+				ARITHMETIC(+)
+			case OpCode::Subtract:
+				ARITHMETIC(-)
+			case OpCode::Multiply:
+				ARITHMETIC(*)
+			case OpCode::Divide:
+				switch(in.Type)
+				{
+				case BaseType::Float:
+					LANEWISE(r.f[c][l] = a.f[c][l] / b.f[c][l])
+					break;
+				case BaseType::Int:
+					LANEWISE(r.i[c][l] = (b.i[c][l] == 0 || (b.i[c][l] == -1 && a.u[c][l] == 0x80000000u)) ? 0 : a.i[c][l] / b.i[c][l])
+					break;
+				default:
+					LANEWISE(r.u[c][l] = b.u[c][l] == 0 ? 0 : a.u[c][l] / b.u[c][l])
+					break;
+				}
+				break;
+			case OpCode::Modulo:
+				switch(in.Type)
+				{
+				case BaseType::Float:
+					LANEWISE(r.f[c][l] = a.f[c][l] - b.f[c][l] * floorf(a.f[c][l] / b.f[c][l]))
+					break;
+				case BaseType::Int:
+					LANEWISE(r.i[c][l] = (b.i[c][l] == 0 || b.i[c][l] == -1) ? 0 : a.i[c][l] % b.i[c][l])
+					break;
+				default:
+					LANEWISE(r.u[c][l] = b.u[c][l] == 0 ? 0 : a.u[c][l] % b.u[c][l])
+					break;
+				}
+				break;
+			/// comparison
+			case OpCode::Equal:
+				COMPARISON(==)
+			case OpCode::NotEqual:
+				COMPARISON(!=)
+			case OpCode::Greater:
+				COMPARISON(>)
+			case OpCode::GreaterEqual:
+				COMPARISON(>=)
+			case OpCode::Less:
+				COMPARISON(<)
+			case OpCode::LessEqual:
+				COMPARISON(<=)
+			/// logical
+			case OpCode::LogicalAnd:
+				LANEWISE(r.u[0][l] = (a.u[0][l] != 0) & (b.u[0][l] != 0))
+				break;
+			case OpCode::LogicalOr:
+				LANEWISE(r.u[0][l] = (a.u[0][l] != 0) | (b.u[0][l] != 0))
+				break;
+			case OpCode::LogicalNot:
+				LANEWISE(r.u[0][l] = a.u[0][l] == 0)
+				break;
+			/// bitwise
+			case OpCode::BitwiseAnd:
+				LANEWISE(r.u[c][l] = a.u[c][l] & b.u[c][l])
+				break;
+			case OpCode::BitwiseOr:
+				LANEWISE(r.u[c][l] = a.u[c][l] | b.u[c][l])
+				break;
+			case OpCode::BitwiseXor:
+				LANEWISE(r.u[c][l] = a.u[c][l] ^ b.u[c][l])
+				break;
+			case OpCode::BitwiseNot:
+				LANEWISE(r.u[c][l] = ~a.u[c][l])
+				break;
+			case OpCode::LeftShift:
+				LANEWISE(r.u[c][l] = a.u[c][l] << (b.u[c][l] & 31))
+				break;
+			case OpCode::RightShift:
+				if(in.Type == BaseType::Int)
+					LANEWISE(r.i[c][l] = a.i[c][l] >> (b.u[c][l] & 31))
+				else
+					LANEWISE(r.u[c][l] = a.u[c][l] >> (b.u[c][l] & 31))
+				break;
+			/// builtins
+			case OpCode::Function:
+				{
+					const LaneValue<Lanes>& e = registers[in.Source[2]];
+					const uint32_t source_width = uint32_t(in.Immediate) >> 8;
+					switch(in.Immediate & 0xFF)
+					{
+					case BuiltinFunction::Sin: LANEWISE(r.f[c][l] = sinf(a.f[c][l])) break;
+					case BuiltinFunction::Cos: LANEWISE(r.f[c][l] = cosf(a.f[c][l])) break;
+					case BuiltinFunction::Tan: LANEWISE(r.f[c][l] = tanf(a.f[c][l])) break;
+					case BuiltinFunction::ASin: LANEWISE(r.f[c][l] = asinf(a.f[c][l])) break;
+					case BuiltinFunction::ACos: LANEWISE(r.f[c][l] = acosf(a.f[c][l])) break;
+					case BuiltinFunction::ATan: LANEWISE(r.f[c][l] = atanf(a.f[c][l])) break;
+					case BuiltinFunction::SinH: LANEWISE(r.f[c][l] = sinhf(a.f[c][l])) break;
+					case BuiltinFunction::CosH: LANEWISE(r.f[c][l] = coshf(a.f[c][l])) break;
+					case BuiltinFunction::TanH: LANEWISE(r.f[c][l] = tanhf(a.f[c][l])) break;
+					case BuiltinFunction::ASinH: LANEWISE(r.f[c][l] = asinhf(a.f[c][l])) break;
+					case BuiltinFunction::ACosH: LANEWISE(r.f[c][l] = acoshf(a.f[c][l])) break;
+					case BuiltinFunction::ATanH: LANEWISE(r.f[c][l] = atanhf(a.f[c][l])) break;
+					case BuiltinFunction::Pow: LANEWISE(r.f[c][l] = powf(a.f[c][l], b.f[c][l])) break;
+					case BuiltinFunction::Exp: LANEWISE(r.f[c][l] = expf(a.f[c][l])) break;
+					case BuiltinFunction::Log: LANEWISE(r.f[c][l] = logf(a.f[c][l])) break;
+					case BuiltinFunction::Exp2: LANEWISE(r.f[c][l] = exp2f(a.f[c][l])) break;
+					case BuiltinFunction::Log2: LANEWISE(r.f[c][l] = log2f(a.f[c][l])) break;
+					case BuiltinFunction::Sqrt: LANEWISE(r.f[c][l] = sqrtf(a.f[c][l])) break;
+					case BuiltinFunction::Abs:
+						if(in.Type == BaseType::Int)
+							LANEWISE(r.i[c][l] = a.i[c][l] < 0 ? -a.i[c][l] : a.i[c][l])
+						else
+							LANEWISE(r.f[c][l] = fabsf(a.f[c][l]))
+						break;
+					case BuiltinFunction::Sign:
+						if(in.Type == BaseType::Int)
+							LANEWISE(r.i[c][l] = (a.i[c][l] > 0) - (a.i[c][l] < 0))
+						else
+							LANEWISE(r.f[c][l] = sign(a.f[c][l]))
+						break;
+					case BuiltinFunction::Floor: LANEWISE(r.f[c][l] = floorf(a.f[c][l])) break;
+					case BuiltinFunction::Ceiling: LANEWISE(r.f[c][l] = ceilf(a.f[c][l])) break;
+					case BuiltinFunction::Min: LANEWISE(r.f[c][l] = min_float(a.f[c][l], b.f[c][l])) break;
+					case BuiltinFunction::Max: LANEWISE(r.f[c][l] = max_float(a.f[c][l], b.f[c][l])) break;
+					case BuiltinFunction::Clamp: LANEWISE(r.f[c][l] = min_float(max_float(a.f[c][l], b.f[c][l]), e.f[c][l])) break;
+					case BuiltinFunction::IsNan:
+					case BuiltinFunction::IsInf:
+						LANEWISE(
+							const bool test = (in.Immediate & 0xFF) == BuiltinFunction::IsNan ? a.f[c][l] != a.f[c][l] : (fabsf(a.f[c][l]) == INFINITY);
+							if(in.Type == BaseType::Float) r.f[c][l] = test ? 1.0f : 0.0f; else r.u[c][l] = test)
+						break;
+					case BuiltinFunction::Length:
+					case BuiltinFunction::Normalize:
+						for(int32_t l = 0; l < Lanes; l++)
+						{
+							float sum = 0.0f;
+							for(uint32_t c = 0; c < source_width; c++)
+							{
+								sum += a.f[c][l] * a.f[c][l];
+							}
+							r.f[0][l] = sqrtf(sum);
+						}
+						if((in.Immediate & 0xFF) == BuiltinFunction::Normalize)
+						{
+							float length[Lanes];
+							memcpy(length, r.f[0], sizeof(length));
+							LANEWISE(r.f[c][l] = a.f[c][l] / length[l])
+						}
+						break;
+					case BuiltinFunction::Distance:
+						for(int32_t l = 0; l < Lanes; l++)
+						{
+							float sum = 0.0f;
+							for(uint32_t c = 0; c < source_width; c++)
+							{
+								sum += (a.f[c][l] - b.f[c][l]) * (a.f[c][l] - b.f[c][l]);
+							}
+							r.f[0][l] = sqrtf(sum);
+						}
+						break;
+					case BuiltinFunction::Dot:
+						for(int32_t l = 0; l < Lanes; l++)
+						{
+							float sum = 0.0f;
+							for(uint32_t c = 0; c < source_width; c++)
+							{
+								sum += a.f[c][l] * b.f[c][l];
+							}
+							r.f[0][l] = sum;
+						}
+						break;
+					case BuiltinFunction::Cross:
+						for(int32_t l = 0; l < Lanes; l++)
+						{
+							r.f[0][l] = a.f[1][l] * b.f[2][l] - a.f[2][l] * b.f[1][l];
+							r.f[1][l] = a.f[2][l] * b.f[0][l] - a.f[0][l] * b.f[2][l];
+							r.f[2][l] = a.f[0][l] * b.f[1][l] - a.f[1][l] * b.f[0][l];
+						}
+						break;
+					default:
+						COMPUTE_ASSERT(false);
+						break;
+					}
+				}
+				break;
+			case OpCode::Index:
+				for(int32_t l = 0; l < Lanes; l++)
+				{
+					r.i[0][l] = x + l;
+					r.i[1][l] = y;
+				}
+				break;
+			case OpCode::NormalizedIndex:
+				for(int32_t l = 0; l < Lanes; l++)
+				{
+					r.f[0][l] = (float(x + l) + 0.5f) / float(_size[0]);
+					r.f[1][l] = (float(y) + 0.5f) / float(_size[1]);
+				}
+				break;
+			case OpCode::Sample1D:
+			case OpCode::Sample2D:
+				{
+					const Sampler& s = args.Samplers[in.Immediate];
+					for(int32_t l = 0; l < Lanes; l++)
+					{
+						const int32_t sx = a.i[0][l];
+						const int32_t sy = in.OpCode == OpCode::Sample2D ? b.i[0][l] : 0;
+						// out of range reads return 0
+						if(sx >= 0 && sy >= 0 && sx < s.Width && sy < s.Height)
+						{
+							const uint32_t* texel = s.Data + (sy * s.Width + sx) * s.Components;
+							for(uint32_t c = 0; c < in.Width; c++)
+							{
+								r.u[c][l] = texel[c];
+							}
+						}
+						else
+						{
+							for(uint32_t c = 0; c < in.Width; c++)
+							{
+								r.u[c][l] = 0;
+							}
+						}
+					}
+				}
+				break;
+			/// flow control
+			case OpCode::Jump:
+				pc = in.Immediate - 1;
+				continue;
+			case OpCode::PushMask:
+				{
+					MaskEntry<Lanes>& entry = mask_stack[mask_depth++];
+					memcpy(entry.Saved, mask, sizeof(mask));
+					memcpy(entry.Remaining, mask, sizeof(mask));
+				}
+				continue;
+			case OpCode::PopMask:
+				memcpy(mask, mask_stack[--mask_depth].Saved, sizeof(mask));
+				break;
+			case OpCode::Branch:
+				{
+					// run the branch for lanes which haven't taken an earlier one and pass the condition
+					MaskEntry<Lanes>& entry = mask_stack[mask_depth - 1];
+					for(int32_t l = 0; l < Lanes; l++)
+					{
+						const uint32_t condition = a.u[0][l] != 0 ? 0xFFFFFFFFu : 0;
+						mask[l] = entry.Remaining[l] & condition;
+						entry.Remaining[l] &= ~condition;
+					}
+				}
+				break;
+			case OpCode::BranchElse:
+				{
+					MaskEntry<Lanes>& entry = mask_stack[mask_depth - 1];
+					memcpy(mask, entry.Remaining, sizeof(mask));
+					memset(entry.Remaining, 0x00, sizeof(mask));
+				}
+				break;
+			case OpCode::LoopBranch:
+				// lanes leave the loop once their condition fails
+				for(int32_t l = 0; l < Lanes; l++)
+				{
+					mask[l] &= a.u[0][l] != 0 ? 0xFFFFFFFFu : 0;
+				}
+				break;
+			case OpCode::JumpIfDone:
+				memcpy(mask, mask_stack[mask_depth - 1].Remaining, sizeof(mask));
+				break;
+			default:
+				COMPUTE_ASSERT(false);
+				break;
+			}
+
+			if(in.OpCode >= OpCode::PopMask)
+			{
+				// the mask changed
+				uint32_t any = 0;
+				uint32_t all = 0xFFFFFFFFu;
+				for(int32_t l = 0; l < Lanes; l++)
+				{
+					any |= mask[l];
+					all &= mask[l];
+				}
+				full_mask = all != 0;
+				// nothing left to run here, skip to the end of the block
+				if(any == 0 && in.OpCode != OpCode::PopMask)
+				{
+					pc = in.Immediate - 1;
+				}
+				continue;
+			}
+
+			// write the result to the active lanes
+			if(full_mask)
+			{
+				memcpy(d.u, r.u, in.Width * sizeof(r.u[0]));
+			}
+			else
+			{
+				LANEWISE(d.u[c][l] = (r.u[c][l] & mask[l]) | (d.u[c][l] & ~mask[l]))
+			}
+		}
+	}
+
+#	undef COMPARISON
+#	undef ARITHMETIC
+#	undef LANEWISE
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "SiCKL.h"
+
+// ReturnType queries shared by the CPU backends
+
+namespace SiCKL
+{
+	// component type of a value
+	struct BaseType
+	{
+		enum Type
+		{
+			Bool,
+			Int,
+			UInt,
+			Float,
+		};
+	};
+
+	static const uint32_t BufferTypes = (uint32_t)ReturnType::Buffer1D | (uint32_t)ReturnType::Buffer2D;
+
+	inline bool is_buffer(ReturnType::Type in_type)
+	{
+		return ((uint32_t)in_type & BufferTypes) != 0;
+	}
+
+	inline ReturnType::Type element_type(ReturnType::Type in_type)
+	{
+		return (ReturnType::Type)((uint32_t)in_type & ~BufferTypes);
+	}
+
+	inline uint8_t base_type(ReturnType::Type in_type)
+	{
+		switch(element_type(in_type))
+		{
+		case ReturnType::Bool:
+			return BaseType::Bool;
+		case ReturnType::Int:
+		case ReturnType::Int2:
+		case ReturnType::Int3:
+		case ReturnType::Int4:
+			return BaseType::Int;
+		case ReturnType::UInt:
+		case ReturnType::UInt2:
+		case ReturnType::UInt3:
+		case ReturnType::UInt4:
+			return BaseType::UInt;
+		default:
+			return BaseType::Float;
+		}
+	}
+
+	inline uint8_t component_count(ReturnType::Type in_type)
+	{
+		switch(element_type(in_type))
+		{
+		case ReturnType::Int2:
+		case ReturnType::UInt2:
+		case ReturnType::Float2:
+			return 2;
+		case ReturnType::Int3:
+		case ReturnType::UInt3:
+		case ReturnType::Float3:
+			return 3;
+		case ReturnType::Int4:
+		case ReturnType::UInt4:
+		case ReturnType::Float4:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	inline ReturnType::Type make_type(uint8_t in_base, uint8_t in_width)
+	{
+		static const ReturnType::Type types[4][4] =
+		{
+			{ReturnType::Bool, ReturnType::Bool, ReturnType::Bool, ReturnType::Bool},
+			{ReturnType::Int, ReturnType::Int2, ReturnType::Int3, ReturnType::Int4},
+			{ReturnType::UInt, ReturnType::UInt2, ReturnType::UInt3, ReturnType::UInt4},
+			{ReturnType::Float, ReturnType::Float2, ReturnType::Float3, ReturnType::Float4},
+		};
+		return types[in_base][in_width - 1];
+	}
+}
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include <cassert>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
 
 namespace cppJSONStream
 {
@@ -409,9 +413,359 @@ namespace cppJSONStream
 	{
 		return str;
 	}
+	bool Reader::readArrayText(std::string& out_text)
+	{
+		out_text.clear();
+		if(_error || _scope_stack.size() == 0 || _scope_stack.back().need_element == false || _scope_stack.back().element_count > 0)
+		{
+			_error = true;
+			return false;
+		}
+
+		// numbers never contain brackets, so read a ']' at a time until the nesting closes
+		std::string chunk;
+		for(size_t depth = 1; depth > 0;)
+		{
+			if(!std::getline(_stream, chunk, ']'))
+			{
+				_error = true;
+				return false;
+			}
+			depth += std::count(chunk.begin(), chunk.end(), '[');
+			depth--;
+
+			out_text += chunk;
+			if(depth > 0)
+			{
+				out_text += ']';
+			}
+		}
+		_scope_stack.pop_back();
+
+		return true;
+	}
 
 /// Writer
 
+	// Shortest round trip float formatting; this is Ulf Adams' Ryu (f2s), which finds the
+	// shortest decimal in the interval of reals that round to the float using only 32x64 bit
+	// multiplies against tables of 5^i and 2^k/5^i
+
+	static const uint64_t FloatPow5InvSplit[31] =
+	{
+		0x0800000000000001ull, 0x0666666666666667ull, 0x051eb851eb851eb9ull,
+		0x04189374bc6a7efaull, 0x068db8bac710cb2aull, 0x053e2d6238da3c22ull,
+		0x0431bde82d7b634eull, 0x06b5fca6af2bd216ull, 0x055e63b88c230e78ull,
+		0x044b82fa09b5a52dull, 0x06df37f675ef6eaeull, 0x057f5ff85e592558ull,
+		0x0465e6604b7a8447ull, 0x0709709a125da071ull, 0x05a126e1a84ae6c1ull,
+		0x0480ebe7b9d58567ull, 0x0734aca5f6226f0bull, 0x05c3bd5191b525a3ull,
+		0x049c97747490eae9ull, 0x0760f253edb4ab0eull, 0x05e72843249088d8ull,
+		0x04b8ed0283a6d3e0ull, 0x078e480405d7b966ull, 0x060b6cd004ac9452ull,
+		0x04d5f0a66a23a9dbull, 0x07bcb43d769f762bull, 0x063090312bb2c4efull,
+		0x04f3a68dbc8f03f3ull, 0x07ec3daf94180651ull, 0x065697bfa9acd1daull,
+		0x051212ffbaf0a7e2ull,
+	};
+	static const uint32_t FloatPow5InvBitCount = 59;
+
+	static const uint64_t FloatPow5Split[48] =
+	{
+		0x1000000000000000ull, 0x1400000000000000ull, 0x1900000000000000ull,
+		0x1f40000000000000ull, 0x1388000000000000ull, 0x186a000000000000ull,
+		0x1e84800000000000ull, 0x1312d00000000000ull, 0x17d7840000000000ull,
+		0x1dcd650000000000ull, 0x12a05f2000000000ull, 0x174876e800000000ull,
+		0x1d1a94a200000000ull, 0x12309ce540000000ull, 0x16bcc41e90000000ull,
+		0x1c6bf52634000000ull, 0x11c37937e0800000ull, 0x16345785d8a00000ull,
+		0x1bc16d674ec80000ull, 0x1158e460913d0000ull, 0x15af1d78b58c4000ull,
+		0x1b1ae4d6e2ef5000ull, 0x10f0cf064dd59200ull, 0x152d02c7e14af680ull,
+		0x1a784379d99db420ull, 0x108b2a2c28029094ull, 0x14adf4b7320334b9ull,
+		0x19d971e4fe8401e7ull, 0x1027e72f1f128130ull, 0x1431e0fae6d7217cull,
+		0x193e5939a08ce9dbull, 0x1f8def8808b02452ull, 0x13b8b5b5056e16b3ull,
+		0x18a6e32246c99c60ull, 0x1ed09bead87c0378ull, 0x13426172c74d822bull,
+		0x1812f9cf7920e2b6ull, 0x1e17b84357691b64ull, 0x12ced32a16a1b11eull,
+		0x178287f49c4a1d66ull, 0x1d6329f1c35ca4bfull, 0x125dfa371a19e6f7ull,
+		0x16f578c4e0a060b5ull, 0x1cb2d6f618c878e3ull, 0x11efc659cf7d4b8dull,
+		0x166bb7f0435c9e71ull, 0x1c06a5ec5433c60dull, 0x118427b3b4a05bc8ull,
+	};
+	static const uint32_t FloatPow5BitCount = 61;
+
+	// ceil(log2(5^e)), 1 for e == 0
+	static inline int32_t pow5_bits(int32_t e)
+	{
+		return int32_t(((uint32_t)e * 1217359) >> 19) + 1;
+	}
+
+	// floor(log10(2^e))
+	static inline uint32_t log10_pow2(int32_t e)
+	{
+		return ((uint32_t)e * 78913) >> 18;
+	}
+
+	// floor(log10(5^e))
+	static inline uint32_t log10_pow5(int32_t e)
+	{
+		return ((uint32_t)e * 732923) >> 20;
+	}
+
+	static inline bool multiple_of_pow5(uint32_t value, uint32_t p)
+	{
+		uint32_t count = 0;
+		for(; value % 5 == 0; value /= 5)
+		{
+			count++;
+		}
+		return count >= p;
+	}
+
+	static inline bool multiple_of_pow2(uint32_t value, uint32_t p)
+	{
+		return (value & ((1u << p) - 1)) == 0;
+	}
+
+	// (m * factor) >> shift, for shift > 32
+	static inline uint32_t mul_shift(uint32_t m, uint64_t factor, int32_t shift)
+	{
+		const uint64_t bits0 = uint64_t(m) * uint32_t(factor);
+		const uint64_t bits1 = uint64_t(m) * uint32_t(factor >> 32);
+		const uint64_t sum = (bits0 >> 32) + bits1;
+		return uint32_t(sum >> (shift - 32));
+	}
+
+	// finds the shortest out_digits * 10^out_exponent that reads back as the finite, non zero
+	// float with the given mantissa and biased exponent bits
+	static void shortest_decimal(uint32_t in_mantissa, uint32_t in_exponent, uint32_t& out_digits, int32_t& out_exponent)
+	{
+		int32_t e2;
+		uint32_t m2;
+		if(in_exponent == 0)
+		{
+			e2 = 1 - 127 - 23 - 2;
+			m2 = in_mantissa;
+		}
+		else
+		{
+			e2 = int32_t(in_exponent) - 127 - 23 - 2;
+			m2 = (1u << 23) | in_mantissa;
+		}
+		const bool accept_bounds = (m2 & 1) == 0;
+
+		// the float and the midpoints to its neighbours, as multiples of 2^e2
+		const uint32_t mv = 4 * m2;
+		const uint32_t mp = 4 * m2 + 2;
+		const uint32_t mm_shift = (in_mantissa != 0 || in_exponent <= 1) ? 1 : 0;
+		const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+		// the same three converted to multiples of 10^e10
+		uint32_t vr, vp, vm;
+		int32_t e10;
+		bool vm_trailing_zeros = false;
+		bool vr_trailing_zeros = false;
+		uint32_t last_removed_digit = 0;
+		if(e2 >= 0)
+		{
+			const uint32_t q = log10_pow2(e2);
+			e10 = int32_t(q);
+			const int32_t k = FloatPow5InvBitCount + pow5_bits(q) - 1;
+			const int32_t i = -e2 + int32_t(q) + k;
+			vr = mul_shift(mv, FloatPow5InvSplit[q], i);
+			vp = mul_shift(mp, FloatPow5InvSplit[q], i);
+			vm = mul_shift(mm, FloatPow5InvSplit[q], i);
+			if(q != 0 && (vp - 1) / 10 <= vm / 10)
+			{
+				// the loop below removes at most one digit, so compute it here
+				const int32_t l = FloatPow5InvBitCount + pow5_bits(q - 1) - 1;
+				last_removed_digit = mul_shift(mv, FloatPow5InvSplit[q - 1], -e2 + int32_t(q) - 1 + l) % 10;
+			}
+			if(q <= 9)
+			{
+				// only one of mp, mv and mm can be a multiple of 5
+				if(mv % 5 == 0)
+				{
+					vr_trailing_zeros = multiple_of_pow5(mv, q);
+				}
+				else if(accept_bounds)
+				{
+					vm_trailing_zeros = multiple_of_pow5(mm, q);
+				}
+				else
+				{
+					vp -= multiple_of_pow5(mp, q) ? 1 : 0;
+				}
+			}
+		}
+		else
+		{
+			const uint32_t q = log10_pow5(-e2);
+			e10 = int32_t(q) + e2;
+			const int32_t i = -e2 - int32_t(q);
+			const int32_t k = pow5_bits(i) - FloatPow5BitCount;
+			int32_t j = int32_t(q) - k;
+			vr = mul_shift(mv, FloatPow5Split[i], j);
+			vp = mul_shift(mp, FloatPow5Split[i], j);
+			vm = mul_shift(mm, FloatPow5Split[i], j);
+			if(q != 0 && (vp - 1) / 10 <= vm / 10)
+			{
+				j = int32_t(q) - 1 - (pow5_bits(i + 1) - FloatPow5BitCount);
+				last_removed_digit = mul_shift(mv, FloatPow5Split[i + 1], j) % 10;
+			}
+			if(q <= 1)
+			{
+				// mv has at least q trailing zero bits, so vr is exact
+				vr_trailing_zeros = true;
+				if(accept_bounds)
+				{
+					vm_trailing_zeros = mm_shift == 1;
+				}
+				else
+				{
+					vp--;
+				}
+			}
+			else if(q < 31)
+			{
+				vr_trailing_zeros = multiple_of_pow2(mv, q - 1);
+			}
+		}
+
+		// drop digits while the interval still contains a shorter number
+		int32_t removed = 0;
+		uint32_t output;
+		if(vm_trailing_zeros || vr_trailing_zeros)
+		{
+			// rare path, where the interval bounds and round to even matter
+			for(; vp / 10 > vm / 10; removed++)
+			{
+				vm_trailing_zeros &= vm % 10 == 0;
+				vr_trailing_zeros &= last_removed_digit == 0;
+				last_removed_digit = vr % 10;
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+			}
+			if(vm_trailing_zeros)
+			{
+				for(; vm % 10 == 0; removed++)
+				{
+					vr_trailing_zeros &= last_removed_digit == 0;
+					last_removed_digit = vr % 10;
+					vr /= 10;
+					vp /= 10;
+					vm /= 10;
+				}
+			}
+			if(vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+			{
+				// exactly halfway, round to even
+				last_removed_digit = 4;
+			}
+			output = vr + (((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5) ? 1 : 0);
+		}
+		else
+		{
+			for(; vp / 10 > vm / 10; removed++)
+			{
+				last_removed_digit = vr % 10;
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+			}
+			output = vr + ((vr == vm || last_removed_digit >= 5) ? 1 : 0);
+		}
+
+		out_digits = output;
+		out_exponent = e10 + removed;
+	}
+
+	// writes the shortest text that reads back as value to out_buffer (at least 24 chars) and
+	// returns its length; exponents always follow a '.' since Reader::parse_number needs one
+	static size_t format_float(float value, char* out_buffer)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		const uint32_t mantissa = bits & ((1u << 23) - 1);
+		const uint32_t exponent = (bits >> 23) & 0xFF;
+
+		char* head = out_buffer;
+		if(bits >> 31)
+		{
+			*head++ = '-';
+		}
+		if(exponent == 0 && mantissa == 0)
+		{
+			*head++ = '0';
+			return size_t(head - out_buffer);
+		}
+
+		uint32_t output;
+		int32_t e10;
+		shortest_decimal(mantissa, exponent, output, e10);
+
+		char digits[10];
+		int32_t digit_count = 0;
+		for(; output > 0; output /= 10)
+		{
+			digits[9 - digit_count++] = char('0' + output % 10);
+		}
+		const char* d = digits + 10 - digit_count;
+
+		// position of the decimal point relative to the first digit
+		const int32_t point = digit_count + e10;
+		if(point > 9 || point < -5)
+		{
+			*head++ = d[0];
+			*head++ = '.';
+			if(digit_count == 1)
+			{
+				*head++ = '0';
+			}
+			for(int32_t k = 1; k < digit_count; k++)
+			{
+				*head++ = d[k];
+			}
+			*head++ = 'e';
+			int32_t e = point - 1;
+			if(e < 0)
+			{
+				*head++ = '-';
+				e = -e;
+			}
+			if(e >= 10)
+			{
+				*head++ = char('0' + e / 10);
+			}
+			*head++ = char('0' + e % 10);
+		}
+		else if(point <= 0)
+		{
+			*head++ = '0';
+			*head++ = '.';
+			for(int32_t k = point; k < 0; k++)
+			{
+				*head++ = '0';
+			}
+			for(int32_t k = 0; k < digit_count; k++)
+			{
+				*head++ = d[k];
+			}
+		}
+		else
+		{
+			for(int32_t k = 0; k < digit_count; k++)
+			{
+				if(k == point)
+				{
+					*head++ = '.';
+				}
+				*head++ = d[k];
+			}
+			for(int32_t k = digit_count; k < point; k++)
+			{
+				*head++ = '0';
+			}
+		}
+
+		return size_t(head - out_buffer);
+	}
+
 	// no unicode support
 	static void write_string(const char* name, std::ostream& stream)
 	{
@@ -637,6 +991,61 @@ namespace cppJSONStream
 
 	}
 
+	void Writer::write(float value)
+	{
+		if(std::isfinite(value) == false)
+		{
+			write(double(value));
+			return;
+		}
+
+		begin_write();
+
+		char buff[24];
+		_stream.write(buff, std::streamsize(format_float(value, buff)));
+
+		end_write();
+	}
+
+	void Writer::write_array(const float* values, size_t count)
+	{
+		begin_array();
+
+		// format into one buffer and hand it to the stream in large writes
+		const size_t flush_size = 64 * 1024;
+		const char* separator = _pretty_format ? ", " : ",";
+		const size_t separator_length = strlen(separator);
+		_buffer.resize(flush_size + 32);
+
+		size_t length = 0;
+		for(size_t k = 0; k < count; k++)
+		{
+			if(k > 0)
+			{
+				memcpy(&_buffer[length], separator, separator_length);
+				length += separator_length;
+			}
+			if(std::isfinite(values[k]))
+			{
+				length += format_float(values[k], &_buffer[length]);
+			}
+			else
+			{
+				length += sprintf(&_buffer[length], "%e", values[k]);
+			}
+
+			if(length >= flush_size)
+			{
+				_stream.write(&_buffer[0], std::streamsize(length));
+				length = 0;
+			}
+		}
+		_stream.write(&_buffer[0], std::streamsize(length));
+		_scope_stack.back().element_count += count;
+
+		end_array();
+	}
+
 	void Writer::write(const char* value)
 	{
 		begin_write();
@@ -48,7 +48,11 @@ namespace cppJSONStream
 		int64_t readInt();
 		uint64_t readUInt();
 		std::string readString();
-		
+		// call after a BeginArray token: consumes the rest of the array without parsing it and
+		// copies its text (without the outer brackets) to out_text; only for arrays of numbers or
+		// of arrays of numbers, so the caller can parse large arrays however it likes
+		bool readArrayText(std::string& out_text);
+
 
 	private:
 
@@ -97,6 +101,8 @@ namespace cppJSONStream
 		void write(int64_t value);
 		void write(uint64_t value);
 		void write(double value);
+		// floats are written with the fewest digits that read back as the same float
+		void write(float value);
 		void write(const char* value);
 		void write(nullptr_t value);
 
@@ -118,6 +124,8 @@ namespace cppJSONStream
 			}
 			end_array();
 		}
+		// formats the whole array into one buffer rather than writing each element to the stream
+		void write_array(const float* values, size_t count);
 	private:
 
 		void begin_write();
@@ -142,5 +150,6 @@ namespace cppJSONStream
 		size_t _depth;
 		std::vector<scope> _scope_stack;
 		std::ostream& _stream;
+		std::vector<char> _buffer;
 	};
 }
\ No newline at end of file
@@ -11,15 +11,25 @@
 struct cJSON;
 namespace OMLT
 {
+	namespace BinaryModel
+	{
+		class Reader;
+	}
+
 	class AutoEncoder
 	{
 	public:
 		void Encode(const float* in_raw, float* out_encoded) const;
 		void Decode(const float* in_decoded, float* out_raw) const;
+		// the same for a matrix of rows; see FeatureMap::CalcFeatureMatrix for the layout
+		void EncodeMatrix(const float* in_raw, float* out_encoded, uint32_t rows) const;
+		void DecodeMatrix(const float* in_decoded, float* out_raw, uint32_t rows) const;
 
 		void ToJSON(std::ostream& stream) const;
 
 		static AutoEncoder* FromJSON(std::istream& stream);
+		// see BinaryModel.h; load with Model::FromFile
+		void ToBinary(std::ostream& stream) const;
 
 		const uint32_t hidden_count;
 		const uint32_t visible_count;
@@ -30,9 +40,13 @@ namespace OMLT
 		FeatureMap encoder;
 		FeatureMap decoder;
 	private:
-		AutoEncoder(uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_hidden_type, ActivationFunction_t in_output_type);
+		AutoEncoder(uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_hidden_type, ActivationFunction_t in_output_type, const MappedFeatureMap* in_encoder = nullptr, const MappedFeatureMap* in_decoder = nullptr);
+
+		static AutoEncoder* FromBinary(BinaryModel::Reader& in_reader);
 
+		friend struct Model;
 		friend class AutoEncoderBackPropagation;
+		friend class AutoEncoderBackPropagationCPU;
 	};
 	typedef AutoEncoder AE;
 }
\ No newline at end of file
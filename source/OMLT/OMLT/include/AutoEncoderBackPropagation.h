@@ -51,6 +51,8 @@ namespace OMLT
 			float VisibleDropout;
 			float HiddenDropout;
 			float AdadeltaDecay;
+			// only used by the CPU trainers
+			Parallelism_t Parallelism;
 
 			TrainingConfig() 
 				: LearningRate(0.0f)
@@ -60,6 +62,7 @@ namespace OMLT
 				, VisibleDropout(0.0f)
 				, HiddenDropout(0.0f)
 				, AdadeltaDecay(1.0f)
+				, Parallelism(Parallelism::Synchronous)
 			{ }
 		};
 		AutoEncoderBackPropagation(const ModelConfig&, uint32_t in_minibatch_size, int32_t in_seed);
@@ -69,18 +72,24 @@ namespace OMLT
 		void SetTrainingConfig(const TrainingConfig&);
 		ModelConfig GetModelConfig() const {return _model_config;};
 
-		void Train(const OpenGLBuffer2D&);
+		void Train(const SiCKLBuffer2D&);
 
 		/// get our trained model
 		AutoEncoder* GetAutoEncoder() const;
 
+		/// these methods are used by cltrain to average models between data-parallel workers
+		// number of floats GetParameters writes: the weights followed by their deltas (momentum)
+		uint32_t GetParameterCount() const;
+		void GetParameters(float* out_parameters) const;
+		void SetParameters(const float* in_parameters);
+
 		/// these methods are used by VisualRBM for real-time visualization
 		bool DumpLastVisible(float** image, float** recon);
 		bool DumpLastHidden(float** activations);
 		bool DumpLastWeights(float** weights);
 
 		float GetLastError();
-		float GetError(const OpenGLBuffer2D&);
+		float GetError(const SiCKLBuffer2D&);
 	private:
 		uint32_t _minibatch_size;
 		ModelConfig _model_config;
@@ -94,43 +103,43 @@ namespace OMLT
 		/** Texture Buffers **/
 		 
 		// dropout related buffers
-		OpenGLBuffer2D VisibleRandom0;
-		OpenGLBuffer2D VisibleRandom1;
-		OpenGLBuffer2D VisibleEnabled;
-		OpenGLBuffer2D HiddenRandom0;
-		OpenGLBuffer2D HiddenRandom1;
-		OpenGLBuffer2D HiddenEnabled;
+		SiCKLBuffer2D VisibleRandom0;
+		SiCKLBuffer2D VisibleRandom1;
+		SiCKLBuffer2D VisibleEnabled;
+		SiCKLBuffer2D HiddenRandom0;
+		SiCKLBuffer2D HiddenRandom1;
+		SiCKLBuffer2D HiddenEnabled;
 
 		// weight buffers
-		OpenGLBuffer2D Weights0;
-		OpenGLBuffer2D Weights1;
-		OpenGLBuffer2D DeltaWeights0;
-		OpenGLBuffer2D DeltaWeights1;
-		OpenGLBuffer2D NesterovWeight;
-		OpenGLBuffer2D MeanSquareDelta0;
-		OpenGLBuffer2D MeanSquareDelta1;
+		SiCKLBuffer2D Weights0;
+		SiCKLBuffer2D Weights1;
+		SiCKLBuffer2D DeltaWeights0;
+		SiCKLBuffer2D DeltaWeights1;
+		SiCKLBuffer2D NesterovWeight;
+		SiCKLBuffer2D MeanSquareDelta0;
+		SiCKLBuffer2D MeanSquareDelta1;
 
 		// layer buffers
-		OpenGLBuffer2D Target;
-		OpenGLBuffer2D Visible;
-		OpenGLBuffer2D Hidden0;
-		OpenGLBuffer2D Hidden1;
-		OpenGLBuffer2D Output0;
-		OpenGLBuffer2D Output1;
+		SiCKLBuffer2D Target;
+		SiCKLBuffer2D Visible;
+		SiCKLBuffer2D Hidden0;
+		SiCKLBuffer2D Hidden1;
+		SiCKLBuffer2D Output0;
+		SiCKLBuffer2D Output1;
 
 		// sensitivities
-		OpenGLBuffer2D HiddenSensitivities;
-		OpenGLBuffer2D OutputSensitivities;
-
-		OpenGLProgram* CalcEnabledVisible;
-		OpenGLProgram* CalcEnabledHidden;
-		OpenGLProgram* CalcHidden;
-		OpenGLProgram* CalcHiddenSoftmax;
-		OpenGLProgram* CalcOutput;
-		OpenGLProgram* CalcOutputSoftmax;
-		OpenGLProgram* CalcOutputSensitivities;
-		OpenGLProgram* CalcHiddenSensitivities;
-		OpenGLProgram* UpdateWeights;
+		SiCKLBuffer2D HiddenSensitivities;
+		SiCKLBuffer2D OutputSensitivities;
+
+		SiCKLProgram* CalcEnabledVisible;
+		SiCKLProgram* CalcEnabledHidden;
+		SiCKLProgram* CalcHidden;
+		SiCKLProgram* CalcHiddenSoftmax;
+		SiCKLProgram* CalcOutput;
+		SiCKLProgram* CalcOutputSoftmax;
+		SiCKLProgram* CalcOutputSensitivities;
+		SiCKLProgram* CalcHiddenSensitivities;
+		SiCKLProgram* UpdateWeights;
 
 		ErrorCalculator* _error_calculator;
 		
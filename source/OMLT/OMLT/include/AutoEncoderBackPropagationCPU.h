@@ -0,0 +1,117 @@
+#pragma once
+
+// std
+#include <stdint.h>
+#include <vector>
+
+// OMLT
+#include "Enums.h"
+#include "Common.h"
+#include "CPUShared.h"
+#include "AutoEncoderBackPropagation.h"
+
+namespace OMLT
+{
+	class AutoEncoder;
+	class DataAtlasCPU;
+
+	// Runs the same algorithm as AutoEncoderBackPropagation (see AutoEncoderBackPropagationKernels.h)
+	// on the host using the multithreaded SIMD kernels in CPUShared.h rather than SiCKL.
+	// Minibatches are passed in as tightly packed MinibatchSize x VisibleCount float arrays.
+	class AutoEncoderBackPropagationCPU
+	{
+	public:
+		typedef AutoEncoderBackPropagation::ModelConfig ModelConfig;
+		typedef AutoEncoderBackPropagation::TrainingConfig TrainingConfig;
+
+		// 0 threads means use every hardware thread
+		AutoEncoderBackPropagationCPU(const ModelConfig&, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count = 0);
+		AutoEncoderBackPropagationCPU(const AutoEncoder* in_autoencoder, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count = 0);
+		~AutoEncoderBackPropagationCPU();
+
+		void SetTrainingConfig(const TrainingConfig&);
+		ModelConfig GetModelConfig() const {return _model_config;};
+
+		void Train(const float* in_example);
+		// trains on the next in_minibatches minibatches of in_examples; with Parallelism::Hogwild each
+		// thread trains on minibatches of its own and updates the shared weights without locking, in
+		// which case the GetLast and Dump methods don't reflect these minibatches; otherwise they
+		// read the last minibatch in place, so only until the atlas' next call to Next
+		void Train(DataAtlasCPU& in_examples, uint32_t in_minibatches);
+
+		/// get our trained model
+		AutoEncoder* GetAutoEncoder() const;
+
+		/// these methods mirror the AutoEncoderBackPropagation ones (and buffer layouts) used by VisualRBM
+		bool DumpLastVisible(float** image, float** recon);
+		bool DumpLastHidden(float** activations);
+		bool DumpLastWeights(float** weights);
+
+		float GetLastError();
+		float GetError(const float* in_example);
+	private:
+		// a single threaded Hogwild worker which trains in_owner's parameters
+		AutoEncoderBackPropagationCPU(const AutoEncoderBackPropagationCPU* in_owner, int32_t in_seed);
+
+		uint32_t _minibatch_size;
+		ModelConfig _model_config;
+		TrainingConfig _training_config;
+		UpdateRule _update_rule;
+
+		// padded row lengths
+		uint32_t _visible_stride;
+		uint32_t _hidden_stride;
+
+		ThreadPool _thread_pool;
+
+		int32_t _seed;
+		// one per thread, created on the first Hogwild pass
+		std::vector<AutoEncoderBackPropagationCPU*> _hogwild_workers;
+
+		// seeds, 4 uint32_t per unit
+		uint32_t* _visible_dropout_seeds;
+		uint32_t* _hidden_dropout_seeds;
+
+		// 1.0f or 0.0f per unit
+		float* _enabled_visible;
+		float* _enabled_hidden;
+
+		// minibatch x units matrices
+		float* _visible;
+		float* _visible_masked;
+		float* _visible_test;
+		float* _hidden;
+		float* _hidden_masked;
+		float* _output;
+		float* _output_sensitivities;
+		float* _hidden_sensitivities;
+		// the minibatch last trained on: _visible, or the atlas page it was read from
+		const float* _current_visible;
+
+		// tied weights; row j holds the visible weights for hidden unit j, and is
+		// read as a column when decoding so no transposed copy is kept
+		ParameterMatrix _weights;
+		ParameterMatrix _hidden_biases;
+		ParameterMatrix _output_biases;
+
+		// gradient scratch
+		float* _weight_gradient;
+		float* _hidden_bias_gradient;
+		float* _output_bias_gradient;
+
+		ErrorFunction_t _error_function;
+
+		// trains on in_visible, a minibatch of rows _visible_stride apart
+		void train_minibatch(const float* in_visible);
+		void train_hogwild(DataAtlasCPU& in_examples, uint32_t in_minibatches);
+
+		void calc_enabled(uint32_t* io_seeds, uint32_t in_count, float in_dropout_prob, float* out_enabled);
+		// encodes, decodes and (optionally) calculates sensitivities for every row of the minibatch
+		void feed_forward(const float* in_visible, bool in_nesterov, bool in_calc_sensitivities);
+		void update_weights();
+
+		// in_owner is only set for Hogwild workers, which use its parameters rather than allocating their own
+		void allocate_buffers(const float* in_weight_buffer, int32_t in_seed, const AutoEncoderBackPropagationCPU* in_owner = nullptr);
+		void free_buffers();
+	};
+}
\ No newline at end of file
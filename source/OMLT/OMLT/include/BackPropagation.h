@@ -78,6 +78,12 @@ namespace OMLT
 		struct TrainingConfig
 		{
 			std::vector<LayerParameters> Parameters;
+			// only used by BackPropagationCPU
+			Parallelism_t Parallelism;
+
+			TrainingConfig()
+				: Parallelism(Parallelism::Synchronous)
+			{ }
 		};
 
 		
@@ -88,16 +94,22 @@ namespace OMLT
 
 		void SetTrainingConfig(const TrainingConfig&);
 
-		void Train(const OpenGLBuffer2D& example_input, const OpenGLBuffer2D& example_label);
+		void Train(const SiCKLBuffer2D& example_input, const SiCKLBuffer2D& example_label);
 
 		float GetLastOutputError();
-		float GetOutputError(const OpenGLBuffer2D& example_input, const OpenGLBuffer2D& example_output);
+		float GetOutputError(const SiCKLBuffer2D& example_input, const SiCKLBuffer2D& example_output);
 
 		uint32_t LayerCount() const {return _layers.size();}
 
 		MultilayerPerceptron* GetMultilayerPerceptron() const;
 		MultilayerPerceptron* GetMultilayerPerceptron(uint32_t begin_layer, uint32_t end_layer) const;
 
+		/// these methods are used by cltrain to average models between data-parallel workers
+		// number of floats GetParameters writes: the weights followed by their deltas (momentum)
+		uint32_t GetParameterCount() const;
+		void GetParameters(float* out_parameters) const;
+		void SetParameters(const float* in_parameters);
+
 		bool DumpLastLabel(float** label);
 		bool DumpInput(uint32_t layer, float** input);
 		bool DumpActivation(uint32_t layer, float** output);
@@ -117,46 +129,46 @@ namespace OMLT
 			/* 
 			 * Inputs from previous layer
 			 */
-			OpenGLBuffer2D* Input;
-			OpenGLBuffer2D InputEnabled;
+			SiCKLBuffer2D* Input;
+			SiCKLBuffer2D InputEnabled;
 			// random seeds for input dropout
-			OpenGLBuffer2D InputRandom0;
-			OpenGLBuffer2D InputRandom1;
+			SiCKLBuffer2D InputRandom0;
+			SiCKLBuffer2D InputRandom1;
 
 			/*
 			 * Weights and weight deltas
 			 */
-			OpenGLBuffer2D Weights0;
-			OpenGLBuffer2D Weights1;
-			OpenGLBuffer2D NesterovWeight;
-			OpenGLBuffer2D DeltaWeights0;
-			OpenGLBuffer2D DeltaWeights1;
-			OpenGLBuffer2D MeanSquareDelta0;
-			OpenGLBuffer2D MeanSquareDelta1;
-			OpenGLBuffer2D* OutputEnabled;
+			SiCKLBuffer2D Weights0;
+			SiCKLBuffer2D Weights1;
+			SiCKLBuffer2D NesterovWeight;
+			SiCKLBuffer2D DeltaWeights0;
+			SiCKLBuffer2D DeltaWeights1;
+			SiCKLBuffer2D MeanSquareDelta0;
+			SiCKLBuffer2D MeanSquareDelta1;
+			SiCKLBuffer2D* OutputEnabled;
 
 			/*
 			 * Output associated data
 			 */
-			OpenGLBuffer2D Activation0;
-			OpenGLBuffer2D Activation1;
+			SiCKLBuffer2D Activation0;
+			SiCKLBuffer2D Activation1;
 			// random seeds used for Gaussian noise (if warranted)
-			OpenGLBuffer2D OutputRandom0;
-			OpenGLBuffer2D OutputRandom1;
+			SiCKLBuffer2D OutputRandom0;
+			SiCKLBuffer2D OutputRandom1;
 
 			/* 
 			 * Sensitivity related data
 			 */ 
-			OpenGLBuffer2D Sensitivities;
+			SiCKLBuffer2D Sensitivities;
 
 			// methods
-			OpenGLProgram* CalcEnabledInputs;
-			OpenGLProgram* FeedForward;
-			OpenGLProgram* CalcSoftmax;
-			OpenGLProgram* CalcSensitivity;
-			OpenGLProgram* UpdateWeights;
+			SiCKLProgram* CalcEnabledInputs;
+			SiCKLProgram* FeedForward;
+			SiCKLProgram* CalcSoftmax;
+			SiCKLProgram* CalcSensitivity;
+			SiCKLProgram* UpdateWeights;
 		};
-		const OpenGLBuffer2D* _last_label;
+		const SiCKLBuffer2D* _last_label;
 
 		ErrorCalculator* _error_calculator;
 
@@ -179,4 +191,4 @@ namespace OMLT
 	};
 
 	typedef BackPropagation BP;
-}
+}
\ No newline at end of file
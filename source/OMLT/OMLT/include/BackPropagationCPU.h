@@ -0,0 +1,152 @@
+#pragma once
+
+// std
+#include <stdint.h>
+#include <vector>
+#include <random>
+using std::vector;
+
+// OMLT
+#include "Enums.h"
+#include "Common.h"
+#include "CPUShared.h"
+#include "BackPropagation.h"
+#include "MultilayerPerceptron.h"
+
+namespace OMLT
+{
+	class DataAtlasCPU;
+
+	// Runs the same algorithm as BackPropagation (see BackPropagationKernels.h) on
+	// the host using the multithreaded SIMD kernels in CPUShared.h rather than SiCKL.
+	// Inputs and labels are passed in as tightly packed MinibatchSize x Units float arrays.
+	class BackPropagationCPU
+	{
+	public:
+		typedef BackPropagation::LayerConfig LayerConfig;
+		typedef BackPropagation::ModelConfig ModelConfig;
+		typedef BackPropagation::LayerParameters LayerParameters;
+		typedef BackPropagation::TrainingConfig TrainingConfig;
+
+		// 0 threads means use every hardware thread
+		BackPropagationCPU(const ModelConfig, uint32_t in_minibatchsize, int32_t in_seed, uint32_t in_thread_count = 0);
+		BackPropagationCPU(MultilayerPerceptron* in_mlp, uint32_t in_minibatchsize, int32_t in_seed, uint32_t in_thread_count = 0);
+
+		~BackPropagationCPU();
+
+		void SetTrainingConfig(const TrainingConfig&);
+
+		void Train(const float* example_input, const float* example_label);
+		// trains on the next in_minibatches minibatches of in_inputs and in_labels; with Parallelism::Hogwild
+		// each thread trains on minibatches of its own and updates the shared weights without locking, in
+		// which case the GetLast and Dump methods don't reflect these minibatches; otherwise they read
+		// the last minibatch in place, so only until the atlases' next call to Next
+		void Train(DataAtlasCPU& in_inputs, DataAtlasCPU& in_labels, uint32_t in_minibatches);
+
+		float GetLastOutputError();
+		float GetOutputError(const float* example_input, const float* example_output);
+
+		uint32_t LayerCount() const {return _layers.size();}
+
+		MultilayerPerceptron* GetMultilayerPerceptron() const;
+		MultilayerPerceptron* GetMultilayerPerceptron(uint32_t begin_layer, uint32_t end_layer) const;
+
+		/// these methods mirror the BackPropagation ones (and buffer layouts)
+		bool DumpLastLabel(float** label);
+		bool DumpInput(uint32_t layer, float** input);
+		bool DumpActivation(uint32_t layer, float** output);
+		bool DumpWeightMatrix(uint32_t layer, float** weights);
+
+	private:
+		// a single threaded Hogwild worker which trains in_owner's parameters
+		BackPropagationCPU(const BackPropagationCPU* in_owner, int32_t in_seed);
+
+		struct Layer
+		{
+			Layer* NextLayer;
+
+			uint32_t InputUnits;
+			uint32_t OutputUnits;
+			// padded row lengths
+			uint32_t InputStride;
+			uint32_t OutputStride;
+
+			ActivationFunction_t Function;
+
+			/*
+			 * Inputs from previous layer
+			 */
+			// raw inputs
+			const float* Input;
+			// inputs with this layer's dropout applied
+			const float* MaskedInput;
+			float* InputEnabled;
+			// random seeds for input dropout
+			uint32_t* InputRandom;
+
+			/*
+			 * Weights; row j holds the input weights for output unit j
+			 */
+			ParameterMatrix Weights;
+			ParameterMatrix Biases;
+			const float* OutputEnabled;
+
+			/*
+			 * Output associated data
+			 */
+			float* Activation;
+			// activations with the next layer's dropout applied
+			float* MaskedActivation;
+			// random seeds used for Gaussian noise (if warranted)
+			uint32_t* OutputRandom;
+
+			/*
+			 * Sensitivity related data
+			 */
+			float* Sensitivities;
+			float* WeightGradient;
+			float* BiasGradient;
+
+			UpdateRule Rule;
+		};
+
+		const uint32_t _input_units;
+		const uint32_t _minibatch_size;
+		TrainingConfig _training_config;
+
+		ThreadPool _thread_pool;
+
+		int32_t _seed;
+		// one per thread, created on the first Hogwild pass
+		vector<BackPropagationCPU*> _hogwild_workers;
+
+		vector<Layer*> _layers;
+
+		// padded copies of the current minibatch
+		float* _input;
+		float* _masked_input;
+		float* _label;
+		// the labels last trained on: _label, or the atlas page they were read from
+		const float* _current_label;
+		// OutputEnabled for the last layer
+		float* _all_enabled;
+
+		ErrorFunction_t _error_function;
+
+		// points the first layer's input and _current_label at a minibatch, with rows at the
+		// first layer's InputStride and the last layer's OutputStride respectively
+		void set_minibatch(const float* in_input, const float* in_label);
+		// trains on the minibatch set by set_minibatch
+		void train_minibatch();
+		void train_hogwild(DataAtlasCPU& in_inputs, DataAtlasCPU& in_labels, uint32_t in_minibatches);
+
+		void calc_enabled();
+		void feed_forward();
+		void calc_sensitivities();
+		void update_weights();
+
+		// in_owner is only set for Hogwild workers, which use its parameters rather than allocating their own
+		void build_layer(LayerConfig in_config, float* in_weights, std::mt19937_64& random, const Layer* in_owner = nullptr);
+		void finish_layers();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+// std
+#include <stdint.h>
+#include <string>
+#include <sstream>
+#include <vector>
+
+namespace cppJSONStream
+{
+	class Reader;
+	class Writer;
+}
+
+namespace OMLT
+{
+	struct FeatureMap;
+	struct MappedFeatureMap;
+
+	// A model file mapped copy-on-write: FeatureMaps loaded from it point straight into the
+	// mapping, and writes to them (ie: further training) stay private to this process.  Each
+	// FeatureMap holds a reference, so the file stays mapped until the last one is gone.
+	class MappedFile
+	{
+	public:
+		// returns nullptr if in_filename could not be mapped; the caller holds the first reference
+		static MappedFile* Open(const char* in_filename);
+
+		uint8_t* Data() const {return _data;}
+		uint64_t Size() const {return _size;}
+
+		void AddReference() {_references++;}
+		void Release();
+	private:
+		MappedFile();
+		~MappedFile();
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+
+		// windows handle of the file mapping
+		void* _mapping;
+		uint8_t* _data;
+		uint64_t _size;
+		uint32_t _references;
+	};
+
+	// Binary models hold the same models as the JSON format, but keep the weights as raw floats laid
+	// out exactly the way FeatureMap stores them, so that loading one is a matter of mapping the file:
+	//
+	//  preamble     -> the characters "OMLT", followed by the format version, the byte length of the
+	//                  header and a reserved 0, each a little endian uint32_t
+	//  header       -> JSON describing the model like ToJSON does, except each FeatureMap is described
+	//                  by its Stride and the offsets of its Biases and Weights blocks
+	//  data section -> starts at the first multiple of Alignment after the header and holds the
+	//                  blocks; offsets are relative to its start and every block is Alignment aligned
+	namespace BinaryModel
+	{
+		const uint32_t Version = 1;
+		const uint32_t PreambleSize = 16;
+		// alignment of the data section and each block in it, the same as FeatureMap's weights
+		const uint32_t Alignment = 64;
+
+		// collects a model's blocks while it writes its header, then writes out the whole file
+		class Writer
+		{
+		public:
+			Writer() : _data_size(0) {}
+			// writes a description of in_map to the header, and queues its blocks for the data section
+			void WriteFeatureMap(cppJSONStream::Writer& header, const FeatureMap& in_map);
+			void Write(std::ostream& stream, const std::string& in_header) const;
+		private:
+			struct Block
+			{
+				const void* data;
+				size_t bytes;
+			};
+			std::vector<Block> _blocks;
+			uint64_t _data_size;
+		};
+
+		class Reader
+		{
+		public:
+			Reader() : _file(nullptr), _data(nullptr), _data_size(0) {}
+			// false if in_file does not hold a binary model of a version we can read
+			bool Open(MappedFile* in_file);
+			std::istream& Header() {return _header;}
+			// reads a FeatureMap description written by Writer::WriteFeatureMap; false if it does not
+			// match the given dimensions or its blocks do not fit in the file
+			bool ReadFeatureMap(cppJSONStream::Reader& header, uint32_t in_input_length, uint32_t in_feature_count, MappedFeatureMap& out_map);
+		private:
+			MappedFile* _file;
+			std::istringstream _header;
+			uint8_t* _data;
+			uint64_t _data_size;
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#pragma once
+
+// std
+#include <stdint.h>
+#include <cmath>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// OMLT
+#include "Enums.h"
+#include "Common.h"
+
+/*
+ * Host side counterparts of the methods in SiCKLShared.h.  These are used by
+ * the CPU trainers and are written so that they produce the same results as
+ * their SiCKL kernel equivalents.
+ *
+ * All matrices are stored row major with each row padded out to a multiple of
+ * 4 floats (see BlockCount), 16 byte aligned, and with the padding zero filled.
+ */
+
+namespace OMLT
+{
+	/// Thread Pool
+
+	// a fixed set of worker threads; the calling thread participates in each job
+	class ThreadPool
+	{
+	public:
+		// 0 means use every hardware thread
+		ThreadPool(uint32_t in_thread_count = 0);
+		~ThreadPool();
+
+		inline uint32_t ThreadCount() const {return _thread_count;}
+
+		// calls in_func(begin, end) on disjoint ranges covering [0, in_count), returns when all have completed
+		void ParallelFor(uint32_t in_count, const std::function<void(uint32_t, uint32_t)>& in_func);
+	private:
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+
+		void worker_main();
+		void run_ranges();
+
+		uint32_t _thread_count;
+		std::vector<std::thread> _workers;
+
+		std::mutex _mutex;
+		std::condition_variable _job_ready;
+		std::condition_variable _job_done;
+		uint64_t _generation;
+		uint32_t _busy_workers;
+		bool _shutdown;
+
+		// the current job
+		const std::function<void(uint32_t, uint32_t)>* _func;
+		uint32_t _count;
+		uint32_t _grain;
+		std::atomic<uint32_t> _next;
+	};
+
+	/// Random Numbers
+
+	// these advance a 4 x uint32_t xorshift128 seed in place (see NextSeed in SiCKLShared.cpp)
+	void NextSeed(uint32_t* io_seed);
+	float NextFloat(uint32_t* io_seed);
+	float NextGaussian(uint32_t* io_seed);
+
+	/// Activation Functions
+
+	inline float Sigmoid(float in_x)
+	{
+		return 1.0f / (1.0f + std::exp(-in_x));
+	}
+
+	float CalcActivation(ActivationFunction_t in_func, float in_accumulation);
+	// this function takes in the result of CalcActivation, not the accumulation
+	float CalcActivationPrime(ActivationFunction_t in_func, float in_activation);
+	// in place softmax on a single row
+	void CalcSoftmax(float* io_row, uint32_t in_length);
+
+	/// Matrix Methods
+
+	// allocates a rows x stride zero filled matrix with stride = 4 * BlockCount(columns)
+	float* AllocateMatrix(uint32_t in_rows, uint32_t in_columns);
+	void FreeMatrix(float*& io_matrix);
+
+	// copies a tightly packed rows x columns matrix into one with padded rows
+	void CopyToPadded(const float* in_source, uint32_t in_rows, uint32_t in_columns, float* out_dest, uint32_t in_dest_stride);
+	// copies out of a padded matrix into a tightly packed one
+	void CopyFromPadded(const float* in_source, uint32_t in_rows, uint32_t in_columns, uint32_t in_source_stride, float* out_dest);
+
+	// called on each block of C as soon as its sums have been stored; io_c points to C[m][n] and the
+	// block is the in_count entries C[m][n] .. C[m][n + in_count - 1]
+	typedef std::function<void(float* io_c, uint32_t in_m, uint32_t in_n, uint32_t in_count)> MatrixEpilogue;
+
+	// C[m][n] = alpha * sum_k A[m][k] * B[n][k] (+ C[m][n] when accumulating)
+	// computes columns [n_begin, n_end) of C for every m; the K padding of A and B must be zero
+	void MatrixMultiplyNT(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate);
+	// C[m][n] = alpha * sum_k A[m][k] * B[n][k], with in_epilogue run over each block of C while it is still
+	// in cache rather than in a second pass over C (for bias, activation etc)
+	void MatrixMultiplyNT(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, const MatrixEpilogue& in_epilogue);
+	// C[m][n] = alpha * sum_k A[m][k] * B[k][n] (+ C[m][n] when accumulating)
+	// computes columns [n_begin, n_end) of C for every m; n_begin and n_end must be multiples of 4
+	void MatrixMultiplyNN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate);
+	// C[n][p] = alpha * sum_m A[m][n] * B[m][p] (+ C[n][p] when accumulating)
+	// computes rows [n_begin, n_end) of C over P columns; P must be a multiple of 4
+	void MatrixMultiplyTN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t P, float alpha, bool accumulate);
+
+	// same as ErrorCalculator::CalcError but on host memory
+	float CalcError(const float* in_calculated, const float* in_expected, uint32_t in_rows, uint32_t in_columns, uint32_t in_stride, ErrorFunction_t in_error_function);
+
+	/// Parameter Updates
+
+	struct UpdateRule
+	{
+		float LearningRate;
+		float Momentum;
+		float L1Regularization;
+		float L2Regularization;
+		float AdadeltaDecay;
+	};
+
+	// a matrix of parameters along with all the state required by the
+	// momentum/Adadelta/Nesterov update used by the SiCKL trainers
+	class ParameterMatrix
+	{
+	public:
+		ParameterMatrix();
+		~ParameterMatrix();
+
+		// all buffers are zero filled
+		void Allocate(uint32_t in_rows, uint32_t in_columns);
+		// uses in_owner's buffers rather than allocating any, so several trainers can update the same
+		// parameters (see Parallelism::Hogwild); in_owner must outlive this matrix
+		void Share(const ParameterMatrix& in_owner);
+		void Free();
+
+		// copies Weights into Nesterov, call after the weights have been set
+		void ResetNesterov();
+
+		// updates a row given the summed gradient;  entries with a 0 enabled value are held (but their nesterov weight is refreshed)
+		void UpdateRow(const UpdateRule& in_rule, uint32_t in_row, const float* in_gradient, float in_scale, const float* in_enabled, bool in_regularize);
+		// holds an entire dropped out row
+		void HoldRow(const UpdateRule& in_rule, uint32_t in_row);
+
+		inline float* weights(uint32_t in_row) {return Weights + in_row * Stride;}
+		inline const float* weights(uint32_t in_row) const {return Weights + in_row * Stride;}
+		inline float* nesterov(uint32_t in_row) {return Nesterov + in_row * Stride;}
+		inline const float* nesterov(uint32_t in_row) const {return Nesterov + in_row * Stride;}
+
+		uint32_t Rows;
+		uint32_t Columns;
+		uint32_t Stride;
+
+		float* Weights;
+		float* Delta;
+		float* MeanSquareDerivative;
+		float* MeanSquareDelta;
+		float* Nesterov;
+	private:
+		ParameterMatrix(const ParameterMatrix&);
+		ParameterMatrix& operator=(const ParameterMatrix&);
+
+		// the buffers belong to another matrix
+		bool _shared;
+	};
+}
\ No newline at end of file
@@ -120,30 +120,53 @@ namespace OMLT
 		uint32_t _user_size;
 	};
 
+	class MappedFile;
+	// a FeatureMap's biases and weights inside a mapped binary model file, see BinaryModel.h
+	struct MappedFeatureMap
+	{
+		MappedFile* file;
+		float* biases;
+		float* weights;
+	};
+
+	// the weights are stored in a single 64 byte aligned buffer, one feature per row; each row
+	// is padded out to a multiple of 16 floats (feature_stride) and the feature count is padded
+	// out to a multiple of 4 with zero filled rows
 	struct FeatureMap
 	{
 	public:
-		FeatureMap(uint32_t input_length, uint32_t feature_count);
+		// with in_mapped the biases and weights are used in place rather than allocated
+		FeatureMap(uint32_t input_length, uint32_t feature_count, const MappedFeatureMap* in_mapped = nullptr);
 		~FeatureMap();
+		// the feature_stride used for the given input length
+		static uint32_t Stride(uint32_t input_length) {return ((BlockCount(input_length) + 3) / 4) * 16;}
 		void CalcFeatureVector(const float* input_vector, float* output_vector, ActivationFunction_t function) const;
-		
+		// calculates the feature vectors for a row major matrix of input vectors; rows are
+		// padded like single vectors: 4 * BlockCount(input_length) floats per input row and
+		// 4 * BlockCount(feature_count) floats per output row
+		void CalcFeatureMatrix(const float* input_matrix, uint32_t rows, float* output_matrix, ActivationFunction_t function) const;
+
 		inline float* biases() {return _biases;};
-		inline float* feature(uint32_t k) {assert(k < feature_count); return _features[k];}
+		inline float* feature(uint32_t k) {assert(k < feature_count); return _weights + k * feature_stride;}
+		inline float* weights() {return _weights;}
 
 		inline const float* biases() const {return _biases;};
-		inline const float* feature(uint32_t k) const {assert(k < feature_count); return _features[k];}
+		inline const float* feature(uint32_t k) const {assert(k < feature_count); return _weights + k * feature_stride;}
+		inline const float* weights() const {return _weights;}
 
 
 		const uint32_t input_length;
 		const uint32_t feature_count;
+		// floats between the start of each feature
+		const uint32_t feature_stride;
 	private:
-
 		const uint32_t _feature_blocks;
 		const uint32_t _input_blocks;
 
 		float* _biases;
-		float** _features;
+		float* _weights;
 		mutable float* _accumulations;
+		// the file _biases and _weights point into, if mapped
+		MappedFile* _file;
 	};
-}
-
+}
\ No newline at end of file
@@ -53,6 +53,8 @@ namespace OMLT
 			float VisibleDropout;
 			float HiddenDropout;
 			float AdadeltaDecay;
+			// only used by the CPU trainers
+			Parallelism_t Parallelism;
 
 			TrainingConfig() 
 				: LearningRate(0.0f)
@@ -62,6 +64,7 @@ namespace OMLT
 				, VisibleDropout(0.0f)
 				, HiddenDropout(0.0f)
 				, AdadeltaDecay(1.0f)
+				, Parallelism(Parallelism::Synchronous)
 			{ }
 		};
 
@@ -72,14 +75,20 @@ namespace OMLT
 		void SetTrainingConfig(const TrainingConfig&);
 		ModelConfig GetModelConfig() const {return _model_config;};
 
-		void Train(const OpenGLBuffer2D&);
+		void Train(const SiCKLBuffer2D&);
 
 		float GetLastReconstructionError();
-		float GetReconstructionError(const OpenGLBuffer2D&);
+		float GetReconstructionError(const SiCKLBuffer2D&);
 
 		// get a new RBM object dumped from GPU memory
 		RestrictedBoltzmannMachine* GetRestrictedBoltzmannMachine() const;
 
+		/// these methods are used by cltrain to average models between data-parallel workers
+		// number of floats GetParameters writes: the weights followed by their deltas (momentum)
+		uint32_t GetParameterCount() const;
+		void GetParameters(float* out_parameters) const;
+		void SetParameters(const float* in_parameters);
+
 		/// these methods are used by VisualRBM for real-time visualization
 		bool DumpLastVisible(float** image, float** recon);
 		bool DumpLastHidden(float** activations);
@@ -93,42 +102,42 @@ namespace OMLT
 		bool _recompile_required;
 
 		// texture buffers
-		OpenGLBuffer2D _visible_dropout_random0;
-		OpenGLBuffer2D _visible_dropout_random1;
-		OpenGLBuffer2D _hidden_dropout_random0;
-		OpenGLBuffer2D _hidden_dropout_random1;
-		OpenGLBuffer2D _enabled_visible;
-		OpenGLBuffer2D _enabled_hidden;
-
-		OpenGLBuffer2D _visible0;
-		OpenGLBuffer2D _visible1;
-		OpenGLBuffer2D _hidden0;
-		OpenGLBuffer2D _hidden1;
-		OpenGLBuffer2D _hidden_states;
-		OpenGLBuffer2D _hidden_random0;
-		OpenGLBuffer2D _hidden_random1;
-		OpenGLBuffer2D _visible_prime0;
-		OpenGLBuffer2D _visible_prime1;
-		OpenGLBuffer2D _hidden_prime0;
-		OpenGLBuffer2D _hidden_prime1;
-
-		OpenGLBuffer2D _weights0;
-		OpenGLBuffer2D _weights1;
-		OpenGLBuffer2D _delta_weights0;
-		OpenGLBuffer2D _delta_weights1;
-		OpenGLBuffer2D _nesterov_weight;
-		OpenGLBuffer2D _mean_square_delta0;
-		OpenGLBuffer2D _mean_square_delta1;
-
-		OpenGLProgram* _calc_enabled_visible;
-		OpenGLProgram* _calc_enabled_hidden;
-		OpenGLProgram* _calc_hidden_states;
-		OpenGLProgram* _calc_hidden_softmax_states;
-		OpenGLProgram* _calc_visible;
-		OpenGLProgram* _calc_visible_softmax;
-		OpenGLProgram* _calc_hidden;
-		OpenGLProgram* _calc_hidden_softmax;
-		OpenGLProgram* _update_weights;
+		SiCKLBuffer2D _visible_dropout_random0;
+		SiCKLBuffer2D _visible_dropout_random1;
+		SiCKLBuffer2D _hidden_dropout_random0;
+		SiCKLBuffer2D _hidden_dropout_random1;
+		SiCKLBuffer2D _enabled_visible;
+		SiCKLBuffer2D _enabled_hidden;
+
+		SiCKLBuffer2D _visible0;
+		SiCKLBuffer2D _visible1;
+		SiCKLBuffer2D _hidden0;
+		SiCKLBuffer2D _hidden1;
+		SiCKLBuffer2D _hidden_states;
+		SiCKLBuffer2D _hidden_random0;
+		SiCKLBuffer2D _hidden_random1;
+		SiCKLBuffer2D _visible_prime0;
+		SiCKLBuffer2D _visible_prime1;
+		SiCKLBuffer2D _hidden_prime0;
+		SiCKLBuffer2D _hidden_prime1;
+
+		SiCKLBuffer2D _weights0;
+		SiCKLBuffer2D _weights1;
+		SiCKLBuffer2D _delta_weights0;
+		SiCKLBuffer2D _delta_weights1;
+		SiCKLBuffer2D _nesterov_weight;
+		SiCKLBuffer2D _mean_square_delta0;
+		SiCKLBuffer2D _mean_square_delta1;
+
+		SiCKLProgram* _calc_enabled_visible;
+		SiCKLProgram* _calc_enabled_hidden;
+		SiCKLProgram* _calc_hidden_states;
+		SiCKLProgram* _calc_hidden_softmax_states;
+		SiCKLProgram* _calc_visible;
+		SiCKLProgram* _calc_visible_softmax;
+		SiCKLProgram* _calc_hidden;
+		SiCKLProgram* _calc_hidden_softmax;
+		SiCKLProgram* _update_weights;
 
 		ErrorCalculator* _error_calculator;
 
@@ -0,0 +1,119 @@
+#pragma once
+
+// std
+#include <stdint.h>
+#include <vector>
+
+// OMLT
+#include "Enums.h"
+#include "Common.h"
+#include "CPUShared.h"
+#include "ContrastiveDivergence.h"
+
+namespace OMLT
+{
+	class RestrictedBoltzmannMachine;
+	class DataAtlasCPU;
+
+	// Runs the same algorithm as ContrastiveDivergence (see ContrastiveDivergenceKernels.h)
+	// on the host using the multithreaded SIMD kernels in CPUShared.h rather than SiCKL.
+	// Minibatches are passed in as tightly packed MinibatchSize x VisibleUnits float arrays.
+	class ContrastiveDivergenceCPU
+	{
+	public:
+		typedef ContrastiveDivergence::ModelConfig ModelConfig;
+		typedef ContrastiveDivergence::TrainingConfig TrainingConfig;
+
+		// 0 threads means use every hardware thread
+		ContrastiveDivergenceCPU(const ModelConfig, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count = 0);
+		ContrastiveDivergenceCPU(RestrictedBoltzmannMachine* in_rbm, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count = 0);
+		~ContrastiveDivergenceCPU();
+
+		void SetTrainingConfig(const TrainingConfig&);
+		ModelConfig GetModelConfig() const {return _model_config;};
+
+		void Train(const float* in_example);
+		// trains on the next in_minibatches minibatches of in_examples; with Parallelism::Hogwild each
+		// thread trains on minibatches of its own and updates the shared weights without locking, in
+		// which case the GetLast and Dump methods don't reflect these minibatches; otherwise they
+		// read the last minibatch in place, so only until the atlas' next call to Next
+		void Train(DataAtlasCPU& in_examples, uint32_t in_minibatches);
+
+		float GetLastReconstructionError();
+		float GetReconstructionError(const float* in_example);
+
+		// get a new RBM object from our current weights
+		RestrictedBoltzmannMachine* GetRestrictedBoltzmannMachine() const;
+
+		/// these methods mirror the ContrastiveDivergence ones (and buffer layouts) used by VisualRBM
+		bool DumpLastVisible(float** image, float** recon);
+		bool DumpLastHidden(float** activations);
+		bool DumpLastWeights(float** weights);
+
+	private:
+		// a single threaded Hogwild worker which trains in_owner's parameters
+		ContrastiveDivergenceCPU(const ContrastiveDivergenceCPU* in_owner, int32_t in_seed);
+
+		uint32_t _minibatch_size;
+		ModelConfig _model_config;
+		TrainingConfig _training_config;
+		UpdateRule _update_rule;
+
+		// padded row lengths
+		uint32_t _visible_stride;
+		uint32_t _hidden_stride;
+
+		ThreadPool _thread_pool;
+
+		int32_t _seed;
+		// one per thread, created on the first Hogwild pass
+		std::vector<ContrastiveDivergenceCPU*> _hogwild_workers;
+
+		// seeds, 4 uint32_t per unit
+		uint32_t* _visible_dropout_seeds;
+		uint32_t* _hidden_dropout_seeds;
+		uint32_t* _hidden_seeds;
+
+		// 1.0f or 0.0f per unit
+		float* _enabled_visible;
+		float* _enabled_hidden;
+
+		// minibatch x units matrices
+		float* _visible;
+		float* _visible_masked;
+		float* _visible_test;
+		float* _hidden;
+		float* _hidden_states;
+		float* _visible_prime;
+		float* _visible_prime_masked;
+		float* _hidden_prime;
+		// the minibatch last trained on: _visible, or the atlas page it was read from
+		const float* _current_visible;
+
+		// weights; row j holds the visible weights for hidden unit j
+		ParameterMatrix _weights;
+		ParameterMatrix _hidden_biases;
+		ParameterMatrix _visible_biases;
+
+		// gradient scratch
+		float* _weight_gradient;
+		float* _hidden_bias_gradient;
+		float* _visible_bias_gradient;
+
+		ErrorFunction_t _error_function;
+
+		// trains on in_visible, a minibatch of rows _visible_stride apart
+		void train_minibatch(const float* in_visible);
+		void train_hogwild(DataAtlasCPU& in_examples, uint32_t in_minibatches);
+
+		void calc_enabled(uint32_t* io_seeds, uint32_t in_count, float in_dropout_prob, float* out_enabled);
+		void calc_hidden_states(const float* in_visible);
+		void calc_visible_prime();
+		void calc_hidden_prime();
+		void update_weights();
+
+		// in_owner is only set for Hogwild workers, which use its parameters rather than allocating their own
+		void allocate_buffers(const float* in_weight_buffer, int32_t in_seed, const ContrastiveDivergenceCPU* in_owner = nullptr);
+		void free_buffers();
+	};
+}
\ No newline at end of file
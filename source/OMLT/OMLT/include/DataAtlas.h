@@ -1,6 +1,10 @@
 #include <stdint.h>
 #include <SiCKL.h>
 
+// OMLT
+#include "DataAtlasCPU.h"
+#include "SiCKLShared.h"
+
 namespace OMLT
 {
 	class IDX;
@@ -11,47 +15,35 @@ namespace OMLT
 		// in_AtlasSize -> size of the atlas in megabytes
 		DataAtlas(uint32_t in_atlas_size);
 		~DataAtlas();
-		bool Initialize(IDX* in_data, uint32_t in_minibatch_size);
-		bool Next(SiCKL::OpenGLBuffer2D& inout_minibatch);
-		uint32_t GetTotalBatches() { return _total_rows / _minibatch_size; }
+		// with in_shuffle set the rows are served in a new order on every pass through the data;
+		// the order only depends on in_seed and the row count, so atlases over paired data (ie:
+		// examples and labels) stay in step
+		bool Initialize(IDX* in_data, uint32_t in_minibatch_size, bool in_shuffle = false, uint32_t in_seed = 0);
+		// see DataAtlasCPU::SetShard
+		void SetShard(uint32_t in_shard, uint32_t in_shard_count) { _pages.SetShard(in_shard, in_shard_count); }
+		// see DataAtlasCPU::SetShuffleBlockRows
+		void SetShuffleBlockRows(uint32_t in_block_rows) { _pages.SetShuffleBlockRows(in_block_rows); }
+		bool Next(SiCKLBuffer2D& inout_minibatch);
+		uint32_t GetTotalBatches() { return _pages.GetTotalBatches(); }
 	private:
-		void PopulateAtlas();
+		// host side pages, streamed and shuffled on the CPU and uploaded to _atlas
+		DataAtlasCPU _pages;
 
 		// our atlas texture on the GPU
-		SiCKL::OpenGLBuffer2D _atlas;
-		// CPU side buffer we keep around for streaming
-		float* _atlas_buffer;
+		SiCKLBuffer2D _atlas;
 		// number of floats per dimension of _atlas
 		uint32_t _atlas_width;
-		// size of our atlas (float count)
-		uint32_t _atlas_size;
 
-		// our backing IDX file
-		IDX* _idx;
 		// length of a single data row
 		uint32_t _row_length;
-		// maximum number of rows we can store in our atlas
-		uint32_t _max_rows;
-		// current row at head of our atlas
-		uint32_t _current_row;
-		// total number of rows in our IDX
-		uint32_t _total_rows;
-		// total number of batches in our IDX
-		uint32_t _total_batches;
-		
-		// flag determines if we are streaming from an IDX file
-		// or if all of our data is loaded
-		bool _streaming;
 		// number of rows in a mini batch
 		uint32_t _minibatch_size;
-		// batches per page
-		uint32_t _batches_per_page;
 
 		// the current minibatch we're on
 		uint32_t _current_batch;
 		// small 2d texture populated in Next();
-		SiCKL::OpenGLBuffer2D _batch;
+		SiCKLBuffer2D _batch;
 		// shader that copies data from our atlas to the batch
-		SiCKL::OpenGLProgram* _texture_copy;
+		SiCKLProgram* _texture_copy;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace OMLT
+{
+	class IDX;
+
+	// Host side data atlas: streams (and optionally shuffles) pages of minibatches out of an
+	// IDX file into host memory, reading the next page on a background thread while the current
+	// one is in use.  Rows are stored at the padded stride the CPU trainers use for their own
+	// matrices (4 * BlockCount(row length), padding zero filled), and Next() hands out pointers
+	// straight into the current page so the trainers can consume minibatches in place; DataAtlas
+	// uploads the same pages to the GPU.
+	//
+	// Pages are allocated with large pages when the account holds SeLockMemoryPrivilege, and are
+	// otherwise locked into the working set, on the NUMA node of the thread that calls the
+	// constructor (the one consuming minibatches).
+	class DataAtlasCPU
+	{
+	public:
+		// in_atlas_size -> size of the atlas in megabytes
+		DataAtlasCPU(uint32_t in_atlas_size);
+		~DataAtlasCPU();
+		// with in_shuffle set the rows are served in a new order on every pass through the data;
+		// the order only depends on in_seed, the row count and the shuffle block size, so atlases
+		// over paired data (ie: examples and labels) stay in step
+		bool Initialize(IDX* in_data, uint32_t in_minibatch_size, bool in_shuffle = false, uint32_t in_seed = 0);
+		// shuffling reads the data in contiguous blocks of this many rows, whole and in a random
+		// order, and hands out each block's rows in a random order; larger blocks mix the rows
+		// better at the cost of a block sized buffer.  Takes effect on the next Initialize, and
+		// paired atlases need the same block size
+		void SetShuffleBlockRows(uint32_t in_block_rows);
+		// restricts the atlas to shard in_shard of in_shard_count equally sized runs of rows; takes
+		// effect on the next Initialize, and the last few rows are dropped when the row count does
+		// not divide evenly so that every shard has the same number of minibatches
+		void SetShard(uint32_t in_shard, uint32_t in_shard_count);
+		// points out_minibatch at the next minibatch: MinibatchSize rows of GetRowLength() floats
+		// out_stride floats apart, which stay valid until the next call to Next
+		bool Next(const float*& out_minibatch, uint32_t& out_stride);
+		uint32_t GetTotalBatches() const { return _total_rows / _minibatch_size; }
+		uint32_t GetRowLength() const { return _row_length; }
+		uint32_t GetRowStride() const { return _row_stride; }
+	private:
+		friend class DataAtlas;
+
+		DataAtlasCPU(const DataAtlasCPU&);
+		DataAtlasCPU& operator=(const DataAtlasCPU&);
+
+		/// page interface used by DataAtlas
+
+		// pages are square so DataAtlas can upload them as a texture
+		uint32_t GetPageWidth() const { return _atlas_width; }
+		const float* GetPage() const { return _atlas_buffer; }
+		uint32_t GetBatchesPerPage() const { return _batches_per_page; }
+		// true when pages get replaced (streaming or shuffling)
+		bool IsPaging() const { return _paging; }
+		// waits for the loader to finish the next page and makes it current
+		void NextPage();
+		// hands the previous page back to the loader once nothing reads from it anymore
+		void ReleasePage();
+
+		// reads the next page of minibatches from _idx
+		void ReadPage(float* out_page);
+		void StartLoader();
+		void StopLoader();
+		void LoaderMain();
+		// reads the next block (in shuffled order) into _block_buffer and shuffles its rows
+		void NextShuffleBlock();
+		// starts a new pass through the data with a new block order
+		void ShuffleBlockOrder();
+
+		// default for SetShuffleBlockRows
+		static const uint32_t DefaultShuffleBlockRows = 4096;
+
+		// the current page
+		float* _atlas_buffer;
+		// when paging, the next page is read into this buffer on a background thread while the
+		// current page is in use
+		float* _next_buffer;
+		// number of floats per dimension of a page
+		uint32_t _atlas_width;
+		// size of a page (float count)
+		uint32_t _atlas_size;
+		// thread state lives in DataAtlasCPU.cpp so this header stays usable from /clr code
+		struct PageLoader;
+		PageLoader* _loader;
+
+		// our backing IDX file
+		IDX* _idx;
+		// length of a single data row
+		uint32_t _row_length;
+		// floats between the starts of consecutive rows in a page
+		uint32_t _row_stride;
+		// maximum number of rows we can store in a page
+		uint32_t _max_rows;
+		// next row to read when not shuffling
+		uint32_t _current_row;
+		// total number of rows in our shard of the IDX
+		uint32_t _total_rows;
+		// the shard of the IDX we read from, see SetShard
+		uint32_t _shard;
+		uint32_t _shard_count;
+		// index of the first row of our shard
+		uint32_t _first_row;
+		// total number of batches in our IDX
+		uint32_t _total_batches;
+
+		// flag determines if we are streaming from an IDX file
+		// or if all of our data is loaded
+		bool _streaming;
+		// pages are refilled when streaming or shuffling
+		bool _paging;
+		// number of rows in a mini batch
+		uint32_t _minibatch_size;
+		// batches per page
+		uint32_t _batches_per_page;
+		// the next minibatch handed out by Next
+		uint32_t _current_batch;
+		// Next swapped pages on the last call, the previous page goes back to the loader on this one
+		bool _release_page;
+
+		// shuffle state, owned by whichever thread is reading pages
+		bool _shuffle;
+		uint32_t _shuffle_seed;
+		uint32_t _shuffle_random[4];
+		uint32_t _epoch;
+		// rows per shuffle block, see SetShuffleBlockRows
+		uint32_t _shuffle_block_rows;
+		uint32_t _block_count;
+		// a random permutation of the blocks, redrawn every pass
+		uint32_t* _block_order;
+		uint32_t _next_block;
+		// the rows of the current block, and the order they are handed out in
+		float* _block_buffer;
+		uint32_t* _row_order;
+		uint32_t _block_rows;
+		uint32_t _block_position;
+	};
+}
\ No newline at end of file
@@ -39,4 +39,23 @@ namespace OMLT
 		};
 	}
 	typedef ErrorFunction::Enum ErrorFunction_t;
+
+	namespace Parallelism
+	{
+		// how the CPU trainers spread a training pass over their threads
+		enum Enum
+		{
+			Invalid = -1,
+			// each minibatch is split across every thread, one minibatch at a time
+			Synchronous,
+			// every thread trains on its own minibatches and updates the shared
+			// weights without any locking (Hogwild!)
+			Hogwild,
+			// the total number of modes
+			Count,
+		};
+	}
+	typedef Parallelism::Enum Parallelism_t;
+	extern const char* ParallelismNames[];
+	extern Parallelism_t ParseParallelism(const char* name);
 }
\ No newline at end of file
@@ -6,6 +6,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+// windows
+#ifndef NOMINMAX
+#	define NOMINMAX
+#endif
+#include <windows.h>
+#include <intrin.h>
+
 #pragma warning (disable : 4482)
 
 #pragma warning ( push )
@@ -30,6 +37,13 @@ namespace OMLT
 		Double = 0x0E
 	};
 
+	// how a mapped IDX file is going to be read; passed on to the OS as a caching hint
+	enum AccessPattern : uint8_t
+	{
+		SequentialAccess,
+		RandomAccess
+	};
+
 	inline const Endianness SystemEndianness()
 	{
 		union
@@ -56,10 +70,18 @@ namespace OMLT
 		// bookkeeping data
 		FILE* _idx_file;
 		bool _writing;
+		// true while the file position is at the end of the file, so appends don't need to seek
+		bool _at_end;
+		// stdio buffer for files we write to, so rows are written in large blocks
+		char* _write_buffer;
 		uint32_t _row_length;	// number of elements
 		int64_t _row_length_bytes;	// number of bytes in each row
 		void* _empty_row;
 
+		// read-only view of the whole file (see Map)
+		HANDLE _mapping;
+		const uint8_t* _mapped_file;
+
 		uint32_t HeaderSize() const
 		{
 			return (2 + 1 + 1 + 4 * _row_dimensions_count);
@@ -68,6 +90,7 @@ namespace OMLT
 		void WriteHeader()
 		{
 			rewind(_idx_file);
+			_at_end = false;
 
 			// write out the header
 			write<uint16_t>((uint16_t)_idx_endianness);
@@ -86,53 +109,360 @@ namespace OMLT
 			, _row_dimensions(NULL)
 			, _idx_file(NULL)
 			, _writing(false)
+			, _at_end(false)
+			, _write_buffer(NULL)
 			, _row_length(0)
 			, _row_length_bytes(0)
 			, _empty_row(NULL)
+			, _mapping(NULL)
+			, _mapped_file(NULL)
 		{ }
 
-	#pragma region Read/Write Methods
-		// binary reading methods
-		template <typename T>
-		T read()
+		void unmap()
 		{
-			T result;
-			if(sizeof(T) != 1 && _idx_endianness != SystemEndianness())
+			if(_mapped_file)
 			{
-				uint8_t* buffer = (uint8_t*)&result;
-				for(int i = sizeof(T) - 1; i >= 0; i--)
-					buffer[i] = fgetc(_idx_file);
+				UnmapViewOfFile(_mapped_file);
+				_mapped_file = NULL;
 			}
-			else
-				fread(&result, sizeof(T), 1, _idx_file);
 
-			return result;
+			if(_mapping)
+			{
+				CloseHandle(_mapping);
+				_mapping = NULL;
+			}
 		}
 
-		template<typename T>
-		T* read_row(T* row)
+		inline const uint8_t* mapped_row(uint32_t row) const
 		{
-			if(row)
+			return _mapped_file + HeaderSize() + size_t(row) * size_t(_row_length_bytes);
+		}
+
+		// size of the stdio buffer used when writing
+		static const size_t WriteBufferSize = 4 * 1024 * 1024;
+		// bytes moved per read/write when copying rows between files
+		static const size_t CopySize = 16 * 1024 * 1024;
+
+		// gives a file we're going to write to a large stdio buffer; must happen before any reads or writes
+		void set_write_buffer()
+		{
+			_write_buffer = (char*)malloc(WriteBufferSize);
+			if(_write_buffer != NULL && setvbuf(_idx_file, _write_buffer, _IOFBF, WriteBufferSize) != 0)
 			{
-				if(sizeof(T) != 1 && _idx_endianness != SystemEndianness())
+				free(_write_buffer);
+				_write_buffer = NULL;
+			}
+		}
+
+		bool seek_end()
+		{
+			if(!_at_end)
+			{
+				if(_fseeki64(_idx_file, 0, SEEK_END) != 0)
 				{
-					T val;
-					uint8_t* byte_buffer = (uint8_t*)&val;
-					for(uint32_t k = 0; k < _row_length; k++)
+					return false;
+				}
+				_at_end = true;
+			}
+			return true;
+		}
+
+		bool seek_row(uint32_t row)
+		{
+			_at_end = false;
+			return _fseeki64(_idx_file, int64_t(HeaderSize()) + int64_t(row) * _row_length_bytes, SEEK_SET) == 0;
+		}
+
+	#pragma region Bulk Conversion Methods
+		// number of values we swap/convert at a time through a stack buffer
+		static const size_t ChunkValues = 2048;
+
+		static bool has_ssse3()
+		{
+			static int ssse3 = -1;
+			if(ssse3 < 0)
+			{
+				int cpu_info[4];
+				__cpuid(cpu_info, 1);
+				ssse3 = (cpu_info[2] >> 9) & 1;
+			}
+			return ssse3 == 1;
+		}
+
+		// reverses the bytes of count values data_size bytes wide; src and dest may be the same buffer
+		static void swap_bytes(const void* src, void* dest, size_t count, size_t data_size)
+		{
+			assert(data_size == 2 || data_size == 4 || data_size == 8);
+
+			const uint8_t* in = (const uint8_t*)src;
+			uint8_t* out = (uint8_t*)dest;
+			size_t k = 0;
+
+			if(has_ssse3())
+			{
+				__m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+				if(data_size == 2)
+				{
+					mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+				}
+				else if(data_size == 4)
+				{
+					mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+				}
+
+				const size_t block_values = 16 / data_size;
+				for(; k + 2 * block_values <= count; k += 2 * block_values)
+				{
+					__m128i block0 = _mm_loadu_si128((const __m128i*)(in + k * data_size));
+					__m128i block1 = _mm_loadu_si128((const __m128i*)(in + k * data_size + 16));
+					_mm_storeu_si128((__m128i*)(out + k * data_size), _mm_shuffle_epi8(block0, mask));
+					_mm_storeu_si128((__m128i*)(out + k * data_size + 16), _mm_shuffle_epi8(block1, mask));
+				}
+			}
+
+			for(; k < count; k++)
+			{
+				const uint8_t* in_val = in + k * data_size;
+				uint8_t* out_val = out + k * data_size;
+				for(size_t i = 0; i < data_size / 2; i++)
+				{
+					const uint8_t lo = in_val[i];
+					const uint8_t hi = in_val[data_size - 1 - i];
+					out_val[i] = hi;
+					out_val[data_size - 1 - i] = lo;
+				}
+			}
+		}
+
+		// converts count values of the given format (already in system byte order) to floats
+		static void convert_to_single(const void* src, float* dest, size_t count, DataFormat format)
+		{
+			size_t k = 0;
+			switch(format)
+			{
+			case DataFormat::UInt8:
+				{
+					const uint8_t* in = (const uint8_t*)src;
+					const __m128i zero = _mm_setzero_si128();
+					for(; k + 16 <= count; k += 16)
+					{
+						__m128i bytes = _mm_loadu_si128((const __m128i*)(in + k));
+						__m128i lo = _mm_unpacklo_epi8(bytes, zero);
+						__m128i hi = _mm_unpackhi_epi8(bytes, zero);
+						_mm_storeu_ps(dest + k, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+						_mm_storeu_ps(dest + k + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+						_mm_storeu_ps(dest + k + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+						_mm_storeu_ps(dest + k + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+					}
+					for(; k < count; k++)
+					{
+						dest[k] = float(in[k]);
+					}
+				}
+				break;
+			case DataFormat::SInt8:
+				{
+					// sign extend by unpacking each value into the high byte/word and shifting back down
+					const int8_t* in = (const int8_t*)src;
+					for(; k + 16 <= count; k += 16)
+					{
+						__m128i bytes = _mm_loadu_si128((const __m128i*)(in + k));
+						__m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+						__m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+						_mm_storeu_ps(dest + k, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)));
+						_mm_storeu_ps(dest + k + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)));
+						_mm_storeu_ps(dest + k + 8, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)));
+						_mm_storeu_ps(dest + k + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)));
+					}
+					for(; k < count; k++)
+					{
+						dest[k] = float(in[k]);
+					}
+				}
+				break;
+			case DataFormat::SInt16:
+				{
+					const int16_t* in = (const int16_t*)src;
+					for(; k + 8 <= count; k += 8)
+					{
+						__m128i words = _mm_loadu_si128((const __m128i*)(in + k));
+						_mm_storeu_ps(dest + k, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16)));
+						_mm_storeu_ps(dest + k + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16)));
+					}
+					for(; k < count; k++)
+					{
+						dest[k] = float(in[k]);
+					}
+				}
+				break;
+			case DataFormat::SInt32:
+				{
+					const int32_t* in = (const int32_t*)src;
+					for(; k + 8 <= count; k += 8)
+					{
+						_mm_storeu_ps(dest + k, _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in + k))));
+						_mm_storeu_ps(dest + k + 4, _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in + k + 4))));
+					}
+					for(; k < count; k++)
+					{
+						dest[k] = float(in[k]);
+					}
+				}
+				break;
+			case DataFormat::Single:
+				memcpy(dest, src, count * sizeof(float));
+				break;
+			case DataFormat::Double:
+				{
+					const double* in = (const double*)src;
+					for(; k + 4 <= count; k += 4)
+					{
+						__m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in + k));
+						__m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in + k + 2));
+						_mm_storeu_ps(dest + k, _mm_movelh_ps(lo, hi));
+					}
+					for(; k < count; k++)
 					{
-						for(int i = sizeof(T) - 1; i >= 0; i--)
-							byte_buffer[i] = fgetc(_idx_file);
-						row[k] = val;
+						dest[k] = float(in[k]);
 					}
 				}
+				break;
+			}
+		}
+
+		template<typename T>
+		static void widen_to_double(const void* src, double* dest, size_t count)
+		{
+			const T* in = (const T*)src;
+			for(size_t k = 0; k < count; k++)
+			{
+				dest[k] = double(in[k]);
+			}
+		}
+
+		// converts count values of the given format (already in system byte order) to doubles
+		static void convert_to_double(const void* src, double* dest, size_t count, DataFormat format)
+		{
+			switch(format)
+			{
+			case DataFormat::UInt8:
+				widen_to_double<uint8_t>(src, dest, count);
+				break;
+			case DataFormat::SInt8:
+				widen_to_double<int8_t>(src, dest, count);
+				break;
+			case DataFormat::SInt16:
+				widen_to_double<int16_t>(src, dest, count);
+				break;
+			case DataFormat::SInt32:
+				widen_to_double<int32_t>(src, dest, count);
+				break;
+			case DataFormat::Single:
+				widen_to_double<float>(src, dest, count);
+				break;
+			case DataFormat::Double:
+				memcpy(dest, src, count * sizeof(double));
+				break;
+			}
+		}
+
+		// writes count rows from buffer at the current file position, swapping to the file's byte order
+		bool write_rows(const void* buffer, uint32_t count)
+		{
+			const size_t data_size = GetDataSize();
+			const size_t values = size_t(count) * _row_length;
+			if(data_size == 1 || _idx_endianness == SystemEndianness())
+			{
+				return fwrite(buffer, data_size, values, _idx_file) == values;
+			}
+
+			uint8_t staging[ChunkValues * sizeof(double)];
+			const uint8_t* src = (const uint8_t*)buffer;
+			for(size_t k = 0; k < values; k += ChunkValues)
+			{
+				const size_t chunk = values - k < ChunkValues ? values - k : ChunkValues;
+				swap_bytes(src + k * data_size, staging, chunk, data_size);
+				if(fwrite(staging, data_size, chunk, _idx_file) != chunk)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// reads count rows starting at row first into buffer, converting every value to dest_format
+		// (Single or Double) and to system byte order on the way
+		bool read_rows_as(uint32_t first, uint32_t count, void* buffer, DataFormat dest_format)
+		{
+			if(first > GetRowCount() || count > GetRowCount() - first)
+			{
+				return false;
+			}
+
+			const size_t data_size = GetDataSize();
+			const bool swap = data_size != 1 && _idx_endianness != SystemEndianness();
+			if(_data_format == dest_format && !swap)
+			{
+				return ReadRows(first, count, buffer);
+			}
+
+			if(_mapped_file == NULL && !seek_row(first))
+			{
+				return false;
+			}
+
+			// go through a small buffer so the swap and the conversion both happen in cache
+			uint8_t staging[ChunkValues * sizeof(double)];
+			const size_t values = size_t(count) * _row_length;
+			for(size_t k = 0; k < values; k += ChunkValues)
+			{
+				const size_t chunk = values - k < ChunkValues ? values - k : ChunkValues;
+
+				const uint8_t* src = staging;
+				if(_mapped_file)
+				{
+					src = mapped_row(first) + k * data_size;
+				}
+				else if(fread(staging, data_size, chunk, _idx_file) != chunk)
+				{
+					return false;
+				}
+
+				if(swap)
+				{
+					swap_bytes(src, staging, chunk, data_size);
+					src = staging;
+				}
+
+				if(dest_format == DataFormat::Single)
+				{
+					convert_to_single(src, (float*)buffer + k, chunk, _data_format);
+				}
 				else
 				{
-					uint32_t bytes_read = fread(row, sizeof(T), _row_length, _idx_file);
-					assert(bytes_read == _row_length);
+					convert_to_double(src, (double*)buffer + k, chunk, _data_format);
 				}
 			}
+			return true;
+		}
+	#pragma endregion
+
+	#pragma region Read/Write Methods
+		// binary reading methods
+		template <typename T>
+		T read()
+		{
+			T result;
+			if(sizeof(T) != 1 && _idx_endianness != SystemEndianness())
+			{
+				uint8_t* buffer = (uint8_t*)&result;
+				for(int i = sizeof(T) - 1; i >= 0; i--)
+					buffer[i] = fgetc(_idx_file);
+			}
+			else
+				fread(&result, sizeof(T), 1, _idx_file);
 
-			return row;
+			return result;
 		}
 
 		// binary writing methods
@@ -152,41 +482,25 @@ namespace OMLT
 				fwrite(&t, sizeof(t), 1, _idx_file);
 			}
 		}
-
-		template<typename T>
-		void write_row(T* row)
-		{
-			if(row)
-			{
-				if(sizeof(T) != 1 && _idx_endianness != SystemEndianness())
-				{
-					uint8_t* byte_buffer = (uint8_t*)row;
-					for(uint32_t k = 0; k < _row_length; k++)
-					{
-						for(int i = sizeof(T) - 1; i >= 0; i--)
-						{
-							fputc(byte_buffer[i], _idx_file);
-						}
-						byte_buffer += sizeof(T);
-					}
-				}
-				else
-				{
-					fwrite(row, sizeof(T), _row_length, _idx_file);
-				}
-			}
-		}
 	#pragma endregion
 
 	public:
 		~IDX()
 		{
+			unmap();
+
 			if(_idx_file)
 			{
 				fclose(_idx_file);
 				_idx_file = NULL;
 			}
 
+			if(_write_buffer)
+			{
+				free(_write_buffer);
+				_write_buffer = NULL;
+			}
+
 			if(_empty_row)
 			{
 				free(_empty_row);
@@ -215,6 +529,10 @@ namespace OMLT
 
 			// set the file ptr
 			idx._idx_file = file;	
+			if(in_writing)
+			{
+				idx.set_write_buffer();
+			}
 
 			// Parse IDX header
 
@@ -288,6 +606,7 @@ namespace OMLT
 
 			// figure out the size of the file, make sure it's as big as the header says it should be
 			_fseeki64(idx._idx_file, 0, SEEK_END);
+			idx._at_end = true;
 			int64_t sz = _ftelli64(idx._idx_file);
 			if(sz != int64_t(idx.GetRowCount()) * idx.GetRowLengthBytes() + int64_t(idx.HeaderSize()))
 			{
@@ -306,6 +625,43 @@ namespace OMLT
 			return result;	
 		}
 
+		// opens an existing IDX file read-only and maps it into memory, so rows can be read
+		// in place with RowPtr/RowRange; returns NULL if the file can't be parsed.  If the
+		// file can't be mapped (ie: it doesn't fit in the address space) the IDX falls back
+		// to reading through the file like Load and RowPtr/RowRange return NULL
+		static IDX* Map(const char* in_filename, AccessPattern in_pattern = SequentialAccess)
+		{
+			IDX* result = Load(in_filename, false);
+			if(result == NULL)
+			{
+				return NULL;
+			}
+
+			// there is no madvise, so the hint goes to the cache manager when we open the file
+			HANDLE file = CreateFileA(in_filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 
+				in_pattern == RandomAccess ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if(file == INVALID_HANDLE_VALUE)
+			{
+				return result;
+			}
+
+			// the mapping holds its own reference to the file
+			result->_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			CloseHandle(file);
+			if(result->_mapping == NULL)
+			{
+				return result;
+			}
+
+			result->_mapped_file = (const uint8_t*)MapViewOfFile(result->_mapping, FILE_MAP_READ, 0, 0, 0);
+			if(result->_mapped_file == NULL)
+			{
+				result->unmap();
+			}
+
+			return result;
+		}
+
 		static IDX* Create(const char* in_filename, Endianness in_endianness, DataFormat in_format, uint32_t row_length)
 		{
 			return Create(in_filename, in_endianness, in_format, &row_length, 1);
@@ -325,6 +681,7 @@ namespace OMLT
 			IDX& idx = *result;
 
 			idx._idx_file = file;		
+			idx.set_write_buffer();
 			idx._idx_endianness = in_endianness;
 			// verify we got a valid Endianness val
 			switch(idx._idx_endianness)
@@ -394,6 +751,7 @@ namespace OMLT
 
 			// write the header
 			idx.WriteHeader();
+			idx._at_end = true;
 
 			// finally allocate temp buffer for writing empty rows
 			idx._writing = true;
@@ -422,7 +780,7 @@ namespace OMLT
 			}
 
 			// move to end of file
-			if(_fseeki64(_idx_file, 0, SEEK_END) != 0)
+			if(!seek_end())
 			{
 				return false;
 			}
@@ -433,8 +791,6 @@ namespace OMLT
 				fwrite(_empty_row, _row_length_bytes, 1, _idx_file);
 			}
 
-			// flush stream
-			fflush(_idx_file);
 			// increment number of rows
 			_row_dimensions[0] += count;
 			return true;
@@ -455,34 +811,17 @@ namespace OMLT
 			}
 
 			// move to end of file
-			if(_fseeki64(_idx_file, 0, SEEK_END) != 0)
+			if(!seek_end())
 			{
 				// could not seek
 				return false;
 			}
 
 			// append the data
-			switch(_data_format)
+			if(!write_rows(buffer, 1))
 			{
-			case DataFormat::UInt8:
-			case DataFormat::SInt8:
-				fwrite(buffer, 1, _row_length, _idx_file);
-				break;
-			case DataFormat::SInt16:
-				write_row<int16_t>((int16_t*)buffer);
-				break;
-			case DataFormat::SInt32:
-				write_row<int32_t>((int32_t*)buffer);
-				break;
-			case DataFormat::Single:
-				write_row<float>((float*)buffer);
-				break;
-			case DataFormat::Double:
-				write_row<double>((double*)buffer);
-				break;
+				return false;
 			}
-			// flush the stream
-			fflush(_idx_file);
 			// increment number of rows
 			_row_dimensions[0] += 1;
 			return true;
@@ -503,74 +842,258 @@ namespace OMLT
 			}
 
 
-			if(_fseeki64(_idx_file, int64_t(HeaderSize()) + int64_t(row) * _row_length_bytes, SEEK_SET) != 0)
+			if(!seek_row(row))
 			{
 				// failed to seek to proper position
 				return false;
 			}
 		
 			// write to buffer
-			switch(_data_format)
+			if(!write_rows(buffer, 1))
 			{
-			case DataFormat::UInt8:
-			case DataFormat::SInt8:
-				fwrite(buffer, 1, _row_length, _idx_file);
-				break;
-			case DataFormat::SInt16:
-				write_row<int16_t>((int16_t*)buffer);
-				break;
-			case DataFormat::SInt32:
-				write_row<int32_t>((int32_t*)buffer);
-				break;
-			case DataFormat::Single:
-				write_row<float>((float*)buffer);
-				break;
-			case DataFormat::Double:
-				write_row<double>((double*)buffer);
-				break;
+				return false;
 			}
-			// flush the stream
-			fflush(_idx_file);
 			return true;
 		}
 
-		// read a given row to the passed in buffer
+		// read a given row to the passed in buffer; foreign byte order rows are read with a
+		// single fread and swapped in place
 		bool ReadRow(uint32_t row, void* buffer)
 		{
-			if(row >= GetRowCount())
+			return ReadRows(row, 1, buffer);
+		}
+
+		// appends count rows (in the file's data format and system byte order) from buffer
+		bool AddRows(const void* buffer, uint32_t count)
+		{
+			if(!_writing)
 			{
 				return false;
 			}
 
-			if(_fseeki64(_idx_file, int64_t(HeaderSize()) + int64_t(row) * _row_length_bytes, SEEK_SET) != 0)
+			// overflow
+			if(GetRowCount() + count < GetRowCount())
 			{
-				// this really shouldn't happen if row is a valid row...
 				return false;
 			}
 
-			switch(_data_format)
+			// move to end of file
+			if(!seek_end())
 			{
-			case DataFormat::UInt8:
-			case DataFormat::SInt8:
-				fread(buffer, 1, _row_length, _idx_file);
-				break;
-			case DataFormat::SInt16:
-				read_row<int16_t>((int16_t*)buffer);
-				break;
-			case DataFormat::SInt32:
-				read_row<int32_t>((int32_t*)buffer);
-				break;
-			case DataFormat::Single:
-				read_row<float>((float*)buffer);
-				break;
-			case DataFormat::Double:
-				read_row<double>((double*)buffer);
-				break;
+				return false;
+			}
+
+			if(!write_rows(buffer, count))
+			{
+				return false;
+			}
+
+			// increment number of rows
+			_row_dimensions[0] += count;
+			return true;
+		}
+
+		// overwrites count rows starting at row first with the rows in buffer
+		bool WriteRows(uint32_t first, uint32_t count, const void* buffer)
+		{
+			if(!_writing)
+			{
+				return false;
+			}
+
+			if(first > GetRowCount() || count > GetRowCount() - first)
+			{
+				return false;
+			}
+
+			if(!seek_row(first))
+			{
+				return false;
+			}
+
+			if(!write_rows(buffer, count))
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		// appends count rows starting at row first of source, which must have the same data format,
+		// row length and endianness as this file; the raw bytes are copied without any conversion,
+		// straight from the mapping if source is mapped
+		bool AppendRowsFrom(IDX* source, uint32_t first, uint32_t count)
+		{
+			if(!_writing || source == NULL)
+			{
+				return false;
+			}
+
+			if(source->_data_format != _data_format || source->_row_length != _row_length ||
+			   (GetDataSize() != 1 && source->_idx_endianness != _idx_endianness))
+			{
+				return false;
+			}
+
+			if(first > source->GetRowCount() || count > source->GetRowCount() - first)
+			{
+				return false;
+			}
+
+			// overflow
+			if(GetRowCount() + count < GetRowCount())
+			{
+				return false;
+			}
+
+			if(!seek_end())
+			{
+				return false;
 			}
 
+			// large writes go around the stdio buffer
+			const uint64_t bytes = uint64_t(count) * uint64_t(_row_length_bytes);
+			if(source->_mapped_file)
+			{
+				const uint8_t* src = source->mapped_row(first);
+				for(uint64_t k = 0; k < bytes; k += CopySize)
+				{
+					const size_t chunk = size_t(bytes - k < CopySize ? bytes - k : CopySize);
+					if(fwrite(src + k, 1, chunk, _idx_file) != chunk)
+					{
+						return false;
+					}
+				}
+			}
+			else
+			{
+				if(!source->seek_row(first))
+				{
+					return false;
+				}
+
+				void* buffer = malloc(CopySize);
+				if(buffer == NULL)
+				{
+					return false;
+				}
+
+				bool success = true;
+				for(uint64_t k = 0; k < bytes && success; k += CopySize)
+				{
+					const size_t chunk = size_t(bytes - k < CopySize ? bytes - k : CopySize);
+					success = fread(buffer, 1, chunk, source->_idx_file) == chunk && fwrite(buffer, 1, chunk, _idx_file) == chunk;
+				}
+				free(buffer);
+
+				if(!success)
+				{
+					return false;
+				}
+			}
+
+			// increment number of rows
+			_row_dimensions[0] += count;
 			return true;
 		}
 
+		// reads count rows starting at row first into buffer, in the file's data format
+		bool ReadRows(uint32_t first, uint32_t count, void* buffer)
+		{
+			if(first > GetRowCount() || count > GetRowCount() - first)
+			{
+				return false;
+			}
+
+			const size_t data_size = GetDataSize();
+			const bool swap = data_size != 1 && _idx_endianness != SystemEndianness();
+			const size_t values = size_t(count) * _row_length;
+
+			if(_mapped_file)
+			{
+				if(swap)
+				{
+					swap_bytes(mapped_row(first), buffer, values, data_size);
+				}
+				else
+				{
+					memcpy(buffer, mapped_row(first), values * data_size);
+				}
+				return true;
+			}
+
+			if(!seek_row(first))
+			{
+				return false;
+			}
+
+			if(fread(buffer, data_size, values, _idx_file) != values)
+			{
+				return false;
+			}
+
+			if(swap)
+			{
+				swap_bytes(buffer, buffer, values, data_size);
+			}
+			return true;
+		}
+
+		// reads count rows starting at row first into buffer, converting every value to float
+		// (and to system byte order) on the way
+		bool ReadRowsAsSingle(uint32_t first, uint32_t count, float* buffer)
+		{
+			return read_rows_as(first, count, buffer, DataFormat::Single);
+		}
+
+		// same as ReadRowsAsSingle, but converts to double
+		bool ReadRowsAsDouble(uint32_t first, uint32_t count, double* buffer)
+		{
+			return read_rows_as(first, count, buffer, DataFormat::Double);
+		}
+
+		// pointer to the given row of a mapped file; NULL if the file isn't mapped, the row is
+		// out of range or the file's endianness doesn't match the system's.  T must match the data
+		// format; rows start right after the header so they are only 4 byte aligned
+		template<typename T>
+		const T* RowPtr(uint32_t row) const
+		{
+			return RowRange<T>(row, 1);
+		}
+
+		// pointer to count consecutive rows (row major, GetRowLength() values each) starting at
+		// row begin; same restrictions as RowPtr
+		template<typename T>
+		const T* RowRange(uint32_t begin, uint32_t count) const
+		{
+			assert(sizeof(T) == GetDataSize());
+			if(_mapped_file == NULL || (sizeof(T) != 1 && _idx_endianness != SystemEndianness()))
+			{
+				return NULL;
+			}
+
+			if(begin > GetRowCount() || count > GetRowCount() - begin)
+			{
+				return NULL;
+			}
+
+			return (const T*)mapped_row(begin);
+		}
+
+		inline bool IsMapped() const {return _mapped_file != NULL;}
+
+		// writes the header with the current row count and flushes everything written so far to disk
+		bool Flush()
+		{
+			if(!_writing)
+			{
+				return false;
+			}
+
+			WriteHeader();
+			return fflush(_idx_file) == 0;
+		}
+
 		// writes the header and closes the underlying file
 		bool Close()
 		{
@@ -582,11 +1105,19 @@ namespace OMLT
 			}
 
 
+			unmap();
+
 			// close
 			fclose(_idx_file);
 
 			_idx_file = NULL;
 
+			if(_write_buffer)
+			{
+				free(_write_buffer);
+				_write_buffer = NULL;
+			}
+
 			return true;
 		}
 
@@ -0,0 +1,24 @@
+#pragma once
+
+// std
+#include <stdint.h>
+
+namespace cppJSONStream
+{
+	class Reader;
+}
+
+namespace OMLT
+{
+	// Fast loading of the number arrays in JSON models.  The reader only finds where each array
+	// ends, and the text is then parsed with a float parser that skips the per character stream
+	// reads of cppJSONStream::Reader; large weight matrices are parsed a run of rows per thread.
+	namespace JSONModel
+	{
+		// call after the array's BeginArray token: reads an array of exactly in_count numbers
+		bool ReadFloatArray(cppJSONStream::Reader& r, float* out_values, uint32_t in_count);
+		// call after the outer array's BeginArray token: reads an array of exactly in_rows arrays of
+		// in_columns numbers each, with row j going to out_rows + j * in_stride
+		bool ReadFloatRows(cppJSONStream::Reader& r, float* out_rows, uint32_t in_rows, uint32_t in_columns, uint32_t in_stride);
+	}
+}
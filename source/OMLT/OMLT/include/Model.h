@@ -34,5 +34,8 @@ namespace OMLT
 		Model() : type(ModelType::NotSet), ptr(nullptr) {}
 
 		static bool FromJSON(std::istream& in_stream, Model& out_model);
+		// loads a model saved with either ToJSON or ToBinary; binary models are mapped into memory
+		// rather than read (see BinaryModel.h)
+		static bool FromFile(const char* in_filename, Model& out_model);
 	};
 }
\ No newline at end of file
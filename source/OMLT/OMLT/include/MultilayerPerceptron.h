@@ -11,6 +11,11 @@
 struct cJSON;
 namespace OMLT
 {
+	namespace BinaryModel
+	{
+		class Reader;
+	}
+
 	class MultilayerPerceptron
 	{
 	public:
@@ -19,6 +24,9 @@ namespace OMLT
 		void FeedForward(float* input_vector, float* output_vector) const;
 		// feedforward to the given layer
 		void FeedForward(float* input_vector, float* output_vector, uint32_t layer) const;
+		// the same for a matrix of rows; see FeatureMap::CalcFeatureMatrix for the layout
+		void FeedForwardMatrix(const float* input_matrix, float* output_matrix, uint32_t rows) const;
+		void FeedForwardMatrix(const float* input_matrix, float* output_matrix, uint32_t rows, uint32_t layer) const;
 
 		struct Layer
 		{
@@ -27,7 +35,7 @@ namespace OMLT
 			ActivationFunction_t function;
 			FeatureMap weights;
 
-			Layer(uint32_t in_inputs, uint32_t in_outputs, ActivationFunction_t in_function);
+			Layer(uint32_t in_inputs, uint32_t in_outputs, ActivationFunction_t in_function, const MappedFeatureMap* in_weights = nullptr);
 		};
 
 		Layer* GetLayer(uint32_t index);
@@ -41,10 +49,15 @@ namespace OMLT
 		void ToJSON(std::ostream& stream) const;
 
 		static MultilayerPerceptron* FromJSON(std::istream& stream);
+		// see BinaryModel.h; load with Model::FromFile
+		void ToBinary(std::ostream& stream) const;
 	private: 
+		static MultilayerPerceptron* FromBinary(BinaryModel::Reader& in_reader);
+
 		std::vector<Layer*> _layers;
 		// properly aligned scratch buffers
 		mutable std::vector<float*> _activations;
+		friend struct Model;
 		friend class BackPropagation;
 	};
 	typedef MultilayerPerceptron MLP;
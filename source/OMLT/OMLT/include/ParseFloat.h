@@ -0,0 +1,123 @@
+#pragma once
+
+// std
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+namespace OMLT
+{
+	// Parses the number [+-]?[0-9]*(.[0-9]*)?([eE][+-]?[0-9]+)? (with at least one digit, no
+	// infinity/nan/etc) starting at io_head and ending no later than in_end, and advances io_head
+	// past it.  The result is correctly rounded: numbers with at most 19 significant digits whose
+	// mantissa and power of ten are exact as doubles (nearly all of the numbers we read) take a
+	// single multiply or divide, anything else (or a result that lands on a tie between two
+	// floats) goes through strtof.
+	inline bool ParseFloat(const char*& io_head, const char* in_end, float& out_value)
+	{
+		static const double PowersOfTen[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+		};
+
+		const char* head = io_head;
+		const bool negative = head < in_end && *head == '-';
+		if(head < in_end && (*head == '-' || *head == '+'))
+		{
+			head++;
+		}
+
+		uint64_t mantissa = 0;
+		uint32_t mantissa_digits = 0;
+		uint32_t digits = 0;
+		int32_t exponent = 0;
+		bool exact = true;
+
+		for(; head < in_end && *head >= '0' && *head <= '9'; head++, digits++)
+		{
+			if(mantissa_digits < 19)
+			{
+				mantissa = mantissa * 10 + uint64_t(*head - '0');
+				mantissa_digits += mantissa > 0 ? 1 : 0;
+			}
+			else
+			{
+				exact = false;
+			}
+		}
+		if(head < in_end && *head == '.')
+		{
+			for(head++; head < in_end && *head >= '0' && *head <= '9'; head++, digits++)
+			{
+				if(mantissa_digits < 19)
+				{
+					mantissa = mantissa * 10 + uint64_t(*head - '0');
+					mantissa_digits += mantissa > 0 ? 1 : 0;
+					exponent--;
+				}
+				else
+				{
+					exact = false;
+				}
+			}
+		}
+		if(digits == 0)
+		{
+			return false;
+		}
+
+		if(head < in_end && (*head == 'e' || *head == 'E'))
+		{
+			head++;
+			const bool negative_exponent = head < in_end && *head == '-';
+			if(head < in_end && (*head == '-' || *head == '+'))
+			{
+				head++;
+			}
+			if(head == in_end || *head < '0' || *head > '9')
+			{
+				return false;
+			}
+
+			int32_t e = 0;
+			for(; head < in_end && *head >= '0' && *head <= '9'; head++)
+			{
+				if(e < 100000)
+				{
+					e = e * 10 + int32_t(*head - '0');
+				}
+			}
+			exponent += negative_exponent ? -e : e;
+		}
+
+		if(exact && mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+		{
+			double value = exponent < 0 ? double(mantissa) / PowersOfTen[-exponent] : double(mantissa) * PowersOfTen[exponent];
+
+			// value is the correctly rounded double and lies well inside the range of normal floats,
+			// so rounding it again to float can only go wrong if it is exactly halfway between two floats
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			if((bits & 0x1FFFFFFF) != 0x10000000)
+			{
+				out_value = float(negative ? -value : value);
+				io_head = head;
+				return true;
+			}
+		}
+
+		// strtof needs a terminated copy
+		const std::string text(io_head, head);
+		char* end;
+		out_value = strtof(text.c_str(), &end);
+		if(end != text.c_str() + text.size())
+		{
+			return false;
+		}
+
+		io_head = head;
+		return true;
+	}
+}
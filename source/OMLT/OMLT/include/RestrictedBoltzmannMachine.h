@@ -11,11 +11,19 @@
 struct cJSON;
 namespace OMLT
 {
+	namespace BinaryModel
+	{
+		class Reader;
+	}
+
 	class RestrictedBoltzmannMachine
 	{
 	public:
 		void CalcHidden(const float* in_visible, float* out_hidden) const;
 		void CalcVisible(const float* in_hidden, float* out_visible) const;
+		// the same for a matrix of rows; see FeatureMap::CalcFeatureMatrix for the layout
+		void CalcHiddenMatrix(const float* in_visible, float* out_hidden, uint32_t rows) const;
+		void CalcVisibleMatrix(const float* in_hidden, float* out_visible, uint32_t rows) const;
 
 		// assumption that both the visible and hidden types are sigmoid
 		float CalcFreeEnergy(const float* in_visible) const;
@@ -23,6 +31,8 @@ namespace OMLT
 		void ToJSON(std::ostream& stream) const;
 
 		static RestrictedBoltzmannMachine* FromJSON(std::istream& stream);
+		// see BinaryModel.h; load with Model::FromFile
+		void ToBinary(std::ostream& stream) const;
 
 		const uint32_t visible_count;
 		const uint32_t hidden_count;
@@ -35,9 +45,13 @@ namespace OMLT
 		// used to calculate visible feature vector
 		FeatureMap visible;
 	private:
-		RestrictedBoltzmannMachine(uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_visible_type, ActivationFunction_t in_hidden_type);
+		RestrictedBoltzmannMachine(uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_visible_type, ActivationFunction_t in_hidden_type, const MappedFeatureMap* in_hidden = nullptr, const MappedFeatureMap* in_visible = nullptr);
+
+		static RestrictedBoltzmannMachine* FromBinary(BinaryModel::Reader& in_reader);
 
+		friend struct Model;
 		friend class ContrastiveDivergence;
+		friend class ContrastiveDivergenceCPU;
 	};
 	typedef RestrictedBoltzmannMachine RBM;
 }
\ No newline at end of file
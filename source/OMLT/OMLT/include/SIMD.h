@@ -0,0 +1,73 @@
+#pragma once
+
+// std
+#include <stdint.h>
+
+// windows
+#include <intrin.h>
+
+// OMLT
+#include "Enums.h"
+
+/*
+ * The inner loops of inference (dot products and activation functions) are
+ * built once per instruction set, each in its own translation unit compiled
+ * for that instruction set:
+ *
+ *   SSE     Common.cpp
+ *   AVX2    CommonAVX2.cpp (/arch:AVX2, also uses FMA)
+ *   AVX512  CommonAVX512.cpp (/arch:AVX512)
+ *
+ * The widest set supported by both the CPU and the OS is picked on first use.
+ * All vectors are padded to 4 float blocks (see BlockCount) and 16 byte aligned,
+ * so the wider kernels use unaligned or masked loads.
+ *
+ * The SiCKL CPU interpreter follows the same level, running 4, 8 or 16 grid
+ * points per instruction (see SiCKL::CPURuntime::SetLaneCount).
+ */
+
+namespace OMLT
+{
+	namespace SIMDLevel
+	{
+		enum Enum
+		{
+			Invalid = -1,
+			SSE,
+			AVX2,
+			AVX512,
+			Count,
+		};
+	}
+	typedef SIMDLevel::Enum SIMDLevel_t;
+	extern const char* SIMDLevelNames[];
+
+	struct SIMDKernels
+	{
+		// out_accumulations[k] = dot(input, feature k) for all 4 * feature_blocks features, which start
+		// feature_stride floats apart (see FeatureMap)
+		void (*CalcDotProducts)(const float* input, const float* features, uint32_t feature_stride, uint32_t feature_blocks, uint32_t input_blocks, float* out_accumulations);
+		// dot products of 2 inputs with 4 consecutive features; each result holds the 4 features' sums for its input
+		void (*CalcDotProducts2x4)(const float* input0, const float* input1, const float* features, uint32_t feature_stride, uint32_t input_blocks, __m128& out_dp0, __m128& out_dp1);
+		// activations = function(accumulations + biases) for Linear, RectifiedLinear and Sigmoid
+		void (*CalcActivation)(const float* accumulations, const float* biases, uint32_t blocks, float* activations, ActivationFunction_t function);
+		// replaces the first count values in vector with their softmax
+		void (*CalcSoftmax)(float* vector, uint32_t count, uint32_t blocks);
+		// sum of ln(1 + e^x) over the vector
+		float (*SumLn1PlusEx)(const float* vector, uint32_t blocks);
+	};
+
+	extern const SIMDKernels SSEKernels;
+	extern const SIMDKernels AVX2Kernels;
+	extern const SIMDKernels AVX512Kernels;
+
+	// widest instruction set this machine supports
+	SIMDLevel_t GetSupportedSIMDLevel();
+	// instruction set the kernels are currently using
+	SIMDLevel_t GetSIMDLevel();
+	// use a narrower instruction set (for testing); fails if the machine doesn't support it.
+	// Also sets the SiCKL CPU interpreter's lane count
+	bool SetSIMDLevel(SIMDLevel_t in_level);
+
+	const SIMDKernels& GetSIMDKernels();
+}
\ No newline at end of file
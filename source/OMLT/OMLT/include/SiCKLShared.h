@@ -5,9 +5,36 @@
 using namespace SiCKL;
 
 #include "Common.h"
+#include "SIMD.h"
 
 namespace OMLT
 {
+	// the SiCKL backend the trainers run their kernels on; define OMLT_SICKL_CPU to use the
+	// CPU interpreter (and any generated kernels built in) instead of OpenGL, which needs no
+	// GL context
+#ifdef OMLT_SICKL_CPU
+	// the interpreter's lane count follows the SIMD level, so the level is picked before
+	// any program runs
+	struct SiCKLRuntime : public SiCKL::CPURuntime
+	{
+		static bool Initialize(uint32_t thread_count = 0)
+		{
+			GetSIMDLevel();
+			return SiCKL::CPURuntime::Initialize(thread_count);
+		}
+	};
+	typedef SiCKL::CPUCompiler SiCKLCompiler;
+	typedef SiCKL::CPUProgram SiCKLProgram;
+	typedef SiCKL::CPUBuffer1D SiCKLBuffer1D;
+	typedef SiCKL::CPUBuffer2D SiCKLBuffer2D;
+#else
+	typedef SiCKL::OpenGLRuntime SiCKLRuntime;
+	typedef SiCKL::OpenGLCompiler SiCKLCompiler;
+	typedef SiCKL::OpenGLProgram SiCKLProgram;
+	typedef SiCKL::OpenGLBuffer1D SiCKLBuffer1D;
+	typedef SiCKL::OpenGLBuffer2D SiCKLBuffer2D;
+#endif
+
 	extern void NextSeed(const SiCKL::UInt4& in_seed, SiCKL::UInt4& out_seed);
 	extern void NextFloat(const SiCKL::UInt4& in_seed, SiCKL::UInt4& out_seed, SiCKL::Float& out_float);
 	extern void NextGaussian(const SiCKL::UInt4& in_seed, SiCKL::UInt4& out_seed, SiCKL::Float& out_gaussian);
@@ -20,15 +47,22 @@ namespace OMLT
 	// this functiont takes in the result of CalcActivation, not the accumulation
 	extern SiCKL::Float CalcActivationPrime(ActivationFunction_t in_func, const SiCKL::Float& in_activation);
 
+	// copy a weight matrix followed by its deltas out of GPU memory into out_parameters,
+	// returns the number of floats written
+	extern uint32_t GetWeightParameters(const SiCKLBuffer2D& in_weights, const SiCKLBuffer2D& in_delta_weights, float* out_parameters);
+	// upload a weight matrix and its deltas laid out as above, and recalculate the nesterov weights
+	// the next minibatch trains with; returns the number of floats read
+	extern uint32_t SetWeightParameters(const float* in_parameters, float in_momentum, SiCKLBuffer2D& inout_weights, SiCKLBuffer2D& inout_delta_weights, SiCKLBuffer2D& inout_nesterov_weight);
+
 	class ErrorCalculator
 	{
 	public:
 		ErrorCalculator(uint32_t minibatch_size, uint32_t data_width, ErrorFunction_t error_function);
 		~ErrorCalculator();
-		float CalcError(const OpenGLBuffer2D& calculated, const OpenGLBuffer2D& expected);
+		float CalcError(const SiCKLBuffer2D& calculated, const SiCKLBuffer2D& expected);
 	private:
-		OpenGLProgram* _calc_error;
-		OpenGLBuffer2D _error_texture;
+		SiCKLProgram* _calc_error;
+		SiCKLBuffer2D _error_texture;
 		AlignedMemoryBlock<float> _error_buffer;
 	};;
 }
\ No newline at end of file
@@ -68,6 +68,18 @@ namespace OMLT
 			return true;
 		}
 
+		// every set of training parameters, in order
+		uint32_t GetTrainingConfigCount() const
+		{
+			return uint32_t(train_config.size());
+		}
+
+		const struct T::TrainingConfig& GetTrainingConfig(uint32_t in_index) const
+		{
+			assert(in_index < train_config.size());
+			return train_config[in_index].first;
+		}
+
 		struct T::ModelConfig GetModelConfig() const
 		{
 			return model_config;
@@ -2,6 +2,8 @@
 #include <string.h>
 
 // c++
+#include <sstream>
+#include <limits>
 #include <memory>
 using std::auto_ptr;
 
@@ -13,16 +15,18 @@ using namespace cppJSONStream;
 // OMLT
 #include "AutoEncoder.h"
 #include "Common.h"
+#include "BinaryModel.h"
+#include "JSONModel.h"
 
 namespace OMLT
 {
-	AutoEncoder::AutoEncoder( uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_hidden_type, ActivationFunction_t in_output_type )
+	AutoEncoder::AutoEncoder( uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_hidden_type, ActivationFunction_t in_output_type, const MappedFeatureMap* in_encoder, const MappedFeatureMap* in_decoder )
 		: visible_count(in_visible_count),
 		  hidden_count(in_hidden_count),
 		  hidden_type(in_hidden_type),
 		  output_type(in_output_type),
-		  encoder(visible_count, hidden_count),
-		  decoder(hidden_count, visible_count)
+		  encoder(visible_count, hidden_count, in_encoder),
+		  decoder(hidden_count, visible_count, in_decoder)
 	{
 
 	}
@@ -37,6 +41,16 @@ namespace OMLT
 		decoder.CalcFeatureVector(in_decoded, out_raw, output_type);
 	}
 
+	void AutoEncoder::EncodeMatrix( const float* in_raw, float* out_encoded, uint32_t rows ) const
+	{
+		encoder.CalcFeatureMatrix(in_raw, rows, out_encoded, hidden_type);
+	}
+
+	void AutoEncoder::DecodeMatrix( const float* in_decoded, float* out_raw, uint32_t rows ) const
+	{
+		decoder.CalcFeatureMatrix(in_decoded, rows, out_raw, output_type);
+	}
+
 	void AutoEncoder::ToJSON(std::ostream& stream) const
 	{
 		cppJSONStream::Writer w(stream, true);
@@ -102,38 +116,85 @@ namespace OMLT
 		// load biases
 
 		TryGetNameValuePair("HiddenBiases", Token::BeginArray);
-		for(size_t j = 0; j < hidden_count; j++)
-		{
-			TryGetToken(Token::Number);
-			ae->encoder.biases()[j] = (float)r.readDouble();
-		}
-		TryGetToken(Token::EndArray);
+		VerifyEqual(JSONModel::ReadFloatArray(r, ae->encoder.biases(), ae->hidden_count), true);
 
 		TryGetNameValuePair("OutputBiases", Token::BeginArray);
-		for(size_t i = 0; i < visible_count; i++)
-		{
-			TryGetToken(Token::Number);
-			ae->decoder.biases()[i] = (float)r.readDouble();
-		}
-		TryGetToken(Token::EndArray);
+		VerifyEqual(JSONModel::ReadFloatArray(r, ae->decoder.biases(), ae->visible_count), true);
 
-		// load weights
+		// load weights, then copy them to the decoder
 		TryGetNameValuePair("Weights", Token::BeginArray);
+		VerifyEqual(JSONModel::ReadFloatRows(r, ae->encoder.weights(), ae->hidden_count, ae->visible_count, ae->encoder.feature_stride), true);
 		for(size_t j = 0; j < ae->hidden_count; j++)
 		{
-			TryGetToken(Token::BeginArray);
+			const float* w_j = ae->encoder.feature(j);
 			for(size_t i = 0; i < ae->visible_count; i++)
 			{
-				TryGetToken(Token::Number);
-				float w_ij = (float)r.readDouble();
-				ae->encoder.feature(j)[i] = w_ij;
-				ae->decoder.feature(i)[j] = w_ij;
+				ae->decoder.feature(i)[j] = w_j[i];
 			}
-			TryGetToken(Token::EndArray);
 		}
-		TryGetToken(Token::EndArray);
 		TryGetToken(Token::EndObject);
 
 		return ae.release();
 	}
+
+	void AutoEncoder::ToBinary(std::ostream& stream) const
+	{
+		BinaryModel::Writer blocks;
+		std::ostringstream header;
+		cppJSONStream::Writer w(header, true);
+
+		// the tied weights are stored in both directions so neither has to be transposed when loading
+		w.begin_object();
+			w.write_namevalue("Type", "AutoEncoder");
+			w.write_namevalue("VisibleCount", (uint64_t)visible_count);
+			w.write_namevalue("HiddenCount", (uint64_t)hidden_count);
+			w.write_namevalue("OutputType", ActivationFunctionNames[output_type]);
+			w.write_namevalue("HiddenType", ActivationFunctionNames[hidden_type]);
+			w.write_name("Encoder");
+				blocks.WriteFeatureMap(w, encoder);
+			w.write_name("Decoder");
+				blocks.WriteFeatureMap(w, decoder);
+		w.end_object();
+
+		blocks.Write(stream, header.str());
+	}
+
+	AutoEncoder* AutoEncoder::FromBinary(BinaryModel::Reader& in_reader)
+	{
+		Reader r(in_reader.Header());
+
+		SetReader(r);
+		SetErrorResult(nullptr);
+		TryGetToken(Token::BeginObject);
+		TryGetNameValuePair("Type", Token::String);
+		VerifyEqual(r.readString(), "AutoEncoder");
+
+		TryGetNameValuePair("VisibleCount", Token::Number);
+		uint64_t visible_count = r.readUInt();
+		TryGetNameValuePair("HiddenCount", Token::Number);
+		uint64_t hidden_count = r.readUInt();
+		TryGetNameValuePair("OutputType", Token::String);
+		ActivationFunction_t output_type = ParseFunction(r.readString().c_str());
+		TryGetNameValuePair("HiddenType", Token::String);
+		ActivationFunction_t hidden_type = ParseFunction(r.readString().c_str());
+
+		if(visible_count > (uint64_t)std::numeric_limits<uint32_t>::max() ||
+		   visible_count == 0 ||
+		   hidden_count > (uint64_t)std::numeric_limits<uint32_t>::max() ||
+		   hidden_count == 0 ||
+		   output_type == ActivationFunction::Invalid ||
+		   hidden_type == ActivationFunction::Invalid)
+		{
+			return nullptr;
+		}
+
+		MappedFeatureMap encoder, decoder;
+		TryGetNameValuePair("Encoder", Token::BeginObject);
+		VerifyEqual(in_reader.ReadFeatureMap(r, uint32_t(visible_count), uint32_t(hidden_count), encoder), true);
+		TryGetNameValuePair("Decoder", Token::BeginObject);
+		VerifyEqual(in_reader.ReadFeatureMap(r, uint32_t(hidden_count), uint32_t(visible_count), decoder), true);
+		TryGetToken(Token::EndObject);
+
+		return new AutoEncoder(uint32_t(visible_count), uint32_t(hidden_count), hidden_type, output_type, &encoder, &decoder);
+	}
 }
\ No newline at end of file
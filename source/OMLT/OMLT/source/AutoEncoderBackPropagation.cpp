@@ -87,7 +87,7 @@ namespace OMLT
 		}
 	}
 
-	void AutoEncoderBackPropagation::Train(const OpenGLBuffer2D& in_example)
+	void AutoEncoderBackPropagation::Train(const SiCKLBuffer2D& in_example)
 	{
 		if(_recompile_required)
 		{
@@ -220,6 +220,21 @@ namespace OMLT
 		return result;
 	}
 
+	uint32_t AutoEncoderBackPropagation::GetParameterCount() const
+	{
+		return 2 * (_model_config.VisibleCount + 1) * (_model_config.HiddenCount + 1);
+	}
+
+	void AutoEncoderBackPropagation::GetParameters(float* out_parameters) const
+	{
+		GetWeightParameters(Weights0, DeltaWeights0, out_parameters);
+	}
+
+	void AutoEncoderBackPropagation::SetParameters(const float* in_parameters)
+	{
+		SetWeightParameters(in_parameters, _training_config.Momentum, Weights0, DeltaWeights0, NesterovWeight);
+	}
+
 	bool AutoEncoderBackPropagation::DumpLastVisible( float** image, float** recon )
 	{
 		assert(image != nullptr);
@@ -254,7 +269,7 @@ namespace OMLT
 		return _error_calculator->CalcError(Visible, Output0);
 	}
 	
-	float AutoEncoderBackPropagation::GetError(const OpenGLBuffer2D& in_example)
+	float AutoEncoderBackPropagation::GetError(const SiCKLBuffer2D& in_example)
 	{
 		if(_recompile_required)
 		{
@@ -264,7 +279,7 @@ namespace OMLT
 			_recompile_required = false;
 		}
 
-		OpenGLBuffer2D previous_Visible = Visible;
+		SiCKLBuffer2D previous_Visible = Visible;
 		Visible = in_example;
 
 		// calc hidden activation
@@ -322,7 +337,7 @@ namespace OMLT
 
 	void AutoEncoderBackPropagation::build_kernels()
 	{
-		OpenGLCompiler comp;
+		SiCKLCompiler comp;
 
 		// calc enabled visible units
 		{
@@ -432,13 +447,13 @@ namespace OMLT
 		uint32_t* visible_dropout_seed_buffer = GetSeedBuffer(_model_config.VisibleCount * 4, 1, random);
 		uint32_t* hidden_dropout_seed_buffer = GetSeedBuffer(_model_config.HiddenCount * 4, 1, random);
 
-		VisibleRandom0 = OpenGLBuffer2D(_model_config.VisibleCount, 1, ReturnType::UInt4, visible_dropout_seed_buffer);
-		VisibleRandom1 = OpenGLBuffer2D(_model_config.VisibleCount, 1, ReturnType::UInt4, nullptr);
-		VisibleEnabled = OpenGLBuffer2D(_model_config.VisibleCount, 1, ReturnType::UInt, nullptr);
+		VisibleRandom0 = SiCKLBuffer2D(_model_config.VisibleCount, 1, ReturnType::UInt4, visible_dropout_seed_buffer);
+		VisibleRandom1 = SiCKLBuffer2D(_model_config.VisibleCount, 1, ReturnType::UInt4, nullptr);
+		VisibleEnabled = SiCKLBuffer2D(_model_config.VisibleCount, 1, ReturnType::UInt, nullptr);
 
-		HiddenRandom0 = OpenGLBuffer2D(_model_config.HiddenCount, 1, ReturnType::UInt4, hidden_dropout_seed_buffer);
-		HiddenRandom1 = OpenGLBuffer2D(_model_config.HiddenCount, 1, ReturnType::UInt4, nullptr);
-		HiddenEnabled = OpenGLBuffer2D(_model_config.HiddenCount, 1, ReturnType::UInt, nullptr);
+		HiddenRandom0 = SiCKLBuffer2D(_model_config.HiddenCount, 1, ReturnType::UInt4, hidden_dropout_seed_buffer);
+		HiddenRandom1 = SiCKLBuffer2D(_model_config.HiddenCount, 1, ReturnType::UInt4, nullptr);
+		HiddenEnabled = SiCKLBuffer2D(_model_config.HiddenCount, 1, ReturnType::UInt, nullptr);
 
 		if(weight_buffer == nullptr)
 		{
@@ -466,34 +481,36 @@ namespace OMLT
 					index++;
 				}
 			}
-			Weights0 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, weight_buffer);
+			Weights0 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, weight_buffer);
+			// no momentum yet, so the first minibatch looks ahead to the weights themselves
+			NesterovWeight = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, weight_buffer);
 			free(weight_buffer);
 		}
 		else
 		{
-			Weights0 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, weight_buffer);
+			Weights0 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, weight_buffer);
+			NesterovWeight = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, weight_buffer);
 		}
-		Weights1 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
-		DeltaWeights0 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
-		DeltaWeights1 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
-		NesterovWeight = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
-		MeanSquareDelta0 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float2, nullptr);
-		MeanSquareDelta1 = OpenGLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float2, nullptr);
-
-		Visible = OpenGLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
-		Hidden0 = OpenGLBuffer2D(_model_config.HiddenCount, _minibatch_size, ReturnType::Float, nullptr);
+		Weights1 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
+		DeltaWeights0 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
+		DeltaWeights1 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float, nullptr);
+		MeanSquareDelta0 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float2, nullptr);
+		MeanSquareDelta1 = SiCKLBuffer2D(_model_config.VisibleCount + 1, _model_config.HiddenCount + 1, ReturnType::Float2, nullptr);
+
+		Visible = SiCKLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
+		Hidden0 = SiCKLBuffer2D(_model_config.HiddenCount, _minibatch_size, ReturnType::Float, nullptr);
 		if(_model_config.HiddenType == ActivationFunction::Softmax)
 		{
-			Hidden1 = OpenGLBuffer2D(_model_config.HiddenCount, _minibatch_size, ReturnType::Float, nullptr);
+			Hidden1 = SiCKLBuffer2D(_model_config.HiddenCount, _minibatch_size, ReturnType::Float, nullptr);
 		}
-		Output0 = OpenGLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
+		Output0 = SiCKLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
 		if(_model_config.OutputType == ActivationFunction::Softmax)
 		{
-			Output1 = OpenGLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
+			Output1 = SiCKLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
 		}
 
-		HiddenSensitivities = OpenGLBuffer2D(_model_config.HiddenCount, _minibatch_size, ReturnType::Float, nullptr);
-		OutputSensitivities = OpenGLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
+		HiddenSensitivities = SiCKLBuffer2D(_model_config.HiddenCount, _minibatch_size, ReturnType::Float, nullptr);
+		OutputSensitivities = SiCKLBuffer2D(_model_config.VisibleCount, _minibatch_size, ReturnType::Float, nullptr);
 
 		free(visible_dropout_seed_buffer);
 		free(hidden_dropout_seed_buffer);
@@ -0,0 +1,584 @@
+// std
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <mutex>
+#include <assert.h>
+
+// OMLT
+#include "Common.h"
+#include "CPUShared.h"
+#include "AutoEncoder.h"
+#include "AutoEncoderBackPropagationCPU.h"
+#include "DataAtlasCPU.h"
+
+namespace OMLT
+{
+	AutoEncoderBackPropagationCPU::AutoEncoderBackPropagationCPU(const ModelConfig& in_model_config, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count)
+		: _model_config(in_model_config)
+		, _minibatch_size(in_minibatch_size)
+		, _thread_pool(in_thread_count)
+		, _seed(in_seed)
+	{
+		allocate_buffers(nullptr, in_seed);
+	}
+
+	AutoEncoderBackPropagationCPU::AutoEncoderBackPropagationCPU(const AutoEncoder* in_autoencoder, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count)
+		: _minibatch_size(in_minibatch_size)
+		, _thread_pool(in_thread_count)
+		, _seed(in_seed)
+	{
+		assert(in_autoencoder != nullptr);
+		_model_config.VisibleCount = in_autoencoder->visible_count;
+		_model_config.HiddenCount = in_autoencoder->hidden_count;
+		_model_config.HiddenType = in_autoencoder->hidden_type;
+		_model_config.OutputType = in_autoencoder->output_type;
+
+		// copy weights to a buffer formatted the same way as AutoEncoderBackPropagation's
+		float* weight_buffer = new float[(_model_config.VisibleCount + 1) * (_model_config.HiddenCount + 1)];
+		weight_buffer[0] = 0.0f;
+
+		// output biases
+		memcpy(weight_buffer + 1, in_autoencoder->decoder.biases(), sizeof(float) * _model_config.VisibleCount);
+
+		// hidden biases and weights
+		for(uint32_t j = 0; j < _model_config.HiddenCount; j++)
+		{
+			const uint32_t offset = (_model_config.VisibleCount + 1) * (j + 1);
+			weight_buffer[offset] = in_autoencoder->encoder.biases()[j];
+			memcpy(weight_buffer + offset + 1, in_autoencoder->encoder.feature(j), sizeof(float) * _model_config.VisibleCount);
+		}
+
+		allocate_buffers(weight_buffer, in_seed);
+		delete[] weight_buffer;
+	}
+
+	AutoEncoderBackPropagationCPU::AutoEncoderBackPropagationCPU(const AutoEncoderBackPropagationCPU* in_owner, int32_t in_seed)
+		: _model_config(in_owner->_model_config)
+		, _minibatch_size(in_owner->_minibatch_size)
+		, _thread_pool(1)
+		, _seed(in_seed)
+	{
+		allocate_buffers(nullptr, in_seed, in_owner);
+	}
+
+	AutoEncoderBackPropagationCPU::~AutoEncoderBackPropagationCPU()
+	{
+		for(auto it = _hogwild_workers.begin(); it != _hogwild_workers.end(); ++it)
+		{
+			delete *it;
+		}
+		free_buffers();
+	}
+
+	void AutoEncoderBackPropagationCPU::SetTrainingConfig(const TrainingConfig& in_config)
+	{
+		_training_config = in_config;
+
+		_update_rule.LearningRate = in_config.LearningRate;
+		_update_rule.Momentum = in_config.Momentum;
+		_update_rule.L1Regularization = in_config.L1Regularization;
+		_update_rule.L2Regularization = in_config.L2Regularization;
+		_update_rule.AdadeltaDecay = in_config.AdadeltaDecay;
+	}
+
+	void AutoEncoderBackPropagationCPU::Train(const float* in_example)
+	{
+		assert(in_example != nullptr);
+
+		CopyToPadded(in_example, _minibatch_size, _model_config.VisibleCount, _visible, _visible_stride);
+		train_minibatch(_visible);
+	}
+
+	void AutoEncoderBackPropagationCPU::Train(DataAtlasCPU& in_examples, uint32_t in_minibatches)
+	{
+		if(_training_config.Parallelism == Parallelism::Hogwild)
+		{
+			train_hogwild(in_examples, in_minibatches);
+			return;
+		}
+
+		for(uint32_t k = 0; k < in_minibatches; k++)
+		{
+			// the atlas stores rows at our padded stride, so train straight out of its page
+			const float* example;
+			uint32_t stride;
+			in_examples.Next(example, stride);
+			assert(stride == _visible_stride);
+			train_minibatch(example);
+		}
+	}
+
+	void AutoEncoderBackPropagationCPU::train_minibatch(const float* in_visible)
+	{
+		_current_visible = in_visible;
+
+		/// Calculate Enabled Units
+
+		calc_enabled(_visible_dropout_seeds, _model_config.VisibleCount, _training_config.VisibleDropout, _enabled_visible);
+		calc_enabled(_hidden_dropout_seeds, _model_config.HiddenCount, _training_config.HiddenDropout, _enabled_hidden);
+
+		/// Encode, Decode, Output and Hidden Sensitivities
+
+		feed_forward(_current_visible, true, true);
+
+		/// Update Weights
+
+		update_weights();
+	}
+
+	AutoEncoder* AutoEncoderBackPropagationCPU::GetAutoEncoder() const
+	{
+		AutoEncoder* result = new AutoEncoder(_model_config.VisibleCount, _model_config.HiddenCount, _model_config.HiddenType, _model_config.OutputType);
+
+		memcpy(result->decoder.biases(), _output_biases.weights(0), sizeof(float) * _model_config.VisibleCount);
+		memcpy(result->encoder.biases(), _hidden_biases.weights(0), sizeof(float) * _model_config.HiddenCount);
+
+		// now get the symmetrical weights
+		for(uint32_t j = 0; j < _model_config.HiddenCount; j++)
+		{
+			const float* w_j = _weights.weights(j);
+			memcpy(result->encoder.feature(j), w_j, sizeof(float) * _model_config.VisibleCount);
+			for(uint32_t i = 0; i < _model_config.VisibleCount; i++)
+			{
+				result->decoder.feature(i)[j] = w_j[i];
+			}
+		}
+
+		return result;
+	}
+
+	bool AutoEncoderBackPropagationCPU::DumpLastVisible(float** image, float** recon)
+	{
+		assert(image != nullptr);
+		assert(recon != nullptr);
+
+		CopyFromPadded(_current_visible, _minibatch_size, _model_config.VisibleCount, _visible_stride, *image);
+		CopyFromPadded(_output, _minibatch_size, _model_config.VisibleCount, _visible_stride, *recon);
+
+		return true;
+	}
+
+	bool AutoEncoderBackPropagationCPU::DumpLastHidden(float** activations)
+	{
+		assert(activations != nullptr);
+
+		CopyFromPadded(_hidden, _minibatch_size, _model_config.HiddenCount, _hidden_stride, *activations);
+
+		return true;
+	}
+
+	bool AutoEncoderBackPropagationCPU::DumpLastWeights(float** weights)
+	{
+		assert(weights != nullptr);
+
+		// (VisibleCount + 1) x (HiddenCount + 1) with the biases in the first row and column
+		float* head = *weights;
+		const uint32_t row_length = _model_config.VisibleCount + 1;
+
+		head[0] = 0.0f;
+		memcpy(head + 1, _output_biases.weights(0), sizeof(float) * _model_config.VisibleCount);
+		for(uint32_t j = 0; j < _model_config.HiddenCount; j++)
+		{
+			float* row = head + (j + 1) * row_length;
+			row[0] = _hidden_biases.weights(0)[j];
+			memcpy(row + 1, _weights.weights(j), sizeof(float) * _model_config.VisibleCount);
+		}
+
+		return true;
+	}
+
+	float AutoEncoderBackPropagationCPU::GetLastError()
+	{
+		// same argument order as AutoEncoderBackPropagation
+		return CalcError(_current_visible, _output, _minibatch_size, _model_config.VisibleCount, _visible_stride, _error_function);
+	}
+
+	float AutoEncoderBackPropagationCPU::GetError(const float* in_example)
+	{
+		assert(in_example != nullptr);
+
+		CopyToPadded(in_example, _minibatch_size, _model_config.VisibleCount, _visible_test, _visible_stride);
+
+		// like AutoEncoderBackPropagation, this uses the current (rather than nesterov) weights and the last enabled units
+		feed_forward(_visible_test, false, false);
+
+		return CalcError(_visible_test, _output, _minibatch_size, _model_config.VisibleCount, _visible_stride, _error_function);
+	}
+
+	void AutoEncoderBackPropagationCPU::train_hogwild(DataAtlasCPU& in_examples, uint32_t in_minibatches)
+	{
+		if(_hogwild_workers.empty())
+		{
+			for(uint32_t k = 0; k < _thread_pool.ThreadCount(); k++)
+			{
+				// every worker needs its own dropout seeds
+				_hogwild_workers.push_back(new AutoEncoderBackPropagationCPU(this, _seed + int32_t(k + 1)));
+			}
+		}
+
+		for(auto it = _hogwild_workers.begin(); it != _hogwild_workers.end(); ++it)
+		{
+			(*it)->SetTrainingConfig(_training_config);
+		}
+
+		std::mutex atlas_mutex;
+		uint32_t next_minibatch = 0;
+
+		_thread_pool.ParallelFor((uint32_t)_hogwild_workers.size(), [&](uint32_t begin, uint32_t end)
+		{
+			for(uint32_t w = begin; w < end; w++)
+			{
+				AutoEncoderBackPropagationCPU* worker = _hogwild_workers[w];
+				for(;;)
+				{
+					{
+						// the atlas' minibatch is only valid until the next call to Next, which another
+						// worker makes while this one trains, so it is copied out before anyone else gets
+						// the atlas
+						std::lock_guard<std::mutex> lock(atlas_mutex);
+						if(next_minibatch == in_minibatches)
+						{
+							break;
+						}
+						next_minibatch++;
+
+						const float* example;
+						uint32_t stride;
+						in_examples.Next(example, stride);
+						assert(stride == _visible_stride);
+						memcpy(worker->_visible, example, sizeof(float) * _minibatch_size * _visible_stride);
+					}
+
+					worker->train_minibatch(worker->_visible);
+				}
+			}
+		});
+	}
+
+	void AutoEncoderBackPropagationCPU::calc_enabled(uint32_t* io_seeds, uint32_t in_count, float in_dropout_prob, float* out_enabled)
+	{
+		for(uint32_t k = 0; k < in_count; k++)
+		{
+			const float p = NextFloat(io_seeds + k * 4);
+			out_enabled[k] = p > in_dropout_prob ? 1.0f : 0.0f;
+		}
+	}
+
+	void AutoEncoderBackPropagationCPU::feed_forward(const float* in_visible, bool in_nesterov, bool in_calc_sensitivities)
+	{
+		const uint32_t visible_units = _model_config.VisibleCount;
+		const uint32_t hidden_units = _model_config.HiddenCount;
+		const ActivationFunction_t hidden_type = _model_config.HiddenType;
+		const ActivationFunction_t output_type = _model_config.OutputType;
+
+		const float* weights = in_nesterov ? _weights.Nesterov : _weights.Weights;
+		const float* hidden_biases = in_nesterov ? _hidden_biases.nesterov(0) : _hidden_biases.weights(0);
+		const float* output_biases = in_nesterov ? _output_biases.nesterov(0) : _output_biases.weights(0);
+
+		/// Apply Visible Dropout
+
+		_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+		{
+			for(uint32_t m = begin; m < end; m++)
+			{
+				const float* src = in_visible + m * _visible_stride;
+				float* dest = _visible_masked + m * _visible_stride;
+				for(uint32_t i = 0; i < _visible_stride; i += 4)
+				{
+					_mm_store_ps(dest + i, _mm_mul_ps(_mm_load_ps(src + i), _mm_load_ps(_enabled_visible + i)));
+				}
+			}
+		});
+
+		// each pass below divides the weights between the threads, so each one reads its own rows (or columns)
+		// of W once for the whole minibatch rather than every thread streaming all of W
+
+		/// Encode: h = f(v * W^T), reading W by rows
+
+		const MatrixEpilogue encode_epilogue = [&](float* io_hidden, uint32_t m, uint32_t n, uint32_t count)
+		{
+			float* hidden_masked = _hidden_masked + m * _hidden_stride;
+			for(uint32_t j = n; j < n + count; j++)
+			{
+				const float hidden = CalcActivation(hidden_type, io_hidden[j - n] + hidden_biases[j]);
+				io_hidden[j - n] = hidden;
+				// hidden dropout is applied when decoding, so bake it in here
+				if(hidden_type != ActivationFunction::Softmax)
+				{
+					hidden_masked[j] = hidden * _enabled_hidden[j];
+				}
+			}
+		};
+
+		_thread_pool.ParallelFor(BlockCount(hidden_units), [&](uint32_t begin, uint32_t end)
+		{
+			MatrixMultiplyNT(_visible_masked, _visible_stride, weights, _weights.Stride, _hidden, _hidden_stride, _minibatch_size, begin * 4, std::min(end * 4, hidden_units), visible_units, 1.0f / (1.0f - _training_config.VisibleDropout), encode_epilogue);
+		});
+
+		if(hidden_type == ActivationFunction::Softmax)
+		{
+			_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t m = begin; m < end; m++)
+				{
+					float* hidden = _hidden + m * _hidden_stride;
+					float* hidden_masked = _hidden_masked + m * _hidden_stride;
+
+					CalcSoftmax(hidden, hidden_units);
+					for(uint32_t j = 0; j < hidden_units; j++)
+					{
+						hidden_masked[j] = hidden[j] * _enabled_hidden[j];
+					}
+				}
+			});
+		}
+
+		/// Decode: y = f(h * W), reading W by columns
+
+		// output sensitivities, once the whole output row is known
+		auto calc_output_sensitivities = [&](uint32_t m, uint32_t k_begin, uint32_t k_end)
+		{
+			const float* label = in_visible + m * _visible_stride;
+			const float* output = _output + m * _visible_stride;
+			float* sensitivities = _output_sensitivities + m * _visible_stride;
+
+			for(uint32_t k = k_begin; k < k_end; k++)
+			{
+				const float diff = label[k] - output[k];
+				if(output_type == ActivationFunction::Softmax)
+				{
+					// cross entropy error
+					sensitivities[k] = diff;
+				}
+				else
+				{
+					// squared error
+					sensitivities[k] = diff * CalcActivationPrime(output_type, output[k]);
+				}
+			}
+		};
+
+		_thread_pool.ParallelFor(BlockCount(visible_units), [&](uint32_t begin, uint32_t end)
+		{
+			const uint32_t k_begin = begin * 4;
+			const uint32_t k_end = end * 4;
+			const uint32_t k_last = std::min(k_end, visible_units);
+
+			MatrixMultiplyNN(_hidden_masked, _hidden_stride, weights, _weights.Stride, _output, _visible_stride, _minibatch_size, k_begin, k_end, hidden_units, 1.0f / (1.0f - _training_config.HiddenDropout), false);
+
+			for(uint32_t m = 0; m < _minibatch_size; m++)
+			{
+				float* output = _output + m * _visible_stride;
+				for(uint32_t k = k_begin; k < k_last; k++)
+				{
+					output[k] = CalcActivation(output_type, output[k] + output_biases[k]);
+				}
+
+				/// Output Sensitivities
+
+				if(in_calc_sensitivities && output_type != ActivationFunction::Softmax)
+				{
+					calc_output_sensitivities(m, k_begin, k_last);
+				}
+			}
+		});
+
+		if(output_type == ActivationFunction::Softmax)
+		{
+			_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t m = begin; m < end; m++)
+				{
+					CalcSoftmax(_output + m * _visible_stride, visible_units);
+					if(in_calc_sensitivities)
+					{
+						calc_output_sensitivities(m, 0, visible_units);
+					}
+				}
+			});
+		}
+
+		if(in_calc_sensitivities == false)
+		{
+			return;
+		}
+
+		/// Hidden Sensitivities: d_j = (d_k * W^T) * f'(h), reading W by rows again
+
+		const MatrixEpilogue sensitivity_epilogue = [&](float* io_sensitivities, uint32_t m, uint32_t n, uint32_t count)
+		{
+			const float* hidden = _hidden + m * _hidden_stride;
+			for(uint32_t j = n; j < n + count; j++)
+			{
+				io_sensitivities[j - n] *= CalcActivationPrime(hidden_type, hidden[j]);
+			}
+		};
+
+		_thread_pool.ParallelFor(BlockCount(hidden_units), [&](uint32_t begin, uint32_t end)
+		{
+			MatrixMultiplyNT(_output_sensitivities, _visible_stride, weights, _weights.Stride, _hidden_sensitivities, _hidden_stride, _minibatch_size, begin * 4, std::min(end * 4, hidden_units), visible_units, 1.0f, sensitivity_epilogue);
+		});
+	}
+
+	void AutoEncoderBackPropagationCPU::update_weights()
+	{
+		const uint32_t hidden_units = _model_config.HiddenCount;
+		const float inv_minibatch = 1.0f / float(_minibatch_size);
+
+		// the tied weight gets the average of its encoder and decoder gradients
+		const float visible_scale = 0.5f / (1.0f - _training_config.VisibleDropout);
+		const float hidden_scale = 0.5f / (1.0f - _training_config.HiddenDropout);
+
+		// weights: sum over the minibatch of d_j * v_i and d_k * h_j, applied while the gradient rows are still in cache
+		_thread_pool.ParallelFor(BlockCount(hidden_units), [&](uint32_t begin, uint32_t end)
+		{
+			const uint32_t j_begin = begin * 4;
+			const uint32_t j_end = std::min(end * 4, hidden_units);
+
+			MatrixMultiplyTN(_hidden_sensitivities, _hidden_stride, _current_visible, _visible_stride, _weight_gradient, _weights.Stride, _minibatch_size, j_begin, j_end, _visible_stride, visible_scale, false);
+			MatrixMultiplyTN(_hidden, _hidden_stride, _output_sensitivities, _visible_stride, _weight_gradient, _weights.Stride, _minibatch_size, j_begin, j_end, _visible_stride, hidden_scale, true);
+
+			for(uint32_t j = j_begin; j < j_end; j++)
+			{
+				_weights.UpdateRow(_update_rule, j, _weight_gradient + j * _weights.Stride, inv_minibatch, nullptr, true);
+			}
+		});
+
+		// biases: sum over the minibatch of d_j and d_k
+		memset(_hidden_bias_gradient, 0x00, sizeof(float) * _hidden_stride);
+		memset(_output_bias_gradient, 0x00, sizeof(float) * _visible_stride);
+		for(uint32_t m = 0; m < _minibatch_size; m++)
+		{
+			const float* hidden_sensitivities = _hidden_sensitivities + m * _hidden_stride;
+			for(uint32_t j = 0; j < _hidden_stride; j += 4)
+			{
+				_mm_store_ps(_hidden_bias_gradient + j, _mm_add_ps(_mm_load_ps(_hidden_bias_gradient + j), _mm_load_ps(hidden_sensitivities + j)));
+			}
+
+			const float* output_sensitivities = _output_sensitivities + m * _visible_stride;
+			for(uint32_t k = 0; k < _visible_stride; k += 4)
+			{
+				_mm_store_ps(_output_bias_gradient + k, _mm_add_ps(_mm_load_ps(_output_bias_gradient + k), _mm_load_ps(output_sensitivities + k)));
+			}
+		}
+
+		_hidden_biases.UpdateRow(_update_rule, 0, _hidden_bias_gradient, inv_minibatch, nullptr, false);
+		_output_biases.UpdateRow(_update_rule, 0, _output_bias_gradient, inv_minibatch, nullptr, false);
+	}
+
+	extern uint32_t* GetSeedBuffer(uint32_t, uint32_t, std::mt19937_64&);
+
+	void AutoEncoderBackPropagationCPU::allocate_buffers(const float* in_weight_buffer, int32_t in_seed, const AutoEncoderBackPropagationCPU* in_owner)
+	{
+		const uint32_t visible_units = _model_config.VisibleCount;
+		const uint32_t hidden_units = _model_config.HiddenCount;
+
+		_visible_stride = BlockCount(visible_units) * 4;
+		_hidden_stride = BlockCount(hidden_units) * 4;
+
+		// default training config until SetTrainingConfig is called
+		SetTrainingConfig(_training_config);
+
+		// same seeds (in the same order) as AutoEncoderBackPropagation
+		std::mt19937_64 random;
+		random.seed(static_cast<uint32_t>(in_seed));
+
+		_visible_dropout_seeds = GetSeedBuffer(visible_units * 4, 1, random);
+		_hidden_dropout_seeds = GetSeedBuffer(hidden_units * 4, 1, random);
+
+		_enabled_visible = AllocateMatrix(1, visible_units);
+		_enabled_hidden = AllocateMatrix(1, hidden_units);
+		// everything is enabled until the first minibatch (GetError uses the last enabled units)
+		std::fill(_enabled_visible, _enabled_visible + visible_units, 1.0f);
+		std::fill(_enabled_hidden, _enabled_hidden + hidden_units, 1.0f);
+
+		_visible = AllocateMatrix(_minibatch_size, visible_units);
+		_current_visible = _visible;
+		_visible_masked = AllocateMatrix(_minibatch_size, visible_units);
+		_visible_test = AllocateMatrix(_minibatch_size, visible_units);
+		_hidden = AllocateMatrix(_minibatch_size, hidden_units);
+		_hidden_masked = AllocateMatrix(_minibatch_size, hidden_units);
+		_output = AllocateMatrix(_minibatch_size, visible_units);
+		_output_sensitivities = AllocateMatrix(_minibatch_size, visible_units);
+		_hidden_sensitivities = AllocateMatrix(_minibatch_size, hidden_units);
+
+		_weight_gradient = AllocateMatrix(hidden_units, visible_units);
+		_hidden_bias_gradient = AllocateMatrix(1, hidden_units);
+		_output_bias_gradient = AllocateMatrix(1, visible_units);
+
+		_error_function = _model_config.OutputType == ActivationFunction::Softmax ? ErrorFunction::CrossEntropy : ErrorFunction::SquareError;
+
+		if(in_owner != nullptr)
+		{
+			_weights.Share(in_owner->_weights);
+			_hidden_biases.Share(in_owner->_hidden_biases);
+			_output_biases.Share(in_owner->_output_biases);
+			return;
+		}
+
+		_weights.Allocate(hidden_units, visible_units);
+		_hidden_biases.Allocate(1, hidden_units);
+		_output_biases.Allocate(1, visible_units);
+
+		if(in_weight_buffer == nullptr)
+		{
+			// initialize weights to random values, biases are 0
+			float weight_stdev = float(1.0 / std::sqrt((float)(visible_units + hidden_units)));
+			std::normal_distribution<float> normal(0.0f, weight_stdev);
+
+			for(uint32_t j = 0; j < hidden_units; j++)
+			{
+				float* w_j = _weights.weights(j);
+				for(uint32_t i = 0; i < visible_units; i++)
+				{
+					w_j[i] = normal(random);
+				}
+			}
+		}
+		else
+		{
+			// (VisibleCount + 1) x (HiddenCount + 1) with the biases in the first row and column
+			const uint32_t row_length = visible_units + 1;
+
+			memcpy(_output_biases.weights(0), in_weight_buffer + 1, sizeof(float) * visible_units);
+			for(uint32_t j = 0; j < hidden_units; j++)
+			{
+				const float* row = in_weight_buffer + (j + 1) * row_length;
+				_hidden_biases.weights(0)[j] = row[0];
+				memcpy(_weights.weights(j), row + 1, sizeof(float) * visible_units);
+			}
+		}
+
+		// with no deltas yet the nesterov weights are just the weights
+		_weights.ResetNesterov();
+		_hidden_biases.ResetNesterov();
+		_output_biases.ResetNesterov();
+	}
+
+	void AutoEncoderBackPropagationCPU::free_buffers()
+	{
+		free(_visible_dropout_seeds);
+		free(_hidden_dropout_seeds);
+
+		FreeMatrix(_enabled_visible);
+		FreeMatrix(_enabled_hidden);
+
+		FreeMatrix(_visible);
+		FreeMatrix(_visible_masked);
+		FreeMatrix(_visible_test);
+		FreeMatrix(_hidden);
+		FreeMatrix(_hidden_masked);
+		FreeMatrix(_output);
+		FreeMatrix(_output_sensitivities);
+		FreeMatrix(_hidden_sensitivities);
+
+		FreeMatrix(_weight_gradient);
+		FreeMatrix(_hidden_bias_gradient);
+		FreeMatrix(_output_bias_gradient);
+
+		_weights.Free();
+		_hidden_biases.Free();
+		_output_biases.Free();
+	}
+}
\ No newline at end of file
@@ -101,7 +101,7 @@ namespace OMLT
 		}
 	}
 
-	void BackPropagation::Train( const OpenGLBuffer2D& example_input, const OpenGLBuffer2D& example_label )
+	void BackPropagation::Train( const SiCKLBuffer2D& example_input, const SiCKLBuffer2D& example_label )
 	{
 		if(_recompile_required)
 		{
@@ -124,7 +124,7 @@ namespace OMLT
 		{
 			Layer* lay = *it;
 
-			OpenGLProgram* calc_enabled = lay->CalcEnabledInputs;
+			SiCKLProgram* calc_enabled = lay->CalcEnabledInputs;
 			{
 				calc_enabled->SetInput(0, lay->InputRandom0);
 				assert(lay->InputRandom0.Width == lay->InputUnits);
@@ -144,14 +144,14 @@ namespace OMLT
 		}
 
 		// set our example input as the input for the first layer
-		_layers.front()->Input = (OpenGLBuffer2D*)&example_input;
+		_layers.front()->Input = (SiCKLBuffer2D*)&example_input;
 
 		// feed forward
 		for(auto it = _layers.begin(); it != _layers.end(); ++it)
 		{
 			Layer* lay = *it;
 
-			OpenGLProgram* feed_forward = lay->FeedForward;
+			SiCKLProgram* feed_forward = lay->FeedForward;
 			{
 				feed_forward->SetInput(0, *lay->Input);
 				feed_forward->SetInput(1, lay->InputEnabled);
@@ -180,7 +180,7 @@ namespace OMLT
 
 			if(lay->Function == ActivationFunction::Softmax)
 			{
-				OpenGLProgram* softmax = lay->CalcSoftmax;
+				SiCKLProgram* softmax = lay->CalcSoftmax;
 				softmax->SetInput(0, lay->Activation0);
 				softmax->BindOutput(0, lay->Activation1);
 
@@ -194,7 +194,7 @@ namespace OMLT
 		{
 			auto it = _layers.rbegin();
 			Layer* lay = *it;
-			OpenGLProgram* calc_sensitivities = lay->CalcSensitivity;
+			SiCKLProgram* calc_sensitivities = lay->CalcSensitivity;
 			{
 				// fill out calc_top_sensitivities (and set the training examples the labels!
 				calc_sensitivities->SetInput(0, *_last_label);
@@ -240,7 +240,7 @@ namespace OMLT
 		for(auto it = _layers.rbegin(); it != _layers.rend(); ++it)
 		{
 			Layer* lay = *it;
-			OpenGLProgram* update_weights = lay->UpdateWeights;
+			SiCKLProgram* update_weights = lay->UpdateWeights;
 
 			// fill out whatever		
 			update_weights->SetInput(0, lay->Sensitivities);
@@ -285,7 +285,7 @@ namespace OMLT
 		return _error_calculator->CalcError(_layers.back()->Activation0, *_last_label);
 	}
 
-	float BackPropagation::GetOutputError(const OpenGLBuffer2D& example_input, const OpenGLBuffer2D& example_output)
+	float BackPropagation::GetOutputError(const SiCKLBuffer2D& example_input, const SiCKLBuffer2D& example_output)
 	{
 		// set out output label texture for error calculation
 		_last_label  = &example_output;
@@ -295,7 +295,7 @@ namespace OMLT
 		{
 			Layer* lay = *it;
 
-			OpenGLProgram* calc_enabled = lay->CalcEnabledInputs;
+			SiCKLProgram* calc_enabled = lay->CalcEnabledInputs;
 			{
 				calc_enabled->SetInput(0, lay->InputRandom0);
 				assert(lay->InputRandom0.Width == lay->InputUnits);
@@ -320,7 +320,7 @@ namespace OMLT
 		{
 			Layer* lay = *it;
 
-			OpenGLProgram* feed_forward = lay->FeedForward;
+			SiCKLProgram* feed_forward = lay->FeedForward;
 			{
 				feed_forward->SetInput(0, *lay->Input);
 				feed_forward->SetInput(1, lay->InputEnabled);
@@ -349,7 +349,7 @@ namespace OMLT
 
 			if(lay->Function == ActivationFunction::Softmax)
 			{
-				OpenGLProgram* softmax = lay->CalcSoftmax;
+				SiCKLProgram* softmax = lay->CalcSoftmax;
 				softmax->SetInput(0, lay->Activation0);
 				softmax->BindOutput(0, lay->Activation1);
 
@@ -394,11 +394,11 @@ namespace OMLT
 			width = result->InputUnits;
 			height = 1;
 
-			result->InputEnabled = OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
+			result->InputEnabled = SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
 
 			uint32_t* random_buffer = GetSeedBuffer(width * 4, height, random);
-			result->InputRandom0 = OpenGLBuffer2D(width, height, ReturnType::UInt4, random_buffer);
-			result->InputRandom1 = OpenGLBuffer2D(width, height, ReturnType::UInt4, nullptr);
+			result->InputRandom0 = SiCKLBuffer2D(width, height, ReturnType::UInt4, random_buffer);
+			result->InputRandom1 = SiCKLBuffer2D(width, height, ReturnType::UInt4, nullptr);
 			delete[] random_buffer;
 		}
 
@@ -434,19 +434,21 @@ namespace OMLT
 					}
 				}
 
-				result->Weights0 = OpenGLBuffer2D(width, height, ReturnType::Float, weight_buffer);
+				result->Weights0 = SiCKLBuffer2D(width, height, ReturnType::Float, weight_buffer);
+				// no momentum yet, so the first minibatch looks ahead to the weights themselves
+				result->NesterovWeight = SiCKLBuffer2D(width, height, ReturnType::Float, weight_buffer);
 				delete[] weight_buffer;
 			}
 			else
 			{
-				result->Weights0 = OpenGLBuffer2D(width, height, ReturnType::Float, in_weights);
+				result->Weights0 = SiCKLBuffer2D(width, height, ReturnType::Float, in_weights);
+				result->NesterovWeight = SiCKLBuffer2D(width, height, ReturnType::Float, in_weights);
 			}
-			result->Weights1 = OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
-			result->NesterovWeight = OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
-			result->DeltaWeights0 = OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
-			result->DeltaWeights1 = OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
-			result->MeanSquareDelta0 = OpenGLBuffer2D(width, height, ReturnType::Float2, nullptr);
-			result->MeanSquareDelta1 = OpenGLBuffer2D(width, height, ReturnType::Float2, nullptr);
+			result->Weights1 = SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
+			result->DeltaWeights0 = SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
+			result->DeltaWeights1 = SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
+			result->MeanSquareDelta0 = SiCKLBuffer2D(width, height, ReturnType::Float2, nullptr);
+			result->MeanSquareDelta1 = SiCKLBuffer2D(width, height, ReturnType::Float2, nullptr);
 			result->OutputEnabled = nullptr;
 
 			if(_layers.size() > 0)
@@ -460,13 +462,13 @@ namespace OMLT
 			width = result->OutputUnits;
 			height = _minibatch_size;
 			uint32_t* seeds = GetSeedBuffer(width * 4, height, random);
-			result->Activation0 =  OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
+			result->Activation0 =  SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
 			if(result->Function == ActivationFunction::Softmax)
 			{
-				result->Activation1 =  OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
+				result->Activation1 =  SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
 			}
-			result->OutputRandom0 =  OpenGLBuffer2D(width, height, ReturnType::UInt4, seeds);
-			result->OutputRandom1 =  OpenGLBuffer2D(width, height, ReturnType::UInt4, nullptr);
+			result->OutputRandom0 =  SiCKLBuffer2D(width, height, ReturnType::UInt4, seeds);
+			result->OutputRandom1 =  SiCKLBuffer2D(width, height, ReturnType::UInt4, nullptr);
 			free(seeds);
 		}
 
@@ -474,7 +476,7 @@ namespace OMLT
 		{
 			width = result->OutputUnits;
 			height = _minibatch_size;
-			result->Sensitivities =  OpenGLBuffer2D(width, height, ReturnType::Float, nullptr);
+			result->Sensitivities =  SiCKLBuffer2D(width, height, ReturnType::Float, nullptr);
 		}
 
 		result->CalcEnabledInputs = nullptr;
@@ -531,6 +533,35 @@ namespace OMLT
 		return result;
 	}
 
+	uint32_t BackPropagation::GetParameterCount() const
+	{
+		uint32_t count = 0;
+		for(uint32_t k = 0; k < _layers.size(); k++)
+		{
+			count += 2 * (_layers[k]->InputUnits + 1) * _layers[k]->OutputUnits;
+		}
+		return count;
+	}
+
+	void BackPropagation::GetParameters(float* out_parameters) const
+	{
+		for(uint32_t k = 0; k < _layers.size(); k++)
+		{
+			out_parameters += GetWeightParameters(_layers[k]->Weights0, _layers[k]->DeltaWeights0, out_parameters);
+		}
+	}
+
+	void BackPropagation::SetParameters(const float* in_parameters)
+	{
+		assert(_training_config.Parameters.size() == _layers.size());
+
+		for(uint32_t k = 0; k < _layers.size(); k++)
+		{
+			Layer* layer = _layers[k];
+			in_parameters += SetWeightParameters(in_parameters, _training_config.Parameters[k].Momentum, layer->Weights0, layer->DeltaWeights0, layer->NesterovWeight);
+		}
+	}
+
 	bool BackPropagation::DumpLastLabel(float** label)
 	{
 		assert(_last_label != nullptr);
@@ -576,7 +607,7 @@ namespace OMLT
 
 	void BackPropagation::build_kernels()
 	{
-		OpenGLCompiler comp;
+		SiCKLCompiler comp;
 
 		for(uint32_t  k = 0; k < _layers.size(); k++)
 		{
@@ -677,7 +708,7 @@ namespace OMLT
 					enabled[j] = 1.0f;
 				}
 
-				last_layer->OutputEnabled = new OpenGLBuffer2D(last_layer->OutputUnits, 1, ReturnType::Float, enabled);
+				last_layer->OutputEnabled = new SiCKLBuffer2D(last_layer->OutputUnits, 1, ReturnType::Float, enabled);
 				delete[] enabled;
 			}
 		}
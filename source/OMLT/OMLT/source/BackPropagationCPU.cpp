@@ -0,0 +1,675 @@
+// std
+#include <string.h>
+#include <algorithm>
+#include <assert.h>
+#include <random>
+#include <mutex>
+
+// OMLT
+#include "BackPropagationCPU.h"
+#include "DataAtlasCPU.h"
+
+namespace OMLT
+{
+	BackPropagationCPU::BackPropagationCPU(const ModelConfig in_config, uint32_t in_minibatchsize, int32_t in_seed, uint32_t in_thread_count)
+		: _input_units(in_config.InputCount)
+		, _minibatch_size(in_minibatchsize)
+		, _thread_pool(in_thread_count)
+		, _seed(in_seed)
+	{
+		assert(in_config.LayerConfigs.size() > 0);
+		std::mt19937_64 random;
+		random.seed(static_cast<uint32_t>(in_seed));
+
+		_input = AllocateMatrix(_minibatch_size, _input_units);
+		_masked_input = AllocateMatrix(_minibatch_size, _input_units);
+
+		for(auto it = in_config.LayerConfigs.begin(); it < in_config.LayerConfigs.end(); ++it)
+		{
+			build_layer(*it, nullptr, random);
+			_training_config.Parameters.push_back(LayerParameters());
+		}
+
+		finish_layers();
+		SetTrainingConfig(_training_config);
+	}
+
+	BackPropagationCPU::BackPropagationCPU(MultilayerPerceptron* in_mlp, uint32_t in_minibatchsize, int32_t in_seed, uint32_t in_thread_count)
+		: _input_units(in_mlp->InputLayer()->inputs)
+		, _minibatch_size(in_minibatchsize)
+		, _thread_pool(in_thread_count)
+		, _seed(in_seed)
+	{
+		std::mt19937_64 random;
+		random.seed(static_cast<uint32_t>(in_seed));
+
+		_input = AllocateMatrix(_minibatch_size, _input_units);
+		_masked_input = AllocateMatrix(_minibatch_size, _input_units);
+
+		for(uint32_t k = 0; k < in_mlp->LayerCount(); k++)
+		{
+			MLP::Layer* layer = in_mlp->GetLayer(k);
+
+			LayerConfig layer_config;
+			{
+				layer_config.Function = layer->function;
+				layer_config.OutputUnits = layer->outputs;
+			}
+
+			// same format as BackPropagation
+			float* weight_buffer = new float[(layer->inputs + 1) * layer->outputs];
+
+			// copy weights from this layer in the MLP to the buffer
+			for(uint32_t j = 0; j < layer->outputs; j++)
+			{
+				// copy in biases
+				uint32_t offset = j * (layer->inputs + 1);
+				weight_buffer[offset] = layer->weights.biases()[j];
+				// and copy in weights
+				memcpy(weight_buffer + (offset + 1), layer->weights.feature(j), layer->inputs * sizeof(float));
+			}
+
+			build_layer(layer_config, weight_buffer, random);
+			delete[] weight_buffer;
+
+			_training_config.Parameters.push_back(LayerParameters());
+		}
+
+		finish_layers();
+		SetTrainingConfig(_training_config);
+	}
+
+	BackPropagationCPU::BackPropagationCPU(const BackPropagationCPU* in_owner, int32_t in_seed)
+		: _input_units(in_owner->_input_units)
+		, _minibatch_size(in_owner->_minibatch_size)
+		, _thread_pool(1)
+		, _seed(in_seed)
+	{
+		std::mt19937_64 random;
+		random.seed(static_cast<uint32_t>(in_seed));
+
+		_input = AllocateMatrix(_minibatch_size, _input_units);
+		_masked_input = AllocateMatrix(_minibatch_size, _input_units);
+
+		for(auto it = in_owner->_layers.begin(); it < in_owner->_layers.end(); ++it)
+		{
+			LayerConfig layer_config;
+			{
+				layer_config.Function = (*it)->Function;
+				layer_config.OutputUnits = (*it)->OutputUnits;
+			}
+
+			build_layer(layer_config, nullptr, random, *it);
+			_training_config.Parameters.push_back(LayerParameters());
+		}
+
+		finish_layers();
+		SetTrainingConfig(_training_config);
+	}
+
+	BackPropagationCPU::~BackPropagationCPU()
+	{
+		for(auto it = _hogwild_workers.begin(); it != _hogwild_workers.end(); ++it)
+		{
+			delete *it;
+		}
+
+		for(auto it = _layers.begin(); it < _layers.end(); ++it)
+		{
+			Layer* lay = *it;
+
+			FreeMatrix(lay->InputEnabled);
+			free(lay->InputRandom);
+			FreeMatrix(lay->Activation);
+			FreeMatrix(lay->MaskedActivation);
+			free(lay->OutputRandom);
+			FreeMatrix(lay->Sensitivities);
+			FreeMatrix(lay->WeightGradient);
+			FreeMatrix(lay->BiasGradient);
+
+			delete lay;
+		}
+
+		FreeMatrix(_input);
+		FreeMatrix(_masked_input);
+		FreeMatrix(_label);
+		FreeMatrix(_all_enabled);
+	}
+
+	void BackPropagationCPU::SetTrainingConfig(const TrainingConfig& in_config)
+	{
+		assert(in_config.Parameters.size() == _layers.size());
+
+		_training_config = in_config;
+		for(size_t k = 0; k < _layers.size(); k++)
+		{
+			const LayerParameters& params = _training_config.Parameters[k];
+			UpdateRule& rule = _layers[k]->Rule;
+
+			rule.LearningRate = params.LearningRate;
+			rule.Momentum = params.Momentum;
+			rule.L1Regularization = params.L1Regularization;
+			rule.L2Regularization = params.L2Regularization;
+			rule.AdadeltaDecay = params.AdadeltaDecay;
+		}
+	}
+
+	void BackPropagationCPU::Train(const float* example_input, const float* example_label)
+	{
+		assert(example_input != nullptr);
+		assert(example_label != nullptr);
+
+		Layer* last = _layers.back();
+		CopyToPadded(example_input, _minibatch_size, _input_units, _input, _layers.front()->InputStride);
+		CopyToPadded(example_label, _minibatch_size, last->OutputUnits, _label, last->OutputStride);
+
+		set_minibatch(_input, _label);
+		train_minibatch();
+	}
+
+	void BackPropagationCPU::Train(DataAtlasCPU& in_inputs, DataAtlasCPU& in_labels, uint32_t in_minibatches)
+	{
+		if(_training_config.Parallelism == Parallelism::Hogwild)
+		{
+			train_hogwild(in_inputs, in_labels, in_minibatches);
+			return;
+		}
+
+		// the atlases store rows at our padded strides, so train straight out of their pages
+		for(uint32_t k = 0; k < in_minibatches; k++)
+		{
+			const float* input;
+			const float* label;
+			uint32_t input_stride;
+			uint32_t label_stride;
+			in_inputs.Next(input, input_stride);
+			in_labels.Next(label, label_stride);
+			assert(input_stride == _layers.front()->InputStride);
+			assert(label_stride == _layers.back()->OutputStride);
+
+			set_minibatch(input, label);
+			train_minibatch();
+		}
+	}
+
+	void BackPropagationCPU::set_minibatch(const float* in_input, const float* in_label)
+	{
+		_layers.front()->Input = in_input;
+		_current_label = in_label;
+	}
+
+	void BackPropagationCPU::train_minibatch()
+	{
+		calc_enabled();
+		feed_forward();
+		calc_sensitivities();
+		update_weights();
+	}
+
+	void BackPropagationCPU::train_hogwild(DataAtlasCPU& in_inputs, DataAtlasCPU& in_labels, uint32_t in_minibatches)
+	{
+		if(_hogwild_workers.empty())
+		{
+			for(uint32_t k = 0; k < _thread_pool.ThreadCount(); k++)
+			{
+				// every worker needs its own dropout and noise seeds
+				_hogwild_workers.push_back(new BackPropagationCPU(this, _seed + int32_t(k + 1)));
+			}
+		}
+
+		for(auto it = _hogwild_workers.begin(); it != _hogwild_workers.end(); ++it)
+		{
+			(*it)->SetTrainingConfig(_training_config);
+		}
+
+		const Layer* first = _layers.front();
+		const Layer* last = _layers.back();
+		std::mutex atlas_mutex;
+		uint32_t next_minibatch = 0;
+
+		_thread_pool.ParallelFor((uint32_t)_hogwild_workers.size(), [&](uint32_t begin, uint32_t end)
+		{
+			for(uint32_t w = begin; w < end; w++)
+			{
+				BackPropagationCPU* worker = _hogwild_workers[w];
+				for(;;)
+				{
+					{
+						// the atlas' minibatches are only valid until the next call to Next, which another
+						// worker makes while this one trains, so they are copied out before anyone else
+						// gets the atlases
+						std::lock_guard<std::mutex> lock(atlas_mutex);
+						if(next_minibatch == in_minibatches)
+						{
+							break;
+						}
+						next_minibatch++;
+
+						const float* input;
+						const float* label;
+						uint32_t input_stride;
+						uint32_t label_stride;
+						in_inputs.Next(input, input_stride);
+						in_labels.Next(label, label_stride);
+						assert(input_stride == first->InputStride);
+						assert(label_stride == last->OutputStride);
+						memcpy(worker->_input, input, sizeof(float) * _minibatch_size * input_stride);
+						memcpy(worker->_label, label, sizeof(float) * _minibatch_size * label_stride);
+					}
+
+					worker->set_minibatch(worker->_input, worker->_label);
+					worker->train_minibatch();
+				}
+			}
+		});
+	}
+
+	float BackPropagationCPU::GetLastOutputError()
+	{
+		Layer* last = _layers.back();
+		return CalcError(last->Activation, _current_label, _minibatch_size, last->OutputUnits, last->OutputStride, _error_function);
+	}
+
+	float BackPropagationCPU::GetOutputError(const float* example_input, const float* example_output)
+	{
+		assert(example_input != nullptr);
+		assert(example_output != nullptr);
+
+		Layer* last = _layers.back();
+		CopyToPadded(example_input, _minibatch_size, _input_units, _input, _layers.front()->InputStride);
+		CopyToPadded(example_output, _minibatch_size, last->OutputUnits, _label, last->OutputStride);
+		set_minibatch(_input, _label);
+
+		calc_enabled();
+		feed_forward();
+
+		return GetLastOutputError();
+	}
+
+	void BackPropagationCPU::calc_enabled()
+	{
+		for(size_t k = 0; k < _layers.size(); k++)
+		{
+			Layer* lay = _layers[k];
+			const float dropout = _training_config.Parameters[k].Dropout;
+
+			for(uint32_t i = 0; i < lay->InputUnits; i++)
+			{
+				const float prob = NextFloat(lay->InputRandom + i * 4);
+				lay->InputEnabled[i] = prob > dropout ? 1.0f : 0.0f;
+			}
+		}
+
+		// apply first layer's dropout to the input
+		Layer* first = _layers.front();
+		for(uint32_t m = 0; m < _minibatch_size; m++)
+		{
+			const float* src = first->Input + m * first->InputStride;
+			float* dest = _masked_input + m * first->InputStride;
+			for(uint32_t i = 0; i < first->InputStride; i += 4)
+			{
+				_mm_store_ps(dest + i, _mm_mul_ps(_mm_load_ps(src + i), _mm_load_ps(first->InputEnabled + i)));
+			}
+		}
+	}
+
+	void BackPropagationCPU::feed_forward()
+	{
+		for(size_t k = 0; k < _layers.size(); k++)
+		{
+			Layer* lay = _layers[k];
+			const LayerParameters& params = _training_config.Parameters[k];
+
+			// take input dropout into account
+			const float scale = 1.0f / (1.0f - params.Dropout);
+			const float noise_stddev = params.Noise;
+			const ActivationFunction_t function = lay->Function;
+			const float* biases = lay->Biases.nesterov(0);
+			// the next layer's dropout is applied here so it can read its input directly
+			const float* next_enabled = lay->NextLayer != nullptr ? lay->NextLayer->InputEnabled : nullptr;
+
+			// bias, noise, activation and dropout, applied to each block of activations as the multiply stores it
+			const MatrixEpilogue epilogue = [&](float* io_activation, uint32_t m, uint32_t n, uint32_t count)
+			{
+				float* masked_activation = lay->MaskedActivation + m * lay->OutputStride;
+				for(uint32_t j = n; j < n + count; j++)
+				{
+					float accumulation = io_activation[j - n] + biases[j];
+
+					// add noise if required
+					if(noise_stddev != 0.0f)
+					{
+						accumulation += NextGaussian(lay->OutputRandom + (m * lay->OutputUnits + j) * 4) * noise_stddev;
+					}
+
+					const float activation = CalcActivation(function, accumulation);
+					io_activation[j - n] = activation;
+					if(next_enabled != nullptr && function != ActivationFunction::Softmax)
+					{
+						masked_activation[j] = activation * next_enabled[j];
+					}
+				}
+			};
+
+			_thread_pool.ParallelFor(BlockCount(lay->OutputUnits), [&](uint32_t begin, uint32_t end)
+			{
+				const uint32_t j_begin = begin * 4;
+				const uint32_t j_end = std::min(end * 4, lay->OutputUnits);
+
+				MatrixMultiplyNT(lay->MaskedInput, lay->InputStride, lay->Weights.Nesterov, lay->Weights.Stride, lay->Activation, lay->OutputStride, _minibatch_size, j_begin, j_end, lay->InputUnits, scale, epilogue);
+			});
+
+			if(function == ActivationFunction::Softmax)
+			{
+				_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+				{
+					for(uint32_t m = begin; m < end; m++)
+					{
+						float* activation = lay->Activation + m * lay->OutputStride;
+						float* masked_activation = lay->MaskedActivation + m * lay->OutputStride;
+
+						CalcSoftmax(activation, lay->OutputUnits);
+						if(next_enabled != nullptr)
+						{
+							for(uint32_t j = 0; j < lay->OutputUnits; j++)
+							{
+								masked_activation[j] = activation[j] * next_enabled[j];
+							}
+						}
+					}
+				});
+			}
+		}
+	}
+
+	void BackPropagationCPU::calc_sensitivities()
+	{
+		// top layer
+		{
+			Layer* lay = _layers.back();
+			const ActivationFunction_t function = lay->Function;
+
+			_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t m = begin; m < end; m++)
+				{
+					const float* label = _current_label + m * lay->OutputStride;
+					const float* activation = lay->Activation + m * lay->OutputStride;
+					float* sensitivities = lay->Sensitivities + m * lay->OutputStride;
+					for(uint32_t j = 0; j < lay->OutputUnits; j++)
+					{
+						const float diff = label[j] - activation[j];
+						if(function == ActivationFunction::Softmax)
+						{
+							// cross entropy error
+							sensitivities[j] = diff;
+						}
+						else
+						{
+							// squared error
+							sensitivities[j] = diff * CalcActivationPrime(function, activation[j]);
+						}
+					}
+				}
+			});
+		}
+
+		// feed backward
+		for(auto it = _layers.rbegin() + 1; it != _layers.rend(); ++it)
+		{
+			Layer* lay = *it;
+			Layer* next = lay->NextLayer;
+			const ActivationFunction_t function = lay->Function;
+
+			_thread_pool.ParallelFor(BlockCount(lay->OutputUnits), [&](uint32_t begin, uint32_t end)
+			{
+				const uint32_t j_begin = begin * 4;
+				const uint32_t j_end = end * 4;
+				const uint32_t j_last = std::min(j_end, lay->OutputUnits);
+
+				// no need to check for enabled outputs, since their sensitivities will be 0.0f
+				MatrixMultiplyNN(next->Sensitivities, next->OutputStride, next->Weights.Nesterov, next->Weights.Stride, lay->Sensitivities, lay->OutputStride, _minibatch_size, j_begin, j_end, next->OutputUnits, 1.0f, false);
+
+				for(uint32_t m = 0; m < _minibatch_size; m++)
+				{
+					const float* activation = lay->Activation + m * lay->OutputStride;
+					float* sensitivities = lay->Sensitivities + m * lay->OutputStride;
+					for(uint32_t j = j_begin; j < j_last; j++)
+					{
+						sensitivities[j] = lay->OutputEnabled[j] == 1.0f ? sensitivities[j] * CalcActivationPrime(function, activation[j]) : 0.0f;
+					}
+				}
+			});
+		}
+	}
+
+	void BackPropagationCPU::update_weights()
+	{
+		const float inv_minibatch = 1.0f / float(_minibatch_size);
+
+		for(auto it = _layers.rbegin(); it != _layers.rend(); ++it)
+		{
+			Layer* lay = *it;
+
+			// weights: sum over the minibatch of d_k * y_j, applied while the gradient rows are still in cache
+			_thread_pool.ParallelFor(BlockCount(lay->OutputUnits), [&](uint32_t begin, uint32_t end)
+			{
+				const uint32_t k_begin = begin * 4;
+				const uint32_t k_end = std::min(end * 4, lay->OutputUnits);
+
+				// dropped out inputs are zero here, but their weights are held by UpdateRow anyway
+				MatrixMultiplyTN(lay->Sensitivities, lay->OutputStride, lay->MaskedInput, lay->InputStride, lay->WeightGradient, lay->Weights.Stride, _minibatch_size, k_begin, k_end, lay->InputStride, 1.0f, false);
+
+				for(uint32_t k = k_begin; k < k_end; k++)
+				{
+					if(lay->OutputEnabled[k] == 1.0f)
+					{
+						lay->Weights.UpdateRow(lay->Rule, k, lay->WeightGradient + k * lay->Weights.Stride, inv_minibatch, lay->InputEnabled, true);
+					}
+					else
+					{
+						lay->Weights.HoldRow(lay->Rule, k);
+					}
+				}
+			});
+
+			// biases: sum over the minibatch of d_k
+			memset(lay->BiasGradient, 0x00, sizeof(float) * lay->OutputStride);
+			for(uint32_t m = 0; m < _minibatch_size; m++)
+			{
+				const float* sensitivities = lay->Sensitivities + m * lay->OutputStride;
+				for(uint32_t k = 0; k < lay->OutputStride; k += 4)
+				{
+					_mm_store_ps(lay->BiasGradient + k, _mm_add_ps(_mm_load_ps(lay->BiasGradient + k), _mm_load_ps(sensitivities + k)));
+				}
+			}
+			lay->Biases.UpdateRow(lay->Rule, 0, lay->BiasGradient, inv_minibatch, lay->OutputEnabled, false);
+		}
+	}
+
+	extern uint32_t* GetSeedBuffer(uint32_t, uint32_t, std::mt19937_64&);
+	void BackPropagationCPU::build_layer(LayerConfig in_config, float* in_weights, std::mt19937_64& random, const Layer* in_owner)
+	{
+		Layer* result = new Layer();
+
+		result->InputUnits = _layers.size() == 0 ? _input_units : _layers.back()->OutputUnits;
+		result->OutputUnits = in_config.OutputUnits;
+		result->InputStride = BlockCount(result->InputUnits) * 4;
+		result->OutputStride = BlockCount(result->OutputUnits) * 4;
+		result->Function = in_config.Function;
+
+		if(_layers.size() == 0)
+		{
+			result->Input = _input;
+			result->MaskedInput = _masked_input;
+		}
+		else
+		{
+			result->Input = _layers.back()->Activation;
+			result->MaskedInput = _layers.back()->MaskedActivation;
+		}
+
+		// init input random, same order as BackPropagation
+		result->InputEnabled = AllocateMatrix(1, result->InputUnits);
+		result->InputRandom = GetSeedBuffer(result->InputUnits * 4, 1, random);
+
+		// init weights
+		if(in_owner != nullptr)
+		{
+			result->Weights.Share(in_owner->Weights);
+			result->Biases.Share(in_owner->Biases);
+		}
+		else if(in_weights == nullptr)
+		{
+			result->Weights.Allocate(result->OutputUnits, result->InputUnits);
+			result->Biases.Allocate(1, result->OutputUnits);
+
+			float weight_stdev = float(1.0 / std::sqrt((float)(result->InputUnits)));
+			std::normal_distribution<float> normal(0.0f, weight_stdev);
+
+			// biases are always initialized to 0
+			for(uint32_t j = 0; j < result->OutputUnits; j++)
+			{
+				float* w_j = result->Weights.weights(j);
+				for(uint32_t i = 0; i < result->InputUnits; i++)
+				{
+					w_j[i] = normal(random);
+				}
+			}
+		}
+		else
+		{
+			result->Weights.Allocate(result->OutputUnits, result->InputUnits);
+			result->Biases.Allocate(1, result->OutputUnits);
+
+			// j rows, each containing i + 1 values, first value in each row is bias
+			const float* head = in_weights;
+			for(uint32_t j = 0; j < result->OutputUnits; j++)
+			{
+				result->Biases.weights(0)[j] = head[0];
+				memcpy(result->Weights.weights(j), head + 1, sizeof(float) * result->InputUnits);
+				head += result->InputUnits + 1;
+			}
+		}
+
+		if(in_owner == nullptr)
+		{
+			result->Weights.ResetNesterov();
+			result->Biases.ResetNesterov();
+		}
+
+		if(_layers.size() > 0)
+		{
+			_layers.back()->OutputEnabled = result->InputEnabled;
+		}
+		result->OutputEnabled = nullptr;
+
+		// now init our output related buffers
+		result->Activation = AllocateMatrix(_minibatch_size, result->OutputUnits);
+		result->MaskedActivation = AllocateMatrix(_minibatch_size, result->OutputUnits);
+		result->OutputRandom = GetSeedBuffer(result->OutputUnits * 4, _minibatch_size, random);
+
+		// sensitivites and gradients
+		result->Sensitivities = AllocateMatrix(_minibatch_size, result->OutputUnits);
+		result->WeightGradient = AllocateMatrix(result->OutputUnits, result->InputUnits);
+		result->BiasGradient = AllocateMatrix(1, result->OutputUnits);
+
+		result->NextLayer = nullptr;
+		if(_layers.size() > 0)
+		{
+			_layers.back()->NextLayer = result;
+		}
+
+		// finally, append our newly created layer to the list
+		_layers.push_back(result);
+	}
+
+	void BackPropagationCPU::finish_layers()
+	{
+		Layer* last = _layers.back();
+
+		// the last layer is always all enabled
+		_all_enabled = AllocateMatrix(1, last->OutputUnits);
+		for(uint32_t j = 0; j < last->OutputUnits; j++)
+		{
+			_all_enabled[j] = 1.0f;
+		}
+		last->OutputEnabled = _all_enabled;
+
+		_label = AllocateMatrix(_minibatch_size, last->OutputUnits);
+		_current_label = _label;
+
+		_error_function = last->Function == ActivationFunction::Softmax ? ErrorFunction::CrossEntropy : ErrorFunction::SquareError;
+	}
+
+	MultilayerPerceptron* BackPropagationCPU::GetMultilayerPerceptron() const
+	{
+		return GetMultilayerPerceptron(0, _layers.size() - 1);
+	}
+
+	MultilayerPerceptron* BackPropagationCPU::GetMultilayerPerceptron(uint32_t begin_layer, uint32_t end_layer) const
+	{
+		assert(begin_layer < _layers.size() && end_layer < _layers.size());
+		assert(begin_layer <= end_layer);
+
+		MultilayerPerceptron* result = new MultilayerPerceptron();
+
+		for(uint32_t k = begin_layer; k <= end_layer; k++)
+		{
+			const Layer* bp_layer = _layers[k];
+
+			MultilayerPerceptron::Layer* layer = new MultilayerPerceptron::Layer(bp_layer->InputUnits, bp_layer->OutputUnits, bp_layer->Function);
+			memcpy(layer->weights.biases(), bp_layer->Biases.weights(0), sizeof(float) * layer->outputs);
+			for(uint32_t j = 0; j < layer->outputs; j++)
+			{
+				memcpy(layer->weights.feature(j), bp_layer->Weights.weights(j), sizeof(float) * layer->inputs);
+			}
+
+			bool added = result->AddLayer(layer);
+			assert(added == true);
+		}
+
+		return result;
+	}
+
+	bool BackPropagationCPU::DumpLastLabel(float** label)
+	{
+		Layer* last = _layers.back();
+		CopyFromPadded(_current_label, _minibatch_size, last->OutputUnits, last->OutputStride, *label);
+		return true;
+	}
+
+	bool BackPropagationCPU::DumpInput(uint32_t layer, float** input)
+	{
+		assert(layer < _layers.size());
+
+		Layer* lay = _layers[layer];
+		CopyFromPadded(lay->Input, _minibatch_size, lay->InputUnits, lay->InputStride, *input);
+		return true;
+	}
+
+	bool BackPropagationCPU::DumpActivation(uint32_t layer, float** output)
+	{
+		assert(layer < _layers.size());
+
+		Layer* lay = _layers[layer];
+		CopyFromPadded(lay->Activation, _minibatch_size, lay->OutputUnits, lay->OutputStride, *output);
+		return true;
+	}
+
+	bool BackPropagationCPU::DumpWeightMatrix(uint32_t layer, float** weights)
+	{
+		assert(layer < _layers.size());
+
+		// j rows, each containing i + 1 values, first value in each row is bias
+		Layer* lay = _layers[layer];
+		float* head = *weights;
+		for(uint32_t j = 0; j < lay->OutputUnits; j++)
+		{
+			head[0] = lay->Biases.weights(0)[j];
+			memcpy(head + 1, lay->Weights.weights(j), sizeof(float) * lay->InputUnits);
+			head += lay->InputUnits + 1;
+		}
+		return true;
+	}
+}
\ No newline at end of file
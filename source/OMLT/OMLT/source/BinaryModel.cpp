@@ -0,0 +1,210 @@
+// std
+#include <string.h>
+#include <assert.h>
+
+// windows
+#ifndef NOMINMAX
+#	define NOMINMAX
+#endif
+#include <windows.h>
+
+// extern
+#include <cppJSONStream.hpp>
+using namespace cppJSONStream;
+
+// OMLT
+#include "BinaryModel.h"
+#include "Common.h"
+
+namespace OMLT
+{
+	static const char Magic[4] = {'O', 'M', 'L', 'T'};
+
+	// rounds in_bytes up to the next multiple of BinaryModel::Alignment
+	static uint64_t AlignBytes(uint64_t in_bytes)
+	{
+		return (in_bytes + BinaryModel::Alignment - 1) / BinaryModel::Alignment * BinaryModel::Alignment;
+	}
+
+	// bytes in the bias and weight buffers of a FeatureMap, including the padding features
+	static uint64_t BiasBytes(uint32_t in_feature_count)
+	{
+		return uint64_t(BlockCount(in_feature_count)) * 4 * sizeof(float);
+	}
+
+	static uint64_t WeightBytes(uint32_t in_input_length, uint32_t in_feature_count)
+	{
+		return BiasBytes(in_feature_count) * FeatureMap::Stride(in_input_length);
+	}
+
+	/// MappedFile
+
+	MappedFile::MappedFile()
+		: _mapping(nullptr)
+		, _data(nullptr)
+		, _size(0)
+		, _references(1)
+	{ }
+
+	MappedFile::~MappedFile()
+	{
+		if(_data)
+		{
+			UnmapViewOfFile(_data);
+		}
+		if(_mapping)
+		{
+			CloseHandle(_mapping);
+		}
+	}
+
+	MappedFile* MappedFile::Open(const char* in_filename)
+	{
+		HANDLE file = CreateFileA(in_filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(file == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+
+		MappedFile* result = new MappedFile();
+
+		LARGE_INTEGER size;
+		if(GetFileSizeEx(file, &size) == FALSE || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			delete result;
+			return nullptr;
+		}
+		result->_size = size.QuadPart;
+
+		// the mapping holds its own reference to the file
+		result->_mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		CloseHandle(file);
+		if(result->_mapping == NULL)
+		{
+			delete result;
+			return nullptr;
+		}
+
+		result->_data = (uint8_t*)MapViewOfFile(result->_mapping, FILE_MAP_COPY, 0, 0, 0);
+		if(result->_data == NULL)
+		{
+			delete result;
+			return nullptr;
+		}
+
+		return result;
+	}
+
+	void MappedFile::Release()
+	{
+		assert(_references > 0);
+		if(--_references == 0)
+		{
+			delete this;
+		}
+	}
+
+	namespace BinaryModel
+	{
+		/// Writer
+
+		void Writer::WriteFeatureMap(cppJSONStream::Writer& header, const FeatureMap& in_map)
+		{
+			Block biases = {in_map.biases(), size_t(BiasBytes(in_map.feature_count))};
+			Block weights = {in_map.weights(), size_t(WeightBytes(in_map.input_length, in_map.feature_count))};
+
+			header.begin_object();
+				header.write_namevalue("Stride", (uint64_t)in_map.feature_stride);
+				header.write_namevalue("Biases", _data_size);
+				_data_size += AlignBytes(biases.bytes);
+				header.write_namevalue("Weights", _data_size);
+				_data_size += AlignBytes(weights.bytes);
+			header.end_object();
+
+			_blocks.push_back(biases);
+			_blocks.push_back(weights);
+		}
+
+		void Writer::Write(std::ostream& stream, const std::string& in_header) const
+		{
+			static const char padding[Alignment] = {0};
+
+			const uint32_t preamble[3] = {Version, uint32_t(in_header.size()), 0};
+			stream.write(Magic, sizeof(Magic));
+			stream.write((const char*)preamble, sizeof(preamble));
+
+			stream.write(in_header.data(), in_header.size());
+			const uint64_t header_end = PreambleSize + in_header.size();
+			stream.write(padding, std::streamsize(AlignBytes(header_end) - header_end));
+
+			for(size_t k = 0; k < _blocks.size(); k++)
+			{
+				stream.write((const char*)_blocks[k].data, _blocks[k].bytes);
+				stream.write(padding, std::streamsize(AlignBytes(_blocks[k].bytes) - _blocks[k].bytes));
+			}
+		}
+
+		/// Reader
+
+		bool Reader::Open(MappedFile* in_file)
+		{
+			_file = in_file;
+
+			const uint8_t* head = _file->Data();
+			if(_file->Size() < PreambleSize || memcmp(head, Magic, sizeof(Magic)) != 0)
+			{
+				return false;
+			}
+
+			uint32_t version, header_size;
+			memcpy(&version, head + 4, sizeof(version));
+			memcpy(&header_size, head + 8, sizeof(header_size));
+
+			const uint64_t data_begin = AlignBytes(uint64_t(PreambleSize) + header_size);
+			if(version != Version || data_begin > _file->Size())
+			{
+				return false;
+			}
+
+			_header.str(std::string((const char*)head + PreambleSize, header_size));
+			_data = _file->Data() + data_begin;
+			_data_size = _file->Size() - data_begin;
+
+			return true;
+		}
+
+		bool Reader::ReadFeatureMap(cppJSONStream::Reader& r, uint32_t in_input_length, uint32_t in_feature_count, MappedFeatureMap& out_map)
+		{
+			SetReader(r);
+			SetErrorResult(false);
+
+			TryGetNameValuePair("Stride", Token::Number);
+			const uint64_t stride = r.readUInt();
+			TryGetNameValuePair("Biases", Token::Number);
+			const uint64_t biases = r.readUInt();
+			TryGetNameValuePair("Weights", Token::Number);
+			const uint64_t weights = r.readUInt();
+			TryGetToken(Token::EndObject);
+
+			const uint64_t bias_bytes = BiasBytes(in_feature_count);
+			const uint64_t weight_bytes = WeightBytes(in_input_length, in_feature_count);
+
+			// the blocks have to be laid out the way FeatureMap expects, and lie within the file
+			if(stride != FeatureMap::Stride(in_input_length) ||
+			   biases % Alignment != 0 ||
+			   weights % Alignment != 0 ||
+			   biases > _data_size || bias_bytes > _data_size - biases ||
+			   weights > _data_size || weight_bytes > _data_size - weights)
+			{
+				return false;
+			}
+
+			out_map.file = _file;
+			out_map.biases = (float*)(_data + biases);
+			out_map.weights = (float*)(_data + weights);
+
+			return true;
+		}
+	}
+}
\ No newline at end of file
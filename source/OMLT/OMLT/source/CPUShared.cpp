@@ -0,0 +1,839 @@
+// std
+#include <string.h>
+#include <float.h>
+#include <algorithm>
+
+// windows
+#include <intrin.h>
+
+// OMLT
+#include "CPUShared.h"
+#include "SIMD.h"
+
+namespace OMLT
+{
+	/// Thread Pool
+
+	ThreadPool::ThreadPool(uint32_t in_thread_count)
+		: _thread_count(in_thread_count)
+		, _generation(0)
+		, _busy_workers(0)
+		, _shutdown(false)
+		, _func(nullptr)
+		, _count(0)
+		, _grain(1)
+	{
+		if(_thread_count == 0)
+		{
+			_thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		_next = 0;
+
+		// the calling thread does its share of each job, so we need one less
+		for(uint32_t k = 1; k < _thread_count; k++)
+		{
+			_workers.push_back(std::thread(&ThreadPool::worker_main, this));
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_shutdown = true;
+		}
+		_job_ready.notify_all();
+
+		for(auto it = _workers.begin(); it != _workers.end(); ++it)
+		{
+			it->join();
+		}
+	}
+
+	void ThreadPool::ParallelFor(uint32_t in_count, const std::function<void(uint32_t, uint32_t)>& in_func)
+	{
+		if(in_count == 0)
+		{
+			return;
+		}
+		else if(_workers.empty() || in_count == 1)
+		{
+			in_func(0, in_count);
+			return;
+		}
+
+		// hand out a few ranges per thread so uneven work still balances out
+		uint32_t grain = in_count / (_thread_count * 4);
+		if(grain == 0)
+		{
+			grain = 1;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_func = &in_func;
+			_count = in_count;
+			_grain = grain;
+			_next = 0;
+			_busy_workers = (uint32_t)_workers.size();
+			_generation++;
+		}
+		_job_ready.notify_all();
+
+		run_ranges();
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		while(_busy_workers > 0)
+		{
+			_job_done.wait(lock);
+		}
+		_func = nullptr;
+	}
+
+	void ThreadPool::worker_main()
+	{
+		uint64_t last_generation = 0;
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				while(_shutdown == false && _generation == last_generation)
+				{
+					_job_ready.wait(lock);
+				}
+
+				if(_shutdown)
+				{
+					return;
+				}
+				last_generation = _generation;
+			}
+
+			run_ranges();
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if(--_busy_workers == 0)
+				{
+					_job_done.notify_one();
+				}
+			}
+		}
+	}
+
+	void ThreadPool::run_ranges()
+	{
+		for(;;)
+		{
+			const uint32_t begin = _next.fetch_add(_grain);
+			if(begin >= _count)
+			{
+				break;
+			}
+			(*_func)(begin, std::min(begin + _grain, _count));
+		}
+	}
+
+	/// Random Numbers
+
+	void NextSeed(uint32_t* io_seed)
+	{
+		uint32_t t = io_seed[0] ^ (io_seed[0] << 11u);
+		io_seed[0] = io_seed[1];
+		io_seed[1] = io_seed[2];
+		io_seed[2] = io_seed[3];
+		io_seed[3] = io_seed[3] ^ (io_seed[3] >> 19u) ^ t ^ (t >> 8u);
+	}
+
+	float NextFloat(uint32_t* io_seed)
+	{
+		NextSeed(io_seed);
+
+		// top 24 bits
+		uint32_t next24 = io_seed[0] >> 8u;
+
+		return (float)next24 / (float)(1 << 24);
+	}
+
+	float NextGaussian(uint32_t* io_seed)
+	{
+		float u1 = std::max(NextFloat(io_seed), 0.00000005960464478f);
+		float u2 = NextFloat(io_seed);
+
+		// calculate a normally distributed variable
+		const float PI = 3.14159265359f;
+		return std::sqrt(-2.0f * std::log(u1)) * std::sin(2.0f * PI * u2);
+	}
+
+	/// Activation Functions
+
+	float CalcActivation(ActivationFunction_t in_func, float in_accumulation)
+	{
+		assert(in_func == ActivationFunction::Linear ||
+		       in_func == ActivationFunction::Sigmoid ||
+		       in_func == ActivationFunction::RectifiedLinear ||
+		       in_func == ActivationFunction::Softmax);
+
+		switch(in_func)
+		{
+		case ActivationFunction::Softmax:
+		case ActivationFunction::Linear:
+			return in_accumulation;
+		case ActivationFunction::Sigmoid:
+			return Sigmoid(in_accumulation);
+		case ActivationFunction::RectifiedLinear:
+			return std::max(in_accumulation, 0.0f);
+		}
+
+		return 0.0f;
+	}
+
+	float CalcActivationPrime(ActivationFunction_t in_func, float in_activation)
+	{
+		assert(in_func == ActivationFunction::Linear ||
+		       in_func == ActivationFunction::Sigmoid ||
+		       in_func == ActivationFunction::RectifiedLinear ||
+		       in_func == ActivationFunction::Softmax);
+
+		switch(in_func)
+		{
+		case ActivationFunction::Linear:
+			return 1.0f;
+		case ActivationFunction::Sigmoid:
+		case ActivationFunction::Softmax:
+			return (1.0f - in_activation) * in_activation;
+		case ActivationFunction::RectifiedLinear:
+			return in_activation > 0.0f ? 1.0f : 0.0f;
+		}
+
+		return 0.0f;
+	}
+
+	void CalcSoftmax(float* io_row, uint32_t in_length)
+	{
+		// first we need to find the max activation (for numerical stability)
+		float max = -FLT_MAX;
+		for(uint32_t k = 0; k < in_length; k++)
+		{
+			max = std::max(max, io_row[k]);
+		}
+
+		// calculate the denominator
+		float denominator = 0.0f;
+		for(uint32_t k = 0; k < in_length; k++)
+		{
+			io_row[k] = std::exp(io_row[k] - max);
+			denominator += io_row[k];
+		}
+
+		const float inv_denominator = 1.0f / denominator;
+		for(uint32_t k = 0; k < in_length; k++)
+		{
+			io_row[k] *= inv_denominator;
+		}
+	}
+
+	/// Matrix Methods
+
+	float* AllocateMatrix(uint32_t in_rows, uint32_t in_columns)
+	{
+		const size_t bytes = size_t(in_rows) * BlockCount(in_columns) * 4 * sizeof(float);
+		float* result = (float*)AlignedMalloc(bytes, 16);
+		memset(result, 0x00, bytes);
+		return result;
+	}
+
+	void FreeMatrix(float*& io_matrix)
+	{
+		if(io_matrix != nullptr)
+		{
+			AlignedFree(io_matrix);
+			io_matrix = nullptr;
+		}
+	}
+
+	void CopyToPadded(const float* in_source, uint32_t in_rows, uint32_t in_columns, float* out_dest, uint32_t in_dest_stride)
+	{
+		for(uint32_t m = 0; m < in_rows; m++)
+		{
+			memcpy(out_dest + m * in_dest_stride, in_source + m * in_columns, sizeof(float) * in_columns);
+		}
+	}
+
+	void CopyFromPadded(const float* in_source, uint32_t in_rows, uint32_t in_columns, uint32_t in_source_stride, float* out_dest)
+	{
+		for(uint32_t m = 0; m < in_rows; m++)
+		{
+			memcpy(out_dest + m * in_columns, in_source + m * in_source_stride, sizeof(float) * in_columns);
+		}
+	}
+
+	// CPUSharedAVX2.cpp
+	namespace AVX2
+	{
+		void MatrixMultiplyNT(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate, const MatrixEpilogue* epilogue);
+		void MatrixMultiplyNN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate);
+		void MatrixMultiplyTN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t P, float alpha, bool accumulate);
+	}
+
+	/*
+	 * The SSE matrix kernels below are blocked so that a tile of B stays resident in
+	 * L1/L2 while every row of A streams past it, and the inner loops work on a
+	 * 2 row register tile so each load from B feeds two multiply-adds.  Callers
+	 * divide the output across threads by handing each one a range of n.
+	 *
+	 * On AVX2 machines the AVX2 versions are used instead (see SetSIMDLevel).
+	 */
+
+	// number of B rows (NT) or B columns (NN, TN) in a cache tile
+	static const uint32_t TileSize = 64;
+
+	// stores [sum(x0), sum(x1), sum(x2), sum(x3)] * alpha to the first count entries of c
+	static inline void store_dot4(float* c, uint32_t count, __m128 x0, __m128 x1, __m128 x2, __m128 x3, __m128 alpha, bool accumulate)
+	{
+		__m128 dp = _mm_hadd_ps(_mm_hadd_ps(x0, x1), _mm_hadd_ps(x2, x3));
+		dp = _mm_mul_ps(dp, alpha);
+
+		if(count == 4)
+		{
+			if(accumulate)
+			{
+				dp = _mm_add_ps(dp, _mm_loadu_ps(c));
+			}
+			_mm_storeu_ps(c, dp);
+		}
+		else
+		{
+			float temp[4];
+			_mm_storeu_ps(temp, dp);
+			for(uint32_t r = 0; r < count; r++)
+			{
+				c[r] = accumulate ? c[r] + temp[r] : temp[r];
+			}
+		}
+	}
+
+	static inline void store_block(float* c, __m128 x, __m128 alpha, bool accumulate)
+	{
+		x = _mm_mul_ps(x, alpha);
+		if(accumulate)
+		{
+			x = _mm_add_ps(x, _mm_load_ps(c));
+		}
+		_mm_store_ps(c, x);
+	}
+
+	static void matrix_multiply_nt_sse(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate, const MatrixEpilogue* epilogue)
+	{
+		const uint32_t K4 = BlockCount(K) * 4;
+		const __m128 alpha4 = _mm_set_ps1(alpha);
+
+		for(uint32_t n0 = n_begin; n0 < n_end; n0 += TileSize)
+		{
+			const uint32_t n1 = std::min(n0 + TileSize, n_end);
+			for(uint32_t m = 0; m < M; m += 2)
+			{
+				// an odd trailing row of A is just computed twice and the second result discarded
+				const bool pair = (m + 1) < M;
+				const float* a0 = A + m * lda;
+				const float* a1 = pair ? a0 + lda : a0;
+				float* c0 = C + m * ldc;
+				float* c1 = c0 + ldc;
+
+				for(uint32_t n = n0; n < n1; n += 4)
+				{
+					// rows of B past n1 are clamped to the last valid row, their results are discarded
+					const uint32_t count = std::min(4u, n1 - n);
+					const float* b0 = B + n * ldb;
+					const float* b1 = B + (n + std::min(1u, count - 1)) * ldb;
+					const float* b2 = B + (n + std::min(2u, count - 1)) * ldb;
+					const float* b3 = B + (n + std::min(3u, count - 1)) * ldb;
+
+					__m128 acc00 = _mm_setzero_ps(), acc01 = _mm_setzero_ps(), acc02 = _mm_setzero_ps(), acc03 = _mm_setzero_ps();
+					__m128 acc10 = _mm_setzero_ps(), acc11 = _mm_setzero_ps(), acc12 = _mm_setzero_ps(), acc13 = _mm_setzero_ps();
+
+					for(uint32_t k = 0; k < K4; k += 4)
+					{
+						const __m128 va0 = _mm_load_ps(a0 + k);
+						const __m128 va1 = _mm_load_ps(a1 + k);
+
+						__m128 vb = _mm_load_ps(b0 + k);
+						acc00 = _mm_add_ps(acc00, _mm_mul_ps(va0, vb));
+						acc10 = _mm_add_ps(acc10, _mm_mul_ps(va1, vb));
+
+						vb = _mm_load_ps(b1 + k);
+						acc01 = _mm_add_ps(acc01, _mm_mul_ps(va0, vb));
+						acc11 = _mm_add_ps(acc11, _mm_mul_ps(va1, vb));
+
+						vb = _mm_load_ps(b2 + k);
+						acc02 = _mm_add_ps(acc02, _mm_mul_ps(va0, vb));
+						acc12 = _mm_add_ps(acc12, _mm_mul_ps(va1, vb));
+
+						vb = _mm_load_ps(b3 + k);
+						acc03 = _mm_add_ps(acc03, _mm_mul_ps(va0, vb));
+						acc13 = _mm_add_ps(acc13, _mm_mul_ps(va1, vb));
+					}
+
+					store_dot4(c0 + n, count, acc00, acc01, acc02, acc03, alpha4, accumulate);
+					if(epilogue)
+					{
+						(*epilogue)(c0 + n, m, n, count);
+					}
+					if(pair)
+					{
+						store_dot4(c1 + n, count, acc10, acc11, acc12, acc13, alpha4, accumulate);
+						if(epilogue)
+						{
+							(*epilogue)(c1 + n, m + 1, n, count);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	static void matrix_multiply_nn_sse(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate)
+	{
+		assert(n_begin % 4 == 0);
+		assert(n_end % 4 == 0);
+
+		const __m128 alpha4 = _mm_set_ps1(alpha);
+
+		for(uint32_t n0 = n_begin; n0 < n_end; n0 += TileSize)
+		{
+			const uint32_t n1 = std::min(n0 + TileSize, n_end);
+			for(uint32_t m = 0; m < M; m += 2)
+			{
+				const bool pair = (m + 1) < M;
+				const float* a0 = A + m * lda;
+				const float* a1 = pair ? a0 + lda : a0;
+				float* c0 = C + m * ldc;
+				float* c1 = c0 + ldc;
+
+				uint32_t n = n0;
+				// 2 x 16 register tile
+				for(; n + 16 <= n1; n += 16)
+				{
+					__m128 acc00 = _mm_setzero_ps(), acc01 = _mm_setzero_ps(), acc02 = _mm_setzero_ps(), acc03 = _mm_setzero_ps();
+					__m128 acc10 = _mm_setzero_ps(), acc11 = _mm_setzero_ps(), acc12 = _mm_setzero_ps(), acc13 = _mm_setzero_ps();
+
+					const float* b = B + n;
+					for(uint32_t k = 0; k < K; k++)
+					{
+						const __m128 va0 = _mm_set_ps1(a0[k]);
+						const __m128 va1 = _mm_set_ps1(a1[k]);
+
+						__m128 vb = _mm_load_ps(b + 0);
+						acc00 = _mm_add_ps(acc00, _mm_mul_ps(va0, vb));
+						acc10 = _mm_add_ps(acc10, _mm_mul_ps(va1, vb));
+
+						vb = _mm_load_ps(b + 4);
+						acc01 = _mm_add_ps(acc01, _mm_mul_ps(va0, vb));
+						acc11 = _mm_add_ps(acc11, _mm_mul_ps(va1, vb));
+
+						vb = _mm_load_ps(b + 8);
+						acc02 = _mm_add_ps(acc02, _mm_mul_ps(va0, vb));
+						acc12 = _mm_add_ps(acc12, _mm_mul_ps(va1, vb));
+
+						vb = _mm_load_ps(b + 12);
+						acc03 = _mm_add_ps(acc03, _mm_mul_ps(va0, vb));
+						acc13 = _mm_add_ps(acc13, _mm_mul_ps(va1, vb));
+
+						b += ldb;
+					}
+
+					store_block(c0 + n + 0, acc00, alpha4, accumulate);
+					store_block(c0 + n + 4, acc01, alpha4, accumulate);
+					store_block(c0 + n + 8, acc02, alpha4, accumulate);
+					store_block(c0 + n + 12, acc03, alpha4, accumulate);
+					if(pair)
+					{
+						store_block(c1 + n + 0, acc10, alpha4, accumulate);
+						store_block(c1 + n + 4, acc11, alpha4, accumulate);
+						store_block(c1 + n + 8, acc12, alpha4, accumulate);
+						store_block(c1 + n + 12, acc13, alpha4, accumulate);
+					}
+				}
+				// remaining 4 wide columns
+				for(; n < n1; n += 4)
+				{
+					__m128 acc0 = _mm_setzero_ps();
+					__m128 acc1 = _mm_setzero_ps();
+
+					const float* b = B + n;
+					for(uint32_t k = 0; k < K; k++)
+					{
+						const __m128 vb = _mm_load_ps(b);
+						acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_set_ps1(a0[k]), vb));
+						acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_set_ps1(a1[k]), vb));
+						b += ldb;
+					}
+
+					store_block(c0 + n, acc0, alpha4, accumulate);
+					if(pair)
+					{
+						store_block(c1 + n, acc1, alpha4, accumulate);
+					}
+				}
+			}
+		}
+	}
+
+	static void matrix_multiply_tn_sse(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t P, float alpha, bool accumulate)
+	{
+		assert(P % 4 == 0);
+
+		const __m128 alpha4 = _mm_set_ps1(alpha);
+
+		for(uint32_t p0 = 0; p0 < P; p0 += TileSize)
+		{
+			const uint32_t p1 = std::min(p0 + TileSize, P);
+			for(uint32_t n = n_begin; n < n_end; n += 4)
+			{
+				// 4 rows of C at a time, columns of A past n_end are clamped and their results discarded
+				const uint32_t count = std::min(4u, n_end - n);
+				const uint32_t r1 = std::min(1u, count - 1);
+				const uint32_t r2 = std::min(2u, count - 1);
+				const uint32_t r3 = std::min(3u, count - 1);
+
+				uint32_t p = p0;
+				// 4 x 8 register tile
+				for(; p + 8 <= p1; p += 8)
+				{
+					__m128 acc00 = _mm_setzero_ps(), acc01 = _mm_setzero_ps();
+					__m128 acc10 = _mm_setzero_ps(), acc11 = _mm_setzero_ps();
+					__m128 acc20 = _mm_setzero_ps(), acc21 = _mm_setzero_ps();
+					__m128 acc30 = _mm_setzero_ps(), acc31 = _mm_setzero_ps();
+
+					const float* a = A + n;
+					const float* b = B + p;
+					for(uint32_t m = 0; m < M; m++)
+					{
+						const __m128 vb0 = _mm_load_ps(b);
+						const __m128 vb1 = _mm_load_ps(b + 4);
+
+						__m128 va = _mm_set_ps1(a[0]);
+						acc00 = _mm_add_ps(acc00, _mm_mul_ps(va, vb0));
+						acc01 = _mm_add_ps(acc01, _mm_mul_ps(va, vb1));
+
+						va = _mm_set_ps1(a[r1]);
+						acc10 = _mm_add_ps(acc10, _mm_mul_ps(va, vb0));
+						acc11 = _mm_add_ps(acc11, _mm_mul_ps(va, vb1));
+
+						va = _mm_set_ps1(a[r2]);
+						acc20 = _mm_add_ps(acc20, _mm_mul_ps(va, vb0));
+						acc21 = _mm_add_ps(acc21, _mm_mul_ps(va, vb1));
+
+						va = _mm_set_ps1(a[r3]);
+						acc30 = _mm_add_ps(acc30, _mm_mul_ps(va, vb0));
+						acc31 = _mm_add_ps(acc31, _mm_mul_ps(va, vb1));
+
+						a += lda;
+						b += ldb;
+					}
+
+					float* c = C + n * ldc + p;
+					store_block(c, acc00, alpha4, accumulate);
+					store_block(c + 4, acc01, alpha4, accumulate);
+					if(count > 1)
+					{
+						c += ldc;
+						store_block(c, acc10, alpha4, accumulate);
+						store_block(c + 4, acc11, alpha4, accumulate);
+					}
+					if(count > 2)
+					{
+						c += ldc;
+						store_block(c, acc20, alpha4, accumulate);
+						store_block(c + 4, acc21, alpha4, accumulate);
+					}
+					if(count > 3)
+					{
+						c += ldc;
+						store_block(c, acc30, alpha4, accumulate);
+						store_block(c + 4, acc31, alpha4, accumulate);
+					}
+				}
+				// remaining 4 wide column
+				for(; p < p1; p += 4)
+				{
+					__m128 acc0 = _mm_setzero_ps();
+					__m128 acc1 = _mm_setzero_ps();
+					__m128 acc2 = _mm_setzero_ps();
+					__m128 acc3 = _mm_setzero_ps();
+
+					const float* a = A + n;
+					const float* b = B + p;
+					for(uint32_t m = 0; m < M; m++)
+					{
+						const __m128 vb = _mm_load_ps(b);
+						acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_set_ps1(a[0]), vb));
+						acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_set_ps1(a[r1]), vb));
+						acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_set_ps1(a[r2]), vb));
+						acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_set_ps1(a[r3]), vb));
+
+						a += lda;
+						b += ldb;
+					}
+
+					float* c = C + n * ldc + p;
+					store_block(c, acc0, alpha4, accumulate);
+					if(count > 1)
+					{
+						store_block(c + ldc, acc1, alpha4, accumulate);
+					}
+					if(count > 2)
+					{
+						store_block(c + 2 * ldc, acc2, alpha4, accumulate);
+					}
+					if(count > 3)
+					{
+						store_block(c + 3 * ldc, acc3, alpha4, accumulate);
+					}
+				}
+			}
+		}
+	}
+
+	void MatrixMultiplyNT(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate)
+	{
+		if(GetSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			AVX2::MatrixMultiplyNT(A, lda, B, ldb, C, ldc, M, n_begin, n_end, K, alpha, accumulate, nullptr);
+		}
+		else
+		{
+			matrix_multiply_nt_sse(A, lda, B, ldb, C, ldc, M, n_begin, n_end, K, alpha, accumulate, nullptr);
+		}
+	}
+
+	void MatrixMultiplyNT(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, const MatrixEpilogue& in_epilogue)
+	{
+		if(GetSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			AVX2::MatrixMultiplyNT(A, lda, B, ldb, C, ldc, M, n_begin, n_end, K, alpha, false, &in_epilogue);
+		}
+		else
+		{
+			matrix_multiply_nt_sse(A, lda, B, ldb, C, ldc, M, n_begin, n_end, K, alpha, false, &in_epilogue);
+		}
+	}
+
+	void MatrixMultiplyNN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate)
+	{
+		if(GetSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			AVX2::MatrixMultiplyNN(A, lda, B, ldb, C, ldc, M, n_begin, n_end, K, alpha, accumulate);
+		}
+		else
+		{
+			matrix_multiply_nn_sse(A, lda, B, ldb, C, ldc, M, n_begin, n_end, K, alpha, accumulate);
+		}
+	}
+
+	void MatrixMultiplyTN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t P, float alpha, bool accumulate)
+	{
+		if(GetSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			AVX2::MatrixMultiplyTN(A, lda, B, ldb, C, ldc, M, n_begin, n_end, P, alpha, accumulate);
+		}
+		else
+		{
+			matrix_multiply_tn_sse(A, lda, B, ldb, C, ldc, M, n_begin, n_end, P, alpha, accumulate);
+		}
+	}
+
+	float CalcError(const float* in_calculated, const float* in_expected, uint32_t in_rows, uint32_t in_columns, uint32_t in_stride, ErrorFunction_t in_error_function)
+	{
+		assert(in_error_function == ErrorFunction::SquareError ||
+		       in_error_function == ErrorFunction::CrossEntropy);
+
+		float result = 0.0f;
+		for(uint32_t m = 0; m < in_rows; m++)
+		{
+			const float* z = in_calculated + m * in_stride;
+			const float* t = in_expected + m * in_stride;
+
+			float row_error = 0.0f;
+			for(uint32_t k = 0; k < in_columns; k++)
+			{
+				if(in_error_function == ErrorFunction::SquareError)
+				{
+					const float diff = z[k] - t[k];
+					row_error += diff * diff;
+				}
+				else
+				{
+					row_error -= t[k] * std::log(std::max(z[k], 1.1754943508e-38f));
+				}
+			}
+
+			// average together
+			result += row_error * (1.0f / in_columns);
+		}
+
+		return result / in_rows;
+	}
+
+	/// Parameter Updates
+
+	ParameterMatrix::ParameterMatrix()
+		: Rows(0)
+		, Columns(0)
+		, Stride(0)
+		, Weights(nullptr)
+		, Delta(nullptr)
+		, MeanSquareDerivative(nullptr)
+		, MeanSquareDelta(nullptr)
+		, Nesterov(nullptr)
+		, _shared(false)
+	{ }
+
+	ParameterMatrix::~ParameterMatrix()
+	{
+		Free();
+	}
+
+	void ParameterMatrix::Allocate(uint32_t in_rows, uint32_t in_columns)
+	{
+		Free();
+
+		Rows = in_rows;
+		Columns = in_columns;
+		Stride = BlockCount(in_columns) * 4;
+
+		Weights = AllocateMatrix(in_rows, in_columns);
+		Delta = AllocateMatrix(in_rows, in_columns);
+		MeanSquareDerivative = AllocateMatrix(in_rows, in_columns);
+		MeanSquareDelta = AllocateMatrix(in_rows, in_columns);
+		Nesterov = AllocateMatrix(in_rows, in_columns);
+	}
+
+	void ParameterMatrix::Share(const ParameterMatrix& in_owner)
+	{
+		Free();
+
+		Rows = in_owner.Rows;
+		Columns = in_owner.Columns;
+		Stride = in_owner.Stride;
+
+		Weights = in_owner.Weights;
+		Delta = in_owner.Delta;
+		MeanSquareDerivative = in_owner.MeanSquareDerivative;
+		MeanSquareDelta = in_owner.MeanSquareDelta;
+		Nesterov = in_owner.Nesterov;
+
+		_shared = true;
+	}
+
+	void ParameterMatrix::Free()
+	{
+		if(_shared)
+		{
+			Weights = Delta = MeanSquareDerivative = MeanSquareDelta = Nesterov = nullptr;
+			_shared = false;
+		}
+		else
+		{
+			FreeMatrix(Weights);
+			FreeMatrix(Delta);
+			FreeMatrix(MeanSquareDerivative);
+			FreeMatrix(MeanSquareDelta);
+			FreeMatrix(Nesterov);
+		}
+
+		Rows = Columns = Stride = 0;
+	}
+
+	void ParameterMatrix::ResetNesterov()
+	{
+		memcpy(Nesterov, Weights, sizeof(float) * Rows * Stride);
+	}
+
+	void ParameterMatrix::UpdateRow(const UpdateRule& in_rule, uint32_t in_row, const float* in_gradient, float in_scale, const float* in_enabled, bool in_regularize)
+	{
+		// epsilon for calculating Adadelta scaling factor
+		const __m128 eps = _mm_set_ps1(1.0e-6f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set_ps1(1.0f);
+		const __m128 scale = _mm_set_ps1(in_scale);
+		const __m128 decay = _mm_set_ps1(in_rule.AdadeltaDecay);
+		const __m128 one_minus_decay = _mm_set_ps1(1.0f - in_rule.AdadeltaDecay);
+		const __m128 momentum = _mm_set_ps1(in_rule.Momentum);
+		const __m128 learning_rate = _mm_set_ps1(in_rule.LearningRate);
+		const __m128 l1 = _mm_set_ps1(in_rule.L1Regularization);
+		const __m128 l2 = _mm_set_ps1(in_rule.L2Regularization);
+		const bool regularize = in_regularize && (in_rule.L1Regularization != 0.0f || in_rule.L2Regularization != 0.0f);
+
+		const uint32_t offset = in_row * Stride;
+		float* weights = Weights + offset;
+		float* delta = Delta + offset;
+		float* mean_square_derivative = MeanSquareDerivative + offset;
+		float* mean_square_delta = MeanSquareDelta + offset;
+		float* nesterov = Nesterov + offset;
+
+		for(uint32_t k = 0; k < Stride; k += 4)
+		{
+			const __m128 prev_weight = _mm_load_ps(weights + k);
+			const __m128 prev_delta = _mm_load_ps(delta + k);
+			const __m128 prev_msd = _mm_load_ps(mean_square_derivative + k);
+			const __m128 prev_msdelta = _mm_load_ps(mean_square_delta + k);
+
+			const __m128 delta_w = _mm_mul_ps(_mm_load_ps(in_gradient + k), scale);
+
+			// L1/L2 regularization; GLSL sign(0) is 0 so we can't use _mm_sign_ps here
+			__m128 weight_decay = zero;
+			if(regularize)
+			{
+				const __m128 sign = _mm_sub_ps(_mm_and_ps(_mm_cmpgt_ps(prev_weight, zero), one), _mm_and_ps(_mm_cmplt_ps(prev_weight, zero), one));
+				weight_decay = _mm_add_ps(_mm_mul_ps(sign, l1), _mm_mul_ps(prev_weight, l2));
+			}
+
+			// calculate mean square weight derivative
+			__m128 msd = _mm_add_ps(_mm_mul_ps(one_minus_decay, _mm_mul_ps(delta_w, delta_w)), _mm_mul_ps(decay, prev_msd));
+
+			// calculate weight delta
+			const __m128 adadelta_factor = _mm_div_ps(_mm_sqrt_ps(_mm_add_ps(prev_msdelta, eps)), _mm_sqrt_ps(_mm_add_ps(msd, eps)));
+			__m128 new_delta = _mm_add_ps(_mm_mul_ps(momentum, prev_delta), _mm_mul_ps(_mm_mul_ps(learning_rate, adadelta_factor), _mm_sub_ps(delta_w, weight_decay)));
+
+			// calculate mean square weight delta
+			__m128 msdelta = _mm_add_ps(_mm_mul_ps(one_minus_decay, _mm_mul_ps(new_delta, new_delta)), _mm_mul_ps(decay, prev_msdelta));
+
+			// update the weight
+			__m128 new_weight = _mm_add_ps(prev_weight, new_delta);
+
+			// dropped out entries keep their previous state
+			if(in_enabled != nullptr)
+			{
+				const __m128 enabled = _mm_cmpneq_ps(_mm_load_ps(in_enabled + k), zero);
+				new_weight = _mm_or_ps(_mm_and_ps(enabled, new_weight), _mm_andnot_ps(enabled, prev_weight));
+				new_delta = _mm_or_ps(_mm_and_ps(enabled, new_delta), _mm_andnot_ps(enabled, prev_delta));
+				msd = _mm_or_ps(_mm_and_ps(enabled, msd), _mm_andnot_ps(enabled, prev_msd));
+				msdelta = _mm_or_ps(_mm_and_ps(enabled, msdelta), _mm_andnot_ps(enabled, prev_msdelta));
+			}
+
+			_mm_store_ps(weights + k, new_weight);
+			_mm_store_ps(delta + k, new_delta);
+			_mm_store_ps(mean_square_derivative + k, msd);
+			_mm_store_ps(mean_square_delta + k, msdelta);
+
+			// calculate the weight for t + 1/2 for nesterov momentum
+			_mm_store_ps(nesterov + k, _mm_add_ps(new_weight, _mm_mul_ps(momentum, new_delta)));
+		}
+	}
+
+	void ParameterMatrix::HoldRow(const UpdateRule& in_rule, uint32_t in_row)
+	{
+		const __m128 momentum = _mm_set_ps1(in_rule.Momentum);
+
+		const uint32_t offset = in_row * Stride;
+		const float* weights = Weights + offset;
+		const float* delta = Delta + offset;
+		float* nesterov = Nesterov + offset;
+
+		for(uint32_t k = 0; k < Stride; k += 4)
+		{
+			_mm_store_ps(nesterov + k, _mm_add_ps(_mm_load_ps(weights + k), _mm_mul_ps(momentum, _mm_load_ps(delta + k))));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+// std
+#include <string.h>
+#include <algorithm>
+#include <assert.h>
+
+// windows
+#include <intrin.h>
+
+// OMLT
+#include "Common.h"
+#include "CPUShared.h"
+
+/*
+ * AVX2 + FMA versions of the matrix kernels in CPUShared.cpp; this file is
+ * built with /arch:AVX2 and only called into when GetSIMDLevel() is at least
+ * SIMDLevel::AVX2.
+ *
+ * All three products run the same 4 x 16 register tile: each step of the
+ * depth broadcasts one value from each of 4 rows of A and multiplies it into
+ * 16 consecutive columns of B (two 8 wide registers), so the 8 accumulators
+ * never need a horizontal add.  Tiles of B are first packed into contiguous
+ * 16 column strips so the tile streams through them regardless of whether B
+ * was transposed, and without the cache set conflicts that walking down the
+ * columns of a matrix with a power of 2 stride causes.
+ */
+
+namespace OMLT
+{
+	namespace AVX2
+	{
+		// rows of C per register tile
+		static const uint32_t TileRows = 4;
+		// columns of C per register tile
+		static const uint32_t TileColumns = 16;
+		// B is packed PanelDepth x PanelColumns at a time (128KB, which stays in L2)
+		static const uint32_t PanelDepth = 256;
+		static const uint32_t PanelColumns = 128;
+
+		// the first count of the 8 lanes
+		static inline __m256i LaneMask(uint32_t count)
+		{
+			return _mm256_cmpgt_epi32(_mm256_set1_epi32(int32_t(count)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+		}
+
+		static inline void store_tile_row(float* c, __m256 x0, __m256 x1, __m256 alpha, bool accumulate)
+		{
+			x0 = _mm256_mul_ps(x0, alpha);
+			x1 = _mm256_mul_ps(x1, alpha);
+			if(accumulate)
+			{
+				x0 = _mm256_add_ps(x0, _mm256_loadu_ps(c));
+				x1 = _mm256_add_ps(x1, _mm256_loadu_ps(c + 8));
+			}
+			_mm256_storeu_ps(c, x0);
+			_mm256_storeu_ps(c + 8, x1);
+		}
+
+		static inline void store_tile_row(float* c, __m256 x0, __m256 x1, __m256 alpha, bool accumulate, __m256i mask0, __m256i mask1)
+		{
+			x0 = _mm256_mul_ps(x0, alpha);
+			x1 = _mm256_mul_ps(x1, alpha);
+			if(accumulate)
+			{
+				x0 = _mm256_add_ps(x0, _mm256_maskload_ps(c, mask0));
+				x1 = _mm256_add_ps(x1, _mm256_maskload_ps(c + 8, mask1));
+			}
+			_mm256_maskstore_ps(c, mask0, x0);
+			_mm256_maskstore_ps(c + 8, mask1, x1);
+		}
+
+		// C[r][j] = alpha * sum_k a[r * a_row + k * a_depth] * b[k * 16 + j] (+ C[r][j] when accumulating)
+		// for r < rows and j < columns; b is a packed strip of 16 columns.  Rows past the end are clamped to the
+		// last one and their results discarded, and FULL tiles have all 16 columns.
+		template<bool FULL>
+		static inline void tile_4x16(const float* a, uint32_t a_row, uint32_t a_depth, const float* b, uint32_t K, float* c, uint32_t ldc, uint32_t rows, uint32_t columns, __m256 alpha, bool accumulate)
+		{
+			const float* a0 = a;
+			const float* a1 = a + std::min(1u, rows - 1) * a_row;
+			const float* a2 = a + std::min(2u, rows - 1) * a_row;
+			const float* a3 = a + std::min(3u, rows - 1) * a_row;
+
+			__m256 acc00 = _mm256_setzero_ps(), acc01 = _mm256_setzero_ps();
+			__m256 acc10 = _mm256_setzero_ps(), acc11 = _mm256_setzero_ps();
+			__m256 acc20 = _mm256_setzero_ps(), acc21 = _mm256_setzero_ps();
+			__m256 acc30 = _mm256_setzero_ps(), acc31 = _mm256_setzero_ps();
+
+			for(uint32_t k = 0; k < K; k++)
+			{
+				const __m256 vb0 = _mm256_load_ps(b);
+				const __m256 vb1 = _mm256_load_ps(b + 8);
+
+				__m256 va = _mm256_broadcast_ss(a0);
+				acc00 = _mm256_fmadd_ps(va, vb0, acc00);
+				acc01 = _mm256_fmadd_ps(va, vb1, acc01);
+
+				va = _mm256_broadcast_ss(a1);
+				acc10 = _mm256_fmadd_ps(va, vb0, acc10);
+				acc11 = _mm256_fmadd_ps(va, vb1, acc11);
+
+				va = _mm256_broadcast_ss(a2);
+				acc20 = _mm256_fmadd_ps(va, vb0, acc20);
+				acc21 = _mm256_fmadd_ps(va, vb1, acc21);
+
+				va = _mm256_broadcast_ss(a3);
+				acc30 = _mm256_fmadd_ps(va, vb0, acc30);
+				acc31 = _mm256_fmadd_ps(va, vb1, acc31);
+
+				a0 += a_depth;
+				a1 += a_depth;
+				a2 += a_depth;
+				a3 += a_depth;
+				b += TileColumns;
+			}
+
+			if(FULL)
+			{
+				store_tile_row(c, acc00, acc01, alpha, accumulate);
+				if(rows > 1)
+				{
+					store_tile_row(c + ldc, acc10, acc11, alpha, accumulate);
+				}
+				if(rows > 2)
+				{
+					store_tile_row(c + 2 * ldc, acc20, acc21, alpha, accumulate);
+				}
+				if(rows > 3)
+				{
+					store_tile_row(c + 3 * ldc, acc30, acc31, alpha, accumulate);
+				}
+			}
+			else
+			{
+				const __m256i mask0 = LaneMask(columns);
+				const __m256i mask1 = LaneMask(columns > 8 ? columns - 8 : 0);
+
+				store_tile_row(c, acc00, acc01, alpha, accumulate, mask0, mask1);
+				if(rows > 1)
+				{
+					store_tile_row(c + ldc, acc10, acc11, alpha, accumulate, mask0, mask1);
+				}
+				if(rows > 2)
+				{
+					store_tile_row(c + 2 * ldc, acc20, acc21, alpha, accumulate, mask0, mask1);
+				}
+				if(rows > 3)
+				{
+					store_tile_row(c + 3 * ldc, acc30, acc31, alpha, accumulate, mask0, mask1);
+				}
+			}
+		}
+
+		// C[r][j] = alpha * sum_k A[r * a_row + k * a_depth] * B[k * b_depth + j * b_column] (+ C[r][j] when accumulating)
+		// for r < rows and j < columns.  B is copied PanelDepth x PanelColumns at a time into strips of 16 columns
+		// laid out one after the other, so the register tile reads it sequentially whatever its original layout.
+		// The epilogue (if any) is run on each tile once its last panel is stored, with column j reported as
+		// epilogue_column + j.
+		static void multiply(const float* A, uint32_t a_row, uint32_t a_depth, const float* B, uint32_t b_depth, uint32_t b_column, uint32_t K, float* C, uint32_t ldc, uint32_t rows, uint32_t columns, float alpha, bool accumulate, const MatrixEpilogue* epilogue = nullptr, uint32_t epilogue_column = 0)
+		{
+			if(rows == 0 || columns == 0)
+			{
+				return;
+			}
+
+			const __m256 alpha8 = _mm256_set1_ps(alpha);
+			float* panel = (float*)AlignedMalloc(sizeof(float) * PanelDepth * PanelColumns, 32);
+
+			for(uint32_t j0 = 0; j0 < columns; j0 += PanelColumns)
+			{
+				const uint32_t panel_columns = std::min(PanelColumns, columns - j0);
+				const uint32_t strips = (panel_columns + TileColumns - 1) / TileColumns;
+
+				for(uint32_t k0 = 0; k0 < K; k0 += PanelDepth)
+				{
+					const uint32_t depth = std::min(PanelDepth, K - k0);
+
+					// pack, zero filling the columns past the end
+					for(uint32_t s = 0; s < strips; s++)
+					{
+						const uint32_t strip_columns = std::min(TileColumns, panel_columns - s * TileColumns);
+						const float* b = B + k0 * b_depth + (j0 + s * TileColumns) * b_column;
+						float* strip = panel + s * PanelDepth * TileColumns;
+
+						if(b_column == 1 && strip_columns == TileColumns)
+						{
+							for(uint32_t k = 0; k < depth; k++)
+							{
+								_mm256_store_ps(strip + k * TileColumns, _mm256_loadu_ps(b + k * b_depth));
+								_mm256_store_ps(strip + k * TileColumns + 8, _mm256_loadu_ps(b + k * b_depth + 8));
+							}
+						}
+						else
+						{
+							for(uint32_t k = 0; k < depth; k++)
+							{
+								uint32_t j = 0;
+								for(; j < strip_columns; j++)
+								{
+									strip[k * TileColumns + j] = b[k * b_depth + j * b_column];
+								}
+								for(; j < TileColumns; j++)
+								{
+									strip[k * TileColumns + j] = 0.0f;
+								}
+							}
+						}
+					}
+
+					// later panels add on to the earlier ones
+					const bool accumulate_panel = accumulate || k0 > 0;
+					const bool last_panel = k0 + depth == K;
+					for(uint32_t r = 0; r < rows; r += TileRows)
+					{
+						const uint32_t tile_rows = std::min(TileRows, rows - r);
+						const float* a = A + r * a_row + k0 * a_depth;
+						float* c = C + r * ldc + j0;
+
+						for(uint32_t s = 0; s < strips; s++)
+						{
+							const float* strip = panel + s * PanelDepth * TileColumns;
+							const uint32_t strip_columns = std::min(TileColumns, panel_columns - s * TileColumns);
+							if(strip_columns == TileColumns)
+							{
+								tile_4x16<true>(a, a_row, a_depth, strip, depth, c + s * TileColumns, ldc, tile_rows, TileColumns, alpha8, accumulate_panel);
+							}
+							else
+							{
+								tile_4x16<false>(a, a_row, a_depth, strip, depth, c + s * TileColumns, ldc, tile_rows, strip_columns, alpha8, accumulate_panel);
+							}
+
+							if(epilogue && last_panel)
+							{
+								const uint32_t j = j0 + s * TileColumns;
+								for(uint32_t t = 0; t < tile_rows; t++)
+								{
+									(*epilogue)(c + t * ldc + s * TileColumns, r + t, epilogue_column + j, strip_columns);
+								}
+							}
+						}
+					}
+				}
+			}
+
+			AlignedFree(panel);
+		}
+
+		void MatrixMultiplyNT(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate, const MatrixEpilogue* epilogue)
+		{
+			multiply(A, lda, 1, B + n_begin * ldb, 1, ldb, K, C + n_begin, ldc, M, n_end - n_begin, alpha, accumulate, epilogue, n_begin);
+		}
+
+		void MatrixMultiplyNN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t K, float alpha, bool accumulate)
+		{
+			assert(n_begin % 4 == 0);
+			assert(n_end % 4 == 0);
+
+			multiply(A, lda, 1, B + n_begin, ldb, 1, K, C + n_begin, ldc, M, n_end - n_begin, alpha, accumulate);
+		}
+
+		void MatrixMultiplyTN(const float* A, uint32_t lda, const float* B, uint32_t ldb, float* C, uint32_t ldc, uint32_t M, uint32_t n_begin, uint32_t n_end, uint32_t P, float alpha, bool accumulate)
+		{
+			assert(P % 4 == 0);
+
+			// rows of C are columns of A, and the depth runs down both A and B
+			multiply(A + n_begin, 1, lda, B, ldb, 1, M, C + n_begin * ldc, ldc, n_end - n_begin, P, alpha, accumulate);
+		}
+	}
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <assert.h>
 // stdlib
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 // windows
 #include <intrin.h>
@@ -10,8 +13,13 @@
 // cjson
 #include <cJSON.h>
 
+// SiCKL
+#include <SiCKL.h>
+
 // OMLT
 #include "Common.h"
+#include "SIMD.h"
+#include "BinaryModel.h"
 #include "RestrictedBoltzmannMachine.h"
 #include "MultilayerPerceptron.h"
 
@@ -225,164 +233,488 @@ namespace OMLT
 	}
 
 	// feature map class
-	FeatureMap::FeatureMap(uint32_t in_input_length, uint32_t in_feature_count)
+	FeatureMap::FeatureMap(uint32_t in_input_length, uint32_t in_feature_count, const MappedFeatureMap* in_mapped)
 		: input_length(in_input_length),
 		feature_count(in_feature_count),
+		feature_stride(Stride(in_input_length)),
 		_input_blocks(BlockCount(input_length)),
-		_feature_blocks(BlockCount(feature_count))
+		_feature_blocks(BlockCount(feature_count)),
+		_file(nullptr)
 	{
 		assert(input_length > 0);
 		assert(feature_count > 0);
-		// allocate space for bias vector
 		const uint32_t feature_bytes = _feature_blocks * 4 * sizeof(float);
-		_biases = (float*)AlignedMalloc(feature_bytes, 16);
-		memset(_biases, 0x00, feature_bytes);
-
 		_accumulations = (float*)AlignedMalloc(feature_bytes, 16);
 		memset(_accumulations, 0x00, feature_bytes);
 
-		// allocate space for feature vectors
-		const uint32_t input_bytes = _input_blocks * 4 * sizeof(float);
-		_features = new float*[feature_count];
-		for(uint32_t k = 0; k < feature_count; k++)
+		if(in_mapped)
 		{
-			_features[k] = (float*)AlignedMalloc(input_bytes, 16);
-			memset(_features[k], 0x00, input_bytes);
+			// the file is laid out just like our buffers
+			_file = in_mapped->file;
+			_file->AddReference();
+			_biases = in_mapped->biases;
+			_weights = in_mapped->weights;
+			return;
 		}
+
+		// allocate space for bias vector
+		_biases = (float*)AlignedMalloc(feature_bytes, 16);
+		memset(_biases, 0x00, feature_bytes);
+
+		// allocate space for feature vectors, including the padding features
+		const size_t weight_bytes = size_t(_feature_blocks) * 4 * feature_stride * sizeof(float);
+		_weights = (float*)AlignedMalloc(weight_bytes, 64);
+		memset(_weights, 0x00, weight_bytes);
 	}
 
 	FeatureMap::~FeatureMap()
 	{
-		AlignedFree(_biases);
+		if(_file)
+		{
+			_file->Release();
+			_file = nullptr;
+		}
+		else
+		{
+			AlignedFree(_biases);
+			AlignedFree(_weights);
+		}
 		_biases = nullptr;
+		_weights = nullptr;
 		AlignedFree(_accumulations);
 		_accumulations = nullptr;
-		for(uint32_t k = 0; k < feature_count; k++)
-		{
-			AlignedFree(_features[k]);
-			_features[k] = nullptr;
-		}
-		delete[] _features;
-		_features = nullptr;
 	}
 
-	template<typename FUNC>
-	static void CalcActivation(float* accumulations, float* biases, uint32_t blocks, float* activations, FUNC _mm_activation)
+	/// SSE kernels, see SIMD.h
+
+	namespace SSE
 	{
-		for(uint32_t k = 0; k < blocks; k++)
+		static void CalcDotProducts(const float* input_vector, const float* features, uint32_t feature_stride, uint32_t feature_blocks, uint32_t input_blocks, float* out_accumulations)
+		{
+			for(uint32_t k = 0; k < feature_blocks * 4; k++)
+			{
+				// copy of our vectors so we can increment ptr
+				const float* input = input_vector;
+				const float* feature = features + k * feature_stride;
+				// initialize dot product to zero
+				__m128 dp = _mm_setzero_ps();
+				for(uint32_t j = 0; j < input_blocks; j++)
+				{
+					__m128 val = _mm_load_ps(input);
+					__m128 feat = _mm_load_ps(feature);
+
+					dp = _mm_add_ps(dp, _mm_mul_ps(val, feat));
+
+					input += 4;
+					feature += 4;
+				}
+
+				dp = _mm_hadd_ps(dp , dp);
+				dp = _mm_hadd_ps(dp , dp);
+
+				// store back to intermediate buffer
+				_mm_store_ss(out_accumulations + k, dp);
+			}
+		}
+
+		static void CalcDotProducts2x4(const float* input0, const float* input1, const float* features, uint32_t feature_stride, uint32_t blocks, __m128& out_dp0, __m128& out_dp1)
+		{
+			const float* feature0 = features;
+			const float* feature1 = feature0 + feature_stride;
+			const float* feature2 = feature1 + feature_stride;
+			const float* feature3 = feature2 + feature_stride;
+
+			__m128 dp00 = _mm_setzero_ps();
+			__m128 dp01 = _mm_setzero_ps();
+			__m128 dp02 = _mm_setzero_ps();
+			__m128 dp03 = _mm_setzero_ps();
+			__m128 dp10 = _mm_setzero_ps();
+			__m128 dp11 = _mm_setzero_ps();
+			__m128 dp12 = _mm_setzero_ps();
+			__m128 dp13 = _mm_setzero_ps();
+
+			for(uint32_t j = 0; j < blocks; j++)
+			{
+				__m128 val0 = _mm_load_ps(input0);
+				__m128 val1 = _mm_load_ps(input1);
+				__m128 feat;
+
+				feat = _mm_load_ps(feature0);
+				dp00 = _mm_add_ps(dp00, _mm_mul_ps(val0, feat));
+				dp10 = _mm_add_ps(dp10, _mm_mul_ps(val1, feat));
+
+				feat = _mm_load_ps(feature1);
+				dp01 = _mm_add_ps(dp01, _mm_mul_ps(val0, feat));
+				dp11 = _mm_add_ps(dp11, _mm_mul_ps(val1, feat));
+
+				feat = _mm_load_ps(feature2);
+				dp02 = _mm_add_ps(dp02, _mm_mul_ps(val0, feat));
+				dp12 = _mm_add_ps(dp12, _mm_mul_ps(val1, feat));
+
+				feat = _mm_load_ps(feature3);
+				dp03 = _mm_add_ps(dp03, _mm_mul_ps(val0, feat));
+				dp13 = _mm_add_ps(dp13, _mm_mul_ps(val1, feat));
+
+				input0 += 4;
+				input1 += 4;
+				feature0 += 4;
+				feature1 += 4;
+				feature2 += 4;
+				feature3 += 4;
+			}
+
+			// hadd(hadd(a, b), hadd(c, d)) gives {sum(a), sum(b), sum(c), sum(d)}
+			out_dp0 = _mm_hadd_ps(_mm_hadd_ps(dp00, dp01), _mm_hadd_ps(dp02, dp03));
+			out_dp1 = _mm_hadd_ps(_mm_hadd_ps(dp10, dp11), _mm_hadd_ps(dp12, dp13));
+		}
+
+		template<typename FUNC>
+		static void CalcActivation(const float* accumulations, const float* biases, uint32_t blocks, float* activations, FUNC _mm_activation)
+		{
+			for(uint32_t k = 0; k < blocks; k++)
+			{
+				__m128 acc = _mm_add_ps(_mm_load_ps(biases), _mm_load_ps(accumulations));
+				__m128 act = _mm_activation(acc);
+				_mm_store_ps(activations, act);
+
+				biases += 4;
+				accumulations += 4;
+				activations += 4;
+			}
+		}
+
+		static void CalcActivation(const float* accumulations, const float* biases, uint32_t blocks, float* activations, ActivationFunction_t function)
+		{
+			switch(function)
+			{
+			case ActivationFunction::Linear:
+				CalcActivation(accumulations, biases, blocks, activations, _mm_noop_ps);
+				break;
+			case ActivationFunction::RectifiedLinear:
+				CalcActivation(accumulations, biases, blocks, activations, _mm_relu_ps);
+				break;
+			case ActivationFunction::Sigmoid:
+				CalcActivation(accumulations, biases, blocks, activations, _mm_sigmoid_ps);
+				break;
+			}
+		}
+
+		static void CalcSoftmax(float* vector, uint32_t count, uint32_t blocks)
+		{
+			// to avoid overflow, we can subtract the max accumulation from all the exp(x) calls
+			// http://deeplearning.stanford.edu/wiki/index.php/Exercise:Softmax_Regression
+
+			// set dangling values to -FLT_MAX
+			for(uint32_t k = count; k < blocks * 4; k++)
+			{
+				vector[k] = -FLT_MAX;
+			}
+
+			// calculate the max value
+			__m128 max = _mm_set1_ps(-FLT_MAX);
+			float* accumulation_head = vector;
+			for(uint32_t k = 0; k < blocks; k++)
+			{
+				__m128 acc = _mm_load_ps(accumulation_head);
+				max = _mm_max_ps(max, acc);
+
+				accumulation_head += 4;
+			}
+			max = _mm_hmax_ps(max);
+
+			// calculate the divisor
+			__m128 divisor = _mm_setzero_ps();
+			accumulation_head = vector;
+			for(uint32_t k = 0; k < blocks; k++)
+			{
+				__m128 acc = _mm_load_ps(accumulation_head);
+				__m128 val = _mm_exp_ps(_mm_sub_ps(acc, max));
+				divisor = _mm_add_ps(divisor, val);
+
+				accumulation_head += 4;
+			}
+			divisor = _mm_hadd_ps(divisor, divisor);
+			divisor = _mm_hadd_ps(divisor, divisor);
+
+			// now calculate softmax
+			accumulation_head = vector;
+			float* output_head = vector;
+			for(uint32_t k = 0; k < blocks; k++)
+			{
+				__m128 acc = _mm_load_ps(accumulation_head);
+				__m128 val = _mm_exp_ps(_mm_sub_ps(acc, max));
+				val = _mm_div_ps(val, divisor);
+
+				_mm_store_ps(output_head, val);
+
+				accumulation_head += 4;
+				output_head += 4;
+			}
+		}
+
+		static float SumLn1PlusEx(const float* vector, uint32_t blocks)
 		{
-			__m128 acc = _mm_add_ps(_mm_load_ps(biases), _mm_load_ps(accumulations));
-			__m128 act = _mm_activation(acc);
-			_mm_store_ps(activations, act);
+			__m128 sum = _mm_setzero_ps();
+			for(uint32_t k = 0; k < blocks; k++)
+			{
+				sum = _mm_add_ps(sum, _mm_ln_1_plus_e_x_ps(_mm_load_ps(vector)));
+				vector += 4;
+			}
+
+			sum = _mm_hadd_ps(sum, sum);
+			sum = _mm_hadd_ps(sum, sum);
 
-			biases += 4;
-			accumulations += 4;
-			activations += 4;
+			float result;
+			_mm_store_ss(&result, sum);
+			return result;
 		}
 	}
 
-	void FeatureMap::CalcFeatureVector(const float* input_vector, float* output_vector, ActivationFunction_t function) const
+	const SIMDKernels SSEKernels =
 	{
-		// verify alignment
-		assert((intptr_t(input_vector) % 16) == 0);
-		assert((intptr_t(output_vector) % 16) == 0);
+		SSE::CalcDotProducts,
+		SSE::CalcDotProducts2x4,
+		SSE::CalcActivation,
+		SSE::CalcSoftmax,
+		SSE::SumLn1PlusEx,
+	};
+
+	/// kernel dispatch
 
-		for(uint32_t k = 0; k < feature_count; k++)
+	const char* SIMDLevelNames[] =
+	{
+		"SSE",
+		"AVX2",
+		"AVX512",
+	};
+
+	static SIMDLevel_t DetectSIMDLevel()
+	{
+		int info[4];
+		__cpuid(info, 0);
+		const int max_leaf = info[0];
+
+		__cpuid(info, 1);
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+
+		bool avx2 = false;
+		bool avx512f = false;
+		if(max_leaf >= 7)
 		{
-			// copy of our vectors so we can increment ptr
-			const float* input = input_vector;
-			float* feature = _features[k];
-			// initialize dot product to zero
-			__m128 dp = _mm_setzero_ps();
-			for(uint32_t j = 0; j < _input_blocks; j++)
-			{
-				__m128 val = _mm_load_ps(input);
-				__m128 feat = _mm_load_ps(feature);
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+			avx512f = (info[1] & (1 << 16)) != 0;
+		}
 
-				dp = _mm_add_ps(dp, _mm_mul_ps(val, feat));
+		// the OS also has to save the wider registers on context switches
+		const uint64_t xcr0 = osxsave ? _xgetbv(0) : 0;
+		// xmm and ymm state
+		const bool ymm_enabled = (xcr0 & 0x06) == 0x06;
+		// plus opmask and both halves of zmm state
+		const bool zmm_enabled = (xcr0 & 0xE6) == 0xE6;
 
-				input += 4;
-				feature += 4;
+		if(avx && avx2 && fma && ymm_enabled)
+		{
+			if(avx512f && zmm_enabled)
+			{
+				return SIMDLevel::AVX512;
 			}
+			return SIMDLevel::AVX2;
+		}
+		return SIMDLevel::SSE;
+	}
+
+	static const SIMDKernels* KernelsForLevel(SIMDLevel_t level)
+	{
+		switch(level)
+		{
+		case SIMDLevel::AVX512:
+			return &AVX512Kernels;
+		case SIMDLevel::AVX2:
+			return &AVX2Kernels;
+		default:
+			return &SSEKernels;
+		}
+	}
+
+	// the SiCKL CPU interpreter runs one grid point per float lane of the current level
+	static void SetSiCKLLaneCount(SIMDLevel_t level)
+	{
+		const uint32_t lanes[SIMDLevel::Count] = {4, 8, 16};
+		SiCKL::CPURuntime::SetLaneCount(lanes[level]);
+	}
+
+	SIMDLevel_t GetSupportedSIMDLevel()
+	{
+		static const SIMDLevel_t supported_level = DetectSIMDLevel();
+		return supported_level;
+	}
+
+	// the first kernel call may come from several threads at once (ie: Hogwild workers), so the
+	// default level is picked exactly once with std::call_once
+	static std::once_flag CurrentSIMDLevelInitialized;
+	static std::atomic<const SIMDKernels*> CurrentSIMDKernels(nullptr);
+	static std::atomic<int> CurrentSIMDLevel(SIMDLevel::Invalid);
+
+	static void InitializeSIMDLevel()
+	{
+		std::call_once(CurrentSIMDLevelInitialized, []()
+		{
+			const SIMDLevel_t level = GetSupportedSIMDLevel();
+			CurrentSIMDKernels = KernelsForLevel(level);
+			CurrentSIMDLevel = level;
+			SetSiCKLLaneCount(level);
+		});
+	}
 
-			dp = _mm_hadd_ps(dp , dp);
-			dp = _mm_hadd_ps(dp , dp);
+	SIMDLevel_t GetSIMDLevel()
+	{
+		InitializeSIMDLevel();
+		return SIMDLevel_t(CurrentSIMDLevel.load());
+	}
 
-			// store back to intermediate buffer
-			_mm_store_ss(_accumulations + k, dp);
+	bool SetSIMDLevel(SIMDLevel_t in_level)
+	{
+		if(in_level <= SIMDLevel::Invalid || in_level > GetSupportedSIMDLevel())
+		{
+			return false;
 		}
 
+		// so a later first use can't put back the default
+		InitializeSIMDLevel();
+		CurrentSIMDKernels = KernelsForLevel(in_level);
+		CurrentSIMDLevel = in_level;
+		SetSiCKLLaneCount(in_level);
+		return true;
+	}
+
+	const SIMDKernels& GetSIMDKernels()
+	{
+		InitializeSIMDLevel();
+		return *CurrentSIMDKernels.load();
+	}
+
+	/// feature vectors
+
+	void FeatureMap::CalcFeatureVector(const float* input_vector, float* output_vector, ActivationFunction_t function) const
+	{
+		// verify alignment
+		assert((intptr_t(input_vector) % 16) == 0);
+		assert((intptr_t(output_vector) % 16) == 0);
+
+		const SIMDKernels& kernels = GetSIMDKernels();
+
+		kernels.CalcDotProducts(input_vector, _weights, feature_stride, _feature_blocks, _input_blocks, _accumulations);
+
 		switch(function)
 		{
 		case ActivationFunction::Linear:
-			CalcActivation(_accumulations, _biases, _feature_blocks, output_vector, _mm_noop_ps);
-			break;
 		case ActivationFunction::RectifiedLinear:
-			CalcActivation(_accumulations, _biases, _feature_blocks, output_vector, _mm_relu_ps);
-			break;
 		case ActivationFunction::Sigmoid:
-			CalcActivation(_accumulations, _biases, _feature_blocks, output_vector, _mm_sigmoid_ps);
+			kernels.CalcActivation(_accumulations, _biases, _feature_blocks, output_vector, function);
 			break;
 		case ActivationFunction::Softmax:
-			CalcActivation(_accumulations, _biases, _feature_blocks, output_vector, _mm_noop_ps);
+			kernels.CalcActivation(_accumulations, _biases, _feature_blocks, output_vector, ActivationFunction::Linear);
+			kernels.CalcSoftmax(output_vector, feature_count, _feature_blocks);
+			break;
+		}
+
+		// finally, set dangling values to 0
+		for(uint32_t k = feature_count; k < _feature_blocks * 4; k++)
+		{
+			output_vector[k] = 0.0f;
+		}
+	}
+
+	/// batched feature vectors
+
+	// input rows kept in cache while every feature is swept over them, so each weight
+	// is read from memory once per tile rather than once per row
+	static const uint32_t FeatureMatrixRowTile = 64;
+	// input blocks per pass; 4 features' worth of weights (16KB) stay in L1
+	static const uint32_t FeatureMatrixDepthTile = 256;
+
+	void FeatureMap::CalcFeatureMatrix(const float* input_matrix, uint32_t rows, float* output_matrix, ActivationFunction_t function) const
+	{
+		// verify alignment
+		assert((intptr_t(input_matrix) % 16) == 0);
+		assert((intptr_t(output_matrix) % 16) == 0);
+
+		const uint32_t input_stride = _input_blocks * 4;
+		const uint32_t output_stride = _feature_blocks * 4;
+		const SIMDKernels& kernels = GetSIMDKernels();
+
+		for(uint32_t row_begin = 0; row_begin < rows; row_begin += FeatureMatrixRowTile)
+		{
+			const uint32_t row_end = std::min(row_begin + FeatureMatrixRowTile, rows);
+
+			for(uint32_t depth_begin = 0; depth_begin < _input_blocks; depth_begin += FeatureMatrixDepthTile)
 			{
-				// to avoid overflow, we can subtract the max accumulation from all the exp(x) calls
-				// http://deeplearning.stanford.edu/wiki/index.php/Exercise:Softmax_Regression
+				const uint32_t depth_blocks = std::min(FeatureMatrixDepthTile, _input_blocks - depth_begin);
+				const bool first_pass = depth_begin == 0;
 
-				// set dangling values to -FLT_MAX
-				for(uint32_t k = feature_count; k < _feature_blocks * 4; k++)
+				for(uint32_t i = 0; i < _feature_blocks; i++)
 				{
-					output_vector[k] = -FLT_MAX;
+					const float* features = _weights + i * 4 * feature_stride + depth_begin * 4;
+
+					for(uint32_t j = row_begin; j < row_end; j += 2)
+					{
+						// an odd row count repeats the last row and drops its second result
+						const bool pair = j + 1 < row_end;
+						const float* input0 = input_matrix + j * input_stride + depth_begin * 4;
+						const float* input1 = pair ? input0 + input_stride : input0;
+						float* output0 = output_matrix + j * output_stride + i * 4;
+						float* output1 = output0 + output_stride;
+
+						__m128 dp0, dp1;
+						kernels.CalcDotProducts2x4(input0, input1, features, feature_stride, depth_blocks, dp0, dp1);
+
+						// partial sums from earlier passes are kept in the output
+						if(!first_pass)
+						{
+							dp0 = _mm_add_ps(dp0, _mm_load_ps(output0));
+							if(pair)
+							{
+								dp1 = _mm_add_ps(dp1, _mm_load_ps(output1));
+							}
+						}
+
+						_mm_store_ps(output0, dp0);
+						if(pair)
+						{
+							_mm_store_ps(output1, dp1);
+						}
+					}
 				}
+			}
 
-				// calculate the max value
-				__m128 max = _mm_set1_ps(-FLT_MAX);
-				float* accumulation_head = output_vector;
-				for(uint32_t k = 0; k < _feature_blocks; k++)
-				{
-					__m128 acc = _mm_load_ps(accumulation_head);
-					max = _mm_max_ps(max, acc);
-
-					accumulation_head += 4;
-				}
-				max = _mm_hmax_ps(max);
+			// the tile's rows are still in cache, so the biases and activation function are
+			// applied a whole row at a time with the widest kernels the machine has
+			for(uint32_t j = row_begin; j < row_end; j++)
+			{
+				float* output_vector = output_matrix + j * output_stride;
 
-				// calculate the divisor
-				__m128 divisor = _mm_setzero_ps();
-				accumulation_head = output_vector;
-				for(uint32_t k = 0; k < _feature_blocks; k++)
+				switch(function)
 				{
-					__m128 acc = _mm_load_ps(accumulation_head);
-					__m128 val = _mm_exp_ps(_mm_sub_ps(acc, max));
-					divisor = _mm_add_ps(divisor, val);
-
-					accumulation_head += 4;
+				case ActivationFunction::Linear:
+				case ActivationFunction::RectifiedLinear:
+				case ActivationFunction::Sigmoid:
+					kernels.CalcActivation(output_vector, _biases, _feature_blocks, output_vector, function);
+					break;
+				case ActivationFunction::Softmax:
+					kernels.CalcActivation(output_vector, _biases, _feature_blocks, output_vector, ActivationFunction::Linear);
+					kernels.CalcSoftmax(output_vector, feature_count, _feature_blocks);
+					break;
 				}
-				divisor = _mm_hadd_ps(divisor, divisor);
-				divisor = _mm_hadd_ps(divisor, divisor);
 
-				// now calculate softmax
-				accumulation_head = output_vector;
-				float* output_head = output_vector;
-				for(uint32_t k = 0; k < _feature_blocks; k++)
+				// finally, set dangling values to 0
+				for(uint32_t k = feature_count; k < output_stride; k++)
 				{
-					__m128 acc = _mm_load_ps(accumulation_head);
-					__m128 val = _mm_exp_ps(_mm_sub_ps(acc, max));
-					val = _mm_div_ps(val, divisor);
-
-					_mm_store_ps(output_head, val);
-
-					accumulation_head += 4;
-					output_head += 4;
+					output_vector[k] = 0.0f;
 				}
 			}
-			break;
-		}
-
-		// finally, set dangling values to 0
-		for(uint32_t k = feature_count; k < _feature_blocks * 4; k++)
-		{
-			output_vector[k] = 0.0f;
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,315 @@
+// stdc
+#include <float.h>
+
+// windows
+#include <intrin.h>
+
+// OMLT
+#include "Common.h"
+#include "SIMD.h"
+
+/*
+ * AVX2 + FMA versions of the SSE kernels in Common.cpp; this file is built
+ * with /arch:AVX2 and only called into when CPUID reports support for it.
+ *
+ * Vectors are 4 float blocks, so they are walked 2 blocks at a time with
+ * unaligned loads and an odd last block is handled with masked loads/stores.
+ */
+
+namespace OMLT
+{
+	namespace AVX2
+	{
+		// lower 4 floats only
+		static inline __m256i LowHalf()
+		{
+			return _mm256_setr_epi32(-1, -1, -1, -1, 0, 0, 0, 0);
+		}
+
+		static inline __m256 _mm256_abs_ps(__m256 x)
+		{
+			return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)));
+		}
+
+		// 1.0f with the sign of x
+		static inline __m256 _mm256_sign_ps(__m256 x)
+		{
+			return _mm256_or_ps(_mm256_set1_ps(1.0f), _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000))));
+		}
+
+		static inline __m256 _mm256_noop_ps(__m256 x)
+		{
+			return x;
+		}
+
+		static inline __m256 _mm256_relu_ps(__m256 x)
+		{
+			return _mm256_max_ps(_mm256_setzero_ps(), x);
+		}
+
+		// see _mm_sigmoid_ps
+		static inline __m256 _mm256_sigmoid_ps(__m256 x0)
+		{
+			__m256 sign = _mm256_sign_ps(x0);
+
+			// (min(abs(x), 4) - 4)^2 / -32 * sign(x)
+			__m256 x = _mm256_sub_ps(_mm256_min_ps(_mm256_abs_ps(x0), _mm256_set1_ps(4.0f)), _mm256_set1_ps(4.0f));
+			x = _mm256_div_ps(_mm256_mul_ps(x, x), _mm256_set1_ps(-32.0f));
+			x = _mm256_mul_ps(x, sign);
+
+			// + (sign(x) + 1) / 2
+			__m256 shift = _mm256_mul_ps(_mm256_add_ps(sign, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f));
+			return _mm256_add_ps(shift, x);
+		}
+
+		// see _mm_ln_1_plus_e_x_ps
+		static inline __m256 _mm256_ln_1_plus_e_x_ps(__m256 x)
+		{
+			x = _mm256_max_ps(_mm256_set1_ps(-4.0f), x);
+
+			__m256 y0 = _mm256_add_ps(_mm256_set1_ps(4.0f), x);
+			y0 = _mm256_mul_ps(_mm256_set1_ps(12.0f), y0);
+			y0 = _mm256_sub_ps(y0, _mm256_mul_ps(_mm256_mul_ps(x, x), _mm256_sign_ps(x)));
+			y0 = _mm256_mul_ps(x, y0);
+			y0 = _mm256_add_ps(_mm256_set1_ps(64.0f), y0);
+			y0 = _mm256_mul_ps(y0, _mm256_set1_ps(1.0f / 96.0f));
+
+			__m256 sign_4_minus_x = _mm256_sign_ps(_mm256_sub_ps(_mm256_set1_ps(4.0f), x));
+			__m256 left = _mm256_mul_ps(_mm256_add_ps(y0, _mm256_mul_ps(y0, sign_4_minus_x)), _mm256_set1_ps(0.5f));
+			__m256 right = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_mul_ps(x, sign_4_minus_x)), _mm256_set1_ps(0.5f));
+
+			return _mm256_max_ps(left, right);
+		}
+
+		// see _mm_exp_ps
+		static inline __m256 _mm256_exp_ps(__m256 x)
+		{
+			x = _mm256_max_ps(x, _mm256_set1_ps(-87.336540f));
+			x = _mm256_min_ps(x, _mm256_set1_ps(88.722816f));
+
+			__m256 a_times_x = _mm256_mul_ps(_mm256_set1_ps(float(1 << 23)), x);
+			a_times_x = _mm256_div_ps(a_times_x, _mm256_set1_ps(0.693147180559945309f));
+
+			__m256 sum = _mm256_add_ps(a_times_x, _mm256_set1_ps(1065353216.0f));
+			return _mm256_castsi256_ps(_mm256_cvtps_epi32(sum));
+		}
+
+		// {sum(a), sum(b), sum(c), sum(d)}
+		static inline __m128 _mm256_hsum4_ps(__m256 a, __m256 b, __m256 c, __m256 d)
+		{
+			__m256 sum = _mm256_hadd_ps(_mm256_hadd_ps(a, b), _mm256_hadd_ps(c, d));
+			return _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+		}
+
+		static inline float _mm256_hsum_ps(__m256 x)
+		{
+			__m128 sum = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+			sum = _mm_hadd_ps(sum, sum);
+			sum = _mm_hadd_ps(sum, sum);
+			return _mm_cvtss_f32(sum);
+		}
+
+		static inline float _mm256_hmax_ps(__m256 x)
+		{
+			__m128 max = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+			max = _mm_max_ps(max, _mm_shuffle_ps(max, max, _MM_SHUFFLE(0, 3, 2, 1)));
+			max = _mm_max_ps(max, _mm_shuffle_ps(max, max, _MM_SHUFFLE(1, 0, 3, 2)));
+			return _mm_cvtss_f32(max);
+		}
+
+		static void CalcDotProducts(const float* input, const float* features, uint32_t feature_stride, uint32_t feature_blocks, uint32_t input_blocks, float* out_accumulations)
+		{
+			const __m256i low_half = LowHalf();
+
+			for(uint32_t k = 0; k < feature_blocks * 4; k += 4)
+			{
+				const float* feature0 = features + k * feature_stride;
+				const float* feature1 = feature0 + feature_stride;
+				const float* feature2 = feature1 + feature_stride;
+				const float* feature3 = feature2 + feature_stride;
+
+				__m256 dp0 = _mm256_setzero_ps();
+				__m256 dp1 = _mm256_setzero_ps();
+				__m256 dp2 = _mm256_setzero_ps();
+				__m256 dp3 = _mm256_setzero_ps();
+
+				uint32_t j = 0;
+				for(; j + 2 <= input_blocks; j += 2)
+				{
+					__m256 val = _mm256_loadu_ps(input + j * 4);
+					dp0 = _mm256_fmadd_ps(val, _mm256_loadu_ps(feature0 + j * 4), dp0);
+					dp1 = _mm256_fmadd_ps(val, _mm256_loadu_ps(feature1 + j * 4), dp1);
+					dp2 = _mm256_fmadd_ps(val, _mm256_loadu_ps(feature2 + j * 4), dp2);
+					dp3 = _mm256_fmadd_ps(val, _mm256_loadu_ps(feature3 + j * 4), dp3);
+				}
+				if(j < input_blocks)
+				{
+					__m256 val = _mm256_maskload_ps(input + j * 4, low_half);
+					dp0 = _mm256_fmadd_ps(val, _mm256_maskload_ps(feature0 + j * 4, low_half), dp0);
+					dp1 = _mm256_fmadd_ps(val, _mm256_maskload_ps(feature1 + j * 4, low_half), dp1);
+					dp2 = _mm256_fmadd_ps(val, _mm256_maskload_ps(feature2 + j * 4, low_half), dp2);
+					dp3 = _mm256_fmadd_ps(val, _mm256_maskload_ps(feature3 + j * 4, low_half), dp3);
+				}
+
+				_mm_store_ps(out_accumulations + k, _mm256_hsum4_ps(dp0, dp1, dp2, dp3));
+			}
+		}
+
+		static void CalcDotProducts2x4(const float* input0, const float* input1, const float* features, uint32_t feature_stride, uint32_t blocks, __m128& out_dp0, __m128& out_dp1)
+		{
+			const float* feature0 = features;
+			const float* feature1 = feature0 + feature_stride;
+			const float* feature2 = feature1 + feature_stride;
+			const float* feature3 = feature2 + feature_stride;
+
+			__m256 dp00 = _mm256_setzero_ps();
+			__m256 dp01 = _mm256_setzero_ps();
+			__m256 dp02 = _mm256_setzero_ps();
+			__m256 dp03 = _mm256_setzero_ps();
+			__m256 dp10 = _mm256_setzero_ps();
+			__m256 dp11 = _mm256_setzero_ps();
+			__m256 dp12 = _mm256_setzero_ps();
+			__m256 dp13 = _mm256_setzero_ps();
+
+			auto accumulate = [&](__m256 val0, __m256 val1, __m256 feat0, __m256 feat1, __m256 feat2, __m256 feat3)
+			{
+				dp00 = _mm256_fmadd_ps(val0, feat0, dp00);
+				dp10 = _mm256_fmadd_ps(val1, feat0, dp10);
+				dp01 = _mm256_fmadd_ps(val0, feat1, dp01);
+				dp11 = _mm256_fmadd_ps(val1, feat1, dp11);
+				dp02 = _mm256_fmadd_ps(val0, feat2, dp02);
+				dp12 = _mm256_fmadd_ps(val1, feat2, dp12);
+				dp03 = _mm256_fmadd_ps(val0, feat3, dp03);
+				dp13 = _mm256_fmadd_ps(val1, feat3, dp13);
+			};
+
+			uint32_t j = 0;
+			for(; j + 2 <= blocks; j += 2)
+			{
+				accumulate(
+					_mm256_loadu_ps(input0 + j * 4), _mm256_loadu_ps(input1 + j * 4),
+					_mm256_loadu_ps(feature0 + j * 4), _mm256_loadu_ps(feature1 + j * 4), _mm256_loadu_ps(feature2 + j * 4), _mm256_loadu_ps(feature3 + j * 4));
+			}
+			if(j < blocks)
+			{
+				const __m256i low_half = LowHalf();
+				accumulate(
+					_mm256_maskload_ps(input0 + j * 4, low_half), _mm256_maskload_ps(input1 + j * 4, low_half),
+					_mm256_maskload_ps(feature0 + j * 4, low_half), _mm256_maskload_ps(feature1 + j * 4, low_half), _mm256_maskload_ps(feature2 + j * 4, low_half), _mm256_maskload_ps(feature3 + j * 4, low_half));
+			}
+
+			out_dp0 = _mm256_hsum4_ps(dp00, dp01, dp02, dp03);
+			out_dp1 = _mm256_hsum4_ps(dp10, dp11, dp12, dp13);
+		}
+
+		template<typename FUNC>
+		static void CalcActivation(const float* accumulations, const float* biases, uint32_t blocks, float* activations, FUNC _mm256_activation)
+		{
+			uint32_t k = 0;
+			for(; k + 2 <= blocks; k += 2)
+			{
+				__m256 acc = _mm256_add_ps(_mm256_loadu_ps(biases + k * 4), _mm256_loadu_ps(accumulations + k * 4));
+				_mm256_storeu_ps(activations + k * 4, _mm256_activation(acc));
+			}
+			if(k < blocks)
+			{
+				const __m256i low_half = LowHalf();
+				__m256 acc = _mm256_add_ps(_mm256_maskload_ps(biases + k * 4, low_half), _mm256_maskload_ps(accumulations + k * 4, low_half));
+				_mm256_maskstore_ps(activations + k * 4, low_half, _mm256_activation(acc));
+			}
+		}
+
+		static void CalcActivation(const float* accumulations, const float* biases, uint32_t blocks, float* activations, ActivationFunction_t function)
+		{
+			switch(function)
+			{
+			case ActivationFunction::Linear:
+				CalcActivation(accumulations, biases, blocks, activations, _mm256_noop_ps);
+				break;
+			case ActivationFunction::RectifiedLinear:
+				CalcActivation(accumulations, biases, blocks, activations, _mm256_relu_ps);
+				break;
+			case ActivationFunction::Sigmoid:
+				CalcActivation(accumulations, biases, blocks, activations, _mm256_sigmoid_ps);
+				break;
+			}
+		}
+
+		static void CalcSoftmax(float* vector, uint32_t count, uint32_t blocks)
+		{
+			// set dangling values to -FLT_MAX so they don't affect the max and exp to 0
+			for(uint32_t k = count; k < blocks * 4; k++)
+			{
+				vector[k] = -FLT_MAX;
+			}
+
+			const __m256i low_half = LowHalf();
+			const uint32_t pairs = blocks / 2;
+			const bool odd = (blocks % 2) == 1;
+
+			// calculate the max value
+			__m256 max = _mm256_set1_ps(-FLT_MAX);
+			for(uint32_t k = 0; k < pairs; k++)
+			{
+				max = _mm256_max_ps(max, _mm256_loadu_ps(vector + k * 8));
+			}
+			if(odd)
+			{
+				// in both halves, which doesn't change the max
+				max = _mm256_max_ps(max, _mm256_broadcast_ps((const __m128*)(vector + pairs * 8)));
+			}
+			max = _mm256_set1_ps(_mm256_hmax_ps(max));
+
+			// calculate the divisor
+			__m256 divisor = _mm256_setzero_ps();
+			for(uint32_t k = 0; k < pairs; k++)
+			{
+				divisor = _mm256_add_ps(divisor, _mm256_exp_ps(_mm256_sub_ps(_mm256_loadu_ps(vector + k * 8), max)));
+			}
+			if(odd)
+			{
+				__m256 val = _mm256_exp_ps(_mm256_sub_ps(_mm256_maskload_ps(vector + pairs * 8, low_half), max));
+				divisor = _mm256_add_ps(divisor, _mm256_and_ps(val, _mm256_castsi256_ps(low_half)));
+			}
+			divisor = _mm256_set1_ps(_mm256_hsum_ps(divisor));
+
+			// now calculate softmax
+			for(uint32_t k = 0; k < pairs; k++)
+			{
+				__m256 val = _mm256_exp_ps(_mm256_sub_ps(_mm256_loadu_ps(vector + k * 8), max));
+				_mm256_storeu_ps(vector + k * 8, _mm256_div_ps(val, divisor));
+			}
+			if(odd)
+			{
+				__m256 val = _mm256_exp_ps(_mm256_sub_ps(_mm256_maskload_ps(vector + pairs * 8, low_half), max));
+				_mm256_maskstore_ps(vector + pairs * 8, low_half, _mm256_div_ps(val, divisor));
+			}
+		}
+
+		static float SumLn1PlusEx(const float* vector, uint32_t blocks)
+		{
+			__m256 sum = _mm256_setzero_ps();
+			uint32_t k = 0;
+			for(; k + 2 <= blocks; k += 2)
+			{
+				sum = _mm256_add_ps(sum, _mm256_ln_1_plus_e_x_ps(_mm256_loadu_ps(vector + k * 4)));
+			}
+			if(k < blocks)
+			{
+				const __m256i low_half = LowHalf();
+				__m256 val = _mm256_ln_1_plus_e_x_ps(_mm256_maskload_ps(vector + k * 4, low_half));
+				sum = _mm256_add_ps(sum, _mm256_and_ps(val, _mm256_castsi256_ps(low_half)));
+			}
+			return _mm256_hsum_ps(sum);
+		}
+	}
+
+	const SIMDKernels AVX2Kernels =
+	{
+		AVX2::CalcDotProducts,
+		AVX2::CalcDotProducts2x4,
+		AVX2::CalcActivation,
+		AVX2::CalcSoftmax,
+		AVX2::SumLn1PlusEx,
+	};
+}
\ No newline at end of file
@@ -0,0 +1,322 @@
+// stdc
+#include <float.h>
+
+// windows
+#include <intrin.h>
+
+// OMLT
+#include "Common.h"
+#include "SIMD.h"
+
+/*
+ * AVX-512 versions of the SSE kernels in Common.cpp; this file is built
+ * with /arch:AVX512 and only called into when CPUID reports support for it.
+ * Only AVX512F instructions are used.
+ *
+ * Vectors are 4 float blocks, so they are walked 4 blocks at a time with
+ * unaligned loads and the remaining blocks are handled with masked loads/stores.
+ */
+
+namespace OMLT
+{
+	namespace AVX512
+	{
+		// lanes of the last (blocks % 4) blocks
+		static inline __mmask16 TailMask(uint32_t blocks)
+		{
+			return (__mmask16)((1u << ((blocks % 4) * 4)) - 1);
+		}
+
+		// 1.0f with the sign of x
+		static inline __m512 _mm512_sign_ps(__m512 x)
+		{
+			__m512i sign = _mm512_and_epi32(_mm512_castps_si512(x), _mm512_set1_epi32(0x80000000));
+			return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_castps_si512(_mm512_set1_ps(1.0f)), sign));
+		}
+
+		static inline __m512 _mm512_noop_ps(__m512 x)
+		{
+			return x;
+		}
+
+		static inline __m512 _mm512_relu_ps(__m512 x)
+		{
+			return _mm512_max_ps(_mm512_setzero_ps(), x);
+		}
+
+		// see _mm_sigmoid_ps
+		static inline __m512 _mm512_sigmoid_ps(__m512 x0)
+		{
+			__m512 sign = _mm512_sign_ps(x0);
+
+			// (min(abs(x), 4) - 4)^2 / -32 * sign(x)
+			__m512 x = _mm512_sub_ps(_mm512_min_ps(_mm512_abs_ps(x0), _mm512_set1_ps(4.0f)), _mm512_set1_ps(4.0f));
+			x = _mm512_div_ps(_mm512_mul_ps(x, x), _mm512_set1_ps(-32.0f));
+			x = _mm512_mul_ps(x, sign);
+
+			// + (sign(x) + 1) / 2
+			__m512 shift = _mm512_mul_ps(_mm512_add_ps(sign, _mm512_set1_ps(1.0f)), _mm512_set1_ps(0.5f));
+			return _mm512_add_ps(shift, x);
+		}
+
+		// see _mm_ln_1_plus_e_x_ps
+		static inline __m512 _mm512_ln_1_plus_e_x_ps(__m512 x)
+		{
+			x = _mm512_max_ps(_mm512_set1_ps(-4.0f), x);
+
+			__m512 y0 = _mm512_add_ps(_mm512_set1_ps(4.0f), x);
+			y0 = _mm512_mul_ps(_mm512_set1_ps(12.0f), y0);
+			y0 = _mm512_sub_ps(y0, _mm512_mul_ps(_mm512_mul_ps(x, x), _mm512_sign_ps(x)));
+			y0 = _mm512_mul_ps(x, y0);
+			y0 = _mm512_add_ps(_mm512_set1_ps(64.0f), y0);
+			y0 = _mm512_mul_ps(y0, _mm512_set1_ps(1.0f / 96.0f));
+
+			__m512 sign_4_minus_x = _mm512_sign_ps(_mm512_sub_ps(_mm512_set1_ps(4.0f), x));
+			__m512 left = _mm512_mul_ps(_mm512_add_ps(y0, _mm512_mul_ps(y0, sign_4_minus_x)), _mm512_set1_ps(0.5f));
+			__m512 right = _mm512_mul_ps(_mm512_sub_ps(x, _mm512_mul_ps(x, sign_4_minus_x)), _mm512_set1_ps(0.5f));
+
+			return _mm512_max_ps(left, right);
+		}
+
+		// see _mm_exp_ps
+		static inline __m512 _mm512_exp_ps(__m512 x)
+		{
+			x = _mm512_max_ps(x, _mm512_set1_ps(-87.336540f));
+			x = _mm512_min_ps(x, _mm512_set1_ps(88.722816f));
+
+			__m512 a_times_x = _mm512_mul_ps(_mm512_set1_ps(float(1 << 23)), x);
+			a_times_x = _mm512_div_ps(a_times_x, _mm512_set1_ps(0.693147180559945309f));
+
+			__m512 sum = _mm512_add_ps(a_times_x, _mm512_set1_ps(1065353216.0f));
+			return _mm512_castsi512_ps(_mm512_cvtps_epi32(sum));
+		}
+
+		// adds the upper and lower 256 bits together
+		static inline __m256 _mm512_fold_ps(__m512 x)
+		{
+			__m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1));
+			return _mm256_add_ps(_mm512_castps512_ps256(x), high);
+		}
+
+		// {sum(a), sum(b), sum(c), sum(d)}
+		static inline __m128 _mm512_hsum4_ps(__m512 a, __m512 b, __m512 c, __m512 d)
+		{
+			__m256 sum = _mm256_hadd_ps(_mm256_hadd_ps(_mm512_fold_ps(a), _mm512_fold_ps(b)), _mm256_hadd_ps(_mm512_fold_ps(c), _mm512_fold_ps(d)));
+			return _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+		}
+
+		static inline float _mm512_hsum_ps(__m512 x)
+		{
+			__m256 sum256 = _mm512_fold_ps(x);
+			__m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum256), _mm256_extractf128_ps(sum256, 1));
+			sum = _mm_hadd_ps(sum, sum);
+			sum = _mm_hadd_ps(sum, sum);
+			return _mm_cvtss_f32(sum);
+		}
+
+		static inline float _mm512_hmax_ps(__m512 x)
+		{
+			__m256 max256 = _mm256_max_ps(_mm512_castps512_ps256(x), _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1)));
+			__m128 max = _mm_max_ps(_mm256_castps256_ps128(max256), _mm256_extractf128_ps(max256, 1));
+			max = _mm_max_ps(max, _mm_shuffle_ps(max, max, _MM_SHUFFLE(0, 3, 2, 1)));
+			max = _mm_max_ps(max, _mm_shuffle_ps(max, max, _MM_SHUFFLE(1, 0, 3, 2)));
+			return _mm_cvtss_f32(max);
+		}
+
+		static void CalcDotProducts(const float* input, const float* features, uint32_t feature_stride, uint32_t feature_blocks, uint32_t input_blocks, float* out_accumulations)
+		{
+			const uint32_t full_blocks = input_blocks - input_blocks % 4;
+			const __mmask16 tail = TailMask(input_blocks);
+
+			for(uint32_t k = 0; k < feature_blocks * 4; k += 4)
+			{
+				const float* feature0 = features + k * feature_stride;
+				const float* feature1 = feature0 + feature_stride;
+				const float* feature2 = feature1 + feature_stride;
+				const float* feature3 = feature2 + feature_stride;
+
+				__m512 dp0 = _mm512_setzero_ps();
+				__m512 dp1 = _mm512_setzero_ps();
+				__m512 dp2 = _mm512_setzero_ps();
+				__m512 dp3 = _mm512_setzero_ps();
+
+				for(uint32_t j = 0; j < full_blocks; j += 4)
+				{
+					__m512 val = _mm512_loadu_ps(input + j * 4);
+					dp0 = _mm512_fmadd_ps(val, _mm512_loadu_ps(feature0 + j * 4), dp0);
+					dp1 = _mm512_fmadd_ps(val, _mm512_loadu_ps(feature1 + j * 4), dp1);
+					dp2 = _mm512_fmadd_ps(val, _mm512_loadu_ps(feature2 + j * 4), dp2);
+					dp3 = _mm512_fmadd_ps(val, _mm512_loadu_ps(feature3 + j * 4), dp3);
+				}
+				if(tail != 0)
+				{
+					const uint32_t j = full_blocks;
+					__m512 val = _mm512_maskz_loadu_ps(tail, input + j * 4);
+					dp0 = _mm512_fmadd_ps(val, _mm512_maskz_loadu_ps(tail, feature0 + j * 4), dp0);
+					dp1 = _mm512_fmadd_ps(val, _mm512_maskz_loadu_ps(tail, feature1 + j * 4), dp1);
+					dp2 = _mm512_fmadd_ps(val, _mm512_maskz_loadu_ps(tail, feature2 + j * 4), dp2);
+					dp3 = _mm512_fmadd_ps(val, _mm512_maskz_loadu_ps(tail, feature3 + j * 4), dp3);
+				}
+
+				_mm_store_ps(out_accumulations + k, _mm512_hsum4_ps(dp0, dp1, dp2, dp3));
+			}
+		}
+
+		static void CalcDotProducts2x4(const float* input0, const float* input1, const float* features, uint32_t feature_stride, uint32_t blocks, __m128& out_dp0, __m128& out_dp1)
+		{
+			const float* feature0 = features;
+			const float* feature1 = feature0 + feature_stride;
+			const float* feature2 = feature1 + feature_stride;
+			const float* feature3 = feature2 + feature_stride;
+
+			__m512 dp00 = _mm512_setzero_ps();
+			__m512 dp01 = _mm512_setzero_ps();
+			__m512 dp02 = _mm512_setzero_ps();
+			__m512 dp03 = _mm512_setzero_ps();
+			__m512 dp10 = _mm512_setzero_ps();
+			__m512 dp11 = _mm512_setzero_ps();
+			__m512 dp12 = _mm512_setzero_ps();
+			__m512 dp13 = _mm512_setzero_ps();
+
+			auto accumulate = [&](__m512 val0, __m512 val1, __m512 feat0, __m512 feat1, __m512 feat2, __m512 feat3)
+			{
+				dp00 = _mm512_fmadd_ps(val0, feat0, dp00);
+				dp10 = _mm512_fmadd_ps(val1, feat0, dp10);
+				dp01 = _mm512_fmadd_ps(val0, feat1, dp01);
+				dp11 = _mm512_fmadd_ps(val1, feat1, dp11);
+				dp02 = _mm512_fmadd_ps(val0, feat2, dp02);
+				dp12 = _mm512_fmadd_ps(val1, feat2, dp12);
+				dp03 = _mm512_fmadd_ps(val0, feat3, dp03);
+				dp13 = _mm512_fmadd_ps(val1, feat3, dp13);
+			};
+
+			const uint32_t full_blocks = blocks - blocks % 4;
+			for(uint32_t j = 0; j < full_blocks; j += 4)
+			{
+				accumulate(
+					_mm512_loadu_ps(input0 + j * 4), _mm512_loadu_ps(input1 + j * 4),
+					_mm512_loadu_ps(feature0 + j * 4), _mm512_loadu_ps(feature1 + j * 4), _mm512_loadu_ps(feature2 + j * 4), _mm512_loadu_ps(feature3 + j * 4));
+			}
+			const __mmask16 tail = TailMask(blocks);
+			if(tail != 0)
+			{
+				const uint32_t j = full_blocks;
+				accumulate(
+					_mm512_maskz_loadu_ps(tail, input0 + j * 4), _mm512_maskz_loadu_ps(tail, input1 + j * 4),
+					_mm512_maskz_loadu_ps(tail, feature0 + j * 4), _mm512_maskz_loadu_ps(tail, feature1 + j * 4), _mm512_maskz_loadu_ps(tail, feature2 + j * 4), _mm512_maskz_loadu_ps(tail, feature3 + j * 4));
+			}
+
+			out_dp0 = _mm512_hsum4_ps(dp00, dp01, dp02, dp03);
+			out_dp1 = _mm512_hsum4_ps(dp10, dp11, dp12, dp13);
+		}
+
+		template<typename FUNC>
+		static void CalcActivation(const float* accumulations, const float* biases, uint32_t blocks, float* activations, FUNC _mm512_activation)
+		{
+			const uint32_t full_blocks = blocks - blocks % 4;
+			for(uint32_t k = 0; k < full_blocks; k += 4)
+			{
+				__m512 acc = _mm512_add_ps(_mm512_loadu_ps(biases + k * 4), _mm512_loadu_ps(accumulations + k * 4));
+				_mm512_storeu_ps(activations + k * 4, _mm512_activation(acc));
+			}
+			const __mmask16 tail = TailMask(blocks);
+			if(tail != 0)
+			{
+				const uint32_t k = full_blocks;
+				__m512 acc = _mm512_add_ps(_mm512_maskz_loadu_ps(tail, biases + k * 4), _mm512_maskz_loadu_ps(tail, accumulations + k * 4));
+				_mm512_mask_storeu_ps(activations + k * 4, tail, _mm512_activation(acc));
+			}
+		}
+
+		static void CalcActivation(const float* accumulations, const float* biases, uint32_t blocks, float* activations, ActivationFunction_t function)
+		{
+			switch(function)
+			{
+			case ActivationFunction::Linear:
+				CalcActivation(accumulations, biases, blocks, activations, _mm512_noop_ps);
+				break;
+			case ActivationFunction::RectifiedLinear:
+				CalcActivation(accumulations, biases, blocks, activations, _mm512_relu_ps);
+				break;
+			case ActivationFunction::Sigmoid:
+				CalcActivation(accumulations, biases, blocks, activations, _mm512_sigmoid_ps);
+				break;
+			}
+		}
+
+		static void CalcSoftmax(float* vector, uint32_t count, uint32_t blocks)
+		{
+			// set dangling values to -FLT_MAX so they don't affect the max and exp to 0
+			for(uint32_t k = count; k < blocks * 4; k++)
+			{
+				vector[k] = -FLT_MAX;
+			}
+
+			const uint32_t full_blocks = blocks - blocks % 4;
+			const __mmask16 tail = TailMask(blocks);
+
+			// calculate the max value
+			__m512 max = _mm512_set1_ps(-FLT_MAX);
+			for(uint32_t k = 0; k < full_blocks; k += 4)
+			{
+				max = _mm512_max_ps(max, _mm512_loadu_ps(vector + k * 4));
+			}
+			if(tail != 0)
+			{
+				max = _mm512_mask_max_ps(max, tail, max, _mm512_maskz_loadu_ps(tail, vector + full_blocks * 4));
+			}
+			max = _mm512_set1_ps(_mm512_hmax_ps(max));
+
+			// calculate the divisor
+			__m512 divisor = _mm512_setzero_ps();
+			for(uint32_t k = 0; k < full_blocks; k += 4)
+			{
+				divisor = _mm512_add_ps(divisor, _mm512_exp_ps(_mm512_sub_ps(_mm512_loadu_ps(vector + k * 4), max)));
+			}
+			if(tail != 0)
+			{
+				__m512 val = _mm512_exp_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(tail, vector + full_blocks * 4), max));
+				divisor = _mm512_mask_add_ps(divisor, tail, divisor, val);
+			}
+			divisor = _mm512_set1_ps(_mm512_hsum_ps(divisor));
+
+			// now calculate softmax
+			for(uint32_t k = 0; k < full_blocks; k += 4)
+			{
+				__m512 val = _mm512_exp_ps(_mm512_sub_ps(_mm512_loadu_ps(vector + k * 4), max));
+				_mm512_storeu_ps(vector + k * 4, _mm512_div_ps(val, divisor));
+			}
+			if(tail != 0)
+			{
+				__m512 val = _mm512_exp_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(tail, vector + full_blocks * 4), max));
+				_mm512_mask_storeu_ps(vector + full_blocks * 4, tail, _mm512_div_ps(val, divisor));
+			}
+		}
+
+		static float SumLn1PlusEx(const float* vector, uint32_t blocks)
+		{
+			const uint32_t full_blocks = blocks - blocks % 4;
+			__m512 sum = _mm512_setzero_ps();
+			for(uint32_t k = 0; k < full_blocks; k += 4)
+			{
+				sum = _mm512_add_ps(sum, _mm512_ln_1_plus_e_x_ps(_mm512_loadu_ps(vector + k * 4)));
+			}
+			const __mmask16 tail = TailMask(blocks);
+			if(tail != 0)
+			{
+				__m512 val = _mm512_ln_1_plus_e_x_ps(_mm512_maskz_loadu_ps(tail, vector + full_blocks * 4));
+				sum = _mm512_mask_add_ps(sum, tail, sum, val);
+			}
+			return _mm512_hsum_ps(sum);
+		}
+	}
+
+	const SIMDKernels AVX512Kernels =
+	{
+		AVX512::CalcDotProducts,
+		AVX512::CalcDotProducts2x4,
+		AVX512::CalcActivation,
+		AVX512::CalcSoftmax,
+		AVX512::SumLn1PlusEx,
+	};
+}
\ No newline at end of file
@@ -90,7 +90,7 @@ namespace OMLT
 		}
 	}
 
-	void ContrastiveDivergence::Train( const OpenGLBuffer2D& in_example)
+	void ContrastiveDivergence::Train( const SiCKLBuffer2D& in_example)
 	{
 		if(_recompile_required)
 		{
@@ -219,7 +219,7 @@ namespace OMLT
 		return _error_calculator->CalcError(_visible0, _visible_prime0);
 	}
 
-	float ContrastiveDivergence::GetReconstructionError( const OpenGLBuffer2D& in_example)
+	float ContrastiveDivergence::GetReconstructionError( const SiCKLBuffer2D& in_example)
 	{
 		if(_recompile_required)
 		{
@@ -229,7 +229,7 @@ namespace OMLT
 			_recompile_required = false;
 		}
 
-		OpenGLBuffer2D prev_visible0 = _visible0;
+		SiCKLBuffer2D prev_visible0 = _visible0;
 		_visible0 = in_example;
 
 		/// Calc Hidden and States from Visible
@@ -334,6 +334,21 @@ namespace OMLT
 		return rbm;
 	}
 
+	uint32_t ContrastiveDivergence::GetParameterCount() const
+	{
+		return 2 * (_model_config.VisibleUnits + 1) * (_model_config.HiddenUnits + 1);
+	}
+
+	void ContrastiveDivergence::GetParameters(float* out_parameters) const
+	{
+		GetWeightParameters(_weights0, _delta_weights0, out_parameters);
+	}
+
+	void ContrastiveDivergence::SetParameters(const float* in_parameters)
+	{
+		SetWeightParameters(in_parameters, _training_config.Momentum, _weights0, _delta_weights0, _nesterov_weight);
+	}
+
 	bool ContrastiveDivergence::DumpLastVisible( float** image, float** recon )
 	{
 		assert(image != nullptr);
@@ -379,7 +394,7 @@ namespace OMLT
 
 	void ContrastiveDivergence::build_kernels()
 	{
-		OpenGLCompiler compiler;
+		SiCKLCompiler compiler;
 
 		/// Calc Enabled Visible
 		SourceCalcEnabled src_calc_enabled_visible;
@@ -521,32 +536,32 @@ namespace OMLT
 		uint32_t* hidden_dropout_seed_buffer = GetSeedBuffer(_model_config.HiddenUnits * 4, 1, random);
 		uint32_t* hidden_seed_buffer = GetSeedBuffer(_model_config.HiddenUnits * 4, _minibatch_size, random);
 
-		_visible_dropout_random0 = OpenGLBuffer2D(_model_config.VisibleUnits, 1, ReturnType::UInt4, visible_dropout_seed_buffer);
-		_visible_dropout_random1 = OpenGLBuffer2D(_model_config.VisibleUnits, 1, ReturnType::UInt4, nullptr);
-		_hidden_dropout_random0 = OpenGLBuffer2D(_model_config.HiddenUnits, 1, ReturnType::UInt4, hidden_dropout_seed_buffer);
-		_hidden_dropout_random1 = OpenGLBuffer2D(_model_config.HiddenUnits, 1, ReturnType::UInt4, nullptr);
+		_visible_dropout_random0 = SiCKLBuffer2D(_model_config.VisibleUnits, 1, ReturnType::UInt4, visible_dropout_seed_buffer);
+		_visible_dropout_random1 = SiCKLBuffer2D(_model_config.VisibleUnits, 1, ReturnType::UInt4, nullptr);
+		_hidden_dropout_random0 = SiCKLBuffer2D(_model_config.HiddenUnits, 1, ReturnType::UInt4, hidden_dropout_seed_buffer);
+		_hidden_dropout_random1 = SiCKLBuffer2D(_model_config.HiddenUnits, 1, ReturnType::UInt4, nullptr);
 
-		_enabled_visible = OpenGLBuffer2D(_model_config.VisibleUnits, 1, ReturnType::UInt, nullptr);
-		_enabled_hidden = OpenGLBuffer2D(_model_config.HiddenUnits, 1, ReturnType::UInt, nullptr);
+		_enabled_visible = SiCKLBuffer2D(_model_config.VisibleUnits, 1, ReturnType::UInt, nullptr);
+		_enabled_hidden = SiCKLBuffer2D(_model_config.HiddenUnits, 1, ReturnType::UInt, nullptr);
 
-		_visible0 = OpenGLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
-		_hidden0 = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
-		_hidden_random0 = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::UInt4, hidden_seed_buffer);
-		_hidden_random1 = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::UInt4, nullptr);
-		_hidden_states = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
-		_visible_prime0 = OpenGLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
-		_hidden_prime0 = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
+		_visible0 = SiCKLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
+		_hidden0 = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
+		_hidden_random0 = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::UInt4, hidden_seed_buffer);
+		_hidden_random1 = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::UInt4, nullptr);
+		_hidden_states = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
+		_visible_prime0 = SiCKLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
+		_hidden_prime0 = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
 
 		if(_model_config.VisibleType == ActivationFunction::Softmax)
 		{
-			_visible1 = OpenGLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
-			_visible_prime1 = OpenGLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
+			_visible1 = SiCKLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
+			_visible_prime1 = SiCKLBuffer2D(_model_config.VisibleUnits, _minibatch_size, ReturnType::Float, nullptr);
 		}
 
 		if(_model_config.HiddenType == ActivationFunction::Softmax)
 		{
-			_hidden1 = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
-			_hidden_prime1 = OpenGLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
+			_hidden1 = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
+			_hidden_prime1 = SiCKLBuffer2D(_model_config.HiddenUnits, _minibatch_size, ReturnType::Float, nullptr);
 		}
 
 		// allocate a weight buffer and copy it to buffer
@@ -576,20 +591,22 @@ namespace OMLT
 					index++;
 				}
 			}
-			_weights0 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, weight_buffer);
+			_weights0 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, weight_buffer);
+			// no momentum yet, so the first minibatch looks ahead to the weights themselves
+			_nesterov_weight = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, weight_buffer);
 			free(weight_buffer);
 		}
 		else
 		{
 			// just use weights received from model
-			_weights0 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, weight_buffer);
+			_weights0 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, weight_buffer);
+			_nesterov_weight = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, weight_buffer);
 		}
-		_weights1 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
-		_delta_weights0 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
-		_delta_weights1 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
-		_nesterov_weight = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
-		_mean_square_delta0 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float2, nullptr);
-		_mean_square_delta1 = OpenGLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float2, nullptr);
+		_weights1 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
+		_delta_weights0 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
+		_delta_weights1 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float, nullptr);
+		_mean_square_delta0 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float2, nullptr);
+		_mean_square_delta1 = SiCKLBuffer2D(_model_config.VisibleUnits + 1, _model_config.HiddenUnits + 1, ReturnType::Float2, nullptr);
 
 		// free freshly allocated seed buffers
 		free(visible_dropout_seed_buffer);
@@ -0,0 +1,649 @@
+// std
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <mutex>
+#include <assert.h>
+
+// OMLT
+#include "Common.h"
+#include "CPUShared.h"
+#include "ContrastiveDivergenceCPU.h"
+#include "RestrictedBoltzmannMachine.h"
+#include "DataAtlasCPU.h"
+
+namespace OMLT
+{
+	ContrastiveDivergenceCPU::ContrastiveDivergenceCPU(const ModelConfig in_config, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count)
+		: _model_config(in_config)
+		, _minibatch_size(in_minibatch_size)
+		, _thread_pool(in_thread_count)
+		, _seed(in_seed)
+	{
+		allocate_buffers(nullptr, in_seed);
+	}
+
+	ContrastiveDivergenceCPU::ContrastiveDivergenceCPU(RestrictedBoltzmannMachine* in_rbm, uint32_t in_minibatch_size, int32_t in_seed, uint32_t in_thread_count)
+		: _minibatch_size(in_minibatch_size)
+		, _thread_pool(in_thread_count)
+		, _seed(in_seed)
+	{
+		assert(in_rbm != nullptr);
+		_model_config.VisibleUnits = in_rbm->visible_count;
+		_model_config.VisibleType = in_rbm->visible_type;
+		_model_config.HiddenUnits = in_rbm->hidden_count;
+		_model_config.HiddenType = in_rbm->hidden_type;
+
+		// copy weights to a buffer formatted the same way as ContrastiveDivergence's
+		float* weight_buffer = new float[(in_rbm->hidden_count + 1) * (in_rbm->visible_count + 1)];
+		weight_buffer[0] = 0.0f;
+
+		// copy in visible biases
+		memcpy(weight_buffer + 1, in_rbm->visible.biases(), sizeof(float) * in_rbm->visible_count);
+
+		// now copy in each hidden feature (as well as hidden bias)
+		for(uint32_t j = 1; j <= in_rbm->hidden_count; j++)
+		{
+			const uint32_t offset = (in_rbm->visible_count + 1) * j;
+			// bias
+			weight_buffer[offset] = in_rbm->hidden.biases()[j-1];
+			// weight vector
+			memcpy(weight_buffer + offset + 1, in_rbm->hidden.feature(j-1), sizeof(float) * in_rbm->visible_count);
+		}
+
+		allocate_buffers(weight_buffer, in_seed);
+		delete[] weight_buffer;
+	}
+
+	ContrastiveDivergenceCPU::ContrastiveDivergenceCPU(const ContrastiveDivergenceCPU* in_owner, int32_t in_seed)
+		: _model_config(in_owner->_model_config)
+		, _minibatch_size(in_owner->_minibatch_size)
+		, _thread_pool(1)
+		, _seed(in_seed)
+	{
+		allocate_buffers(nullptr, in_seed, in_owner);
+	}
+
+	ContrastiveDivergenceCPU::~ContrastiveDivergenceCPU()
+	{
+		for(auto it = _hogwild_workers.begin(); it != _hogwild_workers.end(); ++it)
+		{
+			delete *it;
+		}
+		free_buffers();
+	}
+
+	void ContrastiveDivergenceCPU::SetTrainingConfig(const TrainingConfig& in_config)
+	{
+		_training_config = in_config;
+
+		_update_rule.LearningRate = in_config.LearningRate;
+		_update_rule.Momentum = in_config.Momentum;
+		_update_rule.L1Regularization = in_config.L1Regularization;
+		_update_rule.L2Regularization = in_config.L2Regularization;
+		_update_rule.AdadeltaDecay = in_config.AdadeltaDecay;
+	}
+
+	void ContrastiveDivergenceCPU::Train(const float* in_example)
+	{
+		assert(in_example != nullptr);
+
+		CopyToPadded(in_example, _minibatch_size, _model_config.VisibleUnits, _visible, _visible_stride);
+		train_minibatch(_visible);
+	}
+
+	void ContrastiveDivergenceCPU::Train(DataAtlasCPU& in_examples, uint32_t in_minibatches)
+	{
+		if(_training_config.Parallelism == Parallelism::Hogwild)
+		{
+			train_hogwild(in_examples, in_minibatches);
+			return;
+		}
+
+		for(uint32_t k = 0; k < in_minibatches; k++)
+		{
+			// the atlas stores rows at our padded stride, so train straight out of its page
+			const float* example;
+			uint32_t stride;
+			in_examples.Next(example, stride);
+			assert(stride == _visible_stride);
+			train_minibatch(example);
+		}
+	}
+
+	void ContrastiveDivergenceCPU::train_minibatch(const float* in_visible)
+	{
+		_current_visible = in_visible;
+
+		/// Calculate Enabled Units
+
+		calc_enabled(_visible_dropout_seeds, _model_config.VisibleUnits, _training_config.VisibleDropout, _enabled_visible);
+		calc_enabled(_hidden_dropout_seeds, _model_config.HiddenUnits, _training_config.HiddenDropout, _enabled_hidden);
+
+		/// Calc Hidden and States from Visible
+
+		calc_hidden_states(_current_visible);
+
+		/// Calc Visible Prime
+
+		calc_visible_prime();
+
+		/// Calc Hidden Prime
+
+		calc_hidden_prime();
+
+		/// Update Weights
+
+		update_weights();
+
+		/// Done!
+	}
+
+	float ContrastiveDivergenceCPU::GetLastReconstructionError()
+	{
+		// same argument order as ContrastiveDivergence
+		return CalcError(_current_visible, _visible_prime, _minibatch_size, _model_config.VisibleUnits, _visible_stride, _error_function);
+	}
+
+	float ContrastiveDivergenceCPU::GetReconstructionError(const float* in_example)
+	{
+		assert(in_example != nullptr);
+
+		CopyToPadded(in_example, _minibatch_size, _model_config.VisibleUnits, _visible_test, _visible_stride);
+
+		calc_hidden_states(_visible_test);
+		calc_visible_prime();
+
+		return CalcError(_visible_test, _visible_prime, _minibatch_size, _model_config.VisibleUnits, _visible_stride, _error_function);
+	}
+
+	RestrictedBoltzmannMachine* ContrastiveDivergenceCPU::GetRestrictedBoltzmannMachine() const
+	{
+		RestrictedBoltzmannMachine* rbm = new RestrictedBoltzmannMachine(_model_config.VisibleUnits, _model_config.HiddenUnits, _model_config.VisibleType, _model_config.HiddenType);
+
+		memcpy(rbm->hidden.biases(), _hidden_biases.weights(0), sizeof(float) * _model_config.HiddenUnits);
+		memcpy(rbm->visible.biases(), _visible_biases.weights(0), sizeof(float) * _model_config.VisibleUnits);
+
+		for(uint32_t j = 0; j < _model_config.HiddenUnits; j++)
+		{
+			const float* w_j = _weights.weights(j);
+			memcpy(rbm->hidden.feature(j), w_j, sizeof(float) * _model_config.VisibleUnits);
+			for(uint32_t i = 0; i < _model_config.VisibleUnits; i++)
+			{
+				rbm->visible.feature(i)[j] = w_j[i];
+			}
+		}
+
+		return rbm;
+	}
+
+	bool ContrastiveDivergenceCPU::DumpLastVisible(float** image, float** recon)
+	{
+		assert(image != nullptr);
+		assert(recon != nullptr);
+
+		CopyFromPadded(_current_visible, _minibatch_size, _model_config.VisibleUnits, _visible_stride, *image);
+		CopyFromPadded(_visible_prime, _minibatch_size, _model_config.VisibleUnits, _visible_stride, *recon);
+
+		return true;
+	}
+
+	bool ContrastiveDivergenceCPU::DumpLastHidden(float** activations)
+	{
+		assert(activations != nullptr);
+
+		CopyFromPadded(_hidden, _minibatch_size, _model_config.HiddenUnits, _hidden_stride, *activations);
+
+		return true;
+	}
+
+	bool ContrastiveDivergenceCPU::DumpLastWeights(float** weights)
+	{
+		assert(weights != nullptr);
+
+		// (VisibleUnits + 1) x (HiddenUnits + 1) with the biases in the first row and column
+		float* head = *weights;
+		const uint32_t row_length = _model_config.VisibleUnits + 1;
+
+		head[0] = 0.0f;
+		memcpy(head + 1, _visible_biases.weights(0), sizeof(float) * _model_config.VisibleUnits);
+		for(uint32_t j = 0; j < _model_config.HiddenUnits; j++)
+		{
+			float* row = head + (j + 1) * row_length;
+			row[0] = _hidden_biases.weights(0)[j];
+			memcpy(row + 1, _weights.weights(j), sizeof(float) * _model_config.VisibleUnits);
+		}
+
+		return true;
+	}
+
+	void ContrastiveDivergenceCPU::train_hogwild(DataAtlasCPU& in_examples, uint32_t in_minibatches)
+	{
+		if(_hogwild_workers.empty())
+		{
+			for(uint32_t k = 0; k < _thread_pool.ThreadCount(); k++)
+			{
+				// every worker needs its own dropout and sampling seeds
+				_hogwild_workers.push_back(new ContrastiveDivergenceCPU(this, _seed + int32_t(k + 1)));
+			}
+		}
+
+		for(auto it = _hogwild_workers.begin(); it != _hogwild_workers.end(); ++it)
+		{
+			(*it)->SetTrainingConfig(_training_config);
+		}
+
+		std::mutex atlas_mutex;
+		uint32_t next_minibatch = 0;
+
+		_thread_pool.ParallelFor((uint32_t)_hogwild_workers.size(), [&](uint32_t begin, uint32_t end)
+		{
+			for(uint32_t w = begin; w < end; w++)
+			{
+				ContrastiveDivergenceCPU* worker = _hogwild_workers[w];
+				for(;;)
+				{
+					{
+						// the atlas' minibatch is only valid until the next call to Next, which another
+						// worker makes while this one trains, so it is copied out before anyone else gets
+						// the atlas
+						std::lock_guard<std::mutex> lock(atlas_mutex);
+						if(next_minibatch == in_minibatches)
+						{
+							break;
+						}
+						next_minibatch++;
+
+						const float* example;
+						uint32_t stride;
+						in_examples.Next(example, stride);
+						assert(stride == _visible_stride);
+						memcpy(worker->_visible, example, sizeof(float) * _minibatch_size * _visible_stride);
+					}
+
+					worker->train_minibatch(worker->_visible);
+				}
+			}
+		});
+	}
+
+	void ContrastiveDivergenceCPU::calc_enabled(uint32_t* io_seeds, uint32_t in_count, float in_dropout_prob, float* out_enabled)
+	{
+		for(uint32_t k = 0; k < in_count; k++)
+		{
+			const float p = NextFloat(io_seeds + k * 4);
+			out_enabled[k] = p > in_dropout_prob ? 1.0f : 0.0f;
+		}
+	}
+
+	void ContrastiveDivergenceCPU::calc_hidden_states(const float* in_visible)
+	{
+		const uint32_t visible_units = _model_config.VisibleUnits;
+		const uint32_t hidden_units = _model_config.HiddenUnits;
+		const ActivationFunction_t function = _model_config.HiddenType;
+
+		// apply visible dropout to the input
+		const float* visible = in_visible;
+		if(_training_config.VisibleDropout > 0.0f)
+		{
+			for(uint32_t m = 0; m < _minibatch_size; m++)
+			{
+				const float* src = in_visible + m * _visible_stride;
+				float* dest = _visible_masked + m * _visible_stride;
+				for(uint32_t i = 0; i < _visible_stride; i += 4)
+				{
+					_mm_store_ps(dest + i, _mm_mul_ps(_mm_load_ps(src + i), _mm_load_ps(_enabled_visible + i)));
+				}
+			}
+			visible = _visible_masked;
+		}
+		// take input dropout into account
+		const float scale = 1.0f / (1.0f - _training_config.VisibleDropout);
+
+		const float* biases = _hidden_biases.nesterov(0);
+
+		_thread_pool.ParallelFor(BlockCount(hidden_units), [&](uint32_t begin, uint32_t end)
+		{
+			const uint32_t j_begin = begin * 4;
+			const uint32_t j_end = std::min(end * 4, hidden_units);
+
+			MatrixMultiplyNT(visible, _visible_stride, _weights.Nesterov, _weights.Stride, _hidden, _hidden_stride, _minibatch_size, j_begin, j_end, visible_units, scale, false);
+
+			// add bias, calc activation and sample states
+			for(uint32_t m = 0; m < _minibatch_size; m++)
+			{
+				float* hidden = _hidden + m * _hidden_stride;
+				float* states = _hidden_states + m * _hidden_stride;
+				for(uint32_t j = j_begin; j < j_end; j++)
+				{
+					const float accumulation = hidden[j] + biases[j];
+					uint32_t* seed = _hidden_seeds + (m * hidden_units + j) * 4;
+
+					float state = 0.0f;
+					switch(function)
+					{
+					case ActivationFunction::Linear:
+						hidden[j] = accumulation;
+						state = accumulation + NextGaussian(seed);
+						break;
+					case ActivationFunction::RectifiedLinear:
+						{
+							hidden[j] = std::max(accumulation, 0.0f);
+							// mean 0, variance sigmoid(x) per http://www.cs.toronto.edu/~hinton/absps/reluICML.pdf
+							// "Rectified linear units improve restricted Boltzmann machines."
+							const float noise = NextGaussian(seed) * std::sqrt(Sigmoid(accumulation));
+							state = std::max(accumulation + noise, 0.0f);
+						}
+						break;
+					case ActivationFunction::Sigmoid:
+						hidden[j] = Sigmoid(accumulation);
+						state = NextFloat(seed) <= hidden[j] ? 1.0f : 0.0f;
+						break;
+					case ActivationFunction::Softmax:
+						// states are sampled once the whole row is known
+						hidden[j] = accumulation;
+						break;
+					}
+					// hidden dropout is applied when calculating visible, so bake it in here
+					states[j] = state * _enabled_hidden[j];
+				}
+			}
+		});
+
+		if(function == ActivationFunction::Softmax)
+		{
+			_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t m = begin; m < end; m++)
+				{
+					float* hidden = _hidden + m * _hidden_stride;
+					float* states = _hidden_states + m * _hidden_stride;
+
+					CalcSoftmax(hidden, hidden_units);
+					for(uint32_t j = 0; j < hidden_units; j++)
+					{
+						uint32_t* seed = _hidden_seeds + (m * hidden_units + j) * 4;
+						const float state = NextFloat(seed) <= hidden[j] ? 1.0f : 0.0f;
+						states[j] = state * _enabled_hidden[j];
+					}
+				}
+			});
+		}
+	}
+
+	void ContrastiveDivergenceCPU::calc_visible_prime()
+	{
+		const uint32_t visible_units = _model_config.VisibleUnits;
+		const uint32_t hidden_units = _model_config.HiddenUnits;
+		const ActivationFunction_t function = _model_config.VisibleType;
+		const bool visible_dropout = _training_config.VisibleDropout > 0.0f;
+
+		// take input dropout into account
+		const float scale = 1.0f / (1.0f - _training_config.HiddenDropout);
+
+		const float* biases = _visible_biases.nesterov(0);
+
+		_thread_pool.ParallelFor(BlockCount(visible_units), [&](uint32_t begin, uint32_t end)
+		{
+			const uint32_t i_begin = begin * 4;
+			const uint32_t i_end = end * 4;
+			const uint32_t i_last = std::min(i_end, visible_units);
+
+			MatrixMultiplyNN(_hidden_states, _hidden_stride, _weights.Nesterov, _weights.Stride, _visible_prime, _visible_stride, _minibatch_size, i_begin, i_end, hidden_units, scale, false);
+
+			for(uint32_t m = 0; m < _minibatch_size; m++)
+			{
+				float* visible_prime = _visible_prime + m * _visible_stride;
+				float* visible_prime_masked = _visible_prime_masked + m * _visible_stride;
+
+				uint32_t i = i_begin;
+				for(; i < i_last; i++)
+				{
+					visible_prime[i] = CalcActivation(function, visible_prime[i] + biases[i]);
+					if(visible_dropout && function != ActivationFunction::Softmax)
+					{
+						visible_prime_masked[i] = visible_prime[i] * _enabled_visible[i];
+					}
+				}
+				// keep the padding zeroed
+				for(; i < i_end; i++)
+				{
+					visible_prime[i] = 0.0f;
+				}
+			}
+		});
+
+		if(function == ActivationFunction::Softmax)
+		{
+			_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t m = begin; m < end; m++)
+				{
+					float* visible_prime = _visible_prime + m * _visible_stride;
+					float* visible_prime_masked = _visible_prime_masked + m * _visible_stride;
+
+					CalcSoftmax(visible_prime, visible_units);
+					if(visible_dropout)
+					{
+						for(uint32_t i = 0; i < visible_units; i++)
+						{
+							visible_prime_masked[i] = visible_prime[i] * _enabled_visible[i];
+						}
+					}
+				}
+			});
+		}
+	}
+
+	void ContrastiveDivergenceCPU::calc_hidden_prime()
+	{
+		const uint32_t visible_units = _model_config.VisibleUnits;
+		const uint32_t hidden_units = _model_config.HiddenUnits;
+		const ActivationFunction_t function = _model_config.HiddenType;
+
+		const float* visible_prime = _training_config.VisibleDropout > 0.0f ? _visible_prime_masked : _visible_prime;
+		// take input dropout into account
+		const float scale = 1.0f / (1.0f - _training_config.VisibleDropout);
+
+		const float* biases = _hidden_biases.nesterov(0);
+
+		_thread_pool.ParallelFor(BlockCount(hidden_units), [&](uint32_t begin, uint32_t end)
+		{
+			const uint32_t j_begin = begin * 4;
+			const uint32_t j_end = std::min(end * 4, hidden_units);
+
+			MatrixMultiplyNT(visible_prime, _visible_stride, _weights.Nesterov, _weights.Stride, _hidden_prime, _hidden_stride, _minibatch_size, j_begin, j_end, visible_units, scale, false);
+
+			for(uint32_t m = 0; m < _minibatch_size; m++)
+			{
+				float* hidden_prime = _hidden_prime + m * _hidden_stride;
+				for(uint32_t j = j_begin; j < j_end; j++)
+				{
+					hidden_prime[j] = CalcActivation(function, hidden_prime[j] + biases[j]);
+				}
+			}
+		});
+
+		if(function == ActivationFunction::Softmax)
+		{
+			_thread_pool.ParallelFor(_minibatch_size, [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t m = begin; m < end; m++)
+				{
+					CalcSoftmax(_hidden_prime + m * _hidden_stride, hidden_units);
+				}
+			});
+		}
+	}
+
+	void ContrastiveDivergenceCPU::update_weights()
+	{
+		const uint32_t hidden_units = _model_config.HiddenUnits;
+		const float inv_minibatch = 1.0f / float(_minibatch_size);
+
+		// weights: sum over the minibatch of v_i * h_j - v'_i * h'_j, applied while the gradient rows are still in cache
+		_thread_pool.ParallelFor(BlockCount(hidden_units), [&](uint32_t begin, uint32_t end)
+		{
+			const uint32_t j_begin = begin * 4;
+			const uint32_t j_end = std::min(end * 4, hidden_units);
+
+			MatrixMultiplyTN(_hidden, _hidden_stride, _current_visible, _visible_stride, _weight_gradient, _weights.Stride, _minibatch_size, j_begin, j_end, _visible_stride, 1.0f, false);
+			MatrixMultiplyTN(_hidden_prime, _hidden_stride, _visible_prime, _visible_stride, _weight_gradient, _weights.Stride, _minibatch_size, j_begin, j_end, _visible_stride, -1.0f, true);
+
+			for(uint32_t j = j_begin; j < j_end; j++)
+			{
+				if(_enabled_hidden[j] != 0.0f)
+				{
+					_weights.UpdateRow(_update_rule, j, _weight_gradient + j * _weights.Stride, inv_minibatch, _enabled_visible, true);
+				}
+				else
+				{
+					_weights.HoldRow(_update_rule, j);
+				}
+			}
+		});
+
+		// biases: sum over the minibatch of h_j - h'_j and v_i - v'_i
+		memset(_hidden_bias_gradient, 0x00, sizeof(float) * _hidden_stride);
+		memset(_visible_bias_gradient, 0x00, sizeof(float) * _visible_stride);
+		for(uint32_t m = 0; m < _minibatch_size; m++)
+		{
+			const float* hidden = _hidden + m * _hidden_stride;
+			const float* hidden_prime = _hidden_prime + m * _hidden_stride;
+			for(uint32_t j = 0; j < _hidden_stride; j += 4)
+			{
+				__m128 diff = _mm_sub_ps(_mm_load_ps(hidden + j), _mm_load_ps(hidden_prime + j));
+				_mm_store_ps(_hidden_bias_gradient + j, _mm_add_ps(_mm_load_ps(_hidden_bias_gradient + j), diff));
+			}
+
+			const float* visible = _current_visible + m * _visible_stride;
+			const float* visible_prime = _visible_prime + m * _visible_stride;
+			for(uint32_t i = 0; i < _visible_stride; i += 4)
+			{
+				__m128 diff = _mm_sub_ps(_mm_load_ps(visible + i), _mm_load_ps(visible_prime + i));
+				_mm_store_ps(_visible_bias_gradient + i, _mm_add_ps(_mm_load_ps(_visible_bias_gradient + i), diff));
+			}
+		}
+
+		_hidden_biases.UpdateRow(_update_rule, 0, _hidden_bias_gradient, inv_minibatch, _enabled_hidden, false);
+		_visible_biases.UpdateRow(_update_rule, 0, _visible_bias_gradient, inv_minibatch, _enabled_visible, false);
+	}
+
+	extern uint32_t* GetSeedBuffer(uint32_t, uint32_t, std::mt19937_64&);
+
+	void ContrastiveDivergenceCPU::allocate_buffers(const float* in_weight_buffer, int32_t in_seed, const ContrastiveDivergenceCPU* in_owner)
+	{
+		const uint32_t visible_units = _model_config.VisibleUnits;
+		const uint32_t hidden_units = _model_config.HiddenUnits;
+
+		_visible_stride = BlockCount(visible_units) * 4;
+		_hidden_stride = BlockCount(hidden_units) * 4;
+
+		// default training config until SetTrainingConfig is called
+		SetTrainingConfig(_training_config);
+
+		// same seeds (in the same order) as ContrastiveDivergence
+		std::mt19937_64 random;
+		random.seed(static_cast<uint32_t>(in_seed));
+
+		_visible_dropout_seeds = GetSeedBuffer(visible_units * 4, 1, random);
+		_hidden_dropout_seeds = GetSeedBuffer(hidden_units * 4, 1, random);
+		_hidden_seeds = GetSeedBuffer(hidden_units * 4, _minibatch_size, random);
+
+		_enabled_visible = AllocateMatrix(1, visible_units);
+		_enabled_hidden = AllocateMatrix(1, hidden_units);
+		// everything is enabled until the first minibatch (GetReconstructionError uses the last enabled
+		// units, and with Hogwild only the workers' units ever change)
+		std::fill(_enabled_visible, _enabled_visible + visible_units, 1.0f);
+		std::fill(_enabled_hidden, _enabled_hidden + hidden_units, 1.0f);
+
+		_visible = AllocateMatrix(_minibatch_size, visible_units);
+		_current_visible = _visible;
+		_visible_masked = AllocateMatrix(_minibatch_size, visible_units);
+		_visible_test = AllocateMatrix(_minibatch_size, visible_units);
+		_hidden = AllocateMatrix(_minibatch_size, hidden_units);
+		_hidden_states = AllocateMatrix(_minibatch_size, hidden_units);
+		_visible_prime = AllocateMatrix(_minibatch_size, visible_units);
+		_visible_prime_masked = AllocateMatrix(_minibatch_size, visible_units);
+		_hidden_prime = AllocateMatrix(_minibatch_size, hidden_units);
+
+		_weight_gradient = AllocateMatrix(hidden_units, visible_units);
+		_hidden_bias_gradient = AllocateMatrix(1, hidden_units);
+		_visible_bias_gradient = AllocateMatrix(1, visible_units);
+
+		_error_function = _model_config.VisibleType == ActivationFunction::Softmax ? ErrorFunction::CrossEntropy : ErrorFunction::SquareError;
+
+		if(in_owner != nullptr)
+		{
+			_weights.Share(in_owner->_weights);
+			_hidden_biases.Share(in_owner->_hidden_biases);
+			_visible_biases.Share(in_owner->_visible_biases);
+			return;
+		}
+
+		_weights.Allocate(hidden_units, visible_units);
+		_hidden_biases.Allocate(1, hidden_units);
+		_visible_biases.Allocate(1, visible_units);
+
+		if(in_weight_buffer == nullptr)
+		{
+			// initialize weights to random values
+			float weight_stdev = float(1.0 / std::sqrt((float)(visible_units + hidden_units)));
+			std::normal_distribution<float> normal(0.0f, weight_stdev);
+
+			for(uint32_t j = 0; j < hidden_units; j++)
+			{
+				float* w_j = _weights.weights(j);
+				for(uint32_t i = 0; i < visible_units; i++)
+				{
+					w_j[i] = normal(random);
+				}
+			}
+		}
+		else
+		{
+			// (VisibleUnits + 1) x (HiddenUnits + 1) with the biases in the first row and column
+			const uint32_t row_length = visible_units + 1;
+
+			memcpy(_visible_biases.weights(0), in_weight_buffer + 1, sizeof(float) * visible_units);
+			for(uint32_t j = 0; j < hidden_units; j++)
+			{
+				const float* row = in_weight_buffer + (j + 1) * row_length;
+				_hidden_biases.weights(0)[j] = row[0];
+				memcpy(_weights.weights(j), row + 1, sizeof(float) * visible_units);
+			}
+		}
+
+		// with no deltas yet the nesterov weights are just the weights
+		_weights.ResetNesterov();
+		_hidden_biases.ResetNesterov();
+		_visible_biases.ResetNesterov();
+	}
+
+	void ContrastiveDivergenceCPU::free_buffers()
+	{
+		free(_visible_dropout_seeds);
+		free(_hidden_dropout_seeds);
+		free(_hidden_seeds);
+
+		FreeMatrix(_enabled_visible);
+		FreeMatrix(_enabled_hidden);
+
+		FreeMatrix(_visible);
+		FreeMatrix(_visible_masked);
+		FreeMatrix(_visible_test);
+		FreeMatrix(_hidden);
+		FreeMatrix(_hidden_states);
+		FreeMatrix(_visible_prime);
+		FreeMatrix(_visible_prime_masked);
+		FreeMatrix(_hidden_prime);
+
+		FreeMatrix(_weight_gradient);
+		FreeMatrix(_hidden_bias_gradient);
+		FreeMatrix(_visible_bias_gradient);
+
+		_weights.Free();
+		_hidden_biases.Free();
+		_visible_biases.Free();
+	}
+}
\ No newline at end of file
@@ -1,6 +1,5 @@
 // std
 #include <assert.h>
-#include <math.h>
 
 // OMLT
 #include <DataAtlas.h>
@@ -9,79 +8,43 @@
 using namespace SiCKL;
 
 OMLT::DataAtlas::DataAtlas(uint32_t in_atlas_size)
-	: _idx(nullptr)
+	: _pages(in_atlas_size)
 	, _row_length(-1)
-	, _max_rows(-1)
-	, _current_row(-1)
-	, _total_rows(-1)
-	, _streaming(false)
 	, _minibatch_size(-1)
+	, _current_batch(0)
 	, _texture_copy(nullptr)
 {
-	// to bytes
-	in_atlas_size *= 1024*1024;
-	const uint32_t float_count = in_atlas_size/sizeof(float);
-	_atlas_width = (int)sqrt((double)float_count);
-	_atlas_size = _atlas_width * _atlas_width;
-
-	_atlas_buffer = new float[_atlas_size];
-	memset(_atlas_buffer, 0x00, sizeof(float) * _atlas_size);
-
-	_atlas = OpenGLBuffer2D(_atlas_width, _atlas_width, ReturnType::Float, _atlas_buffer);
+	_atlas_width = _pages.GetPageWidth();
+	_atlas = SiCKLBuffer2D(_atlas_width, _atlas_width, ReturnType::Float, const_cast<float*>(_pages.GetPage()));
 }
 
 OMLT::DataAtlas::~DataAtlas()
 {
-	delete[] _atlas_buffer;
-	delete _idx;
 	delete _texture_copy;
 }
 
-bool OMLT::DataAtlas::Initialize(IDX* in_data, uint32_t in_minibatch_size)
+bool OMLT::DataAtlas::Initialize(IDX* in_data, uint32_t in_minibatch_size, bool in_shuffle, uint32_t in_seed)
 {
-	if(_idx != in_data)
+	if(_pages.Initialize(in_data, in_minibatch_size, in_shuffle, in_seed) == false)
 	{
-		delete _idx;
-		_idx = in_data;
+		return false;
 	}
-	
-	_minibatch_size = in_minibatch_size;
 
-	_row_length = _idx->GetRowLength();
-	_max_rows = _atlas_size / _row_length;
-	_current_row = 0;
-	_total_rows = _idx->GetRowCount();
-	_total_batches = _total_rows / _minibatch_size;
-
-	_max_rows = _atlas_size / _row_length;
-	if(_max_rows < _total_rows)
-	{
-		_streaming = true;
-	}
-	else
-	{
-		_streaming = false;
-	}
-	
-	if(_streaming)
-	{
-		_batches_per_page = _atlas_size / (_minibatch_size * _row_length);
-	}
-	else
-	{
-		_batches_per_page = _total_batches;
-	}
+	_minibatch_size = in_minibatch_size;
+	_row_length = _pages.GetRowLength();
 
 	// allocate batch texture
-	_batch = OpenGLBuffer2D(_row_length, _minibatch_size, ReturnType::Float, nullptr);
+	_batch = SiCKLBuffer2D(_row_length, _minibatch_size, ReturnType::Float, nullptr);
 
-	PopulateAtlas();
+	_current_batch = 0;
+	_atlas.SetData(const_cast<float*>(_pages.GetPage()));
 
 	class CopyDataSource : public SiCKL::Source
 	{
 	public:
 		int32_t atlas_width;
-		int32_t row_length;
+		// rows are padded out to this many floats in the atlas
+		int32_t row_stride;
 		int32_t minibatch_size;
 
 		BEGIN_SOURCE
@@ -97,7 +60,7 @@ bool OMLT::DataAtlas::Initialize(IDX* in_data, uint32_t in_minibatch_size)
 			BEGIN_MAIN
 				Int2 index = Index();
 
-				Int flat_index = (batch * row_length * minibatch_size) + index.X + (index.Y * row_length);
+				Int flat_index = (batch * row_stride * minibatch_size) + index.X + (index.Y * row_stride);
 
 				Int x = flat_index % atlas_width;
 				Int y = flat_index / atlas_width;
@@ -108,11 +71,11 @@ bool OMLT::DataAtlas::Initialize(IDX* in_data, uint32_t in_minibatch_size)
 	} source;
 
 	source.atlas_width = _atlas_width;
-	source.row_length = _row_length;
+	source.row_stride = _pages.GetRowStride();
 	source.minibatch_size = _minibatch_size;
 
 	source.Parse();
-	OpenGLCompiler comp;
+	SiCKLCompiler comp;
 	delete _texture_copy;
 	_texture_copy = comp.Build(source);
 	_texture_copy->Initialize(_row_length, _minibatch_size);
@@ -120,26 +83,7 @@ bool OMLT::DataAtlas::Initialize(IDX* in_data, uint32_t in_minibatch_size)
 	return true;
 }
 
-void OMLT::DataAtlas::PopulateAtlas()
-{
-	float* atlas_head = _atlas_buffer;
-
-	for(uint32_t  k = 0; k < _batches_per_page; k++)
-	{
-		for(uint32_t j = 0; j < _minibatch_size; j++)
-		{
-			_idx->ReadRow(_current_row % _total_rows, atlas_head);
-			_current_row = (_current_row + 1) % _total_rows;
-			atlas_head += _row_length;
-		}
-	}
-
-	_current_batch = 0;
-
-	_atlas.SetData(_atlas_buffer);
-}
-
-bool OMLT::DataAtlas::Next(SiCKL::OpenGLBuffer2D& inout_minibatch)
+bool OMLT::DataAtlas::Next(SiCKLBuffer2D& inout_minibatch)
 {
 	_texture_copy->SetInput(0, _atlas);
 	_texture_copy->SetInput(1, (int32_t)_current_batch);
@@ -148,11 +92,15 @@ bool OMLT::DataAtlas::Next(SiCKL::OpenGLBuffer2D& inout_minibatch)
 
 	inout_minibatch = _batch;
 
-	_current_batch = (_current_batch + 1) % _batches_per_page;
-	if(_current_batch == 0 && _streaming)
+	_current_batch = (_current_batch + 1) % _pages.GetBatchesPerPage();
+	if(_current_batch == 0 && _pages.IsPaging())
 	{
-		PopulateAtlas();
+		// the batch has already been copied out of the old page, so move on right away;
+		// the upload has to happen on this thread since it owns the GL context
+		_pages.NextPage();
+		_pages.ReleasePage();
+		_atlas.SetData(const_cast<float*>(_pages.GetPage()));
 	}
 
 	return true;
-}
+}
\ No newline at end of file
@@ -0,0 +1,488 @@
+// std
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// windows
+#ifndef NOMINMAX
+#	define NOMINMAX
+#endif
+#include <windows.h>
+
+// OMLT
+#include "CPUShared.h"
+#include "DataAtlasCPU.h"
+#include "IDX.hpp"
+
+namespace OMLT
+{
+	struct DataAtlasCPU::PageLoader
+	{
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable page_requested_cv;
+		std::condition_variable page_ready_cv;
+		// the consuming thread wants _next_buffer filled
+		bool page_requested;
+		// _next_buffer holds the next page
+		bool page_ready;
+		bool shutdown;
+	};
+
+	/// Page Allocation
+
+	// large pages need SeLockMemoryPrivilege, which an administrator grants to the account ("Lock
+	// pages in memory") but which is disabled in the process token until it is enabled here
+	static bool EnableLockMemoryPrivilege()
+	{
+		HANDLE token;
+		if(OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token) == FALSE)
+		{
+			return false;
+		}
+
+		TOKEN_PRIVILEGES privileges;
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+		bool result = false;
+		if(LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid))
+		{
+			// succeeds without enabling anything when the account doesn't hold the privilege
+			result = AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL) && GetLastError() == ERROR_SUCCESS;
+		}
+
+		CloseHandle(token);
+		return result;
+	}
+
+	// zero filled page on the NUMA node of the calling thread; uses large pages when the account
+	// holds SeLockMemoryPrivilege (large pages are never paged out), otherwise tries to lock the
+	// page into the working set
+	static float* AllocatePage(uint32_t in_floats)
+	{
+		const SIZE_T bytes = SIZE_T(in_floats) * sizeof(float);
+		const HANDLE process = GetCurrentProcess();
+
+		UCHAR node = 0;
+		if(GetNumaProcessorNode((UCHAR)GetCurrentProcessorNumber(), &node) == FALSE)
+		{
+			node = 0;
+		}
+
+		static const bool large_pages = EnableLockMemoryPrivilege();
+		const SIZE_T large_page = large_pages ? GetLargePageMinimum() : 0;
+		if(large_page > 0)
+		{
+			const SIZE_T large_bytes = (bytes + large_page - 1) / large_page * large_page;
+			void* page = VirtualAllocExNuma(process, NULL, large_bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+			if(page != NULL)
+			{
+				return (float*)page;
+			}
+		}
+
+		void* page = VirtualAllocExNuma(process, NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+		if(page == NULL)
+		{
+			return nullptr;
+		}
+
+		// locking fails once we run past the minimum working set, so grow it first; both are
+		// best effort, the page works either way
+		SIZE_T min_working_set, max_working_set;
+		if(GetProcessWorkingSetSize(process, &min_working_set, &max_working_set))
+		{
+			SetProcessWorkingSetSize(process, min_working_set + bytes, max_working_set + bytes);
+		}
+		VirtualLock(page, bytes);
+
+		return (float*)page;
+	}
+
+	static void FreePage(float*& io_page)
+	{
+		if(io_page != nullptr)
+		{
+			VirtualFree(io_page, 0, MEM_RELEASE);
+			io_page = nullptr;
+		}
+	}
+
+	// moves in_rows tightly packed rows at the start of io_rows out to in_stride apart (last row
+	// first, so nothing is overwritten before it has moved) and zeroes the padding after each
+	static void SpreadRows(float* io_rows, uint32_t in_rows, uint32_t in_row_length, uint32_t in_stride)
+	{
+		for(uint32_t r = in_rows; r-- > 0;)
+		{
+			float* row = io_rows + size_t(r) * in_stride;
+			memmove(row, io_rows + size_t(r) * in_row_length, sizeof(float) * in_row_length);
+			memset(row + in_row_length, 0x00, sizeof(float) * (in_stride - in_row_length));
+		}
+	}
+
+	/// Shuffling
+
+	// uniformly distributed in [0, in_count)
+	static uint32_t RandomIndex(uint32_t* io_seed, uint32_t in_count)
+	{
+		NextSeed(io_seed);
+		return uint32_t((uint64_t(io_seed[3]) * in_count) >> 32);
+	}
+
+	// Fisher-Yates shuffle of [0, in_count)
+	static void RandomPermutation(uint32_t* io_seed, uint32_t* out_permutation, uint32_t in_count)
+	{
+		for(uint32_t k = 0; k < in_count; k++)
+		{
+			out_permutation[k] = k;
+		}
+		for(uint32_t k = in_count; k-- > 1;)
+		{
+			const uint32_t j = RandomIndex(io_seed, k + 1);
+			const uint32_t temp = out_permutation[j];
+			out_permutation[j] = out_permutation[k];
+			out_permutation[k] = temp;
+		}
+	}
+
+	/// DataAtlasCPU
+
+	DataAtlasCPU::DataAtlasCPU(uint32_t in_atlas_size)
+		: _next_buffer(nullptr)
+		, _loader(nullptr)
+		, _idx(nullptr)
+		, _row_length(-1)
+		, _row_stride(-1)
+		, _max_rows(-1)
+		, _current_row(-1)
+		, _total_rows(-1)
+		, _shard(0)
+		, _shard_count(1)
+		, _first_row(0)
+		, _streaming(false)
+		, _paging(false)
+		, _minibatch_size(-1)
+		, _batches_per_page(0)
+		, _current_batch(0)
+		, _release_page(false)
+		, _shuffle(false)
+		, _shuffle_seed(0)
+		, _epoch(0)
+		, _shuffle_block_rows(DefaultShuffleBlockRows)
+		, _block_count(0)
+		, _block_order(nullptr)
+		, _next_block(0)
+		, _block_buffer(nullptr)
+		, _row_order(nullptr)
+		, _block_rows(0)
+		, _block_position(0)
+	{
+		// to bytes
+		in_atlas_size *= 1024*1024;
+		const uint32_t float_count = in_atlas_size/sizeof(float);
+		_atlas_width = (int)sqrt((double)float_count);
+		_atlas_size = _atlas_width * _atlas_width;
+
+		_atlas_buffer = AllocatePage(_atlas_size);
+	}
+
+	DataAtlasCPU::~DataAtlasCPU()
+	{
+		StopLoader();
+		FreePage(_atlas_buffer);
+		FreePage(_next_buffer);
+		delete[] _block_order;
+		delete[] _block_buffer;
+		delete[] _row_order;
+		delete _idx;
+	}
+
+	bool DataAtlasCPU::Initialize(IDX* in_data, uint32_t in_minibatch_size, bool in_shuffle, uint32_t in_seed)
+	{
+		// the loader may be reading from the old _idx
+		StopLoader();
+
+		if(_idx != in_data)
+		{
+			delete _idx;
+			_idx = in_data;
+		}
+
+		if(_atlas_buffer == nullptr)
+		{
+			return false;
+		}
+
+		_minibatch_size = in_minibatch_size;
+
+		_row_length = _idx->GetRowLength();
+		_row_stride = BlockCount(_row_length) * 4;
+		_current_row = 0;
+		_total_rows = _idx->GetRowCount() / _shard_count;
+		_first_row = _shard * _total_rows;
+		_total_batches = _total_rows / _minibatch_size;
+
+		_max_rows = _atlas_size / _row_stride;
+		_streaming = _max_rows < _total_rows;
+
+		if(_streaming)
+		{
+			_batches_per_page = _atlas_size / (_minibatch_size * _row_stride);
+		}
+		else
+		{
+			_batches_per_page = _total_batches;
+		}
+
+		_shuffle = in_shuffle;
+		_paging = _streaming || _shuffle;
+
+		if(_shuffle)
+		{
+			_shuffle_seed = in_seed;
+			_epoch = 0;
+			_block_count = (_total_rows + _shuffle_block_rows - 1) / _shuffle_block_rows;
+
+			const uint32_t block_rows = _shuffle_block_rows < _total_rows ? _shuffle_block_rows : _total_rows;
+			delete[] _block_order;
+			delete[] _block_buffer;
+			delete[] _row_order;
+			_block_order = new uint32_t[_block_count];
+			_block_buffer = new float[size_t(block_rows) * _row_length];
+			_row_order = new uint32_t[block_rows];
+
+			// first page starts a new pass
+			_next_block = _block_count;
+			_block_rows = 0;
+			_block_position = 0;
+		}
+
+		if(_paging && _next_buffer == nullptr)
+		{
+			_next_buffer = AllocatePage(_atlas_size);
+			if(_next_buffer == nullptr)
+			{
+				return false;
+			}
+		}
+
+		ReadPage(_atlas_buffer);
+		_current_batch = 0;
+		_release_page = false;
+
+		if(_paging)
+		{
+			StartLoader();
+		}
+
+		return true;
+	}
+
+	void DataAtlasCPU::SetShard(uint32_t in_shard, uint32_t in_shard_count)
+	{
+		assert(in_shard < in_shard_count);
+
+		_shard = in_shard;
+		_shard_count = in_shard_count;
+	}
+
+	void DataAtlasCPU::SetShuffleBlockRows(uint32_t in_block_rows)
+	{
+		assert(in_block_rows > 0);
+
+		_shuffle_block_rows = in_block_rows;
+	}
+
+	bool DataAtlasCPU::Next(const float*& out_minibatch, uint32_t& out_stride)
+	{
+		// the last minibatch of the previous page is no longer in use, so it can be refilled
+		if(_release_page)
+		{
+			ReleasePage();
+			_release_page = false;
+		}
+
+		// the previous minibatch may still be in use, so only move on to the next page now
+		if(_current_batch == _batches_per_page)
+		{
+			if(_paging)
+			{
+				NextPage();
+				_release_page = true;
+			}
+			_current_batch = 0;
+		}
+
+		out_minibatch = _atlas_buffer + size_t(_current_batch) * _minibatch_size * _row_stride;
+		out_stride = _row_stride;
+		_current_batch++;
+
+		return true;
+	}
+
+	void DataAtlasCPU::ReadPage(float* out_page)
+	{
+		float* atlas_head = out_page;
+
+		// read the page in as few runs of rows as possible, only splitting where we wrap
+		// around to the first row
+		uint32_t rows_remaining = _batches_per_page * _minibatch_size;
+
+		if(_shuffle)
+		{
+			while(rows_remaining > 0)
+			{
+				if(_block_position == _block_rows)
+				{
+					NextShuffleBlock();
+				}
+
+				const uint32_t rows_in_block = _block_rows - _block_position;
+				const uint32_t rows = rows_remaining < rows_in_block ? rows_remaining : rows_in_block;
+				for(uint32_t j = 0; j < rows; j++)
+				{
+					const float* row = _block_buffer + size_t(_row_order[_block_position + j]) * _row_length;
+					memcpy(atlas_head, row, sizeof(float) * _row_length);
+					memset(atlas_head + _row_length, 0x00, sizeof(float) * (_row_stride - _row_length));
+					atlas_head += _row_stride;
+				}
+				_block_position += rows;
+				rows_remaining -= rows;
+			}
+			return;
+		}
+
+		while(rows_remaining > 0)
+		{
+			const uint32_t rows_to_end = _total_rows - _current_row;
+			const uint32_t rows = rows_remaining < rows_to_end ? rows_remaining : rows_to_end;
+			_idx->ReadRowsAsSingle(_first_row + _current_row, rows, atlas_head);
+			SpreadRows(atlas_head, rows, _row_length, _row_stride);
+			_current_row = (_current_row + rows) % _total_rows;
+			atlas_head += rows * _row_stride;
+			rows_remaining -= rows;
+		}
+	}
+
+	void DataAtlasCPU::ShuffleBlockOrder()
+	{
+		// each pass is seeded from the seed and pass number alone
+		_shuffle_random[0] = _shuffle_seed;
+		_shuffle_random[1] = _epoch;
+		_shuffle_random[2] = 0x9E3779B9;
+		_shuffle_random[3] = 0x7F4A7C15;
+		for(uint32_t k = 0; k < 16; k++)
+		{
+			NextSeed(_shuffle_random);
+		}
+		_epoch++;
+
+		RandomPermutation(_shuffle_random, _block_order, _block_count);
+		_next_block = 0;
+	}
+
+	void DataAtlasCPU::NextShuffleBlock()
+	{
+		if(_next_block == _block_count)
+		{
+			ShuffleBlockOrder();
+		}
+
+		// one contiguous read per block
+		const uint32_t first_row = _block_order[_next_block++] * _shuffle_block_rows;
+		const uint32_t rows_to_end = _total_rows - first_row;
+		_block_rows = rows_to_end < _shuffle_block_rows ? rows_to_end : _shuffle_block_rows;
+		_block_position = 0;
+
+		_idx->ReadRowsAsSingle(_first_row + first_row, _block_rows, _block_buffer);
+		RandomPermutation(_shuffle_random, _row_order, _block_rows);
+	}
+
+	void DataAtlasCPU::NextPage()
+	{
+		{
+			std::unique_lock<std::mutex> lock(_loader->mutex);
+			while(_loader->page_ready == false)
+			{
+				_loader->page_ready_cv.wait(lock);
+			}
+
+			float* temp = _atlas_buffer;
+			_atlas_buffer = _next_buffer;
+			_next_buffer = temp;
+
+			_loader->page_ready = false;
+		}
+	}
+
+	void DataAtlasCPU::ReleasePage()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_loader->mutex);
+			_loader->page_requested = true;
+		}
+		_loader->page_requested_cv.notify_one();
+	}
+
+	void DataAtlasCPU::StartLoader()
+	{
+		assert(_loader == nullptr);
+
+		_loader = new PageLoader();
+		_loader->page_requested = true;
+		_loader->page_ready = false;
+		_loader->shutdown = false;
+		_loader->thread = std::thread(&DataAtlasCPU::LoaderMain, this);
+	}
+
+	void DataAtlasCPU::StopLoader()
+	{
+		if(_loader == nullptr)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_loader->mutex);
+			_loader->shutdown = true;
+		}
+		_loader->page_requested_cv.notify_one();
+		_loader->thread.join();
+
+		delete _loader;
+		_loader = nullptr;
+	}
+
+	void DataAtlasCPU::LoaderMain()
+	{
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_loader->mutex);
+				while(_loader->shutdown == false && _loader->page_requested == false)
+				{
+					_loader->page_requested_cv.wait(lock);
+				}
+
+				if(_loader->shutdown)
+				{
+					return;
+				}
+				_loader->page_requested = false;
+			}
+
+			// _next_buffer and the read position belong to this thread until the page is marked ready
+			ReadPage(_next_buffer);
+
+			{
+				std::lock_guard<std::mutex> lock(_loader->mutex);
+				_loader->page_ready = true;
+			}
+			_loader->page_ready_cv.notify_one();
+		}
+	}
+}
\ No newline at end of file
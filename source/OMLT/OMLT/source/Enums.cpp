@@ -26,4 +26,23 @@ namespace OMLT
 
 		return ActivationFunction::Invalid;
 	}
+
+	const char* ParallelismNames[] =
+	{
+		"Synchronous",
+		"Hogwild",
+	};
+
+	Parallelism_t ParseParallelism(const char* name)
+	{
+		for(uint32_t k = 0; k < ArraySize(ParallelismNames); k++)
+		{
+			if(strcmp(name, ParallelismNames[k]) == 0)
+			{
+				return (Parallelism_t)k;
+			}
+		}
+
+		return Parallelism::Invalid;
+	}
 }
\ No newline at end of file
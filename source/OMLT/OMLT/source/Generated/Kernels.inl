@@ -0,0 +1,34 @@
+// C++ versions of the kernels the trainers build for the schedules in tutorials/mnist-classifier,
+// written by CPPGenerator (see cltrain -generatedKernelPath) and registered with the CPU backend
+// by including them into SiCKLShared.cpp, which every trainer links against.  Kernels are keyed
+// by a hash of their source, which bakes in the model dimensions, minibatch size and training
+// parameters; any other configuration falls back to the interpreter.
+
+#include "sickl_kernel_004303e0c1f91ef8.cpp"
+#include "sickl_kernel_15386215120b9b95.cpp"
+#include "sickl_kernel_24245198b9434ac4.cpp"
+#include "sickl_kernel_2704bc591b615432.cpp"
+#include "sickl_kernel_46450b6019311519.cpp"
+#include "sickl_kernel_496765549929ae9f.cpp"
+#include "sickl_kernel_5b11c5707d8f59ab.cpp"
+#include "sickl_kernel_64df0b2c56c50aae.cpp"
+#include "sickl_kernel_6eaa722ba9c9b259.cpp"
+#include "sickl_kernel_81fa954507c371c0.cpp"
+#include "sickl_kernel_847a010cdb8e69bb.cpp"
+#include "sickl_kernel_88b84528ebe03b93.cpp"
+#include "sickl_kernel_8e7463d1c7e76207.cpp"
+#include "sickl_kernel_96c9b94c3bd85703.cpp"
+#include "sickl_kernel_986424038908238f.cpp"
+#include "sickl_kernel_9e52768c6a43c9e3.cpp"
+#include "sickl_kernel_a7b2411ddf9ae2a1.cpp"
+#include "sickl_kernel_a8b4f03aeb13c6fc.cpp"
+#include "sickl_kernel_b18b927d6d05cb62.cpp"
+#include "sickl_kernel_b399995f87af9b4a.cpp"
+#include "sickl_kernel_bc62c5a77697a999.cpp"
+#include "sickl_kernel_be31850da15a988e.cpp"
+#include "sickl_kernel_c35637a0ca26deba.cpp"
+#include "sickl_kernel_c5060bf9d1ee7f65.cpp"
+#include "sickl_kernel_cb94e31f5bb42fd2.cpp"
+#include "sickl_kernel_ccf47001307a34e5.cpp"
+#include "sickl_kernel_d55d85d08cbb2013.cpp"
+#include "sickl_kernel_ed82b8226fcd338b.cpp"
\ No newline at end of file
@@ -0,0 +1,61 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_15386215120b9b95(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				uint32_t v1_0 = 0;
+				uint32_t v1_1 = 0;
+				uint32_t v1_2 = 0;
+				uint32_t v1_3 = 0;
+				int32_t v2 = 0;
+				int32_t v3 = 0;
+				float v4 = 0;
+				int32_t v5 = 0;
+				float v6 = 0;
+				float v7 = 0;
+				float v8 = 0;
+				float v9 = 0;
+				float v10 = 0;
+				v2 = x;
+				v3 = y;
+				v4 = 0.0f;
+				for(v5 = (0); v5 < (500); v5++)
+				{
+					v6 = CPPSample<float>(args.Inputs[0], v5, v3, 0);
+					v7 = CPPSample<float>(args.Inputs[1], v5, (0), 0);
+					v8 = CPPSample<float>(args.Inputs[2], (int32_t)((uint32_t)v5 + (uint32_t)(1)), v2, 0);
+					v4 = (v4 + ((v6 * v7) * v8));
+				}
+				v4 = (v4 * 2.0f);
+				v4 = (v4 + CPPSample<float>(args.Inputs[2], (0), v2, 0));
+				v9 = 0.0f;
+				v10 = CPPMax(v4, v9);
+				v0 = v10;
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+				if(x < args.Outputs[1].Width && y < args.Outputs[1].Height)
+				{
+					uint32_t* dest = (uint32_t*)args.Outputs[1].Data + (y * args.Outputs[1].Width + x) * 4;
+					dest[0] = v1_0;
+					dest[1] = v1_1;
+					dest[2] = v1_2;
+					dest[3] = v1_3;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_15386215120b9b95_registration(0x15386215120b9b95ull, &sickl_kernel_15386215120b9b95);
+}
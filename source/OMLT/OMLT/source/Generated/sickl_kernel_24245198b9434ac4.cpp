@@ -0,0 +1,109 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_24245198b9434ac4(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				float v1 = 0;
+				float v2 = 0;
+				float v3_0 = 0;
+				float v3_1 = 0;
+				float v4 = 0;
+				float v5 = 0;
+				bool v6 = 0;
+				float v7 = 0;
+				float v8 = 0;
+				int32_t v9 = 0;
+				float v10 = 0;
+				int32_t v11 = 0;
+				float v12 = 0;
+				float v13 = 0;
+				float v14 = 0;
+				float v15 = 0;
+				v4 = 0.0f;
+				v5 = 0.0f;
+				v6 = false;
+				v7 = CPPSample<float>(args.Inputs[4], x, y, 0);
+				if(((x == (0)) && (CPPSample<float>(args.Inputs[3], y, (0), 0) == 1.0f)))
+				{
+					v8 = 0.0f;
+					for(v9 = (0); v9 < (10); v9++)
+					{
+						v8 = (v8 + CPPSample<float>(args.Inputs[0], y, v9, 0));
+					}
+					v4 = v8;
+				}
+				else if(((CPPSample<float>(args.Inputs[2], (int32_t)((uint32_t)x - (uint32_t)(1)), (0), 0) == 1.0f) && (CPPSample<float>(args.Inputs[3], y, (0), 0) == 1.0f)))
+				{
+					v10 = 0.0f;
+					for(v11 = (0); v11 < (10); v11++)
+					{
+						v12 = CPPSample<float>(args.Inputs[0], y, v11, 0);
+						v13 = CPPSample<float>(args.Inputs[1], (int32_t)((uint32_t)x - (uint32_t)(1)), v11, 0);
+						v10 = (v10 + (v12 * v13));
+					}
+					v4 = v10;
+					v14 = CPPSample<float>(args.Inputs[4], x, y, 0);
+					v5 = 0.0f;
+				}
+				else
+				{
+					v6 = true;
+				}
+				if((v6 == false))
+				{
+					v4 = (v4 * 0.100000001f);
+					v3_0 = ((0.0f * (v4 * v4)) + (1.0f * CPPSample<float>(args.Inputs[6], x, y, 0)));
+					v15 = CPPDivide(sqrtf((CPPSample<float>(args.Inputs[6], x, y, 1) + 9.99999997e-07f)), sqrtf((v3_0 + 9.99999997e-07f)));
+					v1 = ((0.699999988f * CPPSample<float>(args.Inputs[5], x, y, 0)) + ((0.00999999978f * v15) * (v4 - v5)));
+					v3_1 = ((0.0f * (v1 * v1)) + (1.0f * CPPSample<float>(args.Inputs[6], x, y, 1)));
+					v0 = (v7 + v1);
+					v2 = (v0 + (0.699999988f * v1));
+				}
+				else
+				{
+					v0 = CPPSample<float>(args.Inputs[4], x, y, 0);
+					v1 = CPPSample<float>(args.Inputs[5], x, y, 0);
+					{
+						const float t0 = CPPSample<float>(args.Inputs[6], x, y, 0);
+						const float t1 = CPPSample<float>(args.Inputs[6], x, y, 1);
+						v3_0 = t0;
+						v3_1 = t1;
+					}
+					v2 = (v0 + (0.699999988f * v1));
+				}
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+				if(x < args.Outputs[1].Width && y < args.Outputs[1].Height)
+				{
+					float* dest = (float*)args.Outputs[1].Data + (y * args.Outputs[1].Width + x) * 1;
+					dest[0] = v1;
+				}
+				if(x < args.Outputs[2].Width && y < args.Outputs[2].Height)
+				{
+					float* dest = (float*)args.Outputs[2].Data + (y * args.Outputs[2].Width + x) * 1;
+					dest[0] = v2;
+				}
+				if(x < args.Outputs[3].Width && y < args.Outputs[3].Height)
+				{
+					float* dest = (float*)args.Outputs[3].Data + (y * args.Outputs[3].Width + x) * 2;
+					dest[0] = v3_0;
+					dest[1] = v3_1;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_24245198b9434ac4_registration(0x24245198b9434ac4ull, &sickl_kernel_24245198b9434ac4);
+}
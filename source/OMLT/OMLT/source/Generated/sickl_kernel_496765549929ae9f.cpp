@@ -0,0 +1,144 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_496765549929ae9f(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				uint32_t v0_0 = 0;
+				uint32_t v0_1 = 0;
+				uint32_t v0_2 = 0;
+				uint32_t v0_3 = 0;
+				float v1 = 0;
+				float v2 = 0;
+				int32_t v3 = 0;
+				int32_t v4 = 0;
+				float v5 = 0;
+				int32_t v6 = 0;
+				float v7 = 0;
+				float v8 = 0;
+				float v9 = 0;
+				float v10 = 0;
+				float v11 = 0;
+				uint32_t v12_0 = 0;
+				uint32_t v12_1 = 0;
+				uint32_t v12_2 = 0;
+				uint32_t v12_3 = 0;
+				uint32_t v13_0 = 0;
+				uint32_t v13_1 = 0;
+				uint32_t v13_2 = 0;
+				uint32_t v13_3 = 0;
+				uint32_t v14 = 0;
+				uint32_t v15 = 0;
+				float v16 = 0;
+				uint32_t v17 = 0;
+				uint32_t v18 = 0;
+				float v19 = 0;
+				float v20 = 0;
+				float v21 = 0;
+				v3 = y;
+				v4 = x;
+				v5 = 0.0f;
+				for(v6 = (0); v6 < (784); v6++)
+				{
+					v7 = CPPSample<float>(args.Inputs[0], v6, v3, 0);
+					v8 = CPPSample<float>(args.Inputs[1], (int32_t)((uint32_t)v6 + (uint32_t)(1)), (int32_t)((uint32_t)v4 + (uint32_t)(1)), 0);
+					v5 = (v5 + ((v7 * ((float)(CPPSample<uint32_t>(args.Inputs[2], v6, (0), 0)))) * v8));
+				}
+				v5 = (v5 * 2.0f);
+				v5 = (v5 + CPPSample<float>(args.Inputs[1], (0), (int32_t)((uint32_t)v4 + (uint32_t)(1)), 0));
+				v9 = 0.0f;
+				v1 = CPPMax(v5, v9);
+				v10 = 0.0f;
+				v11 = 0.0f;
+				{
+					const uint32_t t0 = CPPSample<uint32_t>(args.Inputs[3], x, y, 0);
+					const uint32_t t1 = CPPSample<uint32_t>(args.Inputs[3], x, y, 1);
+					const uint32_t t2 = CPPSample<uint32_t>(args.Inputs[3], x, y, 2);
+					const uint32_t t3 = CPPSample<uint32_t>(args.Inputs[3], x, y, 3);
+					v12_0 = t0;
+					v12_1 = t1;
+					v12_2 = t2;
+					v12_3 = t3;
+				}
+				{
+					const uint32_t t0 = 0u;
+					const uint32_t t1 = 0u;
+					const uint32_t t2 = 0u;
+					const uint32_t t3 = 0u;
+					v13_0 = t0;
+					v13_1 = t1;
+					v13_2 = t2;
+					v13_3 = t3;
+				}
+				v14 = (v12_0 ^ (v12_0 << (11u & 31u)));
+				v13_0 = v12_1;
+				v13_1 = v12_2;
+				v13_2 = v12_3;
+				v13_3 = (((v12_3 ^ (v12_3 >> (19u & 31u))) ^ v14) ^ (v14 >> (8u & 31u)));
+				v15 = (v13_0 >> (8u & 31u));
+				v10 = CPPDivide(((float)(v15)), 16777216.0f);
+				v16 = 5.96046448e-08f;
+				v10 = CPPMax(v10, v16);
+				{
+					const uint32_t t0 = v13_0;
+					const uint32_t t1 = v13_1;
+					const uint32_t t2 = v13_2;
+					const uint32_t t3 = v13_3;
+					v12_0 = t0;
+					v12_1 = t1;
+					v12_2 = t2;
+					v12_3 = t3;
+				}
+				v17 = (v12_0 ^ (v12_0 << (11u & 31u)));
+				v13_0 = v12_1;
+				v13_1 = v12_2;
+				v13_2 = v12_3;
+				v13_3 = (((v12_3 ^ (v12_3 >> (19u & 31u))) ^ v17) ^ (v17 >> (8u & 31u)));
+				v18 = (v13_0 >> (8u & 31u));
+				v11 = CPPDivide(((float)(v18)), 16777216.0f);
+				{
+					const uint32_t t0 = v13_0;
+					const uint32_t t1 = v13_1;
+					const uint32_t t2 = v13_2;
+					const uint32_t t3 = v13_3;
+					v0_0 = t0;
+					v0_1 = t1;
+					v0_2 = t2;
+					v0_3 = t3;
+				}
+				v19 = (sqrtf(((-2.0f) * logf(v10))) * sinf((6.28318548f * v11)));
+				v20 = CPPDivide(1.0f, (1.0f + expf((-v5))));
+				v19 = (v19 * sqrtf(v20));
+				v21 = 0.0f;
+				v2 = CPPMax((v5 + v19), v21);
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					uint32_t* dest = (uint32_t*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 4;
+					dest[0] = v0_0;
+					dest[1] = v0_1;
+					dest[2] = v0_2;
+					dest[3] = v0_3;
+				}
+				if(x < args.Outputs[1].Width && y < args.Outputs[1].Height)
+				{
+					float* dest = (float*)args.Outputs[1].Data + (y * args.Outputs[1].Width + x) * 1;
+					dest[0] = v1;
+				}
+				if(x < args.Outputs[2].Width && y < args.Outputs[2].Height)
+				{
+					float* dest = (float*)args.Outputs[2].Data + (y * args.Outputs[2].Width + x) * 1;
+					dest[0] = v2;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_496765549929ae9f_registration(0x496765549929ae9full, &sickl_kernel_496765549929ae9f);
+}
@@ -0,0 +1,132 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_64df0b2c56c50aae(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				float v1 = 0;
+				float v2_0 = 0;
+				float v2_1 = 0;
+				float v3 = 0;
+				float v4 = 0;
+				float v5 = 0;
+				bool v6 = 0;
+				float v7 = 0;
+				int32_t v8 = 0;
+				float v9 = 0;
+				float v10 = 0;
+				int32_t v11 = 0;
+				float v12 = 0;
+				float v13 = 0;
+				int32_t v14 = 0;
+				float v15 = 0;
+				float v16 = 0;
+				float v17 = 0;
+				float v18 = 0;
+				float v19 = 0;
+				v4 = 0.0f;
+				v5 = 0.0f;
+				v6 = false;
+				v7 = CPPSample<float>(args.Inputs[5], x, y, 0);
+				if(((x == (0)) && (y == (0))))
+				{
+					v4 = 0.0f;
+					v5 = 0.0f;
+				}
+				else if(((x == (0)) && (CPPSample<uint32_t>(args.Inputs[7], (int32_t)((uint32_t)y - (uint32_t)(1)), (0), 0) == 1u)))
+				{
+					v4 = 0.0f;
+					for(v8 = (0); v8 < (10); v8++)
+					{
+						v9 = CPPSample<float>(args.Inputs[1], (int32_t)((uint32_t)y - (uint32_t)(1)), v8, 0);
+						v10 = CPPSample<float>(args.Inputs[3], (int32_t)((uint32_t)y - (uint32_t)(1)), v8, 0);
+						v4 = (v4 + (v9 - v10));
+					}
+					v5 = 0.0f;
+				}
+				else if(((y == (0)) && (CPPSample<uint32_t>(args.Inputs[6], (int32_t)((uint32_t)x - (uint32_t)(1)), (0), 0) == 1u)))
+				{
+					v4 = 0.0f;
+					for(v11 = (0); v11 < (10); v11++)
+					{
+						v12 = CPPSample<float>(args.Inputs[0], (int32_t)((uint32_t)x - (uint32_t)(1)), v11, 0);
+						v13 = CPPSample<float>(args.Inputs[2], (int32_t)((uint32_t)x - (uint32_t)(1)), v11, 0);
+						v4 = (v4 + (v12 - v13));
+					}
+					v5 = 0.0f;
+				}
+				else if(((CPPSample<uint32_t>(args.Inputs[6], (int32_t)((uint32_t)x - (uint32_t)(1)), (0), 0) == 1u) && (CPPSample<uint32_t>(args.Inputs[7], (int32_t)((uint32_t)y - (uint32_t)(1)), (0), 0) == 1u)))
+				{
+					v4 = 0.0f;
+					for(v14 = (0); v14 < (10); v14++)
+					{
+						v15 = CPPSample<float>(args.Inputs[0], (int32_t)((uint32_t)x - (uint32_t)(1)), v14, 0);
+						v16 = CPPSample<float>(args.Inputs[2], (int32_t)((uint32_t)x - (uint32_t)(1)), v14, 0);
+						v17 = CPPSample<float>(args.Inputs[1], (int32_t)((uint32_t)y - (uint32_t)(1)), v14, 0);
+						v18 = CPPSample<float>(args.Inputs[3], (int32_t)((uint32_t)y - (uint32_t)(1)), v14, 0);
+						v4 = (v4 + (v15 * v17));
+						v4 = (v4 - (v16 * v18));
+					}
+					v5 = 0.0f;
+				}
+				else
+				{
+					v6 = true;
+				}
+				if((v6 == false))
+				{
+					v4 = (v4 * 0.100000001f);
+					v2_0 = ((0.0f * (v4 * v4)) + (1.0f * CPPSample<float>(args.Inputs[8], x, y, 0)));
+					v19 = CPPDivide(sqrtf((CPPSample<float>(args.Inputs[8], x, y, 1) + 9.99999997e-07f)), sqrtf((v2_0 + 9.99999997e-07f)));
+					v0 = ((0.600000024f * CPPSample<float>(args.Inputs[4], x, y, 0)) + ((0.00999999978f * v19) * (v4 - v5)));
+					v2_1 = ((0.0f * (v0 * v0)) + (1.0f * CPPSample<float>(args.Inputs[8], x, y, 1)));
+					v1 = (v7 + v0);
+					v3 = (v1 + (0.600000024f * v0));
+				}
+				else
+				{
+					v0 = CPPSample<float>(args.Inputs[4], x, y, 0);
+					v1 = v7;
+					{
+						const float t0 = CPPSample<float>(args.Inputs[8], x, y, 0);
+						const float t1 = CPPSample<float>(args.Inputs[8], x, y, 1);
+						v2_0 = t0;
+						v2_1 = t1;
+					}
+					v3 = (v1 + (0.600000024f * v0));
+				}
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+				if(x < args.Outputs[1].Width && y < args.Outputs[1].Height)
+				{
+					float* dest = (float*)args.Outputs[1].Data + (y * args.Outputs[1].Width + x) * 1;
+					dest[0] = v1;
+				}
+				if(x < args.Outputs[2].Width && y < args.Outputs[2].Height)
+				{
+					float* dest = (float*)args.Outputs[2].Data + (y * args.Outputs[2].Width + x) * 2;
+					dest[0] = v2_0;
+					dest[1] = v2_1;
+				}
+				if(x < args.Outputs[3].Width && y < args.Outputs[3].Height)
+				{
+					float* dest = (float*)args.Outputs[3].Data + (y * args.Outputs[3].Width + x) * 1;
+					dest[0] = v3;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_64df0b2c56c50aae_registration(0x64df0b2c56c50aaeull, &sickl_kernel_64df0b2c56c50aae);
+}
@@ -0,0 +1,45 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_847a010cdb8e69bb(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				int32_t v1 = 0;
+				int32_t v2 = 0;
+				float v3 = 0;
+				int32_t v4 = 0;
+				float v5 = 0;
+				float v6 = 0;
+				float v7 = 0;
+				v1 = y;
+				v2 = x;
+				v3 = 0.0f;
+				for(v4 = (0); v4 < (500); v4++)
+				{
+					v5 = CPPSample<float>(args.Inputs[0], v4, v1, 0);
+					v6 = CPPSample<float>(args.Inputs[1], (int32_t)((uint32_t)v4 + (uint32_t)(1)), (int32_t)((uint32_t)v2 + (uint32_t)(1)), 0);
+					v3 = (v3 + ((v5 * v6) * ((float)(CPPSample<uint32_t>(args.Inputs[2], v4, (0), 0)))));
+				}
+				v3 = (v3 * 2.0f);
+				v3 = (v3 + CPPSample<float>(args.Inputs[1], (0), (int32_t)((uint32_t)v2 + (uint32_t)(1)), 0));
+				v7 = 0.0f;
+				v0 = CPPMax(v3, v7);
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_847a010cdb8e69bb_registration(0x847a010cdb8e69bbull, &sickl_kernel_847a010cdb8e69bb);
+}
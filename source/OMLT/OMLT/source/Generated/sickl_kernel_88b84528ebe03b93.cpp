@@ -0,0 +1,52 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_88b84528ebe03b93(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				int32_t v1 = 0;
+				int32_t v2 = 0;
+				float v3 = 0;
+				int32_t v4 = 0;
+				float v5 = 0;
+				float v6 = 0;
+				float v7 = 0;
+				float v8 = 0;
+				v1 = x;
+				v2 = y;
+				if((CPPSample<float>(args.Inputs[3], v1, (0), 0) == 1.0f))
+				{
+					v3 = 0.0f;
+					for(v4 = (0); v4 < (10); v4++)
+					{
+						v5 = CPPSample<float>(args.Inputs[0], (int32_t)((uint32_t)v1 + (uint32_t)(1)), v4, 0);
+						v6 = CPPSample<float>(args.Inputs[1], v4, v2, 0);
+						v3 = (v3 + (v5 * v6));
+					}
+					v7 = 0.0f;
+					v8 = CPPMax(v7, CPPSign(CPPSample<float>(args.Inputs[2], v1, v2, 0)));
+					v0 = (v3 * v8);
+				}
+				else
+				{
+					v0 = 0.0f;
+				}
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_88b84528ebe03b93_registration(0x88b84528ebe03b93ull, &sickl_kernel_88b84528ebe03b93);
+}
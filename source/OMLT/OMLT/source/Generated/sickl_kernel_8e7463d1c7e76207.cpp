@@ -0,0 +1,55 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_8e7463d1c7e76207(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				uint32_t v0 = 0;
+				uint32_t v1_0 = 0;
+				uint32_t v1_1 = 0;
+				uint32_t v1_2 = 0;
+				uint32_t v1_3 = 0;
+				uint32_t v2 = 0;
+				uint32_t v3 = 0;
+				float v4 = 0;
+				v2 = (CPPSample<uint32_t>(args.Inputs[0], x, y, 0) ^ (CPPSample<uint32_t>(args.Inputs[0], x, y, 0) << (11u & 31u)));
+				v1_0 = CPPSample<uint32_t>(args.Inputs[0], x, y, 1);
+				v1_1 = CPPSample<uint32_t>(args.Inputs[0], x, y, 2);
+				v1_2 = CPPSample<uint32_t>(args.Inputs[0], x, y, 3);
+				v1_3 = (((CPPSample<uint32_t>(args.Inputs[0], x, y, 3) ^ (CPPSample<uint32_t>(args.Inputs[0], x, y, 3) >> (19u & 31u))) ^ v2) ^ (v2 >> (8u & 31u)));
+				v3 = (v1_0 >> (8u & 31u));
+				v4 = CPPDivide(((float)(v3)), 16777216.0f);
+				if((v4 > 0.5f))
+				{
+					v0 = 1u;
+				}
+				else
+				{
+					v0 = 0u;
+				}
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					uint32_t* dest = (uint32_t*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+				if(x < args.Outputs[1].Width && y < args.Outputs[1].Height)
+				{
+					uint32_t* dest = (uint32_t*)args.Outputs[1].Data + (y * args.Outputs[1].Width + x) * 4;
+					dest[0] = v1_0;
+					dest[1] = v1_1;
+					dest[2] = v1_2;
+					dest[3] = v1_3;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_8e7463d1c7e76207_registration(0x8e7463d1c7e76207ull, &sickl_kernel_8e7463d1c7e76207);
+}
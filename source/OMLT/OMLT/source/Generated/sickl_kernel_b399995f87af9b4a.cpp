@@ -0,0 +1,44 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_b399995f87af9b4a(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				int32_t v1 = 0;
+				float v2 = 0;
+				int32_t v3 = 0;
+				float v4 = 0;
+				int32_t v5 = 0;
+				float v6 = 0;
+				v1 = y;
+				v2 = (-3.40282347e+38f);
+				for(v3 = (0); v3 < (10); v3++)
+				{
+					v2 = CPPMax(v2, CPPSample<float>(args.Inputs[0], v3, v1, 0));
+				}
+				v4 = 0.0f;
+				for(v5 = (0); v5 < (10); v5++)
+				{
+					v4 = (v4 + expf((CPPSample<float>(args.Inputs[0], v5, v1, 0) - v2)));
+				}
+				v6 = expf((CPPSample<float>(args.Inputs[0], x, y, 0) - v2));
+				v0 = CPPDivide(v6, v4);
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_b399995f87af9b4a_registration(0xb399995f87af9b4aull, &sickl_kernel_b399995f87af9b4a);
+}
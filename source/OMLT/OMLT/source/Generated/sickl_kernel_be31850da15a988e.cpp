@@ -0,0 +1,40 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_be31850da15a988e(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				float v0 = 0;
+				int32_t v1 = 0;
+				int32_t v2 = 0;
+				float v3 = 0;
+				float v4 = 0;
+				float v5 = 0;
+				v1 = x;
+				v0 = 0.0f;
+				for(v2 = (0); v2 < (784); v2++)
+				{
+					v3 = CPPSample<float>(args.Inputs[0], v2, v1, 0);
+					v4 = CPPSample<float>(args.Inputs[1], v2, v1, 0);
+					v5 = (v3 - v4);
+					v0 = (v0 + (v5 * v5));
+				}
+				v0 = (v0 * 0.00127551018f);
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					float* dest = (float*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 1;
+					dest[0] = v0;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_be31850da15a988e_registration(0xbe31850da15a988eull, &sickl_kernel_be31850da15a988e);
+}
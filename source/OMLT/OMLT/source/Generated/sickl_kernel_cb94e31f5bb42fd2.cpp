@@ -0,0 +1,55 @@
+// generated by SiCKL::CPPGenerator, do not edit
+#include "SiCKL.h"
+
+namespace
+{
+	using namespace SiCKL;
+
+	void sickl_kernel_cb94e31f5bb42fd2(const CPPKernelArgs& args)
+	{
+		for(int32_t y = args.RowBegin; y < args.RowEnd; y++)
+		{
+			for(int32_t x = 0; x < args.Width; x++)
+			{
+				uint32_t v0_0 = 0;
+				uint32_t v0_1 = 0;
+				uint32_t v0_2 = 0;
+				uint32_t v0_3 = 0;
+				float v1 = 0;
+				uint32_t v2 = 0;
+				uint32_t v3 = 0;
+				float v4 = 0;
+				v2 = (CPPSample<uint32_t>(args.Inputs[0], x, (0), 0) ^ (CPPSample<uint32_t>(args.Inputs[0], x, (0), 0) << (11u & 31u)));
+				v0_0 = CPPSample<uint32_t>(args.Inputs[0], x, (0), 1);
+				v0_1 = CPPSample<uint32_t>(args.Inputs[0], x, (0), 2);
+				v0_2 = CPPSample<uint32_t>(args.Inputs[0], x, (0), 3);
+				v0_3 = (((CPPSample<uint32_t>(args.Inputs[0], x, (0), 3) ^ (CPPSample<uint32_t>(args.Inputs[0], x, (0), 3) >> (19u & 31u))) ^ v2) ^ (v2 >> (8u & 31u)));
+				v3 = (v0_0 >> (8u & 31u));
+				v4 = CPPDivide(((float)(v3)), 16777216.0f);
+				if((v4 > 0.5f))
+				{
+					v1 = 1.0f;
+				}
+				else
+				{
+					v1 = 0.0f;
+				}
+				if(x < args.Outputs[0].Width && y < args.Outputs[0].Height)
+				{
+					uint32_t* dest = (uint32_t*)args.Outputs[0].Data + (y * args.Outputs[0].Width + x) * 4;
+					dest[0] = v0_0;
+					dest[1] = v0_1;
+					dest[2] = v0_2;
+					dest[3] = v0_3;
+				}
+				if(x < args.Outputs[1].Width && y < args.Outputs[1].Height)
+				{
+					float* dest = (float*)args.Outputs[1].Data + (y * args.Outputs[1].Width + x) * 1;
+					dest[0] = v1;
+				}
+			}
+		}
+	}
+
+	CPPKernelRegistration sickl_kernel_cb94e31f5bb42fd2_registration(0xcb94e31f5bb42fd2ull, &sickl_kernel_cb94e31f5bb42fd2);
+}
@@ -0,0 +1,137 @@
+// std
+#include <string.h>
+#include <string>
+#include <vector>
+#include <atomic>
+
+// extern
+#include <cppJSONStream.hpp>
+
+// OMLT
+#include "JSONModel.h"
+#include "ParseFloat.h"
+#include "CPUShared.h"
+
+namespace OMLT
+{
+	namespace JSONModel
+	{
+		// below this many characters a matrix is parsed on the calling thread
+		static const size_t ParallelTextSize = 1 << 20;
+
+		static inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		}
+
+		static inline const char* SkipSpace(const char* head)
+		{
+			while(IsSpace(*head))
+			{
+				head++;
+			}
+			return head;
+		}
+
+		// parses in_count comma separated numbers followed by in_terminator
+		static bool ParseNumbers(const char*& io_head, const char* in_end, char in_terminator, float* out_values, uint32_t in_count)
+		{
+			const char* head = SkipSpace(io_head);
+			for(uint32_t k = 0; k < in_count; k++)
+			{
+				if(k > 0)
+				{
+					if(*head != ',')
+					{
+						return false;
+					}
+					head = SkipSpace(head + 1);
+				}
+				if(ParseFloat(head, in_end, out_values[k]) == false)
+				{
+					return false;
+				}
+				head = SkipSpace(head);
+			}
+			if(*head != in_terminator)
+			{
+				return false;
+			}
+
+			io_head = head;
+			return true;
+		}
+
+		bool ReadFloatArray(cppJSONStream::Reader& r, float* out_values, uint32_t in_count)
+		{
+			std::string text;
+			if(r.readArrayText(text) == false)
+			{
+				return false;
+			}
+
+			// text ends in a null
+			const char* head = text.c_str();
+			return ParseNumbers(head, text.c_str() + text.size(), '\0', out_values, in_count);
+		}
+
+		bool ReadFloatRows(cppJSONStream::Reader& r, float* out_rows, uint32_t in_rows, uint32_t in_columns, uint32_t in_stride)
+		{
+			std::string text;
+			if(r.readArrayText(text) == false)
+			{
+				return false;
+			}
+
+			// find where each row starts, then check the separators between them
+			std::vector<const char*> rows;
+			rows.reserve(in_rows);
+			for(const char* head = text.c_str(); (head = strchr(head, '[')) != nullptr; head++)
+			{
+				if(rows.size() == in_rows)
+				{
+					return false;
+				}
+				rows.push_back(head + 1);
+			}
+			if(rows.size() != in_rows || SkipSpace(text.c_str()) + 1 != rows[0])
+			{
+				return false;
+			}
+
+			const char* text_end = text.c_str() + text.size();
+			std::atomic<bool> failed(false);
+			auto parse_rows = [&](uint32_t begin, uint32_t end)
+			{
+				for(uint32_t j = begin; j < end && failed == false; j++)
+				{
+					const char* head = rows[j];
+					if(ParseNumbers(head, text_end, ']', out_rows + size_t(j) * in_stride, in_columns) == false)
+					{
+						failed = true;
+						break;
+					}
+
+					// rows are followed by a ',' and the next row, or by the end of the text
+					head = SkipSpace(head + 1);
+					if(j + 1 < in_rows ? (*head != ',' || SkipSpace(head + 1) + 1 != rows[j + 1]) : *head != '\0')
+					{
+						failed = true;
+					}
+				}
+			};
+
+			if(text.size() < ParallelTextSize)
+			{
+				parse_rows(0, in_rows);
+			}
+			else
+			{
+				ThreadPool pool;
+				pool.ParallelFor(in_rows, parse_rows);
+			}
+
+			return failed == false;
+		}
+	}
+}
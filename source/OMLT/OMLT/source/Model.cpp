@@ -1,3 +1,6 @@
+// std
+#include <fstream>
+
 // cJSON
 #include <cJSON.h>
 // cppJSONStream
@@ -9,29 +12,36 @@ using namespace cppJSONStream;
 #include "RestrictedBoltzmannMachine.h"
 #include "MultilayerPerceptron.h"
 #include "AutoEncoder.h"
+#include "BinaryModel.h"
 
 namespace OMLT
 {
-	bool Model::FromJSON(std::istream& in_stream, Model& out_model)
+	// reads the "Type" of the model described by in_stream, then rewinds it
+	static std::string ReadType(std::istream& in_stream)
 	{
-		out_model.type = ModelType::Invalid;
-		out_model.ptr = nullptr;
-
-		// save our current position
 		std::streampos pos = in_stream.tellg();
+		std::string type;
+		{
+			cppJSONStream::Reader r(in_stream);
 
-		cppJSONStream::Reader r(in_stream);
-
-		SetReader(r);
-		SetErrorResult(false);
-		TryGetToken(Token::BeginObject);
+			SetReader(r);
+			SetErrorResult(type);
+			TryGetToken(Token::BeginObject);
+			TryGetNameValuePair("Type", Token::String);
+			type = r.readString();
+		}
+		in_stream.clear();
+		in_stream.seekg(pos, in_stream.beg);
 
-		TryGetNameValuePair("Type", Token::String);
+		return type;
+	}
 
-		std::string type = r.readString();
+	bool Model::FromJSON(std::istream& in_stream, Model& out_model)
+	{
+		out_model.type = ModelType::Invalid;
+		out_model.ptr = nullptr;
 
-		// reset stream to beginning
-		in_stream.seekg(pos, in_stream.beg);
+		const std::string type = ReadType(in_stream);
 		if(type == "RestrictedBoltzmannMachine")
 		{
 			RBM* rbm = RBM::FromJSON(in_stream);
@@ -65,4 +75,56 @@ namespace OMLT
 
 		return false;
 	}
+
+	bool Model::FromFile(const char* in_filename, Model& out_model)
+	{
+		out_model.type = ModelType::Invalid;
+		out_model.ptr = nullptr;
+
+		if(MappedFile* file = MappedFile::Open(in_filename))
+		{
+			BinaryModel::Reader reader;
+			const bool binary = reader.Open(file);
+			if(binary)
+			{
+				const std::string type = ReadType(reader.Header());
+				if(type == "RestrictedBoltzmannMachine")
+				{
+					out_model.rbm = RBM::FromBinary(reader);
+					out_model.type = ModelType::RBM;
+				}
+				else if(type == "AutoEncoder")
+				{
+					out_model.ae = AE::FromBinary(reader);
+					out_model.type = ModelType::AE;
+				}
+				else if(type == "MultilayerPerceptron")
+				{
+					out_model.mlp = MLP::FromBinary(reader);
+					out_model.type = ModelType::MLP;
+				}
+
+				if(out_model.ptr == nullptr)
+				{
+					out_model.type = ModelType::Invalid;
+				}
+			}
+
+			// the loaded model holds its own references
+			file->Release();
+			if(binary)
+			{
+				return out_model.ptr != nullptr;
+			}
+		}
+
+		// not a binary model, so it should be JSON
+		std::fstream fs;
+		fs.open(in_filename, std::ios_base::in | std::ios_base::binary);
+		if(fs.is_open() == false)
+		{
+			return false;
+		}
+		return FromJSON(fs, out_model);
+	}
 }
\ No newline at end of file
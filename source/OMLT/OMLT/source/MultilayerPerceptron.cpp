@@ -2,7 +2,9 @@
 #include <assert.h>
 
 // c++
+#include <sstream>
 #include <memory>
+#include <algorithm>
 using std::auto_ptr;
 
  // windows
@@ -17,6 +19,8 @@ using namespace cppJSONStream;
 // OMLT
 #include "MultilayerPerceptron.h"
 #include "Common.h"
+#include "BinaryModel.h"
+#include "JSONModel.h"
 
 namespace OMLT
 {
@@ -58,6 +62,41 @@ namespace OMLT
 		_activations.back() = nullptr;
 	}
 
+	void MultilayerPerceptron::FeedForwardMatrix(const float* input_matrix, float* output_matrix, uint32_t rows) const
+	{
+		FeedForwardMatrix(input_matrix, output_matrix, rows, _layers.size() - 1);
+	}
+
+	void MultilayerPerceptron::FeedForwardMatrix(const float* input_matrix, float* output_matrix, uint32_t rows, uint32_t last_layer) const
+	{
+		assert(last_layer < _layers.size());
+
+		// hidden layer activations ping-pong between two scratch matrices sized for the widest layer
+		size_t scratch_alloc_size = 0;
+		for(size_t k = 0; k < last_layer; k++)
+		{
+			scratch_alloc_size = std::max(scratch_alloc_size, sizeof(float) * BlockCount(_layers[k]->outputs) * 4 * rows);
+		}
+
+		float* scratch[2] = {nullptr, nullptr};
+		if(scratch_alloc_size > 0)
+		{
+			scratch[0] = (float*)AlignedMalloc(scratch_alloc_size, 16);
+			scratch[1] = (float*)AlignedMalloc(scratch_alloc_size, 16);
+		}
+
+		const float* layer_input = input_matrix;
+		for(size_t k = 0; k <= last_layer; k++)
+		{
+			float* layer_output = k == last_layer ? output_matrix : scratch[k % 2];
+			_layers[k]->weights.CalcFeatureMatrix(layer_input, rows, layer_output, _layers[k]->function);
+			layer_input = layer_output;
+		}
+
+		AlignedFree(scratch[0]);
+		AlignedFree(scratch[1]);
+	}
+
 	MultilayerPerceptron::Layer* MultilayerPerceptron::GetLayer( uint32_t index )
 	{
 		assert(index < _layers.size());
@@ -157,27 +196,87 @@ namespace OMLT
 
 			// set biases
 			TryGetNameValuePair("Biases", Token::BeginArray);
-			for(uint32_t j = 0; j < outputs; j++)
-			{
-				TryGetToken(Token::Number);
-				layer->weights.biases()[j] = (float)r.readDouble();
-			}
-			TryGetToken(Token::EndArray);
+			VerifyEqual(JSONModel::ReadFloatArray(r, layer->weights.biases(), layer->outputs), true);
 
 			// set weights
 			TryGetNameValuePair("Weights", Token::BeginArray);
-			for(uint32_t j = 0; j < outputs; j++)
-			{
-				TryGetToken(Token::BeginArray);
-				for(uint32_t i = 0; i < inputs; i++)
+			VerifyEqual(JSONModel::ReadFloatRows(r, layer->weights.weights(), layer->outputs, layer->inputs, layer->weights.feature_stride), true);
+			mlp->AddLayer(layer.release());
+			TryGetToken(Token::EndObject);
+		}
+		TryGetToken(Token::EndObject);
+
+		return mlp.release();
+	}
+
+	void MultilayerPerceptron::ToBinary(std::ostream& stream) const
+	{
+		BinaryModel::Writer blocks;
+		std::ostringstream header;
+		cppJSONStream::Writer w(header, true);
+
+		w.begin_object();
+			w.write_namevalue("Type", "MultilayerPerceptron");
+			w.write_name("Layers");
+			w.begin_array();
+				for(auto it = _layers.begin(); it < _layers.end(); ++it)
 				{
-					TryGetToken(Token::Number);
-					layer->weights.feature(j)[i] = (float)r.readDouble();
+					w.begin_object();
+						w.write_namevalue("Inputs", (uint64_t)(*it)->inputs);
+						w.write_namevalue("Outputs", (uint64_t)(*it)->outputs);
+						w.write_namevalue("Function", ActivationFunctionNames[(*it)->function]);
+						w.write_name("Weights");
+							blocks.WriteFeatureMap(w, (*it)->weights);
+					w.end_object();
 				}
-				TryGetToken(Token::EndArray);
+			w.end_array();
+		w.end_object();
+
+		blocks.Write(stream, header.str());
+	}
+
+	MultilayerPerceptron* MultilayerPerceptron::FromBinary(BinaryModel::Reader& in_reader)
+	{
+		Reader r(in_reader.Header());
+
+		SetReader(r);
+		SetErrorResult(nullptr);
+		TryGetToken(Token::BeginObject);
+		TryGetNameValuePair("Type", Token::String);
+		VerifyEqual(r.readString(), "MultilayerPerceptron");
+
+		TryGetNameValuePair("Layers", Token::BeginArray);
+
+		auto_ptr<MLP> mlp(new MLP());
+
+		for(Token_t t = r.next(); t == Token::BeginObject; t = r.next())
+		{
+			TryGetNameValuePair("Inputs", Token::Number);
+			uint64_t inputs = r.readUInt();
+			TryGetNameValuePair("Outputs", Token::Number);
+			uint64_t outputs = r.readUInt();
+			TryGetNameValuePair("Function", Token::String);
+			ActivationFunction_t function = ParseFunction(r.readString().c_str());
+
+			if(inputs > (uint64_t)std::numeric_limits<uint32_t>::max() ||
+			  inputs == 0 ||
+			  outputs > (uint64_t)std::numeric_limits<uint32_t>::max() ||
+			  outputs == 0 ||
+			  function == ActivationFunction::Invalid)
+			{
+				return nullptr;
 			}
-			TryGetToken(Token::EndArray);
-			mlp->AddLayer(layer.release());
+
+			MappedFeatureMap weights;
+			TryGetNameValuePair("Weights", Token::BeginObject);
+			VerifyEqual(in_reader.ReadFeatureMap(r, uint32_t(inputs), uint32_t(outputs), weights), true);
+
+			auto_ptr<Layer> layer(new Layer(uint32_t(inputs), uint32_t(outputs), function, &weights));
+			if(mlp->AddLayer(layer.get()) == false)
+			{
+				return nullptr;
+			}
+			layer.release();
 			TryGetToken(Token::EndObject);
 		}
 		TryGetToken(Token::EndObject);
@@ -185,10 +284,10 @@ namespace OMLT
 		return mlp.release();
 	}
 
-	MultilayerPerceptron::Layer::Layer( uint32_t in_inputs, uint32_t in_outputs, ActivationFunction_t in_function )
+	MultilayerPerceptron::Layer::Layer( uint32_t in_inputs, uint32_t in_outputs, ActivationFunction_t in_function, const MappedFeatureMap* in_weights )
 		: inputs(in_inputs)
 		, outputs(in_outputs)
 		, function(in_function)
-		, weights(inputs, outputs)
+		, weights(inputs, outputs, in_weights)
 	{ }
 }
\ No newline at end of file
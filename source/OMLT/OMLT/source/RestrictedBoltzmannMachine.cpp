@@ -3,6 +3,7 @@
 
 // c++
 #include <string>
+#include <sstream>
 #include <limits>
 using std::string;
 #include <memory>
@@ -18,17 +19,20 @@ using namespace cppJSONStream;
 
 // OMLT
 #include "Common.h"
+#include "SIMD.h"
 #include "RestrictedBoltzmannMachine.h"
+#include "BinaryModel.h"
+#include "JSONModel.h"
 
 namespace OMLT
 {
-	RestrictedBoltzmannMachine::RestrictedBoltzmannMachine( uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_visible_type, ActivationFunction_t in_hidden_type )
+	RestrictedBoltzmannMachine::RestrictedBoltzmannMachine( uint32_t in_visible_count, uint32_t in_hidden_count, ActivationFunction_t in_visible_type, ActivationFunction_t in_hidden_type, const MappedFeatureMap* in_hidden, const MappedFeatureMap* in_visible )
 		: visible_count(in_visible_count)
 		, hidden_count(in_hidden_count)
 		, visible_type(in_visible_type)
 		, hidden_type(in_hidden_type)
-		, hidden(visible_count, hidden_count)
-		, visible(hidden_count, visible_count)
+		, hidden(visible_count, hidden_count, in_hidden)
+		, visible(hidden_count, visible_count, in_visible)
 	{
 
 	}
@@ -43,7 +47,16 @@ namespace OMLT
 		visible.CalcFeatureVector(in_hidden, out_visible, visible_type);
 	}
 
-	extern __m128 _mm_ln_1_plus_e_x_ps(__m128 x);
+	void RestrictedBoltzmannMachine::CalcHiddenMatrix( const float* in_visible, float* out_hidden, uint32_t rows ) const
+	{
+		hidden.CalcFeatureMatrix(in_visible, rows, out_hidden, hidden_type);
+	}
+
+	void RestrictedBoltzmannMachine::CalcVisibleMatrix( const float* in_hidden, float* out_visible, uint32_t rows ) const
+	{
+		visible.CalcFeatureMatrix(in_hidden, rows, out_visible, visible_type);
+	}
+
 	float RestrictedBoltzmannMachine::CalcFreeEnergy( const float* in_visible ) const
 	{
 		assert(visible_type == ActivationFunction::Sigmoid || visible_type == ActivationFunction::RectifiedLinear);
@@ -80,19 +93,7 @@ namespace OMLT
 		}
 
 		// calc all the ln(1 + e^x) and add them together
-		float* head = hidden_buffer;
-		__m128 sum = _mm_setzero_ps();
-		for(uint32_t k = 0; k < hidden_buffer.BlockCount(); k++)
-		{
-			sum = _mm_add_ps(sum, _mm_ln_1_plus_e_x_ps(_mm_load_ps(head)));
-			head += 4;
-		}
-		
-		sum = _mm_hadd_ps(sum, sum);
-		sum = _mm_hadd_ps(sum, sum);
-
-		float log_sum;
-		_mm_store_ss(&log_sum, sum);
+		float log_sum = GetSIMDKernels().SumLn1PlusEx(hidden_buffer, hidden_buffer.BlockCount());
 
 		return (-bias_sum - log_sum);
 	}
@@ -159,39 +160,86 @@ namespace OMLT
 		// now load our biases
 
 		TryGetNameValuePair("VisibleBiases", Token::BeginArray);
-		for(size_t i = 0; i < rbm->visible_count; i++)
-		{
-			TryGetToken(Token::Number);
-			rbm->visible.biases()[i] = (float)r.readDouble();
-		}
-		TryGetToken(Token::EndArray);
+		VerifyEqual(JSONModel::ReadFloatArray(r, rbm->visible.biases(), rbm->visible_count), true);
 
 		TryGetNameValuePair("HiddenBiases", Token::BeginArray);
-		for(size_t j = 0; j < rbm->hidden_count; j++)
-		{
-			TryGetToken(Token::Number);
-			rbm->hidden.biases()[j] = (float)r.readDouble();
-		}
-		TryGetToken(Token::EndArray);
+		VerifyEqual(JSONModel::ReadFloatArray(r, rbm->hidden.biases(), rbm->hidden_count), true);
 
-		// now load our weights
+		// now load our weights, then copy them to the visible features
 
 		TryGetNameValuePair("Weights", Token::BeginArray);
+		VerifyEqual(JSONModel::ReadFloatRows(r, rbm->hidden.weights(), rbm->hidden_count, rbm->visible_count, rbm->hidden.feature_stride), true);
 		for(size_t j = 0; j < rbm->hidden_count; j++)
 		{
-			TryGetToken(Token::BeginArray);
+			const float* w_j = rbm->hidden.feature(j);
 			for(size_t i = 0; i < rbm->visible_count; i++)
 			{
-				TryGetToken(Token::Number);
-				float w_ij = (float)r.readDouble();
-				rbm->hidden.feature(j)[i] = w_ij;
-				rbm->visible.feature(i)[j] = w_ij;
+				rbm->visible.feature(i)[j] = w_j[i];
 			}
-			TryGetToken(Token::EndArray);
 		}
-		TryGetToken(Token::EndArray);
 		TryGetToken(Token::EndObject);
 
 		return rbm.release();
 	}
+
+	void RestrictedBoltzmannMachine::ToBinary(std::ostream& stream) const
+	{
+		BinaryModel::Writer blocks;
+		std::ostringstream header;
+		cppJSONStream::Writer w(header, true);
+
+		// both directions are stored so neither has to be transposed when loading
+		w.begin_object();
+			w.write_namevalue("Type", "RestrictedBoltzmannMachine");
+			w.write_namevalue("VisibleCount", (uint64_t)visible_count);
+			w.write_namevalue("HiddenCount", (uint64_t)hidden_count);
+			w.write_namevalue("VisibleType", ActivationFunctionNames[visible_type]);
+			w.write_namevalue("HiddenType", ActivationFunctionNames[hidden_type]);
+			w.write_name("Hidden");
+				blocks.WriteFeatureMap(w, hidden);
+			w.write_name("Visible");
+				blocks.WriteFeatureMap(w, visible);
+		w.end_object();
+
+		blocks.Write(stream, header.str());
+	}
+
+	RestrictedBoltzmannMachine* RestrictedBoltzmannMachine::FromBinary(BinaryModel::Reader& in_reader)
+	{
+		Reader r(in_reader.Header());
+
+		SetReader(r);
+		SetErrorResult(nullptr);
+		TryGetToken(Token::BeginObject);
+		TryGetNameValuePair("Type", Token::String);
+		VerifyEqual(r.readString(), "RestrictedBoltzmannMachine");
+
+		TryGetNameValuePair("VisibleCount", Token::Number);
+		uint64_t visible_count = r.readUInt();
+		TryGetNameValuePair("HiddenCount", Token::Number);
+		uint64_t hidden_count = r.readUInt();
+		TryGetNameValuePair("VisibleType", Token::String);
+		ActivationFunction_t visible_type = ParseFunction(r.readString().c_str());
+		TryGetNameValuePair("HiddenType", Token::String);
+		ActivationFunction_t hidden_type = ParseFunction(r.readString().c_str());
+
+		if(visible_count > (uint64_t)std::numeric_limits<uint32_t>::max() ||
+		   visible_count == 0 ||
+		   hidden_count > (uint64_t)std::numeric_limits<uint32_t>::max() ||
+		   hidden_count == 0 ||
+		   visible_type == ActivationFunction::Invalid ||
+		   hidden_type == ActivationFunction::Invalid)
+		{
+			return nullptr;
+		}
+
+		MappedFeatureMap hidden, visible;
+		TryGetNameValuePair("Hidden", Token::BeginObject);
+		VerifyEqual(in_reader.ReadFeatureMap(r, uint32_t(visible_count), uint32_t(hidden_count), hidden), true);
+		TryGetNameValuePair("Visible", Token::BeginObject);
+		VerifyEqual(in_reader.ReadFeatureMap(r, uint32_t(hidden_count), uint32_t(visible_count), visible), true);
+		TryGetToken(Token::EndObject);
+
+		return new RBM(uint32_t(visible_count), uint32_t(hidden_count), visible_type, hidden_type, &hidden, &visible);
+	}
 }
\ No newline at end of file
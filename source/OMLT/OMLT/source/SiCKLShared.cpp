@@ -98,6 +98,44 @@ namespace OMLT
 		return Float(0.0f);
 	}
 
+	/// Parameter Transfer
+
+	uint32_t GetWeightParameters(const SiCKLBuffer2D& in_weights, const SiCKLBuffer2D& in_delta_weights, float* out_parameters)
+	{
+		assert(in_weights.Width == in_delta_weights.Width && in_weights.Height == in_delta_weights.Height);
+		const uint32_t weight_count = in_weights.Width * in_weights.Height;
+
+		float* weights = out_parameters;
+		float* delta_weights = out_parameters + weight_count;
+		in_weights.GetData(weights);
+		in_delta_weights.GetData(delta_weights);
+
+		return 2 * weight_count;
+	}
+
+	uint32_t SetWeightParameters(const float* in_parameters, float in_momentum, SiCKLBuffer2D& inout_weights, SiCKLBuffer2D& inout_delta_weights, SiCKLBuffer2D& inout_nesterov_weight)
+	{
+		const uint32_t weight_count = inout_weights.Width * inout_weights.Height;
+		const float* weights = in_parameters;
+		const float* delta_weights = in_parameters + weight_count;
+
+		// same as the update kernels: the weight for t + 1/2
+		float* nesterov_weight = new float[weight_count];
+		for(uint32_t k = 0; k < weight_count; k++)
+		{
+			nesterov_weight[k] = weights[k] + in_momentum * delta_weights[k];
+		}
+
+		inout_weights.SetData(const_cast<float*>(weights));
+		inout_delta_weights.SetData(const_cast<float*>(delta_weights));
+		inout_nesterov_weight.SetData(nesterov_weight);
+		delete[] nesterov_weight;
+
+		return 2 * weight_count;
+	}
+
+	/// Error Calculation
+
 	ErrorCalculator::ErrorCalculator(uint32_t minibatch_size, uint32_t data_width, ErrorFunction_t error_function)
 	{
 		struct SourceCalcErrorVector : public SiCKL::Source
@@ -148,12 +186,12 @@ namespace OMLT
 		source.ERROR_FUNC = error_function;
 		source.Parse();
 		
-		OpenGLCompiler compiler;
+		SiCKLCompiler compiler;
 
 		_calc_error = compiler.Build(source);
 		_calc_error->Initialize(minibatch_size, 1);
 
-		_error_texture = OpenGLBuffer2D(minibatch_size, 1, ReturnType::Float, nullptr);
+		_error_texture = SiCKLBuffer2D(minibatch_size, 1, ReturnType::Float, nullptr);
 
 		_error_buffer.Acquire(minibatch_size);
 	}
@@ -163,7 +201,7 @@ namespace OMLT
 		delete _calc_error;
 	}
 
-	float ErrorCalculator::CalcError(const OpenGLBuffer2D& calculated, const OpenGLBuffer2D& expected)
+	float ErrorCalculator::CalcError(const SiCKLBuffer2D& calculated, const SiCKLBuffer2D& expected)
 	{
 		// calc error
 		_calc_error->SetInput(0, calculated);
@@ -194,4 +232,8 @@ namespace OMLT
 		result /= _error_texture.Width;
 		return result;
 	}
-}
\ No newline at end of file
+}
+
+/// Generated Kernels
+
+#include "Generated/Kernels.inl"
\ No newline at end of file
@@ -108,6 +108,7 @@ namespace OMLT
 					cJSON* cj_visible_dropout = cJSON_GetObjectItem(cj_train_config, "VisibleDropout");
 					cJSON* cj_hidden_dropout = cJSON_GetObjectItem(cj_train_config, "HiddenDropout");
 					cJSON* cj_adadelta_decay = cJSON_GetObjectItem(cj_train_config, "AdadeltaDecay");
+					cJSON* cj_parallelism = cJSON_GetObjectItem(cj_train_config, "Parallelism");
 
 					// epochs is the only thing required
 					if(cj_epochs && cj_epochs->valueint > 0)
@@ -195,6 +196,17 @@ namespace OMLT
 							train_config.AdadeltaDecay = (float)cj_adadelta_decay->valuedouble;
 						}
 					}
+					if(cj_parallelism)
+					{
+						if(cj_parallelism->type == cJSON_String)
+						{
+							train_config.Parallelism = ParseParallelism(cj_parallelism->valuestring);
+						}
+						if(cj_parallelism->type != cJSON_String || train_config.Parallelism == Parallelism::Invalid)
+						{
+							goto Error;
+						}
+					}
 
 
 					// save off this schedule and epoch count
@@ -375,6 +387,19 @@ Error:
 						READ_PARAMS(Noise, 0.0f, FLT_MAX)
 						READ_PARAMS(AdadeltaDecay, 0.0f, 1.0f)
 
+						cJSON* cj_parallelism = cJSON_GetObjectItem(cj_train_config, "Parallelism");
+						if(cj_parallelism)
+						{
+							if(cj_parallelism->type == cJSON_String)
+							{
+								train_config.Parallelism = ParseParallelism(cj_parallelism->valuestring);
+							}
+							if(cj_parallelism->type != cJSON_String || train_config.Parallelism == Parallelism::Invalid)
+							{
+								goto Error;
+							}
+						}
+
 						//now get the number of epochs
 						cJSON* cj_epochs = cJSON_GetObjectItem(cj_train_config, "Epochs");
 						if(cj_epochs == nullptr || cj_epochs->type != cJSON_Number || cj_epochs->valueint < 1)
@@ -514,6 +539,7 @@ Error:
 					cJSON* cj_visible_dropout = cJSON_GetObjectItem(cj_train_config, "VisibleDropout");
 					cJSON* cj_hidden_dropout = cJSON_GetObjectItem(cj_train_config, "HiddenDropout");
 					cJSON* cj_adadelta_decay = cJSON_GetObjectItem(cj_train_config, "AdadeltaDecay");
+					cJSON* cj_parallelism = cJSON_GetObjectItem(cj_train_config, "Parallelism");
 
 					// epochs is the only thing required
 					if(cj_epochs && cj_epochs->valueint > 0)
@@ -601,6 +627,17 @@ Error:
 							train_config.AdadeltaDecay = (float)cj_adadelta_decay->valuedouble;
 						}
 					}
+					if(cj_parallelism)
+					{
+						if(cj_parallelism->type == cJSON_String)
+						{
+							train_config.Parallelism = ParseParallelism(cj_parallelism->valuestring);
+						}
+						if(cj_parallelism->type != cJSON_String || train_config.Parallelism == Parallelism::Invalid)
+						{
+							goto Error;
+						}
+					}
 
 					// save off this schedule and epoch count
 					schedule.push_back(std::pair<AutoEncoderBackPropagation::TrainingConfig, uint32_t>(train_config, epochs));
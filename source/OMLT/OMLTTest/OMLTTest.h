@@ -12,9 +12,22 @@ typedef bool (*TestFunction)(int argc, char** argv);
 EXTERN(VerifySigmoid);
 EXTERN(VerifyLn1PlusEx);
 EXTERN(VerifyExp);
+EXTERN(VerifyFeatureMatrix);
+EXTERN(VerifyMatrixMultiply);
+EXTERN(VerifySiCKLKernels);
+EXTERN(VerifySiCKLControlFlow);
+EXTERN(VerifyGeneratedKernels);
 EXTERN(TrainRBM);
+EXTERN(TrainRBMCPU);
+EXTERN(TrainRBMHogwild);
 EXTERN(TrainAutoEncoder);
+EXTERN(TrainAutoEncoderCPU);
+EXTERN(TrainAutoEncoderBackPropagationCPU);
+EXTERN(TrainAutoEncoderHogwild);
 EXTERN(SerializeRBM);
+EXTERN(VerifyModelSerialization);
+EXTERN(VerifyParseFloat);
+EXTERN(VerifyCSV2IDX);
 // function list
 
 struct
@@ -26,7 +39,20 @@ struct
 	TEST(VerifySigmoid),
 	TEST(VerifyLn1PlusEx),
 	TEST(TrainRBM),
+	TEST(TrainRBMCPU),
+	TEST(TrainRBMHogwild),
 	TEST(TrainAutoEncoder),
+	TEST(TrainAutoEncoderCPU),
+	TEST(TrainAutoEncoderBackPropagationCPU),
+	TEST(TrainAutoEncoderHogwild),
 	TEST(SerializeRBM),
 	TEST(VerifyExp),
+	TEST(VerifyFeatureMatrix),
+	TEST(VerifyMatrixMultiply),
+	TEST(VerifySiCKLKernels),
+	TEST(VerifySiCKLControlFlow),
+	TEST(VerifyGeneratedKernels),
+	TEST(VerifyModelSerialization),
+	TEST(VerifyParseFloat),
+	TEST(VerifyCSV2IDX),
 };
\ No newline at end of file
@@ -4,7 +4,11 @@
 // OMLT
 #include <IDX.hpp>
 #include <DataAtlas.h>
+#include <DataAtlasCPU.h>
 #include <BackPropagation.h>
+#include <BackPropagationCPU.h>
+#include <AutoEncoderBackPropagation.h>
+#include <AutoEncoderBackPropagationCPU.h>
 #include <MultilayerPerceptron.h>
 #include <TrainingSchedule.h>
 
@@ -57,7 +61,7 @@ bool TrainAutoEncoder(int argc, char** argv)
 	printf("Initing SiCKL\n");
 
 	// startup SiCKL
-	SiCKL::OpenGLRuntime::Initialize();
+	SiCKLRuntime::Initialize();
 
 	printf("Building DataAtlas\n");
 	// construct our data atlas
@@ -74,7 +78,7 @@ bool TrainAutoEncoder(int argc, char** argv)
 	training_schedule->GetTrainingConfig(train_config);
 	bp.SetTrainingConfig(train_config);
 
-	OpenGLBuffer2D train_example;
+	SiCKLBuffer2D train_example;
 	float error = 0.0f;
 	uint32_t epoch_count = 0;
 	uint32_t iteration_count = 0;
@@ -122,7 +126,451 @@ bool TrainAutoEncoder(int argc, char** argv)
 
 	out_recon->Close();
 	
-	SiCKL::OpenGLRuntime::Finalize();
+	SiCKLRuntime::Finalize();
 
 	return true;
+}
+
+// trains BackPropagationCPU and BackPropagation as autoencoders from the same seed on the same minibatches;
+// they draw the same random numbers, so their errors should track each other
+bool TrainAutoEncoderCPU(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		printf("Usage: TrainAutoEncoderCPU [in_data.idx] [in_schedule.json]\n");
+		return false;
+	}
+
+	IDX* in_data = IDX::Load(argv[0]);
+	if(in_data == nullptr)
+	{
+		printf("Could not load %s\n", argv[0]);
+		return false;
+	}
+
+	std::string schedule_json;
+	if(!OMLT::ReadTextFile(argv[1], schedule_json))
+	{
+		printf("Could not open %s\n", argv[1]);
+		return false;
+	}
+
+	printf("Loading Training Schedule\n");
+	TrainingSchedule<BackPropagation>* training_schedule = TrainingSchedule<BackPropagation>::FromJSON(schedule_json);
+	if(training_schedule == nullptr)
+	{
+		printf("Could not parse training schedule\n");
+		return false;
+	}
+
+	printf("Initing SiCKL\n");
+	SiCKLRuntime::Initialize();
+
+	printf("Constructing CPU and SiCKL Backpropagation Trainers\n");
+	const uint32_t minibatch_size = training_schedule->GetMinibatchSize();
+	BackPropagationCPU bp_cpu(training_schedule->GetModelConfig(), minibatch_size, 1);
+	BackPropagation bp(training_schedule->GetModelConfig(), minibatch_size, 1);
+
+	BackPropagationCPU::TrainingConfig train_config;
+	training_schedule->StartTraining();
+	training_schedule->GetTrainingConfig(train_config);
+	bp_cpu.SetTrainingConfig(train_config);
+	bp.SetTrainingConfig(train_config);
+
+	const uint32_t row_length = in_data->GetRowLength();
+	const uint32_t total_batches = in_data->GetRowCount() / minibatch_size;
+	float* minibatch = new float[row_length * minibatch_size];
+
+	bool result = true;
+	float cpu_error = 0.0f;
+	float error = 0.0f;
+	float first_error = 0.0f;
+	float last_error = 0.0f;
+	uint32_t epoch_count = 0;
+	uint32_t batch = 0;
+	printf("Training!\n");
+
+	while(training_schedule->TrainingComplete() == false)
+	{
+		for(uint32_t m = 0; m < minibatch_size; m++)
+		{
+			in_data->ReadRow(batch * minibatch_size + m, minibatch + m * row_length);
+		}
+		SiCKLBuffer2D example(row_length, minibatch_size, ReturnType::Float, minibatch);
+
+		bp_cpu.Train(minibatch, minibatch);
+		bp.Train(example, example);
+
+		// before rounding has had a chance to add up both should agree closely
+		if(epoch_count == 0 && batch == 0 && std::fabs(bp_cpu.GetLastOutputError() - bp.GetLastOutputError()) > 1e-4f * bp.GetLastOutputError())
+		{
+			printf("First minibatch error: %f, expected %f\n", bp_cpu.GetLastOutputError(), bp.GetLastOutputError());
+			result = false;
+		}
+
+		cpu_error += bp_cpu.GetLastOutputError();
+		error += bp.GetLastOutputError();
+		batch++;
+
+		if(batch == total_batches)
+		{
+			epoch_count++;
+			cpu_error /= batch;
+			error /= batch;
+			printf("Epoch %u: Error %f, SiCKL Error %f\n", epoch_count, cpu_error, error);
+
+			if(std::fabs(cpu_error - error) > 0.05f * error)
+			{
+				printf("CPU error is more than 5%% away from the SiCKL error\n");
+				result = false;
+			}
+			if(epoch_count == 1)
+			{
+				first_error = cpu_error;
+			}
+			last_error = cpu_error;
+
+			batch = 0;
+			cpu_error = 0;
+			error = 0;
+
+			if(training_schedule->NextEpoch() && training_schedule->TrainingComplete() == false)
+			{
+				training_schedule->GetTrainingConfig(train_config);
+				bp_cpu.SetTrainingConfig(train_config);
+				bp.SetTrainingConfig(train_config);
+			}
+		}
+	}
+
+	if(epoch_count > 1 && last_error >= first_error)
+	{
+		printf("Error did not decrease\n");
+		result = false;
+	}
+
+	// the trained MLPs should reconstruct the first minibatch equally well
+	MLP* mlp = bp_cpu.GetMultilayerPerceptron();
+	MLP* sickl_mlp = bp.GetMultilayerPerceptron();
+
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		in_data->ReadRow(m, minibatch + m * row_length);
+	}
+
+	float* visible_buffer = (float*)AlignedMalloc(sizeof(float) * (mlp->InputLayer()->inputs + 4), 16);
+	float* output_buffer = (float*)AlignedMalloc(sizeof(float) * (mlp->OutputLayer()->outputs + 4), 16);
+
+	float mlp_error = 0.0f;
+	float sickl_mlp_error = 0.0f;
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		memcpy(visible_buffer, minibatch + m * row_length, sizeof(float) * row_length);
+		mlp->FeedForward(visible_buffer, output_buffer);
+		mlp_error += calc_square_error(visible_buffer, output_buffer, row_length);
+
+		sickl_mlp->FeedForward(visible_buffer, output_buffer);
+		sickl_mlp_error += calc_square_error(visible_buffer, output_buffer, row_length);
+	}
+	mlp_error /= minibatch_size;
+	sickl_mlp_error /= minibatch_size;
+
+	printf("CPU MLP error: %f, SiCKL MLP error: %f\n", mlp_error, sickl_mlp_error);
+	if(std::fabs(mlp_error - sickl_mlp_error) > 0.01f * sickl_mlp_error)
+	{
+		printf("CPU MLP is more than 1%% away from the SiCKL MLP\n");
+		result = false;
+	}
+
+	AlignedFree(visible_buffer);
+	AlignedFree(output_buffer);
+	delete mlp;
+	delete sickl_mlp;
+	delete[] minibatch;
+	delete training_schedule;
+
+	in_data->Close();
+	delete in_data;
+
+	SiCKLRuntime::Finalize();
+
+	return result;
+}
+
+// trains AutoEncoderBackPropagationCPU and AutoEncoderBackPropagation from the same seed on the same minibatches;
+// they draw the same random numbers, so their errors should track each other
+bool TrainAutoEncoderBackPropagationCPU(int argc, char** argv)
+{
+	if(argc != 1)
+	{
+		printf("Usage: TrainAutoEncoderBackPropagationCPU [in_data.idx]\n");
+		return false;
+	}
+
+	IDX* in_data = IDX::Load(argv[0]);
+	if(in_data == nullptr)
+	{
+		printf("Could not load %s\n", argv[0]);
+		return false;
+	}
+
+	printf("Initing SiCKL\n");
+	SiCKLRuntime::Initialize();
+
+	printf("Setting up model and training parameters\n");
+
+	const uint32_t minibatch_size = 10;
+	const uint32_t row_length = in_data->GetRowLength();
+
+	AutoEncoderBackPropagation::ModelConfig model_config;
+	{
+		model_config.VisibleCount = row_length;
+		model_config.HiddenCount = 64;
+		model_config.HiddenType = ActivationFunction::Sigmoid;
+		model_config.OutputType = ActivationFunction::Sigmoid;
+	}
+	AutoEncoderBackPropagation::TrainingConfig train_config;
+	{
+		train_config.LearningRate = 0.05f;
+		train_config.Momentum = 0.5f;
+		train_config.VisibleDropout = 0.2f;
+		train_config.HiddenDropout = 0.5f;
+	}
+
+	printf("Constructing CPU and SiCKL AutoEncoder Backpropagation algorithms\n");
+
+	AutoEncoderBackPropagationCPU ae_cpu(model_config, minibatch_size, 1);
+	ae_cpu.SetTrainingConfig(train_config);
+	AutoEncoderBackPropagation ae(model_config, minibatch_size, 1);
+	ae.SetTrainingConfig(train_config);
+
+	const uint32_t total_batches = in_data->GetRowCount() / minibatch_size;
+	float* minibatch = new float[row_length * minibatch_size];
+
+	printf("Training\n");
+
+	bool result = true;
+	const uint32_t epochs = 5;
+	float first_error = 0.0f;
+	float cpu_error = 0.0f;
+	for(uint32_t e = 0; e < epochs; e++)
+	{
+		cpu_error = 0.0f;
+		float error = 0.0f;
+		for(uint32_t k = 0; k < total_batches; k++)
+		{
+			for(uint32_t m = 0; m < minibatch_size; m++)
+			{
+				in_data->ReadRow(k * minibatch_size + m, minibatch + m * row_length);
+			}
+			SiCKLBuffer2D example(row_length, minibatch_size, ReturnType::Float, minibatch);
+
+			ae_cpu.Train(minibatch);
+			ae.Train(example);
+
+			// before rounding has had a chance to add up both should agree closely
+			if(e == 0 && k == 0 && std::fabs(ae_cpu.GetLastError() - ae.GetLastError()) > 1e-4f * ae.GetLastError())
+			{
+				printf("First minibatch error : %f, expected %f\n", ae_cpu.GetLastError(), ae.GetLastError());
+				result = false;
+			}
+
+			cpu_error += ae_cpu.GetLastError();
+			error += ae.GetLastError();
+		}
+		cpu_error /= total_batches;
+		error /= total_batches;
+		printf("Epoch : %u, error : %f, SiCKL error : %f\n", e, cpu_error, error);
+
+		if(std::fabs(cpu_error - error) > 0.05f * error)
+		{
+			printf("CPU error is more than 5%% away from the SiCKL error\n");
+			result = false;
+		}
+		if(e == 0)
+		{
+			first_error = cpu_error;
+		}
+	}
+
+	if(cpu_error >= first_error)
+	{
+		printf("Error did not decrease\n");
+		result = false;
+	}
+
+	// the trained autoencoders should reconstruct the first minibatch equally well
+	AutoEncoder* autoencoder = ae_cpu.GetAutoEncoder();
+	AutoEncoder* sickl_autoencoder = ae.GetAutoEncoder();
+
+	float* visible_buffer = (float*)AlignedMalloc(sizeof(float) * (row_length + 4), 16);
+	float* hidden_buffer = (float*)AlignedMalloc(sizeof(float) * (model_config.HiddenCount + 4), 16);
+	float* output_buffer = (float*)AlignedMalloc(sizeof(float) * (row_length + 4), 16);
+
+	float autoencoder_error = 0.0f;
+	float sickl_autoencoder_error = 0.0f;
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		in_data->ReadRow(m, visible_buffer);
+
+		autoencoder->Encode(visible_buffer, hidden_buffer);
+		autoencoder->Decode(hidden_buffer, output_buffer);
+		autoencoder_error += calc_square_error(visible_buffer, output_buffer, row_length);
+
+		sickl_autoencoder->Encode(visible_buffer, hidden_buffer);
+		sickl_autoencoder->Decode(hidden_buffer, output_buffer);
+		sickl_autoencoder_error += calc_square_error(visible_buffer, output_buffer, row_length);
+	}
+	autoencoder_error /= minibatch_size;
+	sickl_autoencoder_error /= minibatch_size;
+
+	printf("CPU AutoEncoder error : %f, SiCKL AutoEncoder error : %f\n", autoencoder_error, sickl_autoencoder_error);
+	if(std::fabs(autoencoder_error - sickl_autoencoder_error) > 0.01f * sickl_autoencoder_error)
+	{
+		printf("CPU AutoEncoder is more than 1%% away from the SiCKL AutoEncoder\n");
+		result = false;
+	}
+
+	AlignedFree(visible_buffer);
+	AlignedFree(hidden_buffer);
+	AlignedFree(output_buffer);
+	delete autoencoder;
+	delete sickl_autoencoder;
+	delete[] minibatch;
+
+	in_data->Close();
+	delete in_data;
+
+	SiCKLRuntime::Finalize();
+
+	return result;
+}
+
+// trains a BackPropagationCPU autoencoder and an AutoEncoderBackPropagationCPU with Parallelism::Hogwild
+// and checks both reconstruct the first minibatch better than they did to begin with
+bool TrainAutoEncoderHogwild(int argc, char** argv)
+{
+	if(argc != 1)
+	{
+		printf("Usage: TrainAutoEncoderHogwild [in_data.idx]\n");
+		return false;
+	}
+
+	// the atlases each take ownership of their IDX
+	IDX* in_data = IDX::Load(argv[0]);
+	IDX* in_labels = IDX::Load(argv[0]);
+	IDX* in_aebp_data = IDX::Load(argv[0]);
+	if(in_data == nullptr || in_labels == nullptr || in_aebp_data == nullptr)
+	{
+		printf("Could not load %s\n", argv[0]);
+		delete in_data;
+		delete in_labels;
+		delete in_aebp_data;
+		return false;
+	}
+
+	printf("Setting up models and training parameters\n");
+
+	const uint32_t minibatch_size = 10;
+	const uint32_t row_length = in_data->GetRowLength();
+	const uint32_t hidden_count = 64;
+
+	BackPropagation::ModelConfig bp_model_config;
+	{
+		bp_model_config.InputCount = row_length;
+		BackPropagation::LayerConfig hidden;
+		hidden.OutputUnits = hidden_count;
+		hidden.Function = ActivationFunction::Sigmoid;
+		BackPropagation::LayerConfig output;
+		output.OutputUnits = row_length;
+		output.Function = ActivationFunction::Sigmoid;
+		bp_model_config.LayerConfigs.push_back(hidden);
+		bp_model_config.LayerConfigs.push_back(output);
+	}
+	BackPropagation::TrainingConfig bp_train_config;
+	{
+		BackPropagation::LayerParameters parameters;
+		parameters.LearningRate = 0.05f;
+		parameters.Momentum = 0.5f;
+		parameters.Dropout = 0.2f;
+		bp_train_config.Parameters.push_back(parameters);
+		parameters.Dropout = 0.5f;
+		bp_train_config.Parameters.push_back(parameters);
+		bp_train_config.Parallelism = Parallelism::Hogwild;
+	}
+
+	AutoEncoderBackPropagation::ModelConfig aebp_model_config;
+	{
+		aebp_model_config.VisibleCount = row_length;
+		aebp_model_config.HiddenCount = hidden_count;
+		aebp_model_config.HiddenType = ActivationFunction::Sigmoid;
+		aebp_model_config.OutputType = ActivationFunction::Sigmoid;
+	}
+	AutoEncoderBackPropagation::TrainingConfig aebp_train_config;
+	{
+		aebp_train_config.LearningRate = 0.05f;
+		aebp_train_config.Momentum = 0.5f;
+		aebp_train_config.VisibleDropout = 0.2f;
+		aebp_train_config.HiddenDropout = 0.5f;
+		aebp_train_config.Parallelism = Parallelism::Hogwild;
+	}
+
+	// the first minibatch, to measure progress with
+	float* minibatch = new float[row_length * minibatch_size];
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		in_data->ReadRow(m, minibatch + m * row_length);
+	}
+
+	printf("Constructing CPU Backpropagation and AutoEncoder Backpropagation algorithms\n");
+
+	BackPropagationCPU bp(bp_model_config, minibatch_size, 1);
+	bp.SetTrainingConfig(bp_train_config);
+	AutoEncoderBackPropagationCPU aebp(aebp_model_config, minibatch_size, 1);
+	aebp.SetTrainingConfig(aebp_train_config);
+
+	DataAtlasCPU inputs(256);
+	DataAtlasCPU labels(256);
+	DataAtlasCPU aebp_inputs(256);
+	if(inputs.Initialize(in_data, minibatch_size) == false ||
+	   labels.Initialize(in_labels, minibatch_size) == false ||
+	   aebp_inputs.Initialize(in_aebp_data, minibatch_size) == false)
+	{
+		printf("Could not initialize data atlas\n");
+		delete[] minibatch;
+		return false;
+	}
+
+	printf("Training\n");
+
+	const float initial_bp_error = bp.GetOutputError(minibatch, minibatch);
+	const float initial_aebp_error = aebp.GetError(minibatch);
+	float bp_error = initial_bp_error;
+	float aebp_error = initial_aebp_error;
+
+	const uint32_t epochs = 10;
+	for(uint32_t e = 0; e < epochs; e++)
+	{
+		bp.Train(inputs, labels, inputs.GetTotalBatches());
+		aebp.Train(aebp_inputs, aebp_inputs.GetTotalBatches());
+		bp_error = bp.GetOutputError(minibatch, minibatch);
+		aebp_error = aebp.GetError(minibatch);
+		printf("Epoch : %u, error : %f, AutoEncoder error : %f\n", e, bp_error, aebp_error);
+	}
+
+	delete[] minibatch;
+
+	bool result = true;
+	if(bp_error >= initial_bp_error)
+	{
+		printf("Backpropagation error did not decrease\n");
+		result = false;
+	}
+	if(aebp_error >= initial_aebp_error)
+	{
+		printf("AutoEncoder Backpropagation error did not decrease\n");
+		result = false;
+	}
+
+	return result;
 }
\ No newline at end of file
@@ -7,7 +7,9 @@
 // OMLT
 #include <IDX.hpp>
 #include <DataAtlas.h>
+#include <DataAtlasCPU.h>
 #include <ContrastiveDivergence.h>
+#include <ContrastiveDivergenceCPU.h>
 #include <RestrictedBoltzmannMachine.h>
 
 using namespace OMLT;
@@ -64,7 +66,7 @@ bool TrainRBM(int argc, char** argv)
 	printf("Initing SiCKL\n");
 
 	// startup SiCKL
-	SiCKL::OpenGLRuntime::Initialize();
+	SiCKLRuntime::Initialize();
 
 	printf("Setting up model and training parameters\n");
 
@@ -97,7 +99,7 @@ bool TrainRBM(int argc, char** argv)
 	DataAtlas atlas(512);
 	atlas.Initialize(in_data, minibatch_size);
 
-	SiCKL::OpenGLBuffer2D training_example;
+	SiCKLBuffer2D training_example;
 
 	printf("Constructing Contrastive Divergence algorithm\n");
 
@@ -166,11 +168,244 @@ bool TrainRBM(int argc, char** argv)
 	delete out_features;
 	delete in_data;
 
-	SiCKL::OpenGLRuntime::Finalize();
+	SiCKLRuntime::Finalize();
 
 	return true;
 }
 
+// trains ContrastiveDivergenceCPU and ContrastiveDivergence from the same seed on the same minibatches;
+// they draw the same random numbers, so their reconstruction errors should track each other
+bool TrainRBMCPU(int argc, char** argv)
+{
+	if(argc != 1)
+	{
+		printf("Usage: TrainRBMCPU [in_data.idx]\n");
+		return false;
+	}
+
+	IDX* in_data = IDX::Load(argv[0]);
+	if(in_data == nullptr)
+	{
+		printf("Could not load %s\n", argv[0]);
+		return false;
+	}
+
+	printf("Initing SiCKL\n");
+	SiCKLRuntime::Initialize();
+
+	printf("Setting up model and training parameters\n");
+
+	const uint32_t minibatch_size = 10;
+	CD::ModelConfig model_config;
+	{
+		model_config.VisibleUnits = in_data->GetRowLength();
+		model_config.HiddenUnits = 256;
+		model_config.VisibleType = ActivationFunction::Sigmoid;
+		model_config.HiddenType = ActivationFunction::Sigmoid;
+	}
+
+	CD::TrainingConfig train_config;
+	{
+		train_config.VisibleDropout = 0.2f;
+		train_config.HiddenDropout = 0.5f;
+		train_config.LearningRate = 0.1f;
+		train_config.Momentum = 0.5f;
+		train_config.L1Regularization = 0.0f;
+		train_config.L2Regularization = 0.0f;
+	}
+
+	printf("Constructing CPU and SiCKL Contrastive Divergence algorithms\n");
+
+	ContrastiveDivergenceCPU cd_cpu(model_config, minibatch_size, 1);
+	cd_cpu.SetTrainingConfig(train_config);
+	ContrastiveDivergence cd(model_config, minibatch_size, 1);
+	cd.SetTrainingConfig(train_config);
+
+	const uint32_t row_length = in_data->GetRowLength();
+	const uint32_t total_batches = in_data->GetRowCount() / minibatch_size;
+	float* minibatch = new float[row_length * minibatch_size];
+
+	printf("Training\n");
+
+	bool result = true;
+	const uint32_t epochs = 10;
+	float first_error = 0.0f;
+	float cpu_error = 0.0f;
+	for(uint32_t e = 0; e < epochs; e++)
+	{
+		cpu_error = 0.0f;
+		float error = 0.0f;
+		for(uint32_t k = 0; k < total_batches; k++)
+		{
+			for(uint32_t m = 0; m < minibatch_size; m++)
+			{
+				in_data->ReadRow(k * minibatch_size + m, minibatch + m * row_length);
+			}
+			SiCKLBuffer2D example(row_length, minibatch_size, ReturnType::Float, minibatch);
+
+			cd_cpu.Train(minibatch);
+			cd.Train(example);
+
+			// before rounding has had a chance to flip a sampled state both should agree closely
+			if(e == 0 && k == 0 && std::fabs(cd_cpu.GetLastReconstructionError() - cd.GetLastReconstructionError()) > 1e-4f * cd.GetLastReconstructionError())
+			{
+				printf("First minibatch error : %f, expected %f\n", cd_cpu.GetLastReconstructionError(), cd.GetLastReconstructionError());
+				result = false;
+			}
+
+			cpu_error += cd_cpu.GetLastReconstructionError();
+			error += cd.GetLastReconstructionError();
+		}
+		cpu_error /= total_batches;
+		error /= total_batches;
+		printf("Epoch : %u, error : %f, SiCKL error : %f\n", e, cpu_error, error);
+
+		if(std::fabs(cpu_error - error) > 0.05f * error)
+		{
+			printf("CPU error is more than 5%% away from the SiCKL error\n");
+			result = false;
+		}
+		if(e == 0)
+		{
+			first_error = cpu_error;
+		}
+	}
+
+	if(cpu_error >= first_error)
+	{
+		printf("Error did not decrease\n");
+		result = false;
+	}
+
+	RBM* rbm = cd_cpu.GetRestrictedBoltzmannMachine();
+	RBM* sickl_rbm = cd.GetRestrictedBoltzmannMachine();
+
+	// the trained models should reconstruct the first minibatch equally well (the trainers' own
+	// errors are from sampled hidden states, so they aren't comparable with the mean field error)
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		in_data->ReadRow(m, minibatch + m * row_length);
+	}
+
+	float* visible_buffer = (float*)_aligned_malloc(sizeof(float) * rbm->visible_count + 16, 16);
+	float* visible_recon_buffer = (float*)_aligned_malloc(sizeof(float) * rbm->visible_count + 16, 16);
+	float* hidden_buffer = (float*)_aligned_malloc(sizeof(float) * rbm->hidden_count + 16, 16);
+
+	float rbm_error = 0.0f;
+	float sickl_rbm_error = 0.0f;
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		memcpy(visible_buffer, minibatch + m * row_length, sizeof(float) * row_length);
+		rbm->CalcHidden(visible_buffer, hidden_buffer);
+		rbm->CalcVisible(hidden_buffer, visible_recon_buffer);
+		rbm_error += calc_square_error(visible_buffer, visible_recon_buffer, rbm->visible_count);
+
+		sickl_rbm->CalcHidden(visible_buffer, hidden_buffer);
+		sickl_rbm->CalcVisible(hidden_buffer, visible_recon_buffer);
+		sickl_rbm_error += calc_square_error(visible_buffer, visible_recon_buffer, rbm->visible_count);
+	}
+	rbm_error /= minibatch_size;
+	sickl_rbm_error /= minibatch_size;
+
+	printf("CPU RBM error : %f, SiCKL RBM error : %f\n", rbm_error, sickl_rbm_error);
+	if(std::fabs(rbm_error - sickl_rbm_error) > 0.01f * sickl_rbm_error)
+	{
+		printf("CPU RBM is more than 1%% away from the SiCKL RBM\n");
+		result = false;
+	}
+
+	_aligned_free(visible_buffer);
+	_aligned_free(visible_recon_buffer);
+	_aligned_free(hidden_buffer);
+	delete[] minibatch;
+	delete rbm;
+	delete sickl_rbm;
+
+	in_data->Close();
+	delete in_data;
+
+	SiCKLRuntime::Finalize();
+
+	return result;
+}
+
+bool TrainRBMHogwild(int argc, char** argv)
+{
+	if(argc != 1)
+	{
+		printf("Usage: TrainRBMHogwild [in_data.idx]\n");
+		return false;
+	}
+
+	IDX* in_data = IDX::Load(argv[0]);
+	if(in_data == nullptr)
+	{
+		printf("Could not load %s\n", argv[0]);
+		return false;
+	}
+
+	printf("Setting up model and training parameters\n");
+
+	const uint32_t minibatch_size = 10;
+	CD::ModelConfig model_config;
+	{
+		model_config.VisibleUnits = in_data->GetRowLength();
+		model_config.HiddenUnits = 256;
+		model_config.VisibleType = ActivationFunction::Sigmoid;
+		model_config.HiddenType = ActivationFunction::Sigmoid;
+	}
+
+	CD::TrainingConfig train_config;
+	{
+		train_config.VisibleDropout = 0.2f;
+		train_config.HiddenDropout = 0.5f;
+		train_config.LearningRate = 0.1f;
+		train_config.Momentum = 0.5f;
+		train_config.L1Regularization = 0.0f;
+		train_config.L2Regularization = 0.0f;
+		train_config.Parallelism = Parallelism::Hogwild;
+	}
+
+	// the first minibatch, to measure progress with
+	const uint32_t row_length = in_data->GetRowLength();
+	float* minibatch = new float[row_length * minibatch_size];
+	for(uint32_t m = 0; m < minibatch_size; m++)
+	{
+		in_data->ReadRow(m, minibatch + m * row_length);
+	}
+
+	printf("Constructing CPU Contrastive Divergence algorithm\n");
+
+	ContrastiveDivergenceCPU cd(model_config, minibatch_size, 1);
+	cd.SetTrainingConfig(train_config);
+
+	// the atlas takes ownership of in_data
+	DataAtlasCPU atlas(256);
+	if(atlas.Initialize(in_data, minibatch_size) == false)
+	{
+		printf("Could not initialize data atlas\n");
+		delete[] minibatch;
+		return false;
+	}
+
+	printf("Training\n");
+
+	const float initial_error = cd.GetReconstructionError(minibatch);
+	float error = initial_error;
+
+	const uint32_t epochs = 10;
+	for(uint32_t e = 0; e < epochs; e++)
+	{
+		cd.Train(atlas, atlas.GetTotalBatches());
+		error = cd.GetReconstructionError(minibatch);
+		printf("Epoch : %u, error : %f\n", e, error);
+	}
+
+	delete[] minibatch;
+
+	return error < initial_error;
+}
+
 // train an RBM, dump it to JSON, convert JSON back to RBM object,
 // create new CD with said RBM object, dump RBM to reserialized json
 bool SerializeRBM(int argc, char** argv)
@@ -207,7 +442,7 @@ bool SerializeRBM(int argc, char** argv)
 	}
 
 	printf("Initing SiCKL\n");
-	SiCKL::OpenGLRuntime::Initialize();
+	SiCKLRuntime::Initialize();
 
 	printf("Construction training params");
 
@@ -241,7 +476,7 @@ bool SerializeRBM(int argc, char** argv)
 	DataAtlas atlas(256);
 	atlas.Initialize(data, minibatch_size);
 
-	SiCKL::OpenGLBuffer2D training_example;
+	SiCKLBuffer2D training_example;
 
 	printf("Training...\n");
 
@@ -289,5 +524,5 @@ bool SerializeRBM(int argc, char** argv)
 	delete rbm;
 	delete rbm_reserial;
 
-	SiCKL::OpenGLRuntime::Finalize();
+	SiCKLRuntime::Finalize();
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+// std
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <random>
+
+// OMLT
+#include <IDX.hpp>
+#include <ParseFloat.h>
+
+using namespace OMLT;
+
+static uint32_t float_bits(float f)
+{
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+	return bits;
+}
+
+// parses all of in_text with ParseFloat and compares the bits of the result against in_expected_bits
+static bool check_parse(const char* in_name, const std::string& in_text, uint32_t in_expected_bits)
+{
+	const char* head = in_text.c_str();
+	const char* end = head + in_text.size();
+	float value;
+	if(!ParseFloat(head, end, value) || head != end)
+	{
+		printf("%s: could not parse \"%s\"\n", in_name, in_text.c_str());
+		return false;
+	}
+	if(float_bits(value) != in_expected_bits)
+	{
+		float expected;
+		memcpy(&expected, &in_expected_bits, sizeof(expected));
+		printf("%s: \"%s\" parsed as %.9g, expected %.9g\n", in_name, in_text.c_str(), value, expected);
+		return false;
+	}
+	return true;
+}
+
+// a random number in one of the forms found in CSVs, with up to in_max_digits significant digits
+static std::string random_number(std::mt19937_64& io_random, uint32_t in_max_digits, int32_t in_max_exponent)
+{
+	std::string digits;
+	const uint32_t digit_count = 1 + uint32_t(io_random() % in_max_digits);
+	for(uint32_t k = 0; k < digit_count; k++)
+	{
+		digits += char('0' + io_random() % 10);
+	}
+
+	std::string result = io_random() % 2 ? "-" : "";
+	switch(io_random() % 3)
+	{
+	case 0:
+		// integer
+		result += digits;
+		break;
+	case 1:
+		// decimal point somewhere in (or just before) the digits
+		{
+			const size_t point = size_t(io_random() % (digits.size() + 1));
+			result += (point == 0 ? "0" : digits.substr(0, point)) + "." + digits.substr(point);
+		}
+		break;
+	case 2:
+		// scientific
+		{
+			char exponent[16];
+			sprintf(exponent, "e%d", int32_t(io_random() % (2 * in_max_exponent + 1)) - in_max_exponent);
+			result += digits.substr(0, 1) + "." + digits.substr(1) + exponent;
+		}
+		break;
+	}
+	return result;
+}
+
+// ParseFloat has to be correctly rounded whichever way it gets there; strtof is correctly rounded
+bool VerifyParseFloat(int argc, char** argv)
+{
+	bool result = true;
+
+	std::mt19937_64 random;
+	random.seed(1);
+
+	printf("Verifying the exact double path\n");
+	{
+		// at most 15 digits and small exponents, so nearly every number takes the single multiply or divide
+		for(uint32_t k = 0; k < 1000000 && result; k++)
+		{
+			const std::string text = random_number(random, 15, 15);
+			result &= check_parse("Exact double", text, float_bits(strtof(text.c_str(), nullptr)));
+		}
+
+		result &= check_parse("Exact double", "0.1", 0x3DCCCCCD);
+		result &= check_parse("Exact double", "+5", 0x40A00000);
+		result &= check_parse("Exact double", ".5", 0x3F000000);
+		result &= check_parse("Exact double", "5.", 0x40A00000);
+		result &= check_parse("Exact double", "-0", 0x80000000);
+		result &= check_parse("Exact double", "1e22", float_bits(1e22f));
+	}
+
+	printf("Verifying ties\n");
+	{
+		// the first four are not halfway between two floats, but their nearest double is, so rounding that
+		// double to float again would go the wrong way; the rest are exactly halfway and round to even
+		const struct
+		{
+			const char* text;
+			uint32_t bits;
+		} ties[] =
+		{
+			{"7.984020948410034", 0x40FF7D19},
+			{"32.37893486022949", 0x42018407},
+			{"0.1637946441769600", 0x3E27B9C9},
+			{"-0.01492166193202138", 0xBC7479FD},
+			{"16777217", 0x4B800000},
+			{"8388608.5", 0x4B000000},
+			{"8388609.5", 0x4B000002},
+			{"-33554434", 0xCC000000},
+		};
+		for(auto& tie : ties)
+		{
+			result &= check_parse("Tie", tie.text, tie.bits);
+		}
+	}
+
+	printf("Verifying the strtof path\n");
+	{
+		// too many digits or too large an exponent for the exact path
+		for(uint32_t k = 0; k < 100000 && result; k++)
+		{
+			const std::string text = random_number(random, 25, 45);
+			result &= check_parse("strtof", text, float_bits(strtof(text.c_str(), nullptr)));
+		}
+
+		result &= check_parse("strtof", "1e-40", float_bits(strtof("1e-40", nullptr)));
+		result &= check_parse("strtof", "3.4028235e38", 0x7F7FFFFF);
+		result &= check_parse("strtof", "123456789012345678901234", float_bits(strtof("123456789012345678901234", nullptr)));
+	}
+
+	printf("Verifying parse failures and partial parses\n");
+	{
+		const char* invalid[] = {"", "-", "+", ".", "-.", "e5", "1e", "1e+", "x1"};
+		for(auto text : invalid)
+		{
+			const char* head = text;
+			float value;
+			if(ParseFloat(head, text + strlen(text), value) || head != text)
+			{
+				printf("Invalid: \"%s\" parsed\n", text);
+				result = false;
+			}
+		}
+
+		// parsing stops at the first character which can't be part of the number, and never reads past in_end
+		const char* text = "1.5,2.5";
+		const char* head = text;
+		float value;
+		if(!ParseFloat(head, text + 7, value) || head != text + 3 || value != 1.5f)
+		{
+			printf("Partial: \"%s\" did not stop at the comma\n", text);
+			result = false;
+		}
+		head = text;
+		if(!ParseFloat(head, text + 2, value) || head != text + 2 || value != 1.0f)
+		{
+			printf("Partial: \"%s\" read past its end\n", text);
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+// the size of the views csv2idx maps the CSV with
+static const uint64_t CSVViewSize = 64 * 1024 * 1024;
+
+// one CSV row: its index followed by random numbers, with the parsed values in out_row
+static std::string random_row(std::mt19937_64& io_random, uint32_t in_index, uint32_t in_columns, float* out_row)
+{
+	char index[16];
+	sprintf(index, "%u", in_index);
+	std::string result = index;
+	out_row[0] = float(in_index);
+	for(uint32_t k = 1; k < in_columns; k++)
+	{
+		const std::string number = random_number(io_random, 12, 12);
+		out_row[k] = strtof(number.c_str(), nullptr);
+		result += (io_random() % 4 == 0 ? ", " : ",") + number;
+	}
+	return result;
+}
+
+// writes a CSV a little over one csv2idx view long, with a row straddling the end of the first view,
+// converts it with the given csv2idx and checks every row came out, in order
+bool VerifyCSV2IDX(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		printf("Usage: VerifyCSV2IDX [csv2idx] [temp.csv] [temp.idx]\n");
+		return false;
+	}
+
+	const char* csv2idx = argv[0];
+	const char* csv_filename = argv[1];
+	const char* idx_filename = argv[2];
+	const uint32_t columns = 6;
+	const uint64_t seed = 1;
+
+	printf("Writing %s\n", csv_filename);
+	uint32_t row_count = 0;
+	{
+		FILE* csv = fopen(csv_filename, "wb");
+		if(csv == nullptr)
+		{
+			printf("Could not create %s\n", csv_filename);
+			return false;
+		}
+
+		std::mt19937_64 random;
+		random.seed(seed);
+		float row[columns];
+		uint64_t bytes = 0;
+		for(; bytes < CSVViewSize + 1024 * 1024; row_count++)
+		{
+			std::string line = random_row(random, row_count, columns, row);
+
+			// now and then a blank line or a Windows line ending
+			switch(random() % 1000)
+			{
+			case 0:
+				line = "\r\n" + line;
+				break;
+			case 1:
+				line += "\r";
+				break;
+			}
+			// no line break at the end of the first view, so that row has to be carried over to the next
+			if(bytes + line.size() == CSVViewSize - 1)
+			{
+				line = " " + line;
+			}
+
+			line += "\n";
+			fwrite(line.data(), 1, line.size(), csv);
+			bytes += line.size();
+		}
+		fclose(csv);
+	}
+
+	printf("Running %s\n", csv2idx);
+	const std::string command = std::string("\"") + csv2idx + "\" \"" + csv_filename + "\" \"" + idx_filename + "\"";
+	if(system(command.c_str()) != 0)
+	{
+		printf("%s failed\n", csv2idx);
+		remove(csv_filename);
+		return false;
+	}
+
+	printf("Verifying %s\n", idx_filename);
+	bool result = true;
+	IDX* idx = IDX::Load(idx_filename);
+	if(idx == nullptr || idx->GetRowLength() != columns || idx->GetRowCount() != row_count)
+	{
+		printf("%s does not have %u rows of %u values\n", idx_filename, row_count, columns);
+		result = false;
+	}
+	else
+	{
+		// the same rows again
+		std::mt19937_64 random;
+		random.seed(seed);
+		float expected[columns];
+		float row[columns];
+		for(uint32_t k = 0; k < row_count && result; k++)
+		{
+			random_row(random, k, columns, expected);
+			// the blank line and line ending draw
+			random();
+			idx->ReadRowsAsSingle(k, 1, row);
+			if(memcmp(row, expected, sizeof(row)) != 0)
+			{
+				printf("Row %u is %g, %g, ..., expected %g, %g, ...\n", k, row[0], row[1], expected[0], expected[1]);
+				result = false;
+			}
+		}
+	}
+
+	delete idx;
+	remove(csv_filename);
+	remove(idx_filename);
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,304 @@
+// std
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <random>
+#include <algorithm>
+
+// OMLT
+#include <Common.h>
+#include <Model.h>
+#include <BinaryModel.h>
+#include <RestrictedBoltzmannMachine.h>
+#include <AutoEncoder.h>
+#include <MultilayerPerceptron.h>
+#include <ContrastiveDivergence.h>
+#include <ContrastiveDivergenceCPU.h>
+#include <AutoEncoderBackPropagation.h>
+#include <AutoEncoderBackPropagationCPU.h>
+#include <BackPropagation.h>
+#include <BackPropagationCPU.h>
+
+using namespace OMLT;
+
+// fills the biases and weights with random values, so that a map which loses or reorders
+// any of them doesn't compare equal
+static void randomize(FeatureMap& io_map, std::mt19937_64& io_random)
+{
+	std::uniform_real<float> uniform(-1.0f, 1.0f);
+	for(uint32_t k = 0; k < io_map.feature_count; k++)
+	{
+		io_map.biases()[k] = uniform(io_random);
+		float* feature = io_map.feature(k);
+		for(uint32_t i = 0; i < io_map.input_length; i++)
+		{
+			feature[i] = uniform(io_random);
+		}
+	}
+}
+
+// RBMs and AutoEncoders save a single weight matrix, so the map going back to the visible units
+// has to hold the transpose of the one going forward
+static void tie_weights(const FeatureMap& in_forward, FeatureMap& io_backward)
+{
+	for(uint32_t i = 0; i < io_backward.feature_count; i++)
+	{
+		float* feature = io_backward.feature(i);
+		for(uint32_t j = 0; j < io_backward.input_length; j++)
+		{
+			feature[j] = in_forward.feature(j)[i];
+		}
+	}
+}
+
+// floats are written to JSON with enough digits to read back exactly, so both formats have
+// to give back the same bits
+static bool same_feature_map(const char* in_name, const FeatureMap& in_expected, const FeatureMap& in_loaded)
+{
+	if(in_expected.input_length != in_loaded.input_length || in_expected.feature_count != in_loaded.feature_count)
+	{
+		printf("%s: loaded %u x %u, expected %u x %u\n", in_name, in_loaded.input_length, in_loaded.feature_count, in_expected.input_length, in_expected.feature_count);
+		return false;
+	}
+	if(memcmp(in_expected.biases(), in_loaded.biases(), sizeof(float) * in_expected.feature_count) != 0)
+	{
+		printf("%s: biases differ\n", in_name);
+		return false;
+	}
+	for(uint32_t k = 0; k < in_expected.feature_count; k++)
+	{
+		if(memcmp(in_expected.feature(k), in_loaded.feature(k), sizeof(float) * in_expected.input_length) != 0)
+		{
+			printf("%s: feature %u differs\n", in_name, k);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool same_model(const RBM& in_expected, const RBM& in_loaded)
+{
+	if(in_expected.visible_type != in_loaded.visible_type || in_expected.hidden_type != in_loaded.hidden_type)
+	{
+		printf("RestrictedBoltzmannMachine: activation functions differ\n");
+		return false;
+	}
+	return same_feature_map("RestrictedBoltzmannMachine hidden", in_expected.hidden, in_loaded.hidden) &&
+		same_feature_map("RestrictedBoltzmannMachine visible", in_expected.visible, in_loaded.visible);
+}
+
+static bool same_model(const AE& in_expected, const AE& in_loaded)
+{
+	if(in_expected.hidden_type != in_loaded.hidden_type || in_expected.output_type != in_loaded.output_type)
+	{
+		printf("AutoEncoder: activation functions differ\n");
+		return false;
+	}
+	return same_feature_map("AutoEncoder encoder", in_expected.encoder, in_loaded.encoder) &&
+		same_feature_map("AutoEncoder decoder", in_expected.decoder, in_loaded.decoder);
+}
+
+static bool same_model(const MLP& in_expected, const MLP& in_loaded)
+{
+	if(in_expected.LayerCount() != in_loaded.LayerCount())
+	{
+		printf("MultilayerPerceptron: loaded %u layers, expected %u\n", in_loaded.LayerCount(), in_expected.LayerCount());
+		return false;
+	}
+	for(uint32_t k = 0; k < in_expected.LayerCount(); k++)
+	{
+		const MLP::Layer* expected = const_cast<MLP&>(in_expected).GetLayer(k);
+		const MLP::Layer* loaded = const_cast<MLP&>(in_loaded).GetLayer(k);
+		if(expected->function != loaded->function)
+		{
+			printf("MultilayerPerceptron: layer %u activation function differs\n", k);
+			return false;
+		}
+		if(!same_feature_map("MultilayerPerceptron layer", expected->weights, loaded->weights))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static std::vector<char> read_file(const char* in_filename)
+{
+	std::vector<char> result;
+	std::ifstream fs(in_filename, std::ios_base::in | std::ios_base::binary);
+	result.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+	return result;
+}
+
+static bool write_file(const char* in_filename, const char* in_data, size_t in_length)
+{
+	std::ofstream fs(in_filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	fs.write(in_data, std::streamsize(in_length));
+	return fs.good();
+}
+
+// saves in_model in both formats and checks that Model::FromFile gives back the same model (JSON
+// files are only read after failing to open as binary), that Model::FromJSON reads it from a
+// stream, and that truncated copies of either file fail to load
+template<typename T>
+static bool verify_round_trips(const char* in_name, const T& in_model, ModelType_t in_type)
+{
+	bool result = true;
+
+	for(int binary = 0; binary < 2; binary++)
+	{
+		const std::string filename = std::string(in_name) + (binary ? ".bin" : ".json");
+		const char* format = binary ? "binary" : "JSON";
+		{
+			std::ofstream fs(filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+			if(binary)
+			{
+				in_model.ToBinary(fs);
+			}
+			else
+			{
+				in_model.ToJSON(fs);
+			}
+			if(!fs.good())
+			{
+				printf("Could not write %s\n", filename.c_str());
+				return false;
+			}
+		}
+
+		Model loaded;
+		if(!Model::FromFile(filename.c_str(), loaded) || loaded.type != in_type)
+		{
+			printf("%s: could not load %s model\n", in_name, format);
+			result = false;
+		}
+		else
+		{
+			result &= same_model(in_model, *(T*)loaded.ptr);
+			// binary models keep their file mapped until they are deleted
+			delete (T*)loaded.ptr;
+		}
+
+		// cut off in the middle of the weights, and in the middle of the binary preamble and header
+		const std::vector<char> contents = read_file(filename.c_str());
+		const size_t lengths[] = {contents.size() / 2, std::min<size_t>(contents.size() - 1, BinaryModel::PreambleSize + 8)};
+		for(auto length : lengths)
+		{
+			if(!write_file(filename.c_str(), contents.data(), length))
+			{
+				printf("Could not write %s\n", filename.c_str());
+				return false;
+			}
+
+			Model truncated;
+			if(Model::FromFile(filename.c_str(), truncated))
+			{
+				printf("%s: %s model truncated to %u of %u bytes loaded\n", in_name, format, uint32_t(length), uint32_t(contents.size()));
+				delete (T*)truncated.ptr;
+				result = false;
+			}
+		}
+
+		remove(filename.c_str());
+	}
+
+	std::stringstream stream;
+	in_model.ToJSON(stream);
+	Model loaded;
+	if(!Model::FromJSON(stream, loaded) || loaded.type != in_type)
+	{
+		printf("%s: could not read JSON model from a stream\n", in_name);
+		result = false;
+	}
+	else
+	{
+		result &= same_model(in_model, *(T*)loaded.ptr);
+		delete (T*)loaded.ptr;
+	}
+
+	return result;
+}
+
+// saves and reloads each model type in both the JSON and binary formats; the dimensions are not
+// multiples of 4 so the padding between features gets skipped over
+bool VerifyModelSerialization(int argc, char** argv)
+{
+	std::mt19937_64 random;
+	random.seed(1);
+
+	const uint32_t visible_units = 29;
+	const uint32_t hidden_units = 13;
+	const uint32_t minibatch_size = 10;
+
+	bool result = true;
+
+	printf("Verifying RestrictedBoltzmannMachine\n");
+	{
+		CD::ModelConfig model_config;
+		{
+			model_config.VisibleUnits = visible_units;
+			model_config.VisibleType = ActivationFunction::Sigmoid;
+			model_config.HiddenUnits = hidden_units;
+			model_config.HiddenType = ActivationFunction::RectifiedLinear;
+		}
+
+		ContrastiveDivergenceCPU cd(model_config, minibatch_size, 1);
+		RBM* rbm = cd.GetRestrictedBoltzmannMachine();
+		randomize(rbm->hidden, random);
+		randomize(rbm->visible, random);
+		tie_weights(rbm->hidden, rbm->visible);
+
+		result &= verify_round_trips("RestrictedBoltzmannMachine", *rbm, ModelType::RBM);
+		delete rbm;
+	}
+
+	printf("Verifying AutoEncoder\n");
+	{
+		AutoEncoderBackPropagation::ModelConfig model_config;
+		{
+			model_config.VisibleCount = visible_units;
+			model_config.HiddenCount = hidden_units;
+			model_config.HiddenType = ActivationFunction::Sigmoid;
+			model_config.OutputType = ActivationFunction::Linear;
+		}
+
+		AutoEncoderBackPropagationCPU aebp(model_config, minibatch_size, 1);
+		AE* ae = aebp.GetAutoEncoder();
+		randomize(ae->encoder, random);
+		randomize(ae->decoder, random);
+		tie_weights(ae->encoder, ae->decoder);
+
+		result &= verify_round_trips("AutoEncoder", *ae, ModelType::AE);
+		delete ae;
+	}
+
+	printf("Verifying MultilayerPerceptron\n");
+	{
+		BackPropagation::ModelConfig model_config;
+		model_config.InputCount = visible_units;
+		const uint32_t layer_units[] = {hidden_units, 17, 3};
+		const ActivationFunction_t layer_functions[] = {ActivationFunction::RectifiedLinear, ActivationFunction::Sigmoid, ActivationFunction::Softmax};
+		for(uint32_t k = 0; k < 3; k++)
+		{
+			BackPropagation::LayerConfig layer;
+			layer.OutputUnits = layer_units[k];
+			layer.Function = layer_functions[k];
+			model_config.LayerConfigs.push_back(layer);
+		}
+
+		BackPropagationCPU bp(model_config, minibatch_size, 1);
+		MLP* mlp = bp.GetMultilayerPerceptron();
+		for(uint32_t k = 0; k < mlp->LayerCount(); k++)
+		{
+			randomize(mlp->GetLayer(k)->weights, random);
+		}
+
+		result &= verify_round_trips("MultilayerPerceptron", *mlp, ModelType::MLP);
+		delete mlp;
+	}
+
+	return result;
+}
\ No newline at end of file
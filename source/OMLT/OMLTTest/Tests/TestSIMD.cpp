@@ -3,12 +3,18 @@
 #include <random>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 // windows
 #include <malloc.h>
 #include <intrin.h>
 #include <windows.h>
 
+// OMLT
+#include <Common.h>
+#include <SIMD.h>
+#include <CPUShared.h>
+
 namespace OMLT
 {
 	extern __m128 _mm_sigmoid_ps(__m128 x0);
@@ -352,4 +358,254 @@ bool VerifyExp(int argc, char** argv)
 		return false;
 	}
 	return true;
+}
+
+bool VerifyFeatureMatrix(int argc, char** argv)
+{
+	std::mt19937_64 random;
+	random.seed(1);
+	std::uniform_real<float> uniform(-1.0f, 1.0f);
+
+	// odd sizes to exercise the padded features and the unpaired last row
+	const uint32_t input_length = 1037;
+	const uint32_t feature_count = 65;
+	const uint32_t rows = 131;
+
+	OMLT::FeatureMap map(input_length, feature_count);
+	for(uint32_t k = 0; k < feature_count; k++)
+	{
+		map.biases()[k] = uniform(random);
+		for(uint32_t j = 0; j < input_length; j++)
+		{
+			map.feature(k)[j] = uniform(random) * 0.1f;
+		}
+	}
+
+	const uint32_t input_stride = OMLT::BlockCount(input_length) * 4;
+	const uint32_t output_stride = OMLT::BlockCount(feature_count) * 4;
+	float* input_matrix = (float*)_aligned_malloc(sizeof(float) * input_stride * rows, 16);
+	float* output_matrix = (float*)_aligned_malloc(sizeof(float) * output_stride * rows, 16);
+	float* output_vector = (float*)_aligned_malloc(sizeof(float) * output_stride, 16);
+
+	memset(input_matrix, 0x00, sizeof(float) * input_stride * rows);
+	for(uint32_t i = 0; i < rows; i++)
+	{
+		for(uint32_t j = 0; j < input_length; j++)
+		{
+			input_matrix[i * input_stride + j] = uniform(random);
+		}
+	}
+
+	// reference results from the SSE kernels
+	float* sse_matrix = (float*)_aligned_malloc(sizeof(float) * output_stride * rows * OMLT::ActivationFunction::Count, 16);
+	const OMLT::SIMDLevel_t supported_level = OMLT::GetSupportedSIMDLevel();
+
+	bool result = true;
+	for(uint32_t level = OMLT::SIMDLevel::SSE; level <= supported_level && result; level++)
+	{
+		OMLT::SetSIMDLevel((OMLT::SIMDLevel_t)level);
+		printf("Verifying %s kernels\n", OMLT::SIMDLevelNames[level]);
+
+		for(uint32_t f = OMLT::ActivationFunction::Linear; f <= OMLT::ActivationFunction::Softmax && result; f++)
+		{
+			const OMLT::ActivationFunction_t function = (OMLT::ActivationFunction_t)f;
+			float* sse_output = sse_matrix + f * output_stride * rows;
+			map.CalcFeatureMatrix(input_matrix, rows, output_matrix, function);
+			if(level == OMLT::SIMDLevel::SSE)
+			{
+				memcpy(sse_output, output_matrix, sizeof(float) * output_stride * rows);
+			}
+
+			for(uint32_t i = 0; i < rows && result; i++)
+			{
+				map.CalcFeatureVector(input_matrix + i * input_stride, output_vector, function);
+				for(uint32_t k = 0; k < output_stride; k++)
+				{
+					const float expected = sse_output[i * output_stride + k];
+					const float vector = output_vector[k];
+					const float matrix = output_matrix[i * output_stride + k];
+					if(std::abs(expected - vector) > 1e-4f * (1.0f + std::abs(expected)) ||
+					   std::abs(expected - matrix) > 1e-4f * (1.0f + std::abs(expected)))
+					{
+						printf("%s row %u feature %u: SSE == %f, CalcFeatureVector == %f, CalcFeatureMatrix == %f\n", OMLT::ActivationFunctionNames[f], i, k, expected, vector, matrix);
+						result = false;
+						break;
+					}
+				}
+			}
+		}
+	}
+	OMLT::SetSIMDLevel(supported_level);
+	_aligned_free(sse_matrix);
+
+	_aligned_free(input_matrix);
+	_aligned_free(output_matrix);
+	_aligned_free(output_vector);
+
+	return result;
+}
+
+// checks the CPU trainers' matrix products at each supported instruction set against a double precision
+// product, over odd sizes and with the output split into uneven ranges the way the trainers' threads split it
+bool VerifyMatrixMultiply(int argc, char** argv)
+{
+	std::mt19937_64 random;
+	random.seed(1);
+	std::uniform_real<float> uniform(-1.0f, 1.0f);
+
+	const uint32_t M = 13;
+	const uint32_t N = 301;
+	const uint32_t K = 517;
+	const uint32_t stride_n = OMLT::BlockCount(N) * 4;
+	const uint32_t stride_k = OMLT::BlockCount(K) * 4;
+	// a multiple of 4 for MatrixMultiplyNN
+	const uint32_t range = 36;
+
+	// A is M x K, B_nt is N x K, B_nn is K x N and A_tn is M x N
+	float* A = OMLT::AllocateMatrix(M, K);
+	float* B_nt = OMLT::AllocateMatrix(N, K);
+	float* B_nn = OMLT::AllocateMatrix(K, N);
+	float* A_tn = OMLT::AllocateMatrix(M, N);
+	auto fill = [&](float* matrix, uint32_t rows, uint32_t columns, uint32_t stride)
+	{
+		for(uint32_t i = 0; i < rows; i++)
+		{
+			for(uint32_t j = 0; j < columns; j++)
+			{
+				matrix[i * stride + j] = uniform(random);
+			}
+		}
+	};
+	fill(A, M, K, stride_k);
+	fill(B_nt, N, K, stride_k);
+	fill(B_nn, K, N, stride_n);
+	fill(A_tn, M, N, stride_n);
+
+	float* C = OMLT::AllocateMatrix(N, K);
+	float* initial = OMLT::AllocateMatrix(N, K);
+	fill(initial, N, K, stride_k);
+
+	// checks rows x columns of C (which has the given stride) against the product plus the initial value
+	bool result = true;
+	auto verify = [&](const char* name, uint32_t rows, uint32_t columns, uint32_t stride, float alpha, bool accumulate, std::function<double(uint32_t, uint32_t)> dot)
+	{
+		for(uint32_t i = 0; i < rows && result; i++)
+		{
+			for(uint32_t j = 0; j < columns; j++)
+			{
+				const double expected = alpha * dot(i, j) + (accumulate ? initial[i * stride + j] : 0.0f);
+				const float calculated = C[i * stride + j];
+				if(std::abs(expected - calculated) > 1e-4 * (1.0 + std::abs(expected)))
+				{
+					printf("%s (%s) C[%u][%u] == %f, expected %f\n", name, accumulate ? "accumulate" : "overwrite", i, j, calculated, expected);
+					result = false;
+					break;
+				}
+			}
+		}
+	};
+
+	const OMLT::SIMDLevel_t supported_level = OMLT::GetSupportedSIMDLevel();
+	for(uint32_t level = OMLT::SIMDLevel::SSE; level <= supported_level && result; level++)
+	{
+		OMLT::SetSIMDLevel((OMLT::SIMDLevel_t)level);
+		printf("Verifying %s matrix multiplies\n", OMLT::SIMDLevelNames[level]);
+
+		for(uint32_t accumulate = 0; accumulate < 2 && result; accumulate++)
+		{
+			// C = A * B_nt^T, M x N
+			memcpy(C, initial, sizeof(float) * M * stride_n);
+			for(uint32_t n = 0; n < N; n += range)
+			{
+				OMLT::MatrixMultiplyNT(A, stride_k, B_nt, stride_k, C, stride_n, M, n, std::min(n + range, N), K, 0.5f, accumulate != 0);
+			}
+			verify("MatrixMultiplyNT", M, N, stride_n, 0.5f, accumulate != 0, [&](uint32_t m, uint32_t n)
+			{
+				double sum = 0.0;
+				for(uint32_t k = 0; k < K; k++)
+				{
+					sum += double(A[m * stride_k + k]) * B_nt[n * stride_k + k];
+				}
+				return sum;
+			});
+
+			// C = A * B_nn, M x N
+			memcpy(C, initial, sizeof(float) * M * stride_n);
+			for(uint32_t n = 0; n < stride_n; n += range)
+			{
+				OMLT::MatrixMultiplyNN(A, stride_k, B_nn, stride_n, C, stride_n, M, n, std::min(n + range, stride_n), K, -1.5f, accumulate != 0);
+			}
+			verify("MatrixMultiplyNN", M, N, stride_n, -1.5f, accumulate != 0, [&](uint32_t m, uint32_t n)
+			{
+				double sum = 0.0;
+				for(uint32_t k = 0; k < K; k++)
+				{
+					sum += double(A[m * stride_k + k]) * B_nn[k * stride_n + n];
+				}
+				return sum;
+			});
+
+			// C = A_tn^T * A, N x K
+			memcpy(C, initial, sizeof(float) * N * stride_k);
+			for(uint32_t n = 0; n < N; n += range - 1)
+			{
+				OMLT::MatrixMultiplyTN(A_tn, stride_n, A, stride_k, C, stride_k, M, n, std::min(n + range - 1, N), stride_k, 2.0f, accumulate != 0);
+			}
+			verify("MatrixMultiplyTN", N, K, stride_k, 2.0f, accumulate != 0, [&](uint32_t n, uint32_t k)
+			{
+				double sum = 0.0;
+				for(uint32_t m = 0; m < M; m++)
+				{
+					sum += double(A_tn[m * stride_n + n]) * A[m * stride_k + k];
+				}
+				return sum;
+			});
+		}
+
+		// the epilogue should see every entry of C exactly once, after its whole sum has been stored
+		if(result)
+		{
+			std::vector<uint32_t> visits(M * N, 0);
+			const OMLT::MatrixEpilogue epilogue = [&](float* io_c, uint32_t m, uint32_t n, uint32_t count)
+			{
+				for(uint32_t j = 0; j < count; j++)
+				{
+					io_c[j] *= 2.0f;
+					visits[m * N + n + j]++;
+				}
+			};
+			memcpy(C, initial, sizeof(float) * M * stride_n);
+			for(uint32_t n = 0; n < N; n += range)
+			{
+				OMLT::MatrixMultiplyNT(A, stride_k, B_nt, stride_k, C, stride_n, M, n, std::min(n + range, N), K, 0.5f, epilogue);
+			}
+			verify("MatrixMultiplyNT epilogue", M, N, stride_n, 1.0f, false, [&](uint32_t m, uint32_t n)
+			{
+				double sum = 0.0;
+				for(uint32_t k = 0; k < K; k++)
+				{
+					sum += double(A[m * stride_k + k]) * B_nt[n * stride_k + k];
+				}
+				return sum;
+			});
+			for(uint32_t k = 0; k < M * N && result; k++)
+			{
+				if(visits[k] != 1)
+				{
+					printf("MatrixMultiplyNT epilogue visited C[%u][%u] %u times\n", k / N, k % N, visits[k]);
+					result = false;
+				}
+			}
+		}
+	}
+	OMLT::SetSIMDLevel(supported_level);
+
+	OMLT::FreeMatrix(A);
+	OMLT::FreeMatrix(B_nt);
+	OMLT::FreeMatrix(B_nn);
+	OMLT::FreeMatrix(A_tn);
+	OMLT::FreeMatrix(C);
+	OMLT::FreeMatrix(initial);
+
+	return result;
 }
\ No newline at end of file
@@ -0,0 +1,826 @@
+// std
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <random>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// SiCKL
+#include <SiCKL.h>
+
+// OMLT
+#include <Enums.h>
+#include <SiCKLShared.h>
+
+namespace OMLT
+{
+	// the ContrastiveDivergence kernel sources, outside of the trainer so they can be run on their own
+	struct CDKernels
+	{
+#		include <ContrastiveDivergenceKernels.h>
+	};
+}
+
+using namespace OMLT;
+
+// compares in_count values of a kernel output against the expected ones, printing the first mismatch
+static bool check_output(const char* in_name, const float* in_result, const float* in_expected, uint32_t in_count, float in_tolerance)
+{
+	for(uint32_t k = 0; k < in_count; k++)
+	{
+		const float error = std::fabs(in_result[k] - in_expected[k]);
+		const bool same_special = (std::isnan(in_result[k]) && std::isnan(in_expected[k])) || (std::isinf(in_expected[k]) && in_result[k] == in_expected[k]);
+		if(!same_special && !(error <= in_tolerance * std::max(1.0f, std::fabs(in_expected[k]))))
+		{
+			printf("%s: value %u is %f, expected %f\n", in_name, k, in_result[k], in_expected[k]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool check_output(const char* in_name, const int32_t* in_result, const int32_t* in_expected, uint32_t in_count)
+{
+	for(uint32_t k = 0; k < in_count; k++)
+	{
+		if(in_result[k] != in_expected[k])
+		{
+			printf("%s: value %u is %i, expected %i\n", in_name, k, in_result[k], in_expected[k]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool check_output(const char* in_name, const uint32_t* in_result, const uint32_t* in_expected, uint32_t in_count)
+{
+	return check_output(in_name, (const int32_t*)in_result, (const int32_t*)in_expected, in_count);
+}
+
+// host version of OMLT::NextSeed
+static void next_seed(const uint32_t* in_seed, uint32_t* out_seed)
+{
+	const uint32_t t = in_seed[0] ^ (in_seed[0] << 11);
+	out_seed[0] = in_seed[1];
+	out_seed[1] = in_seed[2];
+	out_seed[2] = in_seed[3];
+	out_seed[3] = in_seed[3] ^ (in_seed[3] >> 19) ^ t ^ (t >> 8);
+}
+
+static float sigmoid(float x)
+{
+	return 1.0f / (1.0f + std::exp(-x));
+}
+
+/// OMLT kernels
+
+// runs the ContrastiveDivergence kernels on the CPU backend and compares them against host calculations;
+// the grid widths are not multiples of the lane count so the partially filled lane groups get used
+bool VerifySiCKLKernels(int argc, char** argv)
+{
+	CPURuntime::Initialize();
+
+	std::mt19937_64 random;
+	random.seed(1);
+	std::uniform_real<float> uniform(-1.0f, 1.0f);
+
+	const int32_t visible_units = 29;
+	const int32_t hidden_units = 19;
+	const int32_t minibatch_size = 5;
+
+	std::vector<float> visible(visible_units * minibatch_size);
+	std::vector<float> weights((visible_units + 1) * (hidden_units + 1));
+	std::vector<uint32_t> enabled_visible(visible_units);
+	std::vector<uint32_t> seeds(4 * visible_units);
+	for(auto& v : visible)
+	{
+		v = uniform(random);
+	}
+	for(auto& w : weights)
+	{
+		w = uniform(random);
+	}
+	for(auto& e : enabled_visible)
+	{
+		e = random() % 4 != 0;
+	}
+	for(auto& s : seeds)
+	{
+		s = uint32_t(random());
+	}
+
+	CPUBuffer2D visible_buffer(visible_units, minibatch_size, ReturnType::Float, visible.data());
+	CPUBuffer2D weights_buffer(visible_units + 1, hidden_units + 1, ReturnType::Float, weights.data());
+	CPUBuffer2D enabled_buffer(visible_units, 1, ReturnType::UInt, enabled_visible.data());
+	CPUBuffer2D seeds_buffer(visible_units, 1, ReturnType::UInt4, seeds.data());
+
+	bool result = true;
+	CPUCompiler compiler;
+
+	printf("Verifying SourceCalcEnabled\n");
+	{
+		CDKernels::SourceCalcEnabled source;
+		source.DROPOUT_PROB = 0.5f;
+		source.Parse();
+
+		CPUProgram* program = compiler.Build(source);
+		CPUBuffer2D states(visible_units, 1, ReturnType::UInt, nullptr);
+		CPUBuffer2D next_seeds(visible_units, 1, ReturnType::UInt4, nullptr);
+		program->Initialize(visible_units, 1);
+		program->SetInput(0, seeds_buffer);
+		program->BindOutput(0, states);
+		program->BindOutput(1, next_seeds);
+		program->Run();
+
+		std::vector<uint32_t> expected_states(visible_units);
+		std::vector<uint32_t> expected_seeds(4 * visible_units);
+		for(int32_t i = 0; i < visible_units; i++)
+		{
+			next_seed(&seeds[4 * i], &expected_seeds[4 * i]);
+			const float p = float(expected_seeds[4 * i] >> 8) / float(1 << 24);
+			expected_states[i] = p > source.DROPOUT_PROB ? 1u : 0u;
+		}
+
+		uint32_t* calculated = nullptr;
+		states.GetData(calculated);
+		result &= check_output("SourceCalcEnabled out_state", calculated, expected_states.data(), visible_units);
+		free(calculated);
+		calculated = nullptr;
+		next_seeds.GetData(calculated);
+		result &= check_output("SourceCalcEnabled out_seed", calculated, expected_seeds.data(), 4 * visible_units);
+		free(calculated);
+
+		delete program;
+	}
+
+	const ActivationFunction_t functions[] = {ActivationFunction::Linear, ActivationFunction::RectifiedLinear, ActivationFunction::Sigmoid};
+	for(auto function : functions)
+	{
+		printf("Verifying SourceCalcHidden with %s activation\n", ActivationFunctionNames[function]);
+
+		CDKernels::SourceCalcHidden source;
+		source.FUNCTION = function;
+		source.VISIBLE_UNITS = visible_units;
+		source.VISIBLE_DROPOUT_PROB = 0.25f;
+		source.Parse();
+
+		CPUProgram* program = compiler.Build(source);
+		CPUBuffer2D hidden(hidden_units, minibatch_size, ReturnType::Float, nullptr);
+		program->Initialize(hidden_units, minibatch_size);
+		program->SetInput(0, visible_buffer);
+		program->SetInput(1, weights_buffer);
+		program->SetInput(2, enabled_buffer);
+		program->BindOutput(0, hidden);
+		program->Run();
+
+		std::vector<float> expected(hidden_units * minibatch_size);
+		for(int32_t m = 0; m < minibatch_size; m++)
+		{
+			for(int32_t j = 0; j < hidden_units; j++)
+			{
+				float accumulation = 0.0f;
+				for(int32_t i = 0; i < visible_units; i++)
+				{
+					accumulation += visible[m * visible_units + i] * weights[(j + 1) * (visible_units + 1) + i + 1] * float(enabled_visible[i]);
+				}
+				accumulation = accumulation * (1.0f / (1.0f - source.VISIBLE_DROPOUT_PROB)) + weights[(j + 1) * (visible_units + 1)];
+
+				float& h = expected[m * hidden_units + j];
+				switch(function)
+				{
+				case ActivationFunction::Linear:
+					h = accumulation;
+					break;
+				case ActivationFunction::RectifiedLinear:
+					h = std::max(accumulation, 0.0f);
+					break;
+				case ActivationFunction::Sigmoid:
+					h = sigmoid(accumulation);
+					break;
+				}
+			}
+		}
+
+		float* calculated = nullptr;
+		hidden.GetData(calculated);
+		result &= check_output("SourceCalcHidden", calculated, expected.data(), hidden_units * minibatch_size, 1e-5f);
+		free(calculated);
+
+		delete program;
+	}
+
+	printf("Verifying SourceCalcSoftmax\n");
+	{
+		CDKernels::SourceCalcSoftmax source;
+		source.ROW_LENGTH = visible_units;
+		source.Parse();
+
+		CPUProgram* program = compiler.Build(source);
+		CPUBuffer2D softmax(visible_units, minibatch_size, ReturnType::Float, nullptr);
+		program->Initialize(visible_units, minibatch_size);
+		program->SetInput(0, visible_buffer);
+		program->BindOutput(0, softmax);
+		program->Run();
+
+		std::vector<float> expected(visible_units * minibatch_size);
+		for(int32_t m = 0; m < minibatch_size; m++)
+		{
+			const float* row = &visible[m * visible_units];
+			const float max = *std::max_element(row, row + visible_units);
+			float denominator = 0.0f;
+			for(int32_t i = 0; i < visible_units; i++)
+			{
+				denominator += std::exp(row[i] - max);
+			}
+			for(int32_t i = 0; i < visible_units; i++)
+			{
+				expected[m * visible_units + i] = std::exp(row[i] - max) / denominator;
+			}
+		}
+
+		float* calculated = nullptr;
+		softmax.GetData(calculated);
+		result &= check_output("SourceCalcSoftmax", calculated, expected.data(), visible_units * minibatch_size, 1e-5f);
+		free(calculated);
+
+		delete program;
+	}
+
+	CPURuntime::Finalize();
+
+	return result;
+}
+
+/// Control Flow
+
+// nested If chains, fixed and per grid point loops
+struct SourceNestedControlFlow : public SiCKL::Source
+{
+	BEGIN_SOURCE
+		BEGIN_CONST_DATA
+		END_CONST_DATA
+
+		BEGIN_OUT_DATA
+			OUT_DATA(Int, out_branch)
+			OUT_DATA(Int, out_loop)
+		END_OUT_DATA
+
+		BEGIN_MAIN
+			const Int x = Index().X;
+			const Int y = Index().Y;
+
+			Int branch = 0;
+			If(x % 2 == 0)
+				If(x % 3 == 0)
+					branch = 1;
+				Else
+					branch = 2;
+				EndIf
+			ElseIf(x % 3 == 0)
+				branch = 3;
+				If(y == 1)
+					branch = 4;
+				EndIf
+			Else
+				Int k = 0;
+				While(k < x % 5)
+					If(k == 2)
+						branch = branch + 100;
+					Else
+						branch = branch + 1;
+					EndIf
+					k = k + 1;
+				EndWhile
+			EndIf
+			out_branch = branch;
+
+			Int loop = 0;
+			ForInRange(i, 0, 6)
+				If(i < y)
+					loop = loop + i;
+				ElseIf(i == 5)
+					loop = loop * 10;
+				EndIf
+			EndFor
+			out_loop = loop;
+		END_MAIN
+	END_SOURCE
+};
+
+// If chains and loops driven by per grid point data, so lanes in the same group diverge
+// irregularly; lanes a branch or loop skips have to keep the values they had before it
+struct SourceDivergentLanes : public SiCKL::Source
+{
+	BEGIN_SOURCE
+		BEGIN_CONST_DATA
+			CONST_DATA(Buffer2D<Int>, in_data)
+		END_CONST_DATA
+
+		BEGIN_OUT_DATA
+			OUT_DATA(Int, out_branch)
+			OUT_DATA(Int, out_trips)
+			OUT_DATA(Float, out_sum)
+		END_OUT_DATA
+
+		BEGIN_MAIN
+			const Int value = in_data(Index().X, Index().Y);
+
+			Int branch = value;
+			If(value < 10)
+				branch = branch * 2;
+			ElseIf(value < 20)
+				If(value % 2 == 0)
+					branch = -1;
+				EndIf
+			Else
+				branch = branch - 20;
+			EndIf
+			out_branch = branch + 1;
+
+			// per lane trip counts, a branch on every iteration, and an inner loop as long as
+			// the outer counter
+			Int trips = 0;
+			Float sum = 0.0f;
+			While(trips < value % 7)
+				If(trips % 2 == 1)
+					sum = sum + 0.5f;
+				Else
+					Int k = 0;
+					While(k < trips)
+						sum = sum + 1.0f;
+						k = k + 1;
+					EndWhile
+				EndIf
+				trips = trips + 1;
+			EndWhile
+			out_trips = trips;
+			out_sum = sum;
+		END_MAIN
+	END_SOURCE
+};
+
+// integer division and modulo by 0 give 0 (instead of faulting), floats follow IEEE
+struct SourceDivideByZero : public SiCKL::Source
+{
+	BEGIN_SOURCE
+		BEGIN_CONST_DATA
+			CONST_DATA(Buffer2D<Int>, in_int)
+			CONST_DATA(Buffer2D<UInt>, in_uint)
+			CONST_DATA(Buffer2D<Float>, in_float)
+		END_CONST_DATA
+
+		BEGIN_OUT_DATA
+			OUT_DATA(Int, out_int_quotient)
+			OUT_DATA(Int, out_int_remainder)
+			OUT_DATA(UInt, out_uint_quotient)
+			OUT_DATA(UInt, out_uint_remainder)
+			OUT_DATA(Float, out_float_quotient)
+		END_OUT_DATA
+
+		BEGIN_MAIN
+			const Int x = Index().X;
+
+			out_int_quotient = in_int(x, 0) / in_int(x, 1);
+			out_int_remainder = in_int(x, 0) % in_int(x, 1);
+			out_uint_quotient = in_uint(x, 0) / in_uint(x, 1);
+			out_uint_remainder = in_uint(x, 0) % in_uint(x, 1);
+			out_float_quotient = in_float(x, 0) / in_float(x, 1);
+		END_MAIN
+	END_SOURCE
+};
+
+// reads a buffer one up and to the left, so the first row and column sample outside it
+struct SourceOutOfRangeSample : public SiCKL::Source
+{
+	BEGIN_SOURCE
+		BEGIN_CONST_DATA
+			CONST_DATA(Buffer2D<Float>, in_data)
+		END_CONST_DATA
+
+		BEGIN_OUT_DATA
+			OUT_DATA(Float, out_data)
+		END_OUT_DATA
+
+		BEGIN_MAIN
+			out_data = in_data(Index().X - 1, Index().Y - 1);
+		END_MAIN
+	END_SOURCE
+};
+
+bool VerifySiCKLControlFlow(int argc, char** argv)
+{
+	CPURuntime::Initialize();
+
+	bool result = true;
+	CPUCompiler compiler;
+
+	printf("Verifying nested control flow\n");
+	{
+		const int32_t width = 35;
+		const int32_t height = 3;
+
+		SourceNestedControlFlow source;
+		source.Parse();
+		CPUProgram* program = compiler.Build(source);
+
+		CPUBuffer2D branch(width, height, ReturnType::Int, nullptr);
+		CPUBuffer2D loop(width, height, ReturnType::Int, nullptr);
+		program->Initialize(width, height);
+		program->BindOutput(0, branch);
+		program->BindOutput(1, loop);
+		program->Run();
+
+		std::vector<int32_t> expected_branch(width * height);
+		std::vector<int32_t> expected_loop(width * height);
+		for(int32_t y = 0; y < height; y++)
+		{
+			for(int32_t x = 0; x < width; x++)
+			{
+				int32_t b = 0;
+				if(x % 2 == 0)
+				{
+					b = x % 3 == 0 ? 1 : 2;
+				}
+				else if(x % 3 == 0)
+				{
+					b = y == 1 ? 4 : 3;
+				}
+				else
+				{
+					for(int32_t k = 0; k < x % 5; k++)
+					{
+						b += k == 2 ? 100 : 1;
+					}
+				}
+				expected_branch[y * width + x] = b;
+
+				int32_t l = 0;
+				for(int32_t i = 0; i < 6; i++)
+				{
+					if(i < y)
+					{
+						l += i;
+					}
+					else if(i == 5)
+					{
+						l *= 10;
+					}
+				}
+				expected_loop[y * width + x] = l;
+			}
+		}
+
+		int32_t* calculated = nullptr;
+		branch.GetData(calculated);
+		result &= check_output("If chains", calculated, expected_branch.data(), width * height);
+		free(calculated);
+		calculated = nullptr;
+		loop.GetData(calculated);
+		result &= check_output("ForInRange", calculated, expected_loop.data(), width * height);
+		free(calculated);
+
+		delete program;
+	}
+
+	// the interpreter is built for every SIMD level, each running a different number of lanes
+	const SIMDLevel_t supported_level = GetSupportedSIMDLevel();
+	for(uint32_t level = SIMDLevel::SSE; level <= supported_level; level++)
+	{
+		SetSIMDLevel((SIMDLevel_t)level);
+		printf("Verifying divergent lanes (%s, %u lanes)\n", SIMDLevelNames[level], CPURuntime::GetLaneCount());
+
+		// wide enough for several lane groups and a partial last one
+		const int32_t lanes = int32_t(CPURuntime::GetLaneCount());
+		const int32_t width = 4 * lanes + 5;
+		const int32_t height = 4;
+
+		// row 0 diverges everywhere; row 1 takes the first branch and never loops; row 2
+		// only takes the Else; row 3 alternates between whole lane groups and single lanes
+		std::mt19937_64 random;
+		random.seed(1);
+		std::vector<int32_t> data(width * height);
+		for(int32_t x = 0; x < width; x++)
+		{
+			data[0 * width + x] = int32_t(random() % 30);
+			data[1 * width + x] = int32_t(random() % 2) * 7;
+			data[2 * width + x] = 20 + int32_t(random() % 10);
+			data[3 * width + x] = (x / lanes) % 2 == 0 ? 13 : (x % 3 == 0 ? 6 : 0);
+		}
+
+		SourceDivergentLanes source;
+		source.Parse();
+		CPUProgram* program = compiler.Build(source);
+
+		CPUBuffer2D data_buffer(width, height, ReturnType::Int, data.data());
+		CPUBuffer2D branch(width, height, ReturnType::Int, nullptr);
+		CPUBuffer2D trips(width, height, ReturnType::Int, nullptr);
+		CPUBuffer2D sum(width, height, ReturnType::Float, nullptr);
+		program->Initialize(width, height);
+		program->SetInput(0, data_buffer);
+		program->BindOutput(0, branch);
+		program->BindOutput(1, trips);
+		program->BindOutput(2, sum);
+		program->Run();
+
+		std::vector<int32_t> expected_branch(width * height);
+		std::vector<int32_t> expected_trips(width * height);
+		std::vector<float> expected_sum(width * height);
+		for(int32_t k = 0; k < width * height; k++)
+		{
+			const int32_t value = data[k];
+
+			int32_t b = value;
+			if(value < 10)
+			{
+				b = b * 2;
+			}
+			else if(value < 20)
+			{
+				if(value % 2 == 0)
+				{
+					b = -1;
+				}
+			}
+			else
+			{
+				b = b - 20;
+			}
+			expected_branch[k] = b + 1;
+
+			int32_t t = 0;
+			float s = 0.0f;
+			for(; t < value % 7; t++)
+			{
+				s += t % 2 == 1 ? 0.5f : float(t);
+			}
+			expected_trips[k] = t;
+			expected_sum[k] = s;
+		}
+
+		int32_t* calculated = nullptr;
+		branch.GetData(calculated);
+		result &= check_output("Divergent If chains", calculated, expected_branch.data(), width * height);
+		free(calculated);
+		calculated = nullptr;
+		trips.GetData(calculated);
+		result &= check_output("Divergent While trip counts", calculated, expected_trips.data(), width * height);
+		free(calculated);
+		float* calculated_sum = nullptr;
+		sum.GetData(calculated_sum);
+		result &= check_output("Divergent While sums", calculated_sum, expected_sum.data(), width * height, 0.0f);
+		free(calculated_sum);
+
+		delete program;
+	}
+	SetSIMDLevel(supported_level);
+
+	printf("Verifying division by zero\n");
+	{
+		// numerators on the first row, denominators on the second
+		const int32_t ints[2][6] = {{7, -7, 0, INT32_MIN, INT32_MIN, 9}, {0, 0, 0, -1, 0, 2}};
+		const uint32_t uints[2][6] = {{7, 0, 0xFFFFFFFFu, 1, 0, 9}, {0, 0, 0, 0, 3, 2}};
+		const float floats[2][6] = {{1.0f, -1.0f, 0.0f, 3.0f, -0.0f, 9.0f}, {0.0f, 0.0f, 0.0f, -0.0f, 2.0f, 2.0f}};
+
+		SourceDivideByZero source;
+		source.Parse();
+		CPUProgram* program = compiler.Build(source);
+
+		CPUBuffer2D int_buffer(6, 2, ReturnType::Int, ints);
+		CPUBuffer2D uint_buffer(6, 2, ReturnType::UInt, uints);
+		CPUBuffer2D float_buffer(6, 2, ReturnType::Float, floats);
+		CPUBuffer2D outputs[5] =
+		{
+			CPUBuffer2D(6, 1, ReturnType::Int, nullptr),
+			CPUBuffer2D(6, 1, ReturnType::Int, nullptr),
+			CPUBuffer2D(6, 1, ReturnType::UInt, nullptr),
+			CPUBuffer2D(6, 1, ReturnType::UInt, nullptr),
+			CPUBuffer2D(6, 1, ReturnType::Float, nullptr),
+		};
+		program->Initialize(6, 1);
+		program->SetInput(0, int_buffer);
+		program->SetInput(1, uint_buffer);
+		program->SetInput(2, float_buffer);
+		for(int32_t k = 0; k < 5; k++)
+		{
+			program->BindOutput(k, outputs[k]);
+		}
+		program->Run();
+
+		const int32_t int_quotients[6] = {0, 0, 0, 0, 0, 4};
+		const int32_t int_remainders[6] = {0, 0, 0, 0, 0, 1};
+		const uint32_t uint_quotients[6] = {0, 0, 0, 0, 0, 4};
+		const uint32_t uint_remainders[6] = {0, 0, 0, 0, 0, 1};
+		const float float_quotients[6] = {INFINITY, -INFINITY, NAN, -INFINITY, -0.0f, 4.5f};
+
+		int32_t* int_result = nullptr;
+		outputs[0].GetData(int_result);
+		result &= check_output("Int division", int_result, int_quotients, 6);
+		free(int_result);
+		int_result = nullptr;
+		outputs[1].GetData(int_result);
+		result &= check_output("Int modulo", int_result, int_remainders, 6);
+		free(int_result);
+
+		uint32_t* uint_result = nullptr;
+		outputs[2].GetData(uint_result);
+		result &= check_output("UInt division", uint_result, uint_quotients, 6);
+		free(uint_result);
+		uint_result = nullptr;
+		outputs[3].GetData(uint_result);
+		result &= check_output("UInt modulo", uint_result, uint_remainders, 6);
+		free(uint_result);
+
+		float* float_result = nullptr;
+		outputs[4].GetData(float_result);
+		result &= check_output("Float division", float_result, float_quotients, 6, 0.0f);
+		free(float_result);
+
+		delete program;
+	}
+
+	printf("Verifying out of range samples\n");
+	{
+		const int32_t width = 5;
+		const int32_t height = 3;
+		std::vector<float> data(width * height);
+		for(int32_t k = 0; k < width * height; k++)
+		{
+			data[k] = float(k + 1);
+		}
+
+		SourceOutOfRangeSample source;
+		source.Parse();
+		CPUProgram* program = compiler.Build(source);
+
+		// one larger than the buffer on every side, so the last row and column read past the end too
+		CPUBuffer2D input(width, height, ReturnType::Float, data.data());
+		CPUBuffer2D output(width + 2, height + 2, ReturnType::Float, nullptr);
+		program->Initialize(width + 2, height + 2);
+		program->SetInput(0, input);
+		program->BindOutput(0, output);
+		program->Run();
+
+		std::vector<float> expected((width + 2) * (height + 2));
+		for(int32_t y = 0; y < height + 2; y++)
+		{
+			for(int32_t x = 0; x < width + 2; x++)
+			{
+				const bool inside = x >= 1 && x <= width && y >= 1 && y <= height;
+				expected[y * (width + 2) + x] = inside ? data[(y - 1) * width + x - 1] : 0.0f;
+			}
+		}
+
+		float* calculated = nullptr;
+		output.GetData(calculated);
+		result &= check_output("Out of range samples", calculated, expected.data(), (width + 2) * (height + 2), 0.0f);
+		free(calculated);
+
+		delete program;
+	}
+
+	CPURuntime::Finalize();
+
+	return result;
+}
+
+/// Generated Kernels
+
+// builds in_source on the interpreter and as its generated C++ version; false if no generated version is compiled in
+static bool build_both(CPUCompiler& in_compiler, const Source& in_source, CPUProgram*& out_interpreted, CPUProgram*& out_generated)
+{
+	CPURuntime::SetUseGeneratedKernels(false);
+	out_interpreted = in_compiler.Build(in_source);
+	CPURuntime::SetUseGeneratedKernels(true);
+	out_generated = in_compiler.Build(in_source);
+
+	return out_interpreted->HasGeneratedKernel() == false && out_generated->HasGeneratedKernel();
+}
+
+// runs kernels from the first layer of tutorials/mnist-classifier, whose C++ versions are compiled into OMLT
+// (see source/Generated), on the interpreter and compiled, and checks they agree
+bool VerifyGeneratedKernels(int argc, char** argv)
+{
+	CPURuntime::Initialize();
+
+	std::mt19937_64 random;
+	random.seed(1);
+	std::uniform_real<float> uniform(0.0f, 1.0f);
+
+	// layer1-schedule.json
+	const int32_t visible_units = 784;
+	const int32_t hidden_units = 500;
+	const int32_t minibatch_size = 10;
+	const float dropout = 0.5f;
+
+	std::vector<float> visible(visible_units * minibatch_size);
+	std::vector<float> weights((visible_units + 1) * (hidden_units + 1));
+	std::vector<uint32_t> enabled_visible(visible_units);
+	std::vector<uint32_t> seeds(4 * hidden_units);
+	for(auto& v : visible)
+	{
+		v = uniform(random);
+	}
+	for(auto& w : weights)
+	{
+		w = uniform(random) - 0.5f;
+	}
+	for(auto& e : enabled_visible)
+	{
+		e = random() % 2;
+	}
+	for(auto& s : seeds)
+	{
+		s = uint32_t(random());
+	}
+
+	CPUBuffer2D visible_buffer(visible_units, minibatch_size, ReturnType::Float, visible.data());
+	CPUBuffer2D weights_buffer(visible_units + 1, hidden_units + 1, ReturnType::Float, weights.data());
+	CPUBuffer2D enabled_buffer(visible_units, 1, ReturnType::UInt, enabled_visible.data());
+	CPUBuffer2D seeds_buffer(hidden_units, 1, ReturnType::UInt4, seeds.data());
+
+	bool result = true;
+	CPUCompiler compiler;
+
+	printf("Verifying generated SourceCalcEnabled\n");
+	{
+		CDKernels::SourceCalcEnabled source;
+		source.DROPOUT_PROB = dropout;
+		source.Parse();
+
+		CPUProgram* programs[2];
+		if(build_both(compiler, source, programs[0], programs[1]) == false)
+		{
+			printf("SourceCalcEnabled: no generated kernel\n");
+			result = false;
+		}
+
+		std::vector<uint32_t> states[2];
+		std::vector<uint32_t> next_seeds[2];
+		for(uint32_t k = 0; k < 2; k++)
+		{
+			CPUBuffer2D states_buffer(hidden_units, 1, ReturnType::UInt, nullptr);
+			CPUBuffer2D next_seeds_buffer(hidden_units, 1, ReturnType::UInt4, nullptr);
+			programs[k]->Initialize(hidden_units, 1);
+			programs[k]->SetInput(0, seeds_buffer);
+			programs[k]->BindOutput(0, states_buffer);
+			programs[k]->BindOutput(1, next_seeds_buffer);
+			programs[k]->Run();
+
+			states[k].resize(hidden_units);
+			next_seeds[k].resize(4 * hidden_units);
+			uint32_t* calculated = states[k].data();
+			states_buffer.GetData(calculated);
+			calculated = next_seeds[k].data();
+			next_seeds_buffer.GetData(calculated);
+
+			delete programs[k];
+		}
+
+		result &= check_output("Generated SourceCalcEnabled out_state", states[1].data(), states[0].data(), hidden_units);
+		result &= check_output("Generated SourceCalcEnabled out_seed", next_seeds[1].data(), next_seeds[0].data(), 4 * hidden_units);
+	}
+
+	printf("Verifying generated SourceCalcHidden\n");
+	{
+		CDKernels::SourceCalcHidden source;
+		source.FUNCTION = ActivationFunction::RectifiedLinear;
+		source.VISIBLE_UNITS = visible_units;
+		source.VISIBLE_DROPOUT_PROB = dropout;
+		source.Parse();
+
+		CPUProgram* programs[2];
+		if(build_both(compiler, source, programs[0], programs[1]) == false)
+		{
+			printf("SourceCalcHidden: no generated kernel\n");
+			result = false;
+		}
+
+		std::vector<float> hidden[2];
+		for(uint32_t k = 0; k < 2; k++)
+		{
+			CPUBuffer2D hidden_buffer(hidden_units, minibatch_size, ReturnType::Float, nullptr);
+			programs[k]->Initialize(hidden_units, minibatch_size);
+			programs[k]->SetInput(0, visible_buffer);
+			programs[k]->SetInput(1, weights_buffer);
+			programs[k]->SetInput(2, enabled_buffer);
+			programs[k]->BindOutput(0, hidden_buffer);
+			programs[k]->Run();
+
+			hidden[k].resize(hidden_units * minibatch_size);
+			float* calculated = hidden[k].data();
+			hidden_buffer.GetData(calculated);
+
+			delete programs[k];
+		}
+
+		// the compiler is free to fuse the multiply adds in the generated version
+		result &= check_output("Generated SourceCalcHidden", hidden[1].data(), hidden[0].data(), hidden_units * minibatch_size, 1e-5f);
+	}
+
+	CPURuntime::Finalize();
+
+	return result;
+}
\ No newline at end of file
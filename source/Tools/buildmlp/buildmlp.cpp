@@ -236,19 +236,11 @@ int main(int argc, char** argv)
 	// load up models
 	for(auto it = layers.begin(); it < layers.end(); ++it)
 	{
-		fstream fs;
-		fs.open(it->filename, std::ios_base::in | std::ios_base::binary);;
-		if(fs.is_open() == false)
+		if(Model::FromFile(it->filename.c_str(), it->model) == false)
 		{
 			printf("Could not load model \"%s\"\n", it->filename.c_str());
 			return -1;
 		}
-
-		if(Model::FromJSON(fs, it->model) == false)
-		{
-			printf("Could not parse model \"%s\"\n", it->filename.c_str());
-			return -1;
-		}
 	}
 
 	// now construct our MLP
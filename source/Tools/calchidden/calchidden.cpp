@@ -9,6 +9,11 @@ using namespace OMLT;
 #include <math.h>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 using std::fstream;
 
 const char* Usage = 
@@ -16,19 +21,155 @@ const char* Usage =
 	"model.  RBMs and AutoEncoders calculate their hidden activations while\n"
 	"an MLP will FeedForward through the entire network.\n"
 	"\n"
-	"Usage: calchidden [INPUT] [OUTPUT] [MODEL]\n"
+	"Usage: calchidden [INPUT] [OUTPUT] [MODEL] [ARGS]\n"
 	"\n"
 	"  INPUT     The input IDX dataset used as input\n"
 	"  OUTPUT    Destination IDX to save hidden values\n"
-	"  MODEL     A trained model json file\n";
+	"  MODEL     A trained model file (json or binary)\n"
+	"\n"
+	" Optional Arguments:\n"
+	"  -threads=N      Calculates N batches at a time.  Default value is the number\n"
+	"                  of hardware threads.\n"
+	"  -batch=ROWS     Number of rows in each batch.  Default value is 256.\n";
+
+// Rows go through three stages: a reader thread fills batches from the input, a pool of
+// compute threads runs the model over whole batches, and the main thread writes the finished
+// batches out in order.  Each batch moves through a ring of slots, so the reader can only get
+// so far ahead of the writer.
+enum SlotState
+{
+	Free,
+	Read,
+	Calculated,
+};
+
+struct Slot
+{
+	SlotState state;
+	// which batch is in this slot
+	uint32_t batch;
+	uint32_t rows;
+	// batch_size rows of input_stride and output_stride floats
+	float* visible;
+	float* hidden;
+};
+
+struct Pipeline
+{
+	IDX* input;
+	const Model* model;
+	uint32_t input_count;
+	uint32_t input_stride;
+	uint32_t batch_size;
+	uint32_t batch_count;
+
+	std::vector<Slot> slots;
+	std::mutex mutex;
+	std::condition_variable changed;
+	// next batch to hand out to a compute thread
+	uint32_t next_batch;
+	// set when any stage fails, and every stage stops
+	bool failed;
+};
+
+void calc_batch(const Model& model, const float* visible, float* hidden, uint32_t rows)
+{
+	switch(model.type)
+	{
+	case ModelType::RBM:
+		model.rbm->CalcHiddenMatrix(visible, hidden, rows);
+		break;
+	case ModelType::AE:
+		model.ae->EncodeMatrix(visible, hidden, rows);
+		break;
+	case ModelType::MLP:
+		model.mlp->FeedForwardMatrix(visible, hidden, rows);
+		break;
+	}
+}
+
+void read_batches(Pipeline* pipeline)
+{
+	// rows are read contiguously and then spread out to the padded stride
+	const bool padded = pipeline->input_stride != pipeline->input_count;
+	std::vector<float> rows_buffer(padded ? size_t(pipeline->batch_size) * pipeline->input_count : 0);
+
+	for(uint32_t b = 0; b < pipeline->batch_count; b++)
+	{
+		Slot& slot = pipeline->slots[b % pipeline->slots.size()];
+		{
+			std::unique_lock<std::mutex> lock(pipeline->mutex);
+			pipeline->changed.wait(lock, [&] {return slot.state == Free || pipeline->failed;});
+			if(pipeline->failed)
+			{
+				return;
+			}
+		}
 
+		const uint32_t first = b * pipeline->batch_size;
+		const uint32_t rows = std::min(pipeline->batch_size, pipeline->input->GetRowCount() - first);
+		bool success = pipeline->input->ReadRows(first, rows, padded ? rows_buffer.data() : slot.visible);
+		if(success && padded)
+		{
+			for(uint32_t j = 0; j < rows; j++)
+			{
+				memcpy(slot.visible + size_t(j) * pipeline->input_stride, rows_buffer.data() + size_t(j) * pipeline->input_count, sizeof(float) * pipeline->input_count);
+			}
+		}
 
+		std::lock_guard<std::mutex> lock(pipeline->mutex);
+		if(!success)
+		{
+			printf("Problem reading rows from input IDX file\n");
+			pipeline->failed = true;
+		}
+		else
+		{
+			slot.batch = b;
+			slot.rows = rows;
+			slot.state = Read;
+		}
+		pipeline->changed.notify_all();
+		if(!success)
+		{
+			return;
+		}
+	}
+}
+
+void calc_batches(Pipeline* pipeline)
+{
+	while(true)
+	{
+		Slot* slot;
+		{
+			std::unique_lock<std::mutex> lock(pipeline->mutex);
+			if(pipeline->next_batch == pipeline->batch_count)
+			{
+				return;
+			}
+			const uint32_t b = pipeline->next_batch++;
+			slot = &pipeline->slots[b % pipeline->slots.size()];
+			pipeline->changed.wait(lock, [&] {return (slot->state == Read && slot->batch == b) || pipeline->failed;});
+			if(pipeline->failed)
+			{
+				return;
+			}
+		}
+
+		calc_batch(*pipeline->model, slot->visible, slot->hidden, slot->rows);
+
+		std::lock_guard<std::mutex> lock(pipeline->mutex);
+		slot->state = Calculated;
+		pipeline->changed.notify_all();
+	}
+}
 
 int main(int argc, char** argv)
 {
 	int result = -1;
 
-	if(argc != 4)
+	if(argc < 4)
 	{
 		printf(Usage);
 		return result;
@@ -45,9 +186,27 @@ int main(int argc, char** argv)
 	uint32_t input_count = 0;
 	uint32_t output_count = 0;
 
-	fstream fs;
+	// settings
+	uint32_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+	uint32_t batch_size = 256;
 
-	input = IDX::Load(input_string);
+	for(int i = 4; i < argc; i++)
+	{
+		if(strncmp(argv[i], "-threads=", 9) == 0 && sscanf(argv[i] + 9, "%u", &thread_count) == 1 && thread_count > 0)
+		{
+			continue;
+		}
+		else if(strncmp(argv[i], "-batch=", 7) == 0 && sscanf(argv[i] + 7, "%u", &batch_size) == 1 && batch_size > 0)
+		{
+			continue;
+		}
+
+		printf("Could not parse argument \"%s\"\n", argv[i]);
+		printf(Usage);
+		return result;
+	}
+
+	input = IDX::Map(input_string);
 	if(input == nullptr)
 	{
 		printf("Could not open input IDX file \"%s\"\n", input_string);
@@ -60,15 +219,8 @@ int main(int argc, char** argv)
 	}
 	input_count = input->GetRowLength();
 
-	fs.open(model_string, std::ios_base::in | std::ios_base::binary);
-	if(fs.is_open())
+	if(Model::FromFile(model_string, model))
 	{
-		if(!Model::FromJSON(fs, model))
-		{
-			printf("Could not parse model json from \"%s\"\n", model_string);
-			goto CLEANUP;
-		}
-
 		switch(model.type)
 		{
 		case ModelType::RBM:
@@ -110,7 +262,7 @@ int main(int argc, char** argv)
 	}
 	else
 	{
-		printf("Could not open input model file \"%s\"\n", model_string);
+		printf("Could not load model from \"%s\"\n", model_string);
 		goto CLEANUP;
 	}
 	
@@ -123,33 +275,102 @@ int main(int argc, char** argv)
 		goto CLEANUP;
 	}
 
-	// now calculate hidden values for visible vector
-	float* visible_buffer = (float*)OMLT::AlignedMalloc(sizeof(float) * input_count, 16);
-	float* hidden_buffer = (float*)OMLT::AlignedMalloc(sizeof(float) * output_count, 16);
-
-	for(uint32_t idx = 0; idx < input->GetRowCount(); idx++)
+	// now calculate hidden values on thread_count batches at a time
+	printf("Calculating %s ...\n", output_string);
 	{
-		input->ReadRow(idx, visible_buffer);
-		switch(model.type)
+		const uint32_t input_stride = BlockCount(input_count) * 4;
+		const uint32_t output_stride = BlockCount(output_count) * 4;
+
+		Pipeline pipeline;
+		pipeline.input = input;
+		pipeline.model = &model;
+		pipeline.input_count = input_count;
+		pipeline.input_stride = input_stride;
+		pipeline.batch_size = batch_size;
+		pipeline.batch_count = uint32_t((uint64_t(input->GetRowCount()) + batch_size - 1) / batch_size);
+		pipeline.next_batch = 0;
+		pipeline.failed = false;
+
+		// enough slots for every compute thread to have a batch while the reader and writer work on others
+		pipeline.slots.resize(thread_count * 2 + 2);
+		for(size_t k = 0; k < pipeline.slots.size(); k++)
 		{
-		case ModelType::RBM:
-			model.rbm->CalcHidden(visible_buffer, hidden_buffer);
-			break;
-		case ModelType::AE:
-			model.ae->Encode(visible_buffer, hidden_buffer);
-			break;
-		case ModelType::MLP:
-			model.mlp->FeedForward(visible_buffer, hidden_buffer);
-			break;
+			Slot& slot = pipeline.slots[k];
+			slot.state = Free;
+			slot.batch = 0;
+			slot.rows = 0;
+			slot.visible = (float*)OMLT::AlignedMalloc(sizeof(float) * input_stride * batch_size, 16);
+			slot.hidden = (float*)OMLT::AlignedMalloc(sizeof(float) * output_stride * batch_size, 16);
+			// padding between rows must be zero
+			memset(slot.visible, 0x00, sizeof(float) * input_stride * batch_size);
+		}
+
+		std::vector<std::thread> threads;
+		threads.push_back(std::thread(read_batches, &pipeline));
+		for(uint32_t t = 0; t < thread_count; t++)
+		{
+			threads.push_back(std::thread(calc_batches, &pipeline));
+		}
+
+		// write batches out in order, dropping the padding at the end of each row
+		std::vector<float> rows_buffer(output_stride != output_count ? size_t(batch_size) * output_count : 0);
+		for(uint32_t b = 0; b < pipeline.batch_count; b++)
+		{
+			Slot& slot = pipeline.slots[b % pipeline.slots.size()];
+			{
+				std::unique_lock<std::mutex> lock(pipeline.mutex);
+				pipeline.changed.wait(lock, [&] {return (slot.state == Calculated && slot.batch == b) || pipeline.failed;});
+				if(pipeline.failed)
+				{
+					break;
+				}
+			}
+
+			const float* rows = slot.hidden;
+			if(output_stride != output_count)
+			{
+				for(uint32_t j = 0; j < slot.rows; j++)
+				{
+					memcpy(rows_buffer.data() + size_t(j) * output_count, slot.hidden + size_t(j) * output_stride, sizeof(float) * output_count);
+				}
+				rows = rows_buffer.data();
+			}
+
+			const bool success = output->AddRows(rows, slot.rows);
+
+			std::lock_guard<std::mutex> lock(pipeline.mutex);
+			if(!success)
+			{
+				printf("Problem writing rows to \"%s\"\n", output_string);
+				pipeline.failed = true;
+			}
+			slot.state = Free;
+			pipeline.changed.notify_all();
+			if(!success)
+			{
+				break;
+			}
+		}
+
+		for(size_t t = 0; t < threads.size(); t++)
+		{
+			threads[t].join();
+		}
+
+		for(size_t k = 0; k < pipeline.slots.size(); k++)
+		{
+			OMLT::AlignedFree(pipeline.slots[k].visible);
+			OMLT::AlignedFree(pipeline.slots[k].hidden);
+		}
+
+		if(pipeline.failed)
+		{
+			goto CLEANUP;
 		}
-		
-		output->AddRow(hidden_buffer);
 	}
 
 	output->Close();
-
-	OMLT::AlignedFree(visible_buffer);
-	OMLT::AlignedFree(hidden_buffer);
+	printf("Done!\n");
 
 	result = 0;
 CLEANUP:
@@ -24,19 +24,23 @@ int main(int argc, char** argv)
 	IDX** inputs = new IDX*[idx_count];
 	memset(inputs, NULL, sizeof(IDX*) * idx_count);
 	DataFormat data_format;
+	// when every input has the same byte order, their rows are copied as is
+	Endianness endianness;
+	bool same_endianness = true;
 	uint32_t* row_dimensions = NULL;
 	uint8_t row_dimensions_count;
 	uint32_t* temp_row_dimensions = NULL;
 	// our output IDX file
 	IDX* output = NULL;
-	// temp buffer for reading/writing rows
+	// temp buffer for reading/writing chunks of rows
 	void* row_buffer = NULL;
+	uint32_t chunk_rows = 0;
 	// iterate through each idx file, and verify data is consistent
 	for(uint32_t  k = 0; k < idx_count; k++)
 	{
 		const char* idx_filename = argv[k+1];
 
-		IDX* idx = IDX::Load(idx_filename);
+		IDX* idx = IDX::Map(idx_filename);
 		inputs[k] = idx;
 
 		if(idx == NULL)
@@ -48,6 +52,7 @@ int main(int argc, char** argv)
 		if(k == 0)
 		{
 			data_format = idx->GetDataFormat();
+			endianness = idx->GetEndianness();
 			row_dimensions_count = idx->GetRowDimensionsCount();
 			row_dimensions = new uint32_t[row_dimensions_count];
 			temp_row_dimensions = new uint32_t[row_dimensions_count];
@@ -67,6 +72,7 @@ int main(int argc, char** argv)
 			}
 			else
 			{
+				same_endianness = same_endianness && endianness == idx->GetEndianness();
 				idx->GetRowDimensions(temp_row_dimensions);
 				for(uint32_t k = 1; k < row_dimensions_count; k++)
 				{
@@ -84,7 +90,7 @@ int main(int argc, char** argv)
 	const char* output_filename = argv[argc - 1];
 	// increment row_dimensions + 1 to skip over row count
 	// decrement row_dimensions_count - 1 to remove row count 
-	output = IDX::Create(output_filename, LittleEndian, data_format, row_dimensions + 1, row_dimensions_count - 1);
+	output = IDX::Create(output_filename, same_endianness ? endianness : LittleEndian, data_format, row_dimensions + 1, row_dimensions_count - 1);
 	if(output == NULL)
 	{
 		printf("Unable to create output file %s\n", output_filename);
@@ -92,16 +98,41 @@ int main(int argc, char** argv)
 	}
 	printf("Writing %s to disk ... \n", output_filename);
 
-	row_buffer = malloc(output->GetRowLengthBytes());
-	// now concatenate all these guys together
-	for(uint32_t i = 0; i < idx_count; i++)
+	if(same_endianness)
+	{
+		// the rows can be copied byte for byte
+		for(uint32_t i = 0; i < idx_count; i++)
+		{
+			const char* input_filename = argv[i + 1];
+			printf(" Concatenating %s...\n", input_filename);
+			if(!output->AppendRowsFrom(inputs[i], 0, inputs[i]->GetRowCount()))
+			{
+				printf("Problem copying rows from %s\n", input_filename);
+				goto CLEANUP;
+			}
+		}
+	}
+	else
 	{
-		const char* input_filename = argv[i + 1];
-		printf(" Concatenating %s...\n", input_filename);
-		for(uint32_t k = 0; k < inputs[i]->GetRowCount(); k++)
+		// convert every row to little endian, copying about 16 megabytes worth of rows at a time
+		chunk_rows = uint32_t(16 * 1024 * 1024 / output->GetRowLengthBytes());
+		if(chunk_rows == 0)
+		{
+			chunk_rows = 1;
+		}
+		row_buffer = malloc(size_t(chunk_rows * output->GetRowLengthBytes()));
+		// now concatenate all these guys together
+		for(uint32_t i = 0; i < idx_count; i++)
 		{
-			inputs[i]->ReadRow(k, row_buffer);
-			output->AddRow(row_buffer);
+			const char* input_filename = argv[i + 1];
+			printf(" Concatenating %s...\n", input_filename);
+			const uint32_t row_count = inputs[i]->GetRowCount();
+			for(uint32_t k = 0; k < row_count; k += chunk_rows)
+			{
+				const uint32_t rows = row_count - k < chunk_rows ? row_count - k : chunk_rows;
+				inputs[i]->ReadRows(k, rows, row_buffer);
+				output->AddRows(row_buffer, rows);
+			}
 		}
 	}
 	// write out header
@@ -1,9 +1,19 @@
 #include <stdint.h>
 #include <stdio.h>
+#include <limits.h>
 #include <vector>
+#include <string>
+#include <thread>
 #include <fstream>
 using std::fstream;
 
+// windows
+#ifndef NOMINMAX
+#	define NOMINMAX
+#endif
+// must come before windows.h
+#include <winsock2.h>
+
 // OMLT
 #include <IDX.hpp>
 #include <DataAtlas.h>
@@ -57,11 +67,30 @@ static union
 
 // file to save rbm to
 fstream export_file;
+// save the model in the binary format rather than JSON
+bool exportBinary = false;
 // in quiet mode, reconstruction error is not calculated
 bool quiet = false;
 
 // amount of gpu memory used to allocate our data atlas
 size_t atlasSize = 0;
+// reshuffle the training data every epoch
+bool shuffleData = false;
+uint32_t shuffleSeed = 0;
+// rows read per contiguous shuffle block
+uint32_t shuffleBlockRows = 4096;
+
+// data parallel training: number of worker processes, each training on its own shard of the data
+uint32_t workerCount = 1;
+// this process' worker; worker 0 launches the others and exports the model
+uint32_t workerRank = 0;
+// minibatches trained by each worker between averaging models
+uint32_t syncInterval = 1;
+// worker k listens on basePort + k
+uint32_t basePort = 27800;
+
+// directory the CPU backend writes C++ versions of the kernels it has no compiled version of to
+const char* generatedKernelPath = nullptr;
 
 void print_help()
 {
@@ -76,9 +105,41 @@ void print_help()
 	printf("  -validationData=IDX     Specifies an optional validation data file.\n");
 	printf("  -validationLabels=IDX   Specifies an optional validation label file (for MLPs only)\n");
 	printf("  -import=IN              Specifies filename of optional model to import and train.\n");
+	printf("  -binary                 Exports the model in the binary model format, which loads\n");
+	printf("                          much faster than JSON.\n");
 	printf("  -quiet                  Suppresses all stdout output.\n");
 	printf("  -atlasSize=SIZE         Specifies the total memory allocated for our data atlas in\n");
-	printf("                          megabytes.  Default value is 512.");
+	printf("                          megabytes.  Default value is 512.\n");
+	printf("  -shuffle=SEED           Presents the training data in a new order every epoch,\n");
+	printf("                          seeded with SEED.\n");
+	printf("  -shuffleBlock=ROWS      The shuffle reads the training data in blocks of ROWS\n");
+	printf("                          contiguous rows, in a random order, and mixes the rows\n");
+	printf("                          within each block.  Default value is 4096.\n");
+	printf("  -workers=N              Trains with N processes, each on its own shard of the\n");
+	printf("                          training data, which average their models together every\n");
+	printf("                          few minibatches.  Reported training error is measured on\n");
+	printf("                          the first shard.  Default value is 1.\n");
+	printf("  -syncInterval=K         Specifies the number of minibatches each worker trains\n");
+	printf("                          between averaging models.  Default value is 1.\n");
+	printf("  -port=PORT              Workers communicate over the N localhost ports starting at\n");
+	printf("                          PORT.  Default value is 27800.\n");
+	printf("  -generatedKernelPath=DIR  Writes a C++ version of every kernel built which has not\n");
+	printf("                          been compiled in to DIR (CPU backend only).");
+}
+
+// cltrain trains with the SiCKL trainers, which only run synchronously; the other
+// Parallelism settings are only supported by the CPU trainers
+template<typename TRAINER>
+bool IsSynchronous(const TrainingSchedule<TRAINER>* in_schedule)
+{
+	for(uint32_t k = 0; k < in_schedule->GetTrainingConfigCount(); k++)
+	{
+		if(in_schedule->GetTrainingConfig(k).Parallelism != Parallelism::Synchronous)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 enum HandleArgumentsResults
@@ -98,12 +159,21 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		Schedule,
 		Import,
 		Export,
+		Binary,
 		Quiet,
 		AtlasSize,
+		Shuffle,
+		ShuffleBlock,
+		Workers,
+		SyncInterval,
+		Port,
+		GeneratedKernelPath,
+		// passed to the workers launched by worker 0
+		Rank,
 		Count
 	};
 
-	const char* flags[Count] = {"-trainingData=", "-trainingLabels=", "-validationData=", "-validationLabels=", "-schedule=", "-import=", "-export=", "-quiet", "-atlasSize="};
+	const char* flags[Count] = {"-trainingData=", "-trainingLabels=", "-validationData=", "-validationLabels=", "-schedule=", "-import=", "-export=", "-binary", "-quiet", "-atlasSize=", "-shuffle=", "-shuffleBlock=", "-workers=", "-syncInterval=", "-port=", "-generatedKernelPath=", "-rank="};
 	char* arguments[Count] = {0};
 
 	for(int i = 1; i < argc; i++)
@@ -138,6 +208,31 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		}
 	}
 
+	// data parallel settings
+	if(arguments[Workers] != nullptr && (sscanf(arguments[Workers], "%u", &workerCount) != 1 || workerCount < 1))
+	{
+		printf("Could not parse \"%s\" as a worker count\n", arguments[Workers]);
+		return Error;
+	}
+
+	if(arguments[SyncInterval] != nullptr && (sscanf(arguments[SyncInterval], "%u", &syncInterval) != 1 || syncInterval < 1))
+	{
+		printf("Could not parse \"%s\" as a sync interval\n", arguments[SyncInterval]);
+		return Error;
+	}
+
+	if(arguments[Port] != nullptr && (sscanf(arguments[Port], "%u", &basePort) != 1 || basePort < 1 || basePort + workerCount > 65536))
+	{
+		printf("Could not parse \"%s\" as a port, must leave room for %u ports\n", arguments[Port], workerCount);
+		return Error;
+	}
+
+	if(arguments[Rank] != nullptr && (sscanf(arguments[Rank], "%u", &workerRank) != 1 || workerRank >= workerCount))
+	{
+		printf("Could not parse \"%s\" as a worker rank\n", arguments[Rank]);
+		return Error;
+	}
+
 	// load our training schedule
 	if(arguments[Schedule] == nullptr)
 	{
@@ -155,9 +250,9 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 
 		if(schedule.cd = TrainingSchedule<CD>::FromJSON(schedule_json))
 		{
-			if(schedule.cd->GetMinibatchSize() > SiCKL::OpenGLRuntime::GetMaxTextureSize())
+			if(schedule.cd->GetMinibatchSize() > SiCKLRuntime::GetMaxTextureSize())
 			{
-				printf("Minibatch size greater than %u is not supported.\n", SiCKL::OpenGLRuntime::GetMaxTextureSize());
+				printf("Minibatch size greater than %u is not supported.\n", SiCKLRuntime::GetMaxTextureSize());
 				return Error;
 			}
 			else
@@ -167,9 +262,9 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		}
 		else if(schedule.aebp = TrainingSchedule<AutoEncoderBackPropagation>::FromJSON(schedule_json))
 		{
-			if(schedule.aebp->GetMinibatchSize() > SiCKL::OpenGLRuntime::GetMaxTextureSize())
+			if(schedule.aebp->GetMinibatchSize() > SiCKLRuntime::GetMaxTextureSize())
 			{
-				printf("Minibatch size greater than %u is not supported.\n", SiCKL::OpenGLRuntime::GetMaxTextureSize());
+				printf("Minibatch size greater than %u is not supported.\n", SiCKLRuntime::GetMaxTextureSize());
 				return Error;
 			}
 			else
@@ -179,9 +274,9 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		}
 		else if(schedule.bp = TrainingSchedule<BackPropagation>::FromJSON(schedule_json))
 		{
-			if(schedule.bp->GetMinibatchSize() > SiCKL::OpenGLRuntime::GetMaxTextureSize())
+			if(schedule.bp->GetMinibatchSize() > SiCKLRuntime::GetMaxTextureSize())
 			{
-				printf("Minibatch size greater than %u is not supported.\n", SiCKL::OpenGLRuntime::GetMaxTextureSize());
+				printf("Minibatch size greater than %u is not supported.\n", SiCKLRuntime::GetMaxTextureSize());
 				return Error;
 			}
 			else
@@ -194,6 +289,15 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 			printf("Problem parsing training schedule: \"%s\"\n", arguments[Schedule]);
 			return Error;
 		}
+
+		const bool synchronous = (model_type == ModelType::RBM && IsSynchronous(schedule.cd)) ||
+		                         (model_type == ModelType::AutoEncoder && IsSynchronous(schedule.aebp)) ||
+		                         (model_type == ModelType::MultilayerPerceptron && IsSynchronous(schedule.bp));
+		if(!synchronous)
+		{
+			printf("Parallelism other than \"%s\" is not supported by cltrain\n", ParallelismNames[Parallelism::Synchronous]);
+			return Error;
+		}
 	}
 
 	// error handling
@@ -221,38 +325,38 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 	}
 
 	// get training data file
-	training_data = IDX::Load(arguments[TrainingData]);
+	training_data = IDX::Map(arguments[TrainingData]);
 	if(training_data == nullptr)
 	{
 		printf("Problem loading idx training data: \"%s\"\n", arguments[TrainingData]);
 		return Error;
 	}
-	else if(training_data->GetRowLength() >= SiCKL::OpenGLRuntime::GetMaxTextureSize())
+	else if(training_data->GetRowLength() >= SiCKLRuntime::GetMaxTextureSize())
 	{
-		printf("Training data row length is too long; can only support up to length %u\n", (SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1));
+		printf("Training data row length is too long; can only support up to length %u\n", (SiCKLRuntime::GetMaxTextureSize() - 1));
 		return Error;
 	}
 
 	// if we're training an MLP load the labels
 	if(model_type == ModelType::MultilayerPerceptron)
 	{
-		training_labels = IDX::Load(arguments[TrainingLabels]);
+		training_labels = IDX::Map(arguments[TrainingLabels]);
 		if(training_labels == nullptr)
 		{
 			printf("Problem loading idx training labels: \"%s\"\n", arguments[TrainingLabels]);
 			return Error;
 		}
-		else if(training_labels->GetRowLength() >= SiCKL::OpenGLRuntime::GetMaxTextureSize())
+		else if(training_labels->GetRowLength() >= SiCKLRuntime::GetMaxTextureSize())
 		{
-			printf("Training label row length is too long; can only support up to length %u\n", (SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1));
+			printf("Training label row length is too long; can only support up to length %u\n", (SiCKLRuntime::GetMaxTextureSize() - 1));
 			return Error;
 		}
 	}
 
-	// get optional validation data file
-	if(arguments[ValidationData])
+	// get optional validation data file; only worker 0 reports errors
+	if(arguments[ValidationData] && workerRank == 0)
 	{
-		validation_data = IDX::Load(arguments[ValidationData]);
+		validation_data = IDX::Map(arguments[ValidationData]);
 		if(validation_data == nullptr)
 		{
 			printf("Problem loading idx validation data: \"%s\"\n", arguments[ValidationData]);
@@ -269,7 +373,7 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		{
 			if(arguments[ValidationLabels])
 			{
-				validation_labels = IDX::Load(arguments[ValidationLabels]);
+				validation_labels = IDX::Map(arguments[ValidationLabels]);
 				if(validation_labels == nullptr)
 				{
 					printf("Problem loading idx validation labels: \"%s\"\n", arguments[ValidationLabels]);
@@ -283,7 +387,7 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 			}
 		}
 	}
-	else if(arguments[ValidationLabels])
+	else if(arguments[ValidationLabels] && arguments[ValidationData] == nullptr)
 	{
 		printf("Validation labels was specified but Validation data was not.\n");
 		return Error;
@@ -293,41 +397,31 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 	// get model to start from
 	if(arguments[Import])
 	{
-		fstream fs;
-		fs.open(arguments[Import], std::ios_base::in | std::ios_base::binary);
-		if(fs.is_open() == false)
+		OMLT::Model model;
+		if(!Model::FromFile(arguments[Import], model))
 		{
-			printf("Problem loading model JSON from: \"%s\"\n", arguments[Import]);
+			printf("Problem loading model from: \"%s\"\n", arguments[Import]);
 			return Error;
 		}
-		else
+		else if(model.type != model_type)
 		{
-			OMLT::Model model;
-			if(!Model::FromJSON(fs, model))
-			{
-				printf("Problem parsing model JSON from: \"%s\"\n", arguments[Import]);
-				return Error;
-			}
-			else if(model.type != model_type)
-			{
-				printf("Loaded model from \"%s\" does not match model found in training schedule \"%s\"\n", arguments[Import], arguments[Schedule]);
-				return Error;
-			}
-			switch(model_type)
-			{
-			case ModelType::RBM:
-				loaded.rbm = model.rbm;
-				break;
-			case ModelType::AE:
-				loaded.ae = model.ae;
-				break;
-			case ModelType::MLP:
-				loaded.mlp = model.mlp;
-				break;
-			default:
-				printf("Could not parse \"%s\"\n", arguments[Import]);
-				return Error;
-			}
+			printf("Loaded model from \"%s\" does not match model found in training schedule \"%s\"\n", arguments[Import], arguments[Schedule]);
+			return Error;
+		}
+		switch(model_type)
+		{
+		case ModelType::RBM:
+			loaded.rbm = model.rbm;
+			break;
+		case ModelType::AE:
+			loaded.ae = model.ae;
+			break;
+		case ModelType::MLP:
+			loaded.mlp = model.mlp;
+			break;
+		default:
+			printf("Could not parse \"%s\"\n", arguments[Import]);
+			return Error;
 		}
 	}
 
@@ -338,16 +432,21 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		return Error;
 	}
 
-	export_file.open(arguments[Export], std::ios_base::out | std::ios_base::binary);
-	if(export_file.is_open() == false)
+	// only worker 0 exports the model
+	if(workerRank == 0)
 	{
-		printf("Could not open \"%s\" for writing.\n", arguments[Export]);
-		return Error;
+		export_file.open(arguments[Export], std::ios_base::out | std::ios_base::binary);
+		if(export_file.is_open() == false)
+		{
+			printf("Could not open \"%s\" for writing.\n", arguments[Export]);
+			return Error;
+		}
 	}
 
+	exportBinary = arguments[Binary] != nullptr;
 
 	// should we calculate error/free energy
-	quiet = arguments[Quiet] != nullptr;
+	quiet = arguments[Quiet] != nullptr || workerRank != 0;
 
 	// figure out what our atlas size should be
 	if(arguments[AtlasSize] == nullptr)
@@ -360,6 +459,33 @@ HandleArgumentsResults handle_arguments(int argc, char** argv)
 		return Error;
 	}
 
+	// shuffle seed
+	if(arguments[Shuffle] != nullptr)
+	{
+		if(sscanf(arguments[Shuffle], "%u", &shuffleSeed) != 1)
+		{
+			printf("Could not parse \"%s\" as a shuffle seed\n", arguments[Shuffle]);
+			return Error;
+		}
+		shuffleData = true;
+	}
+
+	// shuffle block size
+	if(arguments[ShuffleBlock] != nullptr && (sscanf(arguments[ShuffleBlock], "%u", &shuffleBlockRows) != 1 || shuffleBlockRows == 0))
+	{
+		printf("Could not parse \"%s\" as a valid shuffle block size, must be at least 1 row\n", arguments[ShuffleBlock]);
+		return Error;
+	}
+
+	if(arguments[GeneratedKernelPath] != nullptr)
+	{
+#ifdef OMLT_SICKL_CPU
+		generatedKernelPath = arguments[GeneratedKernelPath];
+#else
+		printf("-generatedKernelPath is only supported by the CPU backend\n");
+		return Error;
+#endif
+	}
 
 	return Success;
 }
@@ -415,14 +541,310 @@ DataAtlas* training_label_atlas = nullptr;
 DataAtlas* validation_data_atlas = nullptr;
 DataAtlas* validation_label_atlas = nullptr;
 
-SiCKL::OpenGLBuffer2D train_example;
-SiCKL::OpenGLBuffer2D train_label;
-SiCKL::OpenGLBuffer2D validation_example;
-SiCKL::OpenGLBuffer2D validation_label;
+SiCKLBuffer2D train_example;
+SiCKLBuffer2D train_label;
+SiCKLBuffer2D validation_example;
+SiCKLBuffer2D validation_label;
 
 template<typename TRAINER>
 TRAINER* GetTrainer() { return nullptr;}
 
+#pragma region Data Parallel Workers
+
+// The workers form a ring over localhost TCP: each one sends to worker (rank + 1) and receives
+// from worker (rank - 1).  Models are averaged with a ring allreduce, so each worker sends and
+// receives 2 * (N - 1) / N model's worth of data per average regardless of the worker count.
+
+// worker processes launched by worker 0
+std::vector<HANDLE> worker_processes;
+SOCKET send_socket = INVALID_SOCKET;
+SOCKET receive_socket = INVALID_SOCKET;
+
+// model parameters being averaged, and a chunk of them received from our neighbour
+std::vector<float> model_parameters;
+std::vector<float> received_parameters;
+
+// how long to wait for the other workers to start up (milliseconds)
+const uint32_t ConnectTimeout = 60 * 1000;
+
+bool LaunchWorkers()
+{
+	for(uint32_t rank = 1; rank < workerCount; rank++)
+	{
+		// same arguments as us plus the worker's rank
+		char rank_flag[32];
+		sprintf(rank_flag, " -rank=%u", rank);
+		std::string command_line = GetCommandLineA();
+		command_line += rank_flag;
+
+		STARTUPINFOA startup_info;
+		memset(&startup_info, 0x00, sizeof(startup_info));
+		startup_info.cb = sizeof(startup_info);
+		PROCESS_INFORMATION process_info;
+		if(CreateProcessA(NULL, &command_line[0], NULL, NULL, FALSE, 0, NULL, NULL, &startup_info, &process_info) == FALSE)
+		{
+			printf("Could not launch worker %u\n", rank);
+			return false;
+		}
+
+		CloseHandle(process_info.hThread);
+		worker_processes.push_back(process_info.hProcess);
+	}
+
+	return true;
+}
+
+bool ConnectRing()
+{
+	WSADATA wsa_data;
+	if(WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0)
+	{
+		printf("Could not initialize Winsock\n");
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0x00, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	// start listening before connecting so no two workers wait on each other
+	SOCKET listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	address.sin_port = htons(u_short(basePort + workerRank));
+	if(listen_socket == INVALID_SOCKET ||
+	   bind(listen_socket, (sockaddr*)&address, sizeof(address)) != 0 ||
+	   listen(listen_socket, 1) != 0)
+	{
+		printf("Could not listen on port %u\n", basePort + workerRank);
+		closesocket(listen_socket);
+		return false;
+	}
+
+	// our neighbour may not be up yet, so keep trying
+	address.sin_port = htons(u_short(basePort + (workerRank + 1) % workerCount));
+	for(uint32_t waited = 0; send_socket == INVALID_SOCKET; waited += 100)
+	{
+		if(waited >= ConnectTimeout)
+		{
+			printf("Could not connect to worker %u\n", (workerRank + 1) % workerCount);
+			closesocket(listen_socket);
+			return false;
+		}
+
+		send_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if(connect(send_socket, (sockaddr*)&address, sizeof(address)) != 0)
+		{
+			closesocket(send_socket);
+			send_socket = INVALID_SOCKET;
+			Sleep(100);
+		}
+	}
+	// models go out in a single burst per step, don't hold back the tail of it
+	BOOL no_delay = TRUE;
+	setsockopt(send_socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&no_delay, sizeof(no_delay));
+
+	fd_set listen_set;
+	FD_ZERO(&listen_set);
+	FD_SET(listen_socket, &listen_set);
+	timeval timeout = {ConnectTimeout / 1000, 0};
+	if(select(0, &listen_set, NULL, NULL, &timeout) == 1)
+	{
+		receive_socket = accept(listen_socket, NULL, NULL);
+	}
+	closesocket(listen_socket);
+
+	if(receive_socket == INVALID_SOCKET)
+	{
+		printf("Worker %u never connected\n", (workerRank + workerCount - 1) % workerCount);
+		return false;
+	}
+
+	return true;
+}
+
+// closes the ring and waits for the workers we launched to finish
+void DisconnectRing()
+{
+	if(send_socket != INVALID_SOCKET)
+	{
+		closesocket(send_socket);
+		send_socket = INVALID_SOCKET;
+	}
+	if(receive_socket != INVALID_SOCKET)
+	{
+		closesocket(receive_socket);
+		receive_socket = INVALID_SOCKET;
+	}
+	WSACleanup();
+
+	for(uint32_t k = 0; k < worker_processes.size(); k++)
+	{
+		WaitForSingleObject(worker_processes[k], INFINITE);
+		CloseHandle(worker_processes[k]);
+	}
+	worker_processes.clear();
+}
+
+bool SendAll(const float* in_buffer, uint32_t in_count)
+{
+	const char* head = (const char*)in_buffer;
+	size_t remaining = size_t(in_count) * sizeof(float);
+	while(remaining > 0)
+	{
+		const int sent = send(send_socket, head, remaining < INT_MAX ? int(remaining) : INT_MAX, 0);
+		if(sent <= 0)
+		{
+			return false;
+		}
+		head += sent;
+		remaining -= sent;
+	}
+	return true;
+}
+
+bool ReceiveAll(float* out_buffer, uint32_t in_count)
+{
+	char* head = (char*)out_buffer;
+	size_t remaining = size_t(in_count) * sizeof(float);
+	while(remaining > 0)
+	{
+		const int received = recv(receive_socket, head, remaining < INT_MAX ? int(remaining) : INT_MAX, 0);
+		if(received <= 0)
+		{
+			return false;
+		}
+		head += received;
+		remaining -= received;
+	}
+	return true;
+}
+
+// sends to our right neighbour while receiving from our left; every worker sends at the same
+// time, so sending has to happen on another thread or we could all block on full socket buffers
+bool Exchange(const float* in_send, uint32_t in_send_count, float* out_receive, uint32_t in_receive_count)
+{
+	bool sent = false;
+	std::thread sender([&]()
+	{
+		sent = SendAll(in_send, in_send_count);
+	});
+	const bool received = ReceiveAll(out_receive, in_receive_count);
+	sender.join();
+
+	return sent && received;
+}
+
+// the ring allreduce splits the model into one chunk per worker
+uint32_t ChunkBegin(uint32_t in_chunk, uint32_t in_count)
+{
+	return uint32_t(uint64_t(in_count) * (in_chunk % workerCount) / workerCount);
+}
+
+uint32_t ChunkSize(uint32_t in_chunk, uint32_t in_count)
+{
+	const uint32_t chunk_end = uint32_t(uint64_t(in_count) * (in_chunk % workerCount + 1) / workerCount);
+	return chunk_end - ChunkBegin(in_chunk, in_count);
+}
+
+// averages io_buffer across all workers; every worker ends up with the exact same values
+bool Allreduce(float* io_buffer, uint32_t in_count)
+{
+	const uint32_t N = workerCount;
+	received_parameters.resize(in_count / N + 1);
+
+	// reduce-scatter: after step s we hold the sum of chunk (rank - s - 1) over s + 2 workers, so
+	// we finish owning the complete sum of chunk (rank + 1)
+	for(uint32_t s = 0; s < N - 1; s++)
+	{
+		const uint32_t send_chunk = workerRank + N - s;
+		const uint32_t receive_chunk = workerRank + 2 * N - s - 1;
+
+		float* sum = io_buffer + ChunkBegin(receive_chunk, in_count);
+		const uint32_t sum_count = ChunkSize(receive_chunk, in_count);
+		if(!Exchange(io_buffer + ChunkBegin(send_chunk, in_count), ChunkSize(send_chunk, in_count), &received_parameters[0], sum_count))
+		{
+			return false;
+		}
+		for(uint32_t k = 0; k < sum_count; k++)
+		{
+			sum[k] += received_parameters[k];
+		}
+	}
+
+	// allgather: pass the completed sums around the ring
+	for(uint32_t s = 0; s < N - 1; s++)
+	{
+		const uint32_t send_chunk = workerRank + N + 1 - s;
+		const uint32_t receive_chunk = workerRank + N - s;
+
+		if(!Exchange(io_buffer + ChunkBegin(send_chunk, in_count), ChunkSize(send_chunk, in_count), io_buffer + ChunkBegin(receive_chunk, in_count), ChunkSize(receive_chunk, in_count)))
+		{
+			return false;
+		}
+	}
+
+	const float scale = 1.0f / N;
+	for(uint32_t k = 0; k < in_count; k++)
+	{
+		io_buffer[k] *= scale;
+	}
+
+	return true;
+}
+
+// copies worker 0's io_buffer to every other worker
+bool Broadcast(float* io_buffer, uint32_t in_count)
+{
+	if(workerRank != 0 && !ReceiveAll(io_buffer, in_count))
+	{
+		return false;
+	}
+	if(workerRank != workerCount - 1 && !SendAll(io_buffer, in_count))
+	{
+		return false;
+	}
+	return true;
+}
+
+// start every worker from worker 0's model
+template<typename TRAINER>
+bool ShareModel()
+{
+	TRAINER* trainer = GetTrainer<TRAINER>();
+	model_parameters.resize(trainer->GetParameterCount());
+
+	trainer->GetParameters(&model_parameters[0]);
+	if(!Broadcast(&model_parameters[0], uint32_t(model_parameters.size())))
+	{
+		printf("Lost connection to the other workers\n");
+		return false;
+	}
+	trainer->SetParameters(&model_parameters[0]);
+
+	return true;
+}
+
+// replace each worker's weights and weight deltas with their average over all the workers
+template<typename TRAINER>
+bool AverageModels()
+{
+	TRAINER* trainer = GetTrainer<TRAINER>();
+	model_parameters.resize(trainer->GetParameterCount());
+
+	trainer->GetParameters(&model_parameters[0]);
+	if(!Allreduce(&model_parameters[0], uint32_t(model_parameters.size())))
+	{
+		printf("Lost connection to the other workers\n");
+		return false;
+	}
+	trainer->SetParameters(&model_parameters[0]);
+
+	return true;
+}
+
+#pragma endregion
+
+
 template<typename TRAINER>
 void InitDataAtlas(uint32_t minibatch_size)
 {
@@ -433,7 +855,9 @@ void InitDataAtlas(uint32_t minibatch_size)
 
 		// load and initialize data
 		training_data_atlas = new DataAtlas(training_atlas_size);
-		training_data_atlas->Initialize(training_data, minibatch_size);
+		training_data_atlas->SetShard(workerRank, workerCount);
+		training_data_atlas->SetShuffleBlockRows(shuffleBlockRows);
+		training_data_atlas->Initialize(training_data, minibatch_size, shuffleData, shuffleSeed);
 
 		validation_data_atlas = new DataAtlas(validation_atlas_size);
 		validation_data_atlas->Initialize(validation_data, minibatch_size);
@@ -442,7 +866,9 @@ void InitDataAtlas(uint32_t minibatch_size)
 	{
 		uint32_t training_atlas_size = training_data->GetDatasetSize() > atlasSize ? atlasSize : training_data->GetDatasetSize();
 		training_data_atlas = new DataAtlas(training_atlas_size);
-		training_data_atlas->Initialize(training_data, minibatch_size);
+		training_data_atlas->SetShard(workerRank, workerCount);
+		training_data_atlas->SetShuffleBlockRows(shuffleBlockRows);
+		training_data_atlas->Initialize(training_data, minibatch_size, shuffleData, shuffleSeed);
 	}
 }
 
@@ -465,13 +891,26 @@ bool Run(MODEL* in_model, TrainingSchedule<TRAINER>* in_schedule)
 	{
 		return false;
 	}
+
+	// every worker starts from worker 0's model
+	if(workerCount > 1 && ShareModel<TRAINER>() == false)
+	{
+		return false;
+	}
 	
 	uint32_t iterations = 0;
+	// minibatches trained since the workers last averaged their models
+	uint32_t unsynced_batches = 0;
 	uint32_t epoch = 0;
 	float train_error = 0.0f;
 	float validation_error = 0.0f;
 
 	const uint32_t total_batches = training_data_atlas->GetTotalBatches();
+	if(total_batches == 0)
+	{
+		printf("Not enough training data for a single minibatch per worker\n");
+		return false;
+	}
 
 	
 	if(!quiet)
@@ -502,6 +941,14 @@ bool Run(MODEL* in_model, TrainingSchedule<TRAINER>* in_schedule)
 			train_error += GetError<TRAINER>();
 		}
 
+		if(workerCount > 1 && ++unsynced_batches == syncInterval)
+		{
+			if(AverageModels<TRAINER>() == false)
+			{
+				return false;
+			}
+			unsynced_batches = 0;
+		}
 
 
 		iterations = (iterations + 1) % total_batches;
@@ -533,10 +980,19 @@ bool Run(MODEL* in_model, TrainingSchedule<TRAINER>* in_schedule)
 				epoch = 0;
 				if(in_schedule->TrainingComplete())
 				{
-					// get model JSOn and write to disk
-					ToJSON<TRAINER>(export_file);
-					export_file.flush();
-					export_file.close();
+					// the workers all finish together, so they can average in their last few minibatches
+					if(workerCount > 1 && unsynced_batches > 0 && AverageModels<TRAINER>() == false)
+					{
+						return false;
+					}
+
+					// get model and write to disk
+					if(workerRank == 0)
+					{
+						Export<TRAINER>(export_file);
+						export_file.flush();
+						export_file.close();
+					}
 
 					return true;
 				}
@@ -569,7 +1025,7 @@ template <typename TRAINER>
 float Validate() { return 0.0f; }
 
 template <typename TRAINER>
-void ToJSON(std::fstream&) {}
+void Export(std::fstream&) {}
 
 #pragma region Contrastive Divergencce
 
@@ -591,17 +1047,17 @@ bool Initialize<CD>()
 			printf("Model parameters in schedule do not match those found in loaded RBM\n");
 			return false;
 		}
-		else if(loaded.rbm->hidden_count >= SiCKL::OpenGLRuntime::GetMaxTextureSize())
+		else if(loaded.rbm->hidden_count >= SiCKLRuntime::GetMaxTextureSize())
 		{
-			printf("Hidden unit count greater than %u is not supported.\n", (SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1));
+			printf("Hidden unit count greater than %u is not supported.\n", (SiCKLRuntime::GetMaxTextureSize() - 1));
 			return false;
 		}
 
-		trainer.cd = new ContrastiveDivergence(loaded.rbm, schedule.cd->GetMinibatchSize(), schedule.cd->GetSeed());
+		trainer.cd = new ContrastiveDivergence(loaded.rbm, schedule.cd->GetMinibatchSize(), schedule.cd->GetSeed() + workerRank);
 	}
 	else
 	{
-		trainer.cd = new ContrastiveDivergence(model_config, schedule.cd->GetMinibatchSize(), schedule.cd->GetSeed());
+		trainer.cd = new ContrastiveDivergence(model_config, schedule.cd->GetMinibatchSize(), schedule.cd->GetSeed() + workerRank);
 	}
 	
 	CD::TrainingConfig train_config;
@@ -631,10 +1087,17 @@ float Validate<CD>()
 }
 
 template <>
-void ToJSON<CD>(fstream& out)
+void Export<CD>(fstream& out)
 {
 	RBM* rbm = trainer.cd->GetRestrictedBoltzmannMachine();
-	rbm->ToJSON(out);
+	if(exportBinary)
+	{
+		rbm->ToBinary(out);
+	}
+	else
+	{
+		rbm->ToJSON(out);
+	}
 	delete rbm;
 }
 
@@ -661,17 +1124,17 @@ bool Initialize<AutoEncoderBackPropagation>()
 			printf("Model parameters in schedule do not match those found in loaded AutoEncoder\n");
 			return false;
 		}
-		else if(loaded.ae->hidden_count >= SiCKL::OpenGLRuntime::GetMaxTextureSize())
+		else if(loaded.ae->hidden_count >= SiCKLRuntime::GetMaxTextureSize())
 		{
-			printf("Hidden unit count greater than %u is not supported.\n", (SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1));
+			printf("Hidden unit count greater than %u is not supported.\n", (SiCKLRuntime::GetMaxTextureSize() - 1));
 			return false;
 		}
 		
-		trainer.aebp = new AutoEncoderBackPropagation(loaded.ae, schedule.aebp->GetMinibatchSize(), schedule.aebp->GetSeed());
+		trainer.aebp = new AutoEncoderBackPropagation(loaded.ae, schedule.aebp->GetMinibatchSize(), schedule.aebp->GetSeed() + workerRank);
 	}
 	else
 	{
-		trainer.aebp = new AutoEncoderBackPropagation(model_config, schedule.aebp->GetMinibatchSize(), schedule.aebp->GetSeed());
+		trainer.aebp = new AutoEncoderBackPropagation(model_config, schedule.aebp->GetMinibatchSize(), schedule.aebp->GetSeed() + workerRank);
 	}
 
 	AutoEncoderBackPropagation::TrainingConfig train_config;
@@ -701,10 +1164,17 @@ float Validate<AutoEncoderBackPropagation>()
 }
 
 template <>
-void ToJSON<AutoEncoderBackPropagation>(fstream& out)
+void Export<AutoEncoderBackPropagation>(fstream& out)
 {
 	AutoEncoder* ae = trainer.aebp->GetAutoEncoder();
-	ae->ToJSON(out);
+	if(exportBinary)
+	{
+		ae->ToBinary(out);
+	}
+	else
+	{
+		ae->ToJSON(out);
+	}
 	delete ae;
 }
 
@@ -725,9 +1195,13 @@ void InitDataAtlas<BP>(uint32_t minibatch_size)
 		GetOptimalParitioning(atlasSize / 2, training_data->GetDatasetSize(), training_labels->GetDatasetSize(), training_data_atlas_size, training_label_atlas_size);
 
 		training_data_atlas = new DataAtlas(training_data_atlas_size);
-		training_data_atlas->Initialize(training_data, minibatch_size);
+		training_data_atlas->SetShard(workerRank, workerCount);
+		training_data_atlas->SetShuffleBlockRows(shuffleBlockRows);
+		training_data_atlas->Initialize(training_data, minibatch_size, shuffleData, shuffleSeed);
 		training_label_atlas = new DataAtlas(training_label_atlas_size);
-		training_label_atlas->Initialize(training_labels, minibatch_size);
+		training_label_atlas->SetShard(workerRank, workerCount);
+		training_label_atlas->SetShuffleBlockRows(shuffleBlockRows);
+		training_label_atlas->Initialize(training_labels, minibatch_size, shuffleData, shuffleSeed);
 
 		uint32_t validation_data_atlas_size, validation_label_atlas_size;
 		GetOptimalParitioning(atlasSize / 2, validation_data->GetDatasetSize(), validation_labels->GetDatasetSize(), validation_data_atlas_size, validation_label_atlas_size);
@@ -744,9 +1218,13 @@ void InitDataAtlas<BP>(uint32_t minibatch_size)
 		GetOptimalParitioning(atlasSize, training_data->GetDatasetSize(), training_labels->GetDatasetSize(), training_data_atlas_size, training_label_atlas_size);
 
 		training_data_atlas = new DataAtlas(training_data_atlas_size);
-		training_data_atlas->Initialize(training_data, minibatch_size);
+		training_data_atlas->SetShard(workerRank, workerCount);
+		training_data_atlas->SetShuffleBlockRows(shuffleBlockRows);
+		training_data_atlas->Initialize(training_data, minibatch_size, shuffleData, shuffleSeed);
 		training_label_atlas = new DataAtlas(training_label_atlas_size);
-		training_label_atlas->Initialize(training_labels, minibatch_size);
+		training_label_atlas->SetShard(workerRank, workerCount);
+		training_label_atlas->SetShuffleBlockRows(shuffleBlockRows);
+		training_label_atlas->Initialize(training_labels, minibatch_size, shuffleData, shuffleSeed);
 	}
 }
 
@@ -792,7 +1270,7 @@ bool Initialize<BP>()
 
 		if(matches)
 		{
-			trainer.bp = new BackPropagation(loaded.mlp, schedule.bp->GetMinibatchSize(), schedule.bp->GetSeed());
+			trainer.bp = new BackPropagation(loaded.mlp, schedule.bp->GetMinibatchSize(), schedule.bp->GetSeed() + workerRank);
 		}
 		else
 		{
@@ -803,7 +1281,7 @@ bool Initialize<BP>()
 	}
 	else
 	{
-		trainer.bp = new BackPropagation(model_config, schedule.bp->GetMinibatchSize(), schedule.bp->GetSeed());
+		trainer.bp = new BackPropagation(model_config, schedule.bp->GetMinibatchSize(), schedule.bp->GetSeed() + workerRank);
 	}
 
 	BP::TrainingConfig train_config;
@@ -833,10 +1311,17 @@ float Validate<BP>()
 }
 
 template <>
-void ToJSON<BP>(fstream& out)
+void Export<BP>(fstream& out)
 {
 	MLP* mlp = trainer.bp->GetMultilayerPerceptron();
-	mlp->ToJSON(out);
+	if(exportBinary)
+	{
+		mlp->ToBinary(out);
+	}
+	else
+	{
+		mlp->ToJSON(out);
+	}
 	delete mlp;
 }
 
@@ -855,11 +1340,24 @@ int main(int argc, char** argv)
 		{		
 			fflush(stdout);
 
-			if(!SiCKL::OpenGLRuntime::Initialize())
+			if(!SiCKLRuntime::Initialize())
 			{
 				printf("Could not initialize OpenGL runtime; support for OpenGL 3.3 required\n");
 				goto ERROR;
 			}
+#ifdef OMLT_SICKL_CPU
+			SiCKL::CPURuntime::SetGeneratedKernelPath(generatedKernelPath);
+#endif
+
+			// data parallel training, worker 0 launches the rest
+			if(workerCount > 1)
+			{
+				if((workerRank == 0 && LaunchWorkers() == false) || ConnectRing() == false)
+				{
+					DisconnectRing();
+					goto ERROR;
+				}
+			}
 
 			bool success = false;
 			switch(model_type)
@@ -875,6 +1373,11 @@ int main(int argc, char** argv)
 				break;
 			}
 
+			if(workerCount > 1)
+			{
+				DisconnectRing();
+			}
+
 			if(success == false )
 			{
 				goto ERROR;
@@ -1,287 +1,231 @@
-#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
 
 #include <IDX.hpp>
+#include <ParseFloat.h>
 using namespace OMLT;
 
-const char Usage[] = 
+const char Usage[] =
 	"Parses the given CSV file as single precision floats into an IDX file.\n"
 	"\n"
 	"Usage: csv2idx [INPUT] [OUTPUT]\n"
 	"  INPUT   A CSV file (with no header) delimitted with commas\n"
 	"  OUTPUT  Desintation to save IDX file\n";
 
-enum
+enum Error
 {
 	NoError = 0,
 	InvalidCharacter,
 	InconsistentRowLength,
 	InvalidNumberParse,
+	LineTooLong,
+	FileError,
 } error;
-size_t line_length = 1024;
-uint8_t* line_buffer = NULL;
-int line_number = 0;
 
+// The CSV is mapped a view at a time, so files of any size fit in the address space.  Each
+// view is split at line breaks into one chunk per thread, the chunks are parsed in parallel,
+// and then their rows are appended to the IDX in file order.
+const uint64_t ViewSize = 64 * 1024 * 1024;
 
-// returns true if line read (no invalid chars)
-// false on error or end of file
+struct Chunk
+{
+	// the text to parse, starting at the beginning of a line
+	const char* begin;
+	const char* end;
+	// row_count rows of parsed values
+	std::vector<float> rows;
+	uint32_t row_count;
+	// number of lines read (including blank ones and the one that failed to parse)
+	uint64_t line_count;
+	// the line that failed to parse, or NULL
+	const char* error_line;
+	const char* error_line_end;
+};
+
+inline bool is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
 
-bool read_line(FILE* file, uint8_t*& line, size_t& length)
+inline const char* skip_space(const char* head, const char* end)
 {
-	if(line_buffer == NULL)
+	while(head < end && is_space(*head))
 	{
-		line_buffer = (uint8_t*)malloc(line_length);
+		head++;
 	}
+	return head;
+}
 
-	// update the line we're on
-	++line_number;
-	int column_number = 0;
+// the line starting at line, not including its '\n'
+inline const char* line_end(const char* line, const char* end)
+{
+	const char* line_break = (const char*)memchr(line, '\n', size_t(end - line));
+	return line_break ? line_break : end;
+}
 
-	length = 0;
-	for(int32_t b = fgetc(file); b >= 0; b = fgetc(file))
+// number of cells on a line, not counting the empty one after a trailing comma; 0 for blank lines
+uint32_t count_cells(const char* line, const char* end)
+{
+	uint32_t commas = 0;
+	const char* last = NULL;
+	for(const char* head = line; head < end; head++)
 	{
-		// update the column we're on
-		++column_number;
-
-		// double buffer size if we need more memory
-		if(length == line_length)
+		if(*head == ',')
 		{
-			line_length *= 2;
-			uint8_t* new_line_buffer = (uint8_t*)malloc(line_length);
-			memcpy(new_line_buffer, line_buffer, length);
-			free(line_buffer);
-			line_buffer = new_line_buffer;
+			commas++;
 		}
-
-		// end of line get out
-		if(b == '\n')
+		if(!is_space(*head))
 		{
-			line_buffer[length++] = 0;
-			break;
-		}
-		// ignore other whitespace
-		else if(b == '\r' || b == '\t' || b == ' ')
-		{
-			continue;
-		}
-		else
-		{
-			if( b == '-' || b == '+' ||
-				(b >= '0' && b <= '9') ||
-				b == '.' || 
-				b == 'e' || b == 'E' ||
-				b == ',')
-			{
-				line_buffer[length++] = (uint8_t)b;
-			}
-			else
-			{
-				error = InvalidCharacter;
-				// printable character
-				if(b >= 0x20 && b < 0x7F)
-				{
-					printf("Error: Problem reading line, found invalid character on line %i, column %i: \"%c\"\n", line_number, column_number, (char)b);
-				}
-				else
-				{
-					printf("Error: Problem reading line, found invalid byte on line %i, column %i: %02x\n", line_number, column_number,  b);
-				}
-				return false;
-			}
-			
+			last = head;
 		}
 	}
 
-	// end of file found
-	if(length == 0)
+	if(last == NULL)
 	{
-		line = NULL;
-		return false;
+		return 0;
 	}
-	
-	// set the buffer
-	line = line_buffer;
-	// replace last printable character with \0 if it is a comma
-	if(line[length - 1 - 1] == ',')
-	{
-		line[length - 1 - 1] = 0;
-		length--;
-	}
-	return true;
+	return *last == ',' ? commas : commas + 1;
 }
 
-// [+-]?[0-9]*(.[0-9]+)?([eE][+-]?[0-9]+)?
-// this is a constrained float parsing method, no infinity/nan/etc allowed
-bool parse_float(const char* buf, float& result)
+// parses a line of exactly columns cells into row; empty cells (ie: between two commas) are 0
+bool parse_line(const char* line, const char* end, uint32_t columns, float* row)
 {
-	enum
-	{
-		Sign,
-		Integer,
-		Fraction,
-		ExponentSign,
-		Exponent,
-	} state = Sign;
-
-	int sign = 1;
-	double integer = 0.0;
-	int exponent_sign = 1;
-	int exponent = 0;
-
-	while(*buf != 0)
+	const char* head = skip_space(line, end);
+	for(uint32_t k = 0; k < columns; k++)
 	{
-		switch(state)
+		if(k > 0)
 		{
-		case Sign:
-			if(*buf == '+')
-			{
-				sign = 1;
-			}
-			else if(*buf == '-')
-			{
-				sign = -1;
-			}
-			else if(*buf >= '0' && *buf <= '9')
-			{
-				integer = (*buf - '0');
-			}
-			else
-			{
-				return false;
-			}
-			state = Integer;
-			break;
-		case Integer:
-			if(*buf == '.')
-			{
-				state = Fraction;
-			}
-			else if(*buf == 'e' || *buf == 'E')
-			{
-				state = ExponentSign;
-			}
-			else if(*buf >= '0' && *buf <= '9')
-			{
-				integer = integer * 10.0 + (double)(*buf - '0');
-			}
-			else
-			{
-				return false;
-			}
-			break;
-		case Fraction:
-			if(*buf == 'e' || *buf == 'E')
-			{
-				state = ExponentSign;
-			}
-			else if(*buf >= '0' && *buf <= '9')
-			{
-				integer = integer * 10.0 + (double)(*buf - '0');
-				--exponent;
-			}
-			else
-			{
-				return false;
-			}
-			break;
-		case ExponentSign:
-			if(*buf == '+')
-			{
-				state = Exponent;
-				exponent_sign = 1;
-			}
-			else if(*buf == '-')
-			{
-				state = Exponent;
-				exponent_sign = -1;
-			}
-			else if(*buf >= '0' && *buf <= '9')
-			{
-				state = Exponent;
-				exponent += exponent_sign * (int)(*buf - '0');
-			}
-			else
+			if(head == end || *head != ',')
 			{
 				return false;
 			}
-			break;
-		case Exponent:
-			if(*buf >= '0' && *buf <= '9')
-			{
-				exponent += exponent_sign * (int)(*buf - '0');
-			}
-			else
-			{
-				return false;
-			}
-			break;
+			head = skip_space(head + 1, end);
 		}
 
-		++buf;
+		if(head < end && *head == ',')
+		{
+			row[k] = 0.0f;
+		}
+		else if(!ParseFloat(head, end, row[k]))
+		{
+			return false;
+		}
+		head = skip_space(head, end);
 	}
 
-	result = (float)(sign * integer * pow(10.0, exponent));
-
-	return true;
+	// allow a trailing comma
+	if(head < end && *head == ',')
+	{
+		head = skip_space(head + 1, end);
+	}
+	return head == end;
 }
 
-bool parse_line(uint8_t* line_buffer, size_t line_length, float*& row_buffer, int& count)
+// works out why parse_line failed on a line and prints it
+Error report_line_error(const char* line, const char* end, uint32_t columns, uint64_t line_number)
 {
-	// count the number of items in this row
-	int new_count = 0;
-	for(size_t i = 0; i < line_length; i++)
+	for(const char* head = line; head < end; head++)
 	{
-		new_count += line_buffer[i] == ',' ? 1 : 0;
+		const char b = *head;
+		if( b == '-' || b == '+' ||
+			(b >= '0' && b <= '9') ||
+			b == '.' ||
+			b == 'e' || b == 'E' ||
+			b == ',' || is_space(b))
+		{
+			continue;
+		}
+
+		const int column_number = int(head - line) + 1;
+		// printable character
+		if(b >= 0x20 && b < 0x7F)
+		{
+			printf("Error: Problem reading line, found invalid character on line %llu, column %i: \"%c\"\n", (unsigned long long)line_number, column_number, b);
+		}
+		else
+		{
+			printf("Error: Problem reading line, found invalid byte on line %llu, column %i: %02x\n", (unsigned long long)line_number, column_number, (uint8_t)b);
+		}
+		return InvalidCharacter;
 	}
-	// one less comma than items
-	++new_count;
 
-	// allocate memory
-	if(row_buffer == NULL && count == -1)
+	const uint32_t cells = count_cells(line, end);
+	if(cells != columns)
 	{
-		count = new_count;
-		row_buffer = new float[count];
+		printf("Error: Inconsistent number of cells on line %llu; found %u cells but the first row had %u cells\n", (unsigned long long)line_number, cells, columns);
+		return InconsistentRowLength;
 	}
-	// or error
-	else if(count != new_count)
+
+	// find the cell that isn't a number
+	const char* cell = line;
+	for(uint32_t k = 0; k < cells; k++)
 	{
-		printf("Error: Inconsistent number of cells on line %i; found %i cells but the first row had %i cells\n", line_number, new_count, count);
-		error = InconsistentRowLength;
-		return false;
+		const char* cell_end = (const char*)memchr(cell, ',', size_t(end - cell));
+		if(cell_end == NULL)
+		{
+			cell_end = end;
+		}
+
+		const char* head = skip_space(cell, cell_end);
+		const char* value_end = cell_end;
+		while(value_end > head && is_space(value_end[-1]))
+		{
+			value_end--;
+		}
+
+		float value;
+		const char* parsed = head;
+		if(head < value_end && (!ParseFloat(parsed, value_end, value) || parsed != value_end))
+		{
+			printf("Error: Problem parsing value \"%s\" as number on line %llu, column %i\n", std::string(head, value_end).c_str(), (unsigned long long)line_number, int(head - line) + 1);
+			return InvalidNumberParse;
+		}
+
+		cell = cell_end + 1;
 	}
 
-	int begin_index = -1;
-	int end_index;
+	printf("Error: Problem parsing line %llu\n", (unsigned long long)line_number);
+	return InvalidNumberParse;
+}
 
-	for(int k = 0; k < count; k++)
+void parse_chunk(Chunk* chunk, uint32_t columns)
+{
+	for(const char* line = chunk->begin; line < chunk->end; )
 	{
-		for(end_index = begin_index + 1; line_buffer[end_index] != ',' && line_buffer[end_index] != 0; ++end_index);
-		line_buffer[end_index] = 0;	// null teriminate this bit
-		// parse
-		float val = -1;
-		const char* str = (char*)(line_buffer + begin_index + 1);
+		const char* end = line_end(line, chunk->end);
+		chunk->line_count++;
 
-		if(parse_float(str, val) == false)
+		// skip blank lines
+		if(skip_space(line, end) < end)
 		{
-			printf("Error: Problem parsing value \"%s\" as number on line %i, column %i\n", str, line_number, (begin_index + 2));
-			error = InvalidNumberParse;
-			return false;
+			chunk->rows.resize(size_t(chunk->row_count + 1) * columns);
+			if(!parse_line(line, end, columns, &chunk->rows[size_t(chunk->row_count) * columns]))
+			{
+				chunk->error_line = line;
+				chunk->error_line_end = end;
+				return;
+			}
+			chunk->row_count++;
 		}
 
-		row_buffer[k] = (float)val;
-
-		begin_index = end_index;
+		line = end < chunk->end ? end + 1 : end;
 	}
-
-	return true;
 }
 
 int main(int argc, char** argv)
 {
 	int result = -1;
 
-	float* row_buffer = NULL;
-	int columns = -1;
-	FILE* file = NULL;
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+	const char* view = NULL;
+	LARGE_INTEGER file_size;
 	IDX* idx = NULL;
 
 	if(argc != 3)
@@ -290,34 +234,181 @@ int main(int argc, char** argv)
 		goto ERROR;
 	}
 
-	uint8_t* line = NULL;
-	size_t line_length = 0;
+	file = CreateFileA(argv[1], GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size))
+	{
+		printf("Error: Could not open \"%s\"\n", argv[1]);
+		error = FileError;
+		goto ERROR;
+	}
+
+	// empty files can't be mapped (and have no rows)
+	if(file_size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping == NULL)
+		{
+			printf("Error: Could not map \"%s\"\n", argv[1]);
+			error = FileError;
+			goto ERROR;
+		}
+	}
 
-	file = fopen(argv[1], "rb");
-	
 	printf("Reading rows and writing IDX ...\n");
-	while(read_line(file, line, line_length) && parse_line(line, line_length, row_buffer, columns))
 	{
-		if(idx == NULL)
+		SYSTEM_INFO system_info;
+		GetSystemInfo(&system_info);
+		const uint64_t granularity = system_info.dwAllocationGranularity;
+		const uint64_t size = uint64_t(file_size.QuadPart);
+		const uint32_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+		std::vector<Chunk> chunks(thread_count);
+		std::vector<std::thread> threads;
+		uint32_t columns = 0;
+		uint64_t lines_read = 0;
+
+		for(uint64_t offset = 0; offset < size; )
 		{
-			idx = IDX::Create(argv[2], LittleEndian, Single, columns);
+			// map ViewSize bytes starting at the first line we haven't read
+			const uint64_t view_offset = offset - offset % granularity;
+			const uint64_t view_size = std::min(offset - view_offset + ViewSize, size - view_offset);
+			view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, DWORD(view_offset >> 32), DWORD(view_offset), SIZE_T(view_size));
+			if(view == NULL)
+			{
+				printf("Error: Could not map \"%s\"\n", argv[1]);
+				error = FileError;
+				goto ERROR;
+			}
+
+			// only parse whole lines, unless this view reaches the end of the file
+			const char* begin = view + (offset - view_offset);
+			const char* end = view + view_size;
+			if(view_offset + view_size < size)
+			{
+				while(end > begin && end[-1] != '\n')
+				{
+					end--;
+				}
+				if(end == begin)
+				{
+					printf("Error: Line %llu is longer than %llu bytes\n", (unsigned long long)(lines_read + 1), (unsigned long long)ViewSize);
+					error = LineTooLong;
+					goto ERROR;
+				}
+			}
+
+			// the first row sets the number of columns
+			for(const char* line = begin; columns == 0 && line < end; )
+			{
+				const char* next = line_end(line, end);
+				columns = count_cells(line, next);
+				line = next < end ? next + 1 : next;
+			}
+
+			if(columns == 0)
+			{
+				// nothing but blank lines so far
+				lines_read += std::count(begin, end, '\n');
+			}
+			else
+			{
+				if(idx == NULL)
+				{
+					idx = IDX::Create(argv[2], LittleEndian, Single, columns);
+					if(idx == NULL)
+					{
+						printf("Error: Could not create \"%s\"\n", argv[2]);
+						error = FileError;
+						goto ERROR;
+					}
+				}
+
+				// split the view at the first line break after every 1/thread_count of it
+				const size_t chunk_size = size_t(end - begin) / thread_count + 1;
+				const char* chunk_begin = begin;
+				for(uint32_t t = 0; t < thread_count; t++)
+				{
+					const char* chunk_end = chunk_begin + std::min(chunk_size, size_t(end - chunk_begin));
+					if(chunk_end < end)
+					{
+						const char* line_break = (const char*)memchr(chunk_end - 1, '\n', size_t(end - chunk_end) + 1);
+						chunk_end = line_break ? line_break + 1 : end;
+					}
+
+					Chunk& chunk = chunks[t];
+					chunk.begin = chunk_begin;
+					chunk.end = chunk_end;
+					chunk.rows.clear();
+					chunk.row_count = 0;
+					chunk.line_count = 0;
+					chunk.error_line = NULL;
+					chunk.error_line_end = NULL;
+
+					chunk_begin = chunk_end;
+				}
+
+				threads.clear();
+				for(uint32_t t = 0; t < thread_count; t++)
+				{
+					threads.push_back(std::thread(parse_chunk, &chunks[t], columns));
+				}
+				for(uint32_t t = 0; t < thread_count; t++)
+				{
+					threads[t].join();
+				}
+
+				// chunks follow each other in the file, so appending them in order gives each its own
+				// range of rows; everything before the first bad line is kept
+				for(uint32_t t = 0; t < thread_count; t++)
+				{
+					const Chunk& chunk = chunks[t];
+					if(chunk.row_count > 0 && !idx->AddRows(chunk.rows.data(), chunk.row_count))
+					{
+						printf("Error: Could not write rows to \"%s\"\n", argv[2]);
+						error = FileError;
+						goto ERROR;
+					}
+
+					lines_read += chunk.line_count;
+					if(chunk.error_line)
+					{
+						error = report_line_error(chunk.error_line, chunk.error_line_end, columns, lines_read);
+						goto ERROR;
+					}
+				}
+			}
+
+			offset += uint64_t(end - begin);
+			UnmapViewOfFile(view);
+			view = NULL;
 		}
-		idx->AddRow(row_buffer);
 	}
-	
+
 	if(error != NoError)
 	{
 		goto ERROR;
 	}
-	
+
 	result = 0;
 	printf("Done!\n");
 ERROR:
 
-	if(file)
+	if(view)
+	{
+		UnmapViewOfFile(view);
+		view = NULL;
+	}
+
+	if(mapping)
+	{
+		CloseHandle(mapping);
+		mapping = NULL;
+	}
+
+	if(file != INVALID_HANDLE_VALUE)
 	{
-		fclose(file);
-		file = NULL;
+		CloseHandle(file);
+		file = INVALID_HANDLE_VALUE;
 	}
 
 	if(idx)
@@ -37,7 +37,7 @@ int main(int argc, char** argv)
 	} write_dest;
 
 	
-	idx = IDX::Load(argv[1]);
+	idx = IDX::Map(argv[1]);
 	if(idx == NULL)
 	{
 		printf("Could not load file \"%s\"\n", idx_filename);
@@ -2,15 +2,50 @@
 using namespace OMLT;
 
 #include <cstdint>
+#include <vector>
+#include <thread>
+#include <algorithm>
 
 const char* Usage = 
 	"Joins together multiple IDX files with the same number of rows into a\n"
-	"single IDX file.\n"
+	"single IDX file.  Files with different data types are joined as Single,\n"
+	"or as Double if any of them is SInt32 or Double.\n"
 	"\n"
 	"Usage: joinidx [INPUTS] [OUTPUT]\n"
 	"  INPUTS      A list of 1 or more IDX files\n"
 	"  OUTPUT      Output joined IDX file\n";
 
+// a data format that holds every value of both a and b exactly
+DataFormat common_format(DataFormat a, DataFormat b)
+{
+	if(a == b)
+	{
+		return a;
+	}
+	if(a == DataFormat::Double || b == DataFormat::Double || a == DataFormat::SInt32 || b == DataFormat::SInt32)
+	{
+		return DataFormat::Double;
+	}
+	return DataFormat::Single;
+}
+
+// reads count rows of idx starting at first into buffer, converted to format
+void read_block(IDX* idx, uint32_t first, uint32_t count, DataFormat format, uint8_t* buffer, uint8_t* success)
+{
+	if(idx->GetDataFormat() == format)
+	{
+		*success = idx->ReadRows(first, count, buffer);
+	}
+	else if(format == DataFormat::Single)
+	{
+		*success = idx->ReadRowsAsSingle(first, count, (float*)buffer);
+	}
+	else
+	{
+		*success = idx->ReadRowsAsDouble(first, count, (double*)buffer);
+	}
+}
+
 int main(int argc, char** argv)
 {
 	int result = -1;
@@ -29,14 +64,15 @@ int main(int argc, char** argv)
 	uint32_t row_length = 0;
 	// our output IDX file
 	IDX* output = NULL;
-	// temp buffer for reading/writing rows
+	// temp buffer for writing chunks of rows
 	uint8_t* row_buffer = NULL;
+	uint32_t chunk_rows = 0;
 
 	// iterate through each idx file, and verify data is consistent
 	for(uint32_t k = 0; k < idx_count; k++)
 	{
 		const char* idx_filename = argv[k+1];
-		IDX* idx = IDX::Load(idx_filename);
+		IDX* idx = IDX::Map(idx_filename, SequentialAccess);
 		inputs[k] = idx;
 
 		if(idx == NULL)
@@ -53,12 +89,8 @@ int main(int argc, char** argv)
 		}
 		else
 		{
-			if(data_format != idx->GetDataFormat())
-			{
-				printf("Data type in %s is inconsistent with the other files\n", idx_filename);
-				goto CLEANUP;
-			}
-			else if(rows != idx->GetRowCount())
+			data_format = common_format(data_format, idx->GetDataFormat());
+			if(rows != idx->GetRowCount())
 			{
 				printf("Number of rows in %s is inconsistent with the other files\n", idx_filename);
 				goto CLEANUP;
@@ -68,26 +100,6 @@ int main(int argc, char** argv)
 		row_length += idx->GetRowLength();
 	}
 
-	// get the number of bytes per row
-	uint32_t data_width = 0;
-	switch(data_format)
-	{
-	case DataFormat::SInt8:
-	case DataFormat::UInt8:
-		data_width = 1;
-		break;
-	case DataFormat::SInt16:
-		data_width = 2;
-		break;
-	case DataFormat::SInt32:
-	case DataFormat::Single:
-		data_width = 4;
-		break;
-	case DataFormat::Double:
-		data_width = 8;
-		break;
-	}
-	
 	const char* output_filename = argv[argc - 1];
 	// last filename is the result
 	output = IDX::Create(output_filename, LittleEndian, data_format, row_length);
@@ -97,19 +109,90 @@ int main(int argc, char** argv)
 		goto CLEANUP;
 	}
 
-	row_buffer = (uint8_t*)malloc(output->GetRowLengthBytes());
+	// join about 16 megabytes worth of rows at a time
+	chunk_rows = uint32_t(16 * 1024 * 1024 / output->GetRowLengthBytes());
+	if(chunk_rows == 0)
+	{
+		chunk_rows = 1;
+	}
+	row_buffer = (uint8_t*)malloc(size_t(chunk_rows * output->GetRowLengthBytes()));
 
 	printf("Writing %s to disk ... \n", output_filename);
-
-	for(uint32_t k = 0; k < rows; k++)
 	{
-		uint32_t offset = 0;
-		for(uint32_t i = 0 ; i < idx_count; i++)
+		// every input has a thread reading its next block (converted to the output format) while
+		// the current blocks are interleaved into output rows and written
+		const size_t data_width = output->GetDataSize();
+		const size_t output_row_bytes = size_t(output->GetRowLengthBytes());
+		std::vector<std::vector<uint8_t>> current(idx_count);
+		std::vector<std::vector<uint8_t>> next(idx_count);
+		std::vector<uint8_t> success(idx_count, 1);
+		std::vector<std::thread> readers;
+		for(uint32_t i = 0; i < idx_count; i++)
 		{
-			inputs[i]->ReadRow(k, row_buffer + offset);
-			offset += inputs[i]->GetRowLength() * data_width;
+			current[i].resize(size_t(chunk_rows) * inputs[i]->GetRowLength() * data_width);
+			next[i].resize(current[i].size());
+		}
+
+		if(rows > 0)
+		{
+			for(uint32_t i = 0; i < idx_count; i++)
+			{
+				readers.push_back(std::thread(read_block, inputs[i], 0, std::min(rows, chunk_rows), data_format, next[i].data(), &success[i]));
+			}
+		}
+
+		for(uint32_t k = 0; k < rows; k += chunk_rows)
+		{
+			const uint32_t chunk = rows - k < chunk_rows ? rows - k : chunk_rows;
+
+			// wait for this block
+			for(size_t i = 0; i < readers.size(); i++)
+			{
+				readers[i].join();
+			}
+			readers.clear();
+			for(uint32_t i = 0; i < idx_count; i++)
+			{
+				if(!success[i])
+				{
+					printf("Problem reading rows from %s\n", argv[i + 1]);
+					goto CLEANUP;
+				}
+			}
+			current.swap(next);
+
+			// start on the one after
+			const uint32_t next_first = k + chunk;
+			if(next_first < rows)
+			{
+				for(uint32_t i = 0; i < idx_count; i++)
+				{
+					readers.push_back(std::thread(read_block, inputs[i], next_first, std::min(rows - next_first, chunk_rows), data_format, next[i].data(), &success[i]));
+				}
+			}
+
+			size_t offset = 0;
+			for(uint32_t i = 0 ; i < idx_count; i++)
+			{
+				const size_t input_row_bytes = inputs[i]->GetRowLength() * data_width;
+				const uint8_t* input_rows = current[i].data();
+				for(uint32_t j = 0; j < chunk; j++)
+				{
+					memcpy(row_buffer + j * output_row_bytes + offset, input_rows + j * input_row_bytes, input_row_bytes);
+				}
+				offset += input_row_bytes;
+			}
+
+			if(!output->AddRows(row_buffer, chunk))
+			{
+				for(size_t i = 0; i < readers.size(); i++)
+				{
+					readers[i].join();
+				}
+				printf("Problem writing rows to %s\n", output_filename);
+				goto CLEANUP;
+			}
 		}
-		output->AddRow(row_buffer);
 	}
 	// write out header
 	output->Close();
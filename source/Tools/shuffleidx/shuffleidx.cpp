@@ -1,6 +1,11 @@
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <random>
+#include <vector>
+#include <string>
+#include <thread>
 #include <algorithm>
 using std::swap;
 #include <IDX.hpp>
@@ -9,16 +14,298 @@ using OMLT::IDX;
 void printHelp()
 {
 	const char* Usage =
-		"Shuffle an IDX file into a new order.  Shuffling is deterministic based\n"
-		"off of the length of the IDX file (different IDX files with identical\n"
-		"length will be shuffled into the same order).\n"
+		"Shuffle an IDX file into a new order.  Rows are scattered into random\n"
+		"buckets on disk with sequential reads and writes (buckets that are still\n"
+		"too large are scattered again), and then each bucket is shuffled in memory,\n"
+		"so the file doesn't have to fit in memory.  The order is deterministic for\n"
+		"a given SEED, MEMORY and THREADS.\n"
 		"\n"
-		"Usage: shuffleidx [INPUT] [OUTPUT]\n"
+		"Usage: shuffleidx [INPUT] [OUTPUT] [ARGS]\n"
 		"  INPUT     An input IDX data file\n"
-		"  OUTPUT    Destination to save shuffled IDX file";
+		"  OUTPUT    Destination to save shuffled IDX file\n"
+		"\n"
+		" Optional Arguments:\n"
+		"  -seed=SEED      Seeds the shuffle.  Default value is 1.\n"
+		"  -memory=SIZE    Specifies the memory used for buckets in megabytes.  Default\n"
+		"                  value is 512.\n"
+		"  -threads=N      Shuffles N buckets at a time.  Default value is the number of\n"
+		"                  hardware threads.\n";
 	printf(Usage);
 }
 
+// a scatter pass never writes runs smaller than this (unless a bucket runs out of rows), so
+// gathering a bucket back up stays a handful of long sequential reads however large the input
+const uint64_t MinRunBytes = 1024 * 1024;
+
+// rows of one bucket stored contiguously in the bucket file
+struct Run
+{
+	uint32_t bucket;
+	uint32_t first;
+	uint32_t count;
+};
+
+// Fisher-Yates shuffle of count rows of row_length_bytes each, in place
+void shuffle_rows(uint8_t* rows, uint32_t count, size_t row_length_bytes, uint64_t seed, uint32_t bucket)
+{
+	std::seed_seq seq = {uint32_t(seed), uint32_t(seed >> 32), bucket};
+	std::mt19937_64 random(seq);
+
+	std::vector<uint8_t> temp(row_length_bytes);
+	for(uint32_t k = count; k > 1; k--)
+	{
+		std::uniform_int_distribution<uint32_t> uniform(0, k - 1);
+		const uint32_t j = uniform(random);
+		if(j != k - 1)
+		{
+			uint8_t* row_j = rows + size_t(j) * row_length_bytes;
+			uint8_t* row_k = rows + size_t(k - 1) * row_length_bytes;
+			memcpy(temp.data(), row_j, row_length_bytes);
+			memcpy(row_j, row_k, row_length_bytes);
+			memcpy(row_k, temp.data(), row_length_bytes);
+		}
+	}
+}
+
+// settings and state shared by every level of the shuffle
+struct Shuffle
+{
+	IDX* shuffled;
+	const char* shuffled_filename;
+	uint64_t seed;
+	uint64_t memory_bytes;
+	// the most rows (in bytes) a bucket may hold and still be shuffled in memory
+	uint64_t bucket_limit;
+	// scatter passes aim for buckets this large, which leaves room for buckets that come out
+	// larger than average
+	uint64_t bucket_target;
+	// most buckets a scatter pass can fill while keeping its runs at least MinRunBytes
+	uint32_t max_fan_out;
+	uint32_t thread_count;
+	size_t row_length_bytes;
+	// drives every scatter pass, in the order they happen
+	std::mt19937_64 random;
+
+	// buckets read into memory and waiting to be shuffled, up to thread_count at a time
+	std::vector<std::vector<uint8_t>> wave;
+	std::vector<uint32_t> wave_row_counts;
+	uint32_t wave_size;
+	// numbers each bucket's shuffle, in the order they are written out
+	uint32_t next_bucket;
+};
+
+// shuffles the buckets in the wave on their own threads and appends them to the output, then
+// frees them so a scatter pass can use the memory
+bool flush_wave(Shuffle& s)
+{
+	std::vector<std::thread> threads;
+	for(uint32_t t = 0; t < s.wave_size; t++)
+	{
+		threads.push_back(std::thread(shuffle_rows, s.wave[t].data(), s.wave_row_counts[t], s.row_length_bytes, s.seed, s.next_bucket + t));
+	}
+	for(uint32_t t = 0; t < s.wave_size; t++)
+	{
+		threads[t].join();
+	}
+
+	for(uint32_t t = 0; t < s.wave_size; t++)
+	{
+		if(s.wave_row_counts[t] > 0 && !s.shuffled->AddRows(s.wave[t].data(), s.wave_row_counts[t]))
+		{
+			printf("Problem writing to \"%s\"\n", s.shuffled_filename);
+			return false;
+		}
+		std::vector<uint8_t>().swap(s.wave[t]);
+	}
+
+	s.next_bucket += s.wave_size;
+	s.wave_size = 0;
+	return true;
+}
+
+// reads runs [begin, end) of source into the wave as one bucket; reads are sequential within a
+// run, and runs are large
+bool add_bucket(Shuffle& s, IDX* source, const Run* begin, const Run* end)
+{
+	uint32_t rows = 0;
+	for(const Run* r = begin; r < end; r++)
+	{
+		rows += r->count;
+	}
+
+	std::vector<uint8_t>& bucket_rows = s.wave[s.wave_size];
+	bucket_rows.resize(size_t(rows) * s.row_length_bytes);
+	s.wave_row_counts[s.wave_size] = rows;
+
+	uint8_t* dest = bucket_rows.data();
+	for(const Run* r = begin; r < end; r++)
+	{
+		if(!source->ReadRows(r->first, r->count, dest))
+		{
+			printf("Problem reading rows for bucket %u\n", s.next_bucket + s.wave_size);
+			return false;
+		}
+		dest += size_t(r->count) * s.row_length_bytes;
+	}
+
+	if(++s.wave_size == s.thread_count)
+	{
+		return flush_wave(s);
+	}
+	return true;
+}
+
+// scatters the rows in runs [begin, end) of source into bucket_count random buckets; each
+// bucket gathers its rows in memory and is appended to dest as a run when full, and the runs
+// written are returned gathered by bucket, keeping the order they were written in
+bool scatter_rows(Shuffle& s, IDX* source, const Run* begin, const Run* end, uint32_t bucket_count, IDX* dest, const char* dest_filename, std::vector<Run>& out_runs)
+{
+	const size_t row_length_bytes = s.row_length_bytes;
+	const uint32_t staging_rows = uint32_t(std::max<uint64_t>(s.memory_bytes / bucket_count / row_length_bytes, 1));
+	std::vector<uint8_t> staging(size_t(bucket_count) * staging_rows * row_length_bytes);
+	std::vector<uint32_t> staged(bucket_count, 0);
+
+	std::uniform_int_distribution<uint32_t> uniform(0, bucket_count - 1);
+
+	// read the source sequentially about 16 megabytes at a time
+	const uint32_t chunk_rows = uint32_t(std::max<size_t>(1, 16 * 1024 * 1024 / row_length_bytes));
+	std::vector<uint8_t> chunk(size_t(chunk_rows) * row_length_bytes);
+	for(const Run* r = begin; r < end; r++)
+	{
+		for(uint32_t k = 0; k < r->count; k += chunk_rows)
+		{
+			const uint32_t rows = std::min(r->count - k, chunk_rows);
+			if(!source->ReadRows(r->first + k, rows, chunk.data()))
+			{
+				printf("Problem reading rows to scatter\n");
+				return false;
+			}
+
+			for(uint32_t j = 0; j < rows; j++)
+			{
+				const uint32_t b = uniform(s.random);
+				uint8_t* bucket_rows = staging.data() + size_t(b) * staging_rows * row_length_bytes;
+				memcpy(bucket_rows + size_t(staged[b]) * row_length_bytes, chunk.data() + size_t(j) * row_length_bytes, row_length_bytes);
+
+				if(++staged[b] == staging_rows)
+				{
+					Run run = {b, dest->GetRowCount(), staged[b]};
+					if(!dest->AddRows(bucket_rows, staged[b]))
+					{
+						printf("Problem writing to \"%s\"\n", dest_filename);
+						return false;
+					}
+					out_runs.push_back(run);
+					staged[b] = 0;
+				}
+			}
+		}
+	}
+
+	// write out what's left in each bucket
+	for(uint32_t b = 0; b < bucket_count; b++)
+	{
+		if(staged[b] > 0)
+		{
+			Run run = {b, dest->GetRowCount(), staged[b]};
+			if(!dest->AddRows(staging.data() + size_t(b) * staging_rows * row_length_bytes, staged[b]))
+			{
+				printf("Problem writing to \"%s\"\n", dest_filename);
+				return false;
+			}
+			out_runs.push_back(run);
+		}
+	}
+
+	std::stable_sort(out_runs.begin(), out_runs.end(), [](const Run& a, const Run& b) {return a.bucket < b.bucket;});
+	return true;
+}
+
+// shuffles the rows in runs [begin, end) of source and appends them to the output.  When they
+// fit in memory they are shuffled as one bucket, otherwise they are scattered into buckets in
+// this level's bucket file (fanning out no wider than max_fan_out) and each of those buckets is
+// shuffled the same way in turn
+bool shuffle_runs(Shuffle& s, IDX* source, const Run* begin, const Run* end, uint32_t level)
+{
+	uint32_t row_count = 0;
+	for(const Run* r = begin; r < end; r++)
+	{
+		row_count += r->count;
+	}
+
+	const uint64_t data_bytes = uint64_t(row_count) * s.row_length_bytes;
+	if(data_bytes <= s.bucket_limit)
+	{
+		return add_bucket(s, source, begin, end);
+	}
+
+	const uint64_t buckets_needed = (data_bytes + s.bucket_target - 1) / s.bucket_target;
+	const uint32_t bucket_count = uint32_t(std::min<uint64_t>(std::min<uint64_t>(buckets_needed, s.max_fan_out), row_count));
+
+	// the wave's buckets and the staging buffers each take up to the whole memory budget, so
+	// the wave is written out and freed before scattering
+	if(!flush_wave(s))
+	{
+		return false;
+	}
+
+	char suffix[32];
+	sprintf(suffix, level == 0 ? ".buckets" : ".buckets%u", level);
+	const std::string bucket_filename = std::string(s.shuffled_filename) + suffix;
+	if(level == 0)
+	{
+		printf("Scattering rows into %u buckets ...\n", bucket_count);
+	}
+
+	bool success = false;
+	std::vector<Run> runs;
+	IDX* buckets = IDX::Create(bucket_filename.c_str(), s.shuffled->GetEndianness(), s.shuffled->GetDataFormat(), s.shuffled->GetRowLength());
+	if(!buckets)
+	{
+		printf("Could not create temporary IDX file \"%s\"\n", bucket_filename.c_str());
+		goto CLEANUP;
+	}
+
+	if(!scatter_rows(s, source, begin, end, bucket_count, buckets, bucket_filename.c_str(), runs))
+	{
+		goto CLEANUP;
+	}
+
+	// reopen the bucket file for reading
+	buckets->Close();
+	delete buckets;
+	buckets = IDX::Map(bucket_filename.c_str(), OMLT::RandomAccess);
+	if(!buckets)
+	{
+		printf("Problem loading \"%s\" as IDX file.\n", bucket_filename.c_str());
+		goto CLEANUP;
+	}
+
+	for(size_t first_run = 0; first_run < runs.size();)
+	{
+		size_t next_run = first_run;
+		for(; next_run < runs.size() && runs[next_run].bucket == runs[first_run].bucket; next_run++);
+
+		if(!shuffle_runs(s, buckets, runs.data() + first_run, runs.data() + next_run, level + 1))
+		{
+			goto CLEANUP;
+		}
+		first_run = next_run;
+	}
+
+	success = true;
+CLEANUP:
+
+	if(buckets)
+	{
+		buckets->Close();
+		delete buckets;
+	}
+	remove(bucket_filename.c_str());
+
+	return success;
+}
+
 int main(int argc, char** argv)
 {
 	int result = -1;
@@ -28,17 +315,38 @@ int main(int argc, char** argv)
 	// idx files
 	IDX* input = nullptr;
 	IDX* shuffled = nullptr;
-	// buffer of indices for shuffling
-	uint32_t* index_buffer = nullptr;
-	// buffer to read and write data rwos
-	void* row_buffer = nullptr;
-	if(argc != 3)
+	// settings
+	uint64_t seed = 1;
+	uint64_t memory_size = 512;
+	uint32_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	if(argc < 3)
 	{
 		printHelp();
 		goto CLEANUP;
 	}
 
-	input = IDX::Load(input_filename);
+	for(int i = 3; i < argc; i++)
+	{
+		if(strncmp(argv[i], "-seed=", 6) == 0 && sscanf(argv[i] + 6, "%llu", &seed) == 1)
+		{
+			continue;
+		}
+		else if(strncmp(argv[i], "-memory=", 8) == 0 && sscanf(argv[i] + 8, "%llu", &memory_size) == 1 && memory_size > 0)
+		{
+			continue;
+		}
+		else if(strncmp(argv[i], "-threads=", 9) == 0 && sscanf(argv[i] + 9, "%u", &thread_count) == 1 && thread_count > 0)
+		{
+			continue;
+		}
+
+		printf("Could not parse argument \"%s\"\n", argv[i]);
+		printHelp();
+		goto CLEANUP;
+	}
+
+	input = IDX::Map(input_filename, OMLT::SequentialAccess);
 	if(!input)
 	{
 		printf("Problem loading \"%s\" as IDX file.\n", input_filename);
@@ -53,35 +361,32 @@ int main(int argc, char** argv)
 	}
 
 	printf("Shuffling %s to %s...\n", input_filename, shuffled_filename);
-
-	index_buffer = new uint32_t[input->GetRowCount()];
-	// FisherYates shuffle
 	{
-		std::mt19937_64 random;
-		random.seed(1);	// deterministic
-		for(uint32_t k = 0; k < input->GetRowCount(); k++)
-		{
-			index_buffer[k] = k;
-		}
-		for(uint32_t k = input->GetRowCount() - 1; k > 0; k--)
+		Shuffle s;
+		s.shuffled = shuffled;
+		s.shuffled_filename = shuffled_filename;
+		s.seed = seed;
+		s.memory_bytes = memory_size * 1024 * 1024;
+		s.row_length_bytes = size_t(input->GetRowLengthBytes());
+		// thread_count buckets fit in memory at once
+		s.bucket_limit = std::max<uint64_t>(s.memory_bytes / thread_count, s.row_length_bytes);
+		s.bucket_target = std::max<uint64_t>(s.bucket_limit * 4 / 5, s.row_length_bytes);
+		s.max_fan_out = uint32_t(std::max<uint64_t>(s.memory_bytes / MinRunBytes, 2));
+		s.thread_count = thread_count;
+		s.random.seed(seed);
+		s.wave.resize(thread_count);
+		s.wave_row_counts.resize(thread_count);
+		s.wave_size = 0;
+		s.next_bucket = 0;
+
+		// the whole input is the first bucket
+		const Run all = {0, 0, input->GetRowCount()};
+		if(!shuffle_runs(s, input, &all, &all + 1, 0) || !flush_wave(s))
 		{
-			std::uniform_int_distribution<uint32_t> uniform(0, k);
-			uint32_t j = uniform(random);
-			swap(index_buffer[j], index_buffer[k]);
+			goto CLEANUP;
 		}
 	}
 
-	// now write shuffled idx file
-	row_buffer = malloc(input->GetRowLengthBytes());
-	printf("Writing %s to disk ... \n", shuffled_filename);
-	const uint32_t row_count = input->GetRowCount();
-	for(uint32_t k = 0; k < row_count; k++)
-	{
-		uint32_t new_index  = index_buffer[k];
-		input->ReadRow(new_index, row_buffer);
-		shuffled->AddRow(row_buffer);
-	}
-
 	printf("Done!\n");
 
 	result = 0;
@@ -98,8 +403,6 @@ CLEANUP:
 
 	delete input;
 	delete shuffled;
-	delete[] index_buffer;
-	free(row_buffer);
 
 	return result;
 }
\ No newline at end of file
@@ -33,7 +33,7 @@ int main(int argc, char** argv)
 	IDX* input = NULL;
 	IDX* output = NULL;
 	
-	input = IDX::Load(input_string, false);
+	input = IDX::Map(input_string);
 	if(input == NULL)
 	{
 		printf("Unable to open input IDX file \"%s\" for reading\n", input_string);
@@ -78,15 +78,13 @@ int main(int argc, char** argv)
 		count = input->GetRowCount() - from;
 	}
 
-	void* row_buffer = malloc(input->GetRowLengthBytes());
+	// the output has the input's format and byte order, so the rows are copied byte for byte
 	printf("Writing %s to disk ... \n", output_string);
-
-	for(uint32_t i = 0; i < count; i++)
+	if(!output->AppendRowsFrom(input, from, count))
 	{
-		input->ReadRow(from + i, row_buffer);
-		output->AddRow(row_buffer);
+		printf("Problem copying rows to \"%s\"\n", output_string);
+		goto CLEANUP;
 	}
-	free(row_buffer);
 
 	input->Close();
 	output->Close();
@@ -23,6 +23,9 @@
 #include <Model.h>
 using namespace OMLT;
 
+// IDX.hpp pulls in windows.h
+#undef MessageBox
+
 // msft
 using namespace System::IO;
 
@@ -210,8 +213,8 @@ namespace VisualRBMInterop
 		virtual void HandleExportModel(String^ path) = 0;
 		virtual bool HandleImportModel(OMLT::Model& model) = 0;
 		virtual bool HandleLoadScheduleMsg(Message^ msg) = 0;
-		virtual float Train(OpenGLBuffer2D& train_example) = 0;
-		virtual float Validation(OpenGLBuffer2D& validation_example) = 0;
+		virtual float Train(SiCKLBuffer2D& train_example) = 0;
+		virtual float Validation(SiCKLBuffer2D& validation_example) = 0;
 		// returns true if training schedule is complete
 		virtual bool HandleEpochCompleted() = 0;
 
@@ -509,7 +512,7 @@ namespace VisualRBMInterop
 
 			return true;
 		}
-		virtual float Train( OpenGLBuffer2D& train_example )
+		virtual float Train( SiCKLBuffer2D& train_example )
 		{
 			assert(currentState == ProcessorState::Running ||
 				currentState == ProcessorState::ScheduleRunning);
@@ -517,7 +520,7 @@ namespace VisualRBMInterop
 			_trainer->Train(train_example);
 			return _trainer->GetLastReconstructionError();
 		}
-		virtual float Validation( OpenGLBuffer2D& validation_example )
+		virtual float Validation( SiCKLBuffer2D& validation_example )
 		{
 			assert(currentState == ProcessorState::Running ||
 				currentState == ProcessorState::ScheduleRunning);
@@ -700,7 +703,7 @@ namespace VisualRBMInterop
 			return true;
 		}
 
-		virtual float Train( OpenGLBuffer2D& train_example )
+		virtual float Train( SiCKLBuffer2D& train_example )
 		{
 			assert(currentState == ProcessorState::Running ||
 				currentState == ProcessorState::ScheduleRunning);
@@ -709,7 +712,7 @@ namespace VisualRBMInterop
 			return _trainer->GetLastError();
 
 		}
-		virtual float Validation( OpenGLBuffer2D& validation_example )
+		virtual float Validation( SiCKLBuffer2D& validation_example )
 		{
 			assert(currentState == ProcessorState::Running ||
 				currentState == ProcessorState::ScheduleRunning);
@@ -791,14 +794,14 @@ namespace VisualRBMInterop
 
 	void Processor::Run(uint32_t atlasSize)
 	{
-		if(SiCKL::OpenGLRuntime::Initialize() == false)
+		if(SiCKLRuntime::Initialize() == false)
 		{
 			ShowError("VisualRBM requires a GPU that supports at least OpenGL 3.3.");
 			System::Windows::Forms::Application::Exit();
 		}
 
-		SiCKL::OpenGLBuffer2D training_example;
-		SiCKL::OpenGLBuffer2D validation_example;
+		SiCKLBuffer2D training_example;
+		SiCKLBuffer2D validation_example;
 
 		_message_queue = gcnew MessageQueue();
 
@@ -884,13 +887,11 @@ namespace VisualRBMInterop
 						String^ path = (String^)msg["path"];
 						IntPtr p = System::Runtime::InteropServices::Marshal::StringToHGlobalAnsi(path);
 						char* filename = static_cast<char*>(p.ToPointer());
-						
-						std::fstream fs(filename, std::ios_base::in | std::ios_base::binary);
 
 						msg["loaded"] = false;
 
 						OMLT::Model model;
-						if(OMLT::Model::FromJSON(fs, model))
+						if(OMLT::Model::FromFile(filename, model))
 						{
 							bool invalid_type = false;
 							switch(model.type)
@@ -965,7 +966,7 @@ namespace VisualRBMInterop
 						SAFE_DELETE(validation_data)
 					
 						// shutdown opengl
-						SiCKL::OpenGLRuntime::Finalize();
+						SiCKLRuntime::Finalize();
 
 						// empty out the message queue
 						_message_queue->Clear();
@@ -1037,7 +1038,7 @@ namespace VisualRBMInterop
 		IntPtr p = System::Runtime::InteropServices::Marshal::StringToHGlobalAnsi(in_filename);
 		char* filename = static_cast<char*>(p.ToPointer());
 
-		training_idx = IDX::Load(filename);
+		training_idx = IDX::Map(filename);
 		System::Runtime::InteropServices::Marshal::FreeHGlobal(p);
 
 		// verify it's the right data type
@@ -1047,9 +1048,9 @@ namespace VisualRBMInterop
 			delete training_idx;
 			return false;
 		}
-		else if(training_idx->GetRowLength() >= SiCKL::OpenGLRuntime::GetMaxTextureSize())
+		else if(training_idx->GetRowLength() >= SiCKLRuntime::GetMaxTextureSize())
 		{
-			ShowError(String::Format("Error: IDX training data may not have more than {0} values", SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1));
+			ShowError(String::Format("Error: IDX training data may not have more than {0} values", SiCKLRuntime::GetMaxTextureSize() - 1));
 			delete training_idx;
 			return false;
 		}
@@ -1077,7 +1078,7 @@ namespace VisualRBMInterop
 			IntPtr p = System::Runtime::InteropServices::Marshal::StringToHGlobalAnsi(in_filename);
 			char* filename = static_cast<char*>(p.ToPointer());
 
-			validation_idx = IDX::Load(filename);
+			validation_idx = IDX::Map(filename);
 			System::Runtime::InteropServices::Marshal::FreeHGlobal(p);
 
 			// verify it's the right data type
@@ -1268,10 +1269,10 @@ namespace VisualRBMInterop
 		assert(units > 0);
 		if(units != hidden_count)
 		{
-			if(units >= SiCKL::OpenGLRuntime::GetMaxTextureSize())
+			if(units >= SiCKLRuntime::GetMaxTextureSize())
 			{
-				ShowError(String::Format("Maximum number of hidden units supported is {0}", SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1));
-				hidden_count = SiCKL::OpenGLRuntime::GetMaxTextureSize() - 1;
+				ShowError(String::Format("Maximum number of hidden units supported is {0}", SiCKLRuntime::GetMaxTextureSize() - 1));
+				hidden_count = SiCKLRuntime::GetMaxTextureSize() - 1;
 			}
 			else
 			{
@@ -1292,10 +1293,10 @@ namespace VisualRBMInterop
 		assert(ms > 0);
 		if(ms != minibatch_size)
 		{
-			if(ms > SiCKL::OpenGLRuntime::GetMaxTextureSize())
+			if(ms > SiCKLRuntime::GetMaxTextureSize())
 			{
-				ShowError(String::Format("Maximum minibatch size supported is {0}", SiCKL::OpenGLRuntime::GetMaxTextureSize()));
-				minibatch_size = SiCKL::OpenGLRuntime::GetMaxTextureSize();
+				ShowError(String::Format("Maximum minibatch size supported is {0}", SiCKLRuntime::GetMaxTextureSize()));
+				minibatch_size = SiCKLRuntime::GetMaxTextureSize();
 			}
 			else
 			{